@@ -33,6 +33,8 @@
 
 #include "File.h"
 #include "PlexAES.h"
+#include "FileSystem/PlexDirectoryCache.h"
+#include "Client/PlexSearchIndex.h"
 #include "Base64.h"
 #include "Third-Party/hash-library/sha256.h"
 
@@ -63,6 +65,21 @@ CMyPlexManager::CMyPlexManager() : CThread("MyPlexManager"), m_state(STATE_REFRE
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* the listings and search index aren't keyed by user, what one user loaded is gone for the next */
+static void forgetUserData()
+{
+  if (g_plexApplication.directoryCache)
+    g_plexApplication.directoryCache->Clear();
+
+  CPlexSearchIndexPtr searchIndex = g_plexApplication.searchIndex;
+  if (searchIndex)
+  {
+    searchIndex->clear();
+    searchIndex->save();
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 std::string CMyPlexManager::HashPin(const std::string& pin)
 {
@@ -435,6 +452,10 @@ int CMyPlexManager::DoRefreshUserInfo()
   /* reset pin information */
   m_currentPinInfo = CMyPlexPinInfo();
 
+  /* listings loaded for the user before aren't for this one */
+  if (userInfo.id != m_currentUserInfo.id)
+    forgetUserData();
+
   /* update current user info */
   m_currentUserInfo = userInfo;
 
@@ -555,6 +576,8 @@ void CMyPlexManager::Logout()
   m_currentUserInfo = CMyPlexUserInfo();
   g_guiSettings.SetString("myplex.uid", "");
 
+  forgetUserData();
+
   m_wakeEvent.Set();
 
   BroadcastState();
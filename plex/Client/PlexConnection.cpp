@@ -23,7 +23,7 @@ CPlexConnection::CPlexConnection(int type, const CStdString& host, int port, con
 }
 
 CURL
-CPlexConnection::BuildURL(const CStdString &path) const
+CPlexConnection::BuildURL(const CStdString &path, const CStdString &options) const
 {
   CURL ret(m_url);
   CStdString p(path);
@@ -33,8 +33,16 @@ CPlexConnection::BuildURL(const CStdString &path) const
 
   ret.SetFileName(p);
 
-  if (!GetAccessToken().empty())
-    ret.SetOption(GetAccessTokenParameter(), GetAccessToken());
+  if (!options.empty())
+    ret.SetOptions(options);
+
+  CStdString token = GetAccessToken();
+  if (!token.empty())
+  {
+    CStdString parameter = GetAccessTokenParameter();
+    if (options.empty() || !ret.HasOption(parameter))
+      ret.SetOption(parameter, token);
+  }
 
   return ret;
 }
@@ -41,7 +41,7 @@ public:
   static CStdString ConnectionStateName(ConnectionState state);
 
   virtual ConnectionState TestReachability(CPlexServerPtr server);
-  CURL BuildURL(const CStdString& path) const;
+  CURL BuildURL(const CStdString& path, const CStdString& options="") const;
 
   bool IsLocal() const
   {
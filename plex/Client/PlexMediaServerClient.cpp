@@ -38,6 +38,8 @@
 #include "NetworkInterface.h"
 #include "PlexPlayQueueManager.h"
 #include "PlexServerDataLoader.h"
+#include "PlexNotificationClient.h"
+#include "FileSystem/PlexDirectoryCache.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 CURL CPlexMediaServerClient::GetItemURL(CFileItemPtr item)
@@ -67,6 +69,11 @@ void CPlexMediaServerClient::OnJobComplete(unsigned int jobID, bool success, CJo
     {
       /* give us a small breathing room to make sure PMS is up-to-date before reloading */
       Sleep(500);
+
+      // the server might not tell us about changes we made ourselves
+      if (g_plexApplication.directoryCache)
+        g_plexApplication.directoryCache->Invalidate(clientJob->m_url.GetHostName(), PLEX_SECTION_UNKNOWN);
+
       g_plexApplication.dataLoader->Refresh();
       g_windowManager.SendThreadMessage(clientJob->m_msg);
     }
@@ -9,6 +9,18 @@
 
 using namespace std;
 
+/////////////////////////////////////////////////////////////////////////////////////////
+static void updateNameAndVersion(const CPlexServerPtr& server, const NetworkServicePtr& service)
+{
+  CStdString name = service->getParam("Name");
+  if (!name.empty() && name != server->GetName())
+    server->SetName(name);
+
+  CStdString version = service->getParam("Version");
+  if (!version.empty() && version != server->GetVersion())
+    server->SetVersion(version);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////
 void CPlexNetworkServiceBrowser::handleServiceArrival(NetworkServicePtr& service)
 {
@@ -59,16 +71,48 @@ void CPlexNetworkServiceBrowser::handleServiceArrival(NetworkServicePtr& service
     server->AddConnection(conn);
   }
 
+  if (server->GetUUID().empty())
+    return;
+
+  {
+    // a server shows up once per address it answers on and again every time the
+    // network settles, there is nothing to test if we already reach it like this
+    CSingleLock lk(m_serversSection);
+    std::map<CStdString, CPlexServerPtr>::iterator it = m_discoveredServers.find(server->GetUUID());
+    if (it != m_discoveredServers.end())
+    {
+      std::vector<CPlexConnectionPtr> connections;
+      it->second->GetConnections(connections);
+      BOOST_FOREACH(CPlexConnectionPtr known, connections)
+      {
+        if (known->GetHttpUrl() == conn->GetHttpUrl() && known->IsReachable())
+        {
+          // but it could have been renamed or updated since
+          updateNameAndVersion(it->second, service);
+          CPlexServerPtr managed = g_plexApplication.serverManager->FindByUUID(server->GetUUID());
+          if (managed)
+            updateNameAndVersion(managed, service);
+
+          dprintf("CPlexNetworkServiceBrowser::handleServiceArrival %s is known already",
+                  service->address().to_string().c_str());
+          return;
+        }
+      }
+    }
+  }
+
   if (conn->TestReachability(server) == CPlexConnection::CONNECTION_STATE_REACHABLE)
     server->SetActiveConnection(conn);
 
   g_plexApplication.serverManager->UpdateFromDiscovery(server);
 
-  if (!server || server->GetUUID().empty())
-    return;
-
   CSingleLock lk(m_serversSection);
-  m_discoveredServers[server->GetUUID()] = server;
+  // keep the connections on the other addresses, the report has to include all of them
+  std::map<CStdString, CPlexServerPtr>::iterator it = m_discoveredServers.find(server->GetUUID());
+  if (it != m_discoveredServers.end())
+    it->second->Merge(server);
+  else
+    m_discoveredServers[server->GetUUID()] = server;
   dprintf("CPlexNetworkServiceBrowser::handleServiceArrival %s arrived",
           service->address().to_string().c_str());
   g_plexApplication.timer->RestartTimeout(5000, this);
@@ -105,17 +149,22 @@ void CPlexNetworkServiceBrowser::handleNetworkChange(const vector<NetworkInterfa
 
   NetworkServiceBrowser::handleNetworkChange(interfaces);
 
-  bool validInterface = false;
+  std::set<std::string> usableAddresses;
   BOOST_FOREACH(const NetworkInterface& xface, interfaces)
   {
     if (!xface.loopback() && !boost::starts_with(xface.address(), "169.254."))
-    {
-      validInterface = true;
-      break;
-    }
+      usableAddresses.insert(xface.address());
+  }
+
+  // nothing to test again if the change didn't touch the addresses we reach the servers from
+  if (usableAddresses == m_usableAddresses)
+  {
+    CLog::Log(LOGDEBUG, "CPlexNetworkServiceBrowser::handleNetworkChange usable addresses didn't change");
+    return;
   }
+  m_usableAddresses = usableAddresses;
 
-  if (validInterface)
+  if (!usableAddresses.empty())
   {
     // update all our reachability states
     g_plexApplication.serverManager->UpdateReachability(true);
@@ -157,11 +206,13 @@ void CPlexServiceListener::Process()
 {
   dprintf("CPlexServiceListener: Initializing.");
 
-  // We start watching for changes in here.
+  // We start watching for changes in here, the browser and the advertiser hear about them from the loop.
   NetworkInterface::WatchForChanges();
+  m_loop.watch();
 
   // Server browser.
   m_pmsBrowser = NetworkServiceBrowserPtr(new CPlexNetworkServiceBrowser(m_ioService, NS_PLEX_MEDIA_SERVER_PORT));
+  m_loop.addService(m_pmsBrowser.get());
 
   // start our reporting timer
   g_plexApplication.timer->SetTimeout(5000, (CPlexNetworkServiceBrowser*)m_pmsBrowser.get());
@@ -3,10 +3,12 @@
 #define BOOST_ASIO_DISABLE_IOCP 1; // IOCP reactor reads failed using boost 1.44.
 
 #include <boost/lexical_cast.hpp>
+#include <set>
 #include <vector>
 
 #include "plex/PlexUtils.h"
 #include "Network/NetworkServiceBrowser.h"
+#include "Network/NetworkServiceLoop.h"
 #include "Network/PlexNetworkServiceAdvertiser.h"
 #include "Client/PlexServerManager.h"
 #include "settings/GUISettings.h"
@@ -46,6 +48,10 @@ private:
   CCriticalSection m_serversSection;
   std::map<CStdString, CPlexServerPtr> m_discoveredServers;
   boost::asio::deadline_timer m_addTimer;
+
+  /// the addresses we could reach servers on last time, reachability only
+  /// needs to be tested again when they change
+  std::set<std::string> m_usableAddresses;
 };
 
 ///
@@ -54,7 +60,7 @@ private:
 class CPlexServiceListener : public CThread
 {
 public:
-  CPlexServiceListener() : CThread("PlexServiceListener")
+  CPlexServiceListener() : CThread("PlexServiceListener"), m_loop(m_ioService)
   {
     Create();
   }
@@ -68,6 +74,9 @@ public:
     m_ioService.stop();
     StopThread(true);
 
+    if (m_pmsBrowser)
+      m_loop.removeService(m_pmsBrowser.get());
+
     m_plexAdvertiser.reset();
     m_pmsBrowser.reset();
   }
@@ -77,6 +86,7 @@ public:
     if (m_plexAdvertiser)
     {
       dprintf("NetworkService: shutting down player advertisement");
+      m_loop.removeService(m_plexAdvertiser.get());
       m_plexAdvertiser->stop();
     }
   }
@@ -87,8 +97,12 @@ public:
     if(g_guiSettings.GetBool("services.plexplayer"))
     {
       dprintf("NetworkService: starting player advertisement");
+      if (m_plexAdvertiser)
+        m_loop.removeService(m_plexAdvertiser.get());
+
       m_plexAdvertiser = NetworkServiceAdvertiserPtr(new PlexNetworkServiceAdvertiser(m_ioService, NS_PLEX_MEDIA_CLIENT_PORT));
       m_plexAdvertiser->start();
+      m_loop.addService(m_plexAdvertiser.get());
     }
   }
 
@@ -96,6 +110,7 @@ public:
 
 private:
   boost::asio::io_service     m_ioService;
+  NetworkServiceLoop          m_loop;
   NetworkServiceBrowserPtr    m_pmsBrowser;
   NetworkServiceAdvertiserPtr m_plexAdvertiser;
 };
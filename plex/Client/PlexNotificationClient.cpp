@@ -0,0 +1,677 @@
+// sha1.hpp has to come before PlatformDefs.h redefines byte
+#include <boost/uuid/sha1.hpp>
+
+#include "PlexNotificationClient.h"
+#include "PlexApplication.h"
+#include "PlexTypes.h"
+#include "FileSystem/PlexDirectoryCache.h"
+#include "Client/PlexServerDataLoader.h"
+#include "GUIMessage.h"
+#include "guilib/GUIWindowManager.h"
+#include "network/websocket/WebSocket.h"
+#include "utils/Base64.h"
+#include "utils/JSONVariantParser.h"
+#include "utils/EndianSwap.h"
+#include "utils/log.h"
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <stdlib.h>
+
+using boost::asio::ip::tcp;
+
+#define WS_KEY_MAGICSTRING "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+/* the timeline states of items that are done being added or were deleted */
+#define TIMELINE_STATE_DONE 5
+#define TIMELINE_STATE_DELETED 9
+
+/* a notification is a few hundred bytes, anything this big is garbage */
+#define NOTIFICATION_MAX_FRAME (1024 * 1024)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static std::string CalculateAcceptKey(const std::string& key)
+{
+  std::string acceptKey = key + WS_KEY_MAGICSTRING;
+
+  boost::uuids::detail::sha1 hash;
+  hash.process_bytes(acceptKey.c_str(), acceptKey.size());
+
+  unsigned int digest[5];
+  hash.get_digest(digest);
+
+  for (unsigned int index = 0; index < 5; index++)
+    digest[index] = Endian_SwapBE32(digest[index]);
+
+  return Base64::Encode((const char*)digest, sizeof(digest));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexNotificationConnection::CPlexNotificationConnection(boost::asio::io_service& io,
+                                                         CPlexNotificationClient* client,
+                                                         const CStdString& uuid, const CURL& url)
+  : m_io(io), m_client(client), m_uuid(uuid), m_url(url), m_resolver(io), m_socket(io), m_retryTimer(io),
+    m_retryDelay(1), m_connected(false), m_closed(false)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::start()
+{
+  m_io.post(boost::bind(&CPlexNotificationConnection::connect, shared_from_this()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::close()
+{
+  m_io.post(boost::bind(&CPlexNotificationConnection::shutdown, shared_from_this()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::shutdown()
+{
+  m_closed = true;
+  m_retryTimer.cancel();
+  m_resolver.cancel();
+  disconnect("closed");
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::connect()
+{
+  if (m_closed)
+    return;
+
+  int port = m_url.GetPort() ? m_url.GetPort() : 32400;
+  tcp::resolver::query query(m_url.GetHostName(), boost::lexical_cast<std::string>(port));
+  m_resolver.async_resolve(query, boost::bind(&CPlexNotificationConnection::onResolved, shared_from_this(),
+                                              boost::asio::placeholders::error,
+                                              boost::asio::placeholders::iterator));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::retry()
+{
+  if (m_closed)
+    return;
+
+  CLog::Log(LOGDEBUG, "CPlexNotificationConnection::retry reconnecting to %s in %d seconds",
+            m_uuid.c_str(), m_retryDelay);
+
+  m_retryTimer.expires_from_now(boost::posix_time::seconds(m_retryDelay));
+  m_retryTimer.async_wait(boost::bind(&CPlexNotificationConnection::onRetry, shared_from_this(),
+                                      boost::asio::placeholders::error));
+
+  m_retryDelay = std::min(m_retryDelay * 2, NOTIFICATION_RETRY_MAX_SEC);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::onRetry(const boost::system::error_code& error)
+{
+  if (!error)
+    connect();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::onResolved(const boost::system::error_code& error, tcp::resolver::iterator it)
+{
+  if (m_closed)
+    return;
+
+  if (error)
+  {
+    CLog::Log(LOGDEBUG, "CPlexNotificationConnection::onResolved can't resolve %s: %s",
+              m_url.GetHostName().c_str(), error.message().c_str());
+    retry();
+    return;
+  }
+
+  boost::asio::async_connect(m_socket, it, boost::bind(&CPlexNotificationConnection::onConnected, shared_from_this(),
+                                                       boost::asio::placeholders::error));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::onConnected(const boost::system::error_code& error)
+{
+  if (m_closed)
+    return;
+
+  if (error)
+  {
+    disconnect("connect failed: " + error.message());
+    retry();
+    return;
+  }
+
+  boost::system::error_code ec;
+  m_socket.set_option(boost::asio::socket_base::keep_alive(true), ec);
+
+  char nonce[16];
+  for (size_t i = 0; i < sizeof(nonce); i++)
+    nonce[i] = (char)(rand() & 0xff);
+  m_key = Base64::Encode(nonce, sizeof(nonce));
+
+  m_request = "GET /" + m_url.GetFileName() + m_url.GetOptions() + " HTTP/1.1\r\n";
+  m_request += "Host: " + m_url.GetHostName() + "\r\n";
+  m_request += "Upgrade: websocket\r\n";
+  m_request += "Connection: Upgrade\r\n";
+  m_request += "Sec-WebSocket-Key: " + m_key + "\r\n";
+  m_request += "Sec-WebSocket-Version: 13\r\n\r\n";
+
+  boost::asio::async_write(m_socket, boost::asio::buffer(m_request),
+                           boost::bind(&CPlexNotificationConnection::onHandshakeSent, shared_from_this(),
+                                       boost::asio::placeholders::error));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::onHandshakeSent(const boost::system::error_code& error)
+{
+  if (m_closed)
+    return;
+
+  if (error)
+  {
+    disconnect("handshake failed: " + error.message());
+    retry();
+    return;
+  }
+
+  boost::asio::async_read_until(m_socket, m_handshake, "\r\n\r\n",
+                                boost::bind(&CPlexNotificationConnection::onHandshakeRead, shared_from_this(),
+                                            boost::asio::placeholders::error,
+                                            boost::asio::placeholders::bytes_transferred));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::onHandshakeRead(const boost::system::error_code& error, size_t bytes)
+{
+  if (m_closed)
+    return;
+
+  if (error)
+  {
+    disconnect("handshake failed: " + error.message());
+    retry();
+    return;
+  }
+
+  std::string data(boost::asio::buffers_begin(m_handshake.data()), boost::asio::buffers_end(m_handshake.data()));
+  m_handshake.consume(m_handshake.size());
+
+  std::string header = data.substr(0, bytes);
+  std::vector<std::string> lines;
+  boost::split(lines, header, boost::is_any_of("\r\n"), boost::token_compress_on);
+
+  bool accepted = false;
+  if (lines.size() > 0 && lines[0].find(" 101") != std::string::npos)
+  {
+    std::string expected = CalculateAcceptKey(m_key);
+    BOOST_FOREACH(const std::string& line, lines)
+    {
+      size_t colon = line.find(':');
+      if (colon != std::string::npos &&
+          boost::iequals(line.substr(0, colon), "Sec-WebSocket-Accept") &&
+          boost::trim_copy(line.substr(colon + 1)) == expected)
+        accepted = true;
+    }
+  }
+
+  if (!accepted)
+  {
+    // older servers don't have the notification endpoint, we keep polling those
+    disconnect("server refused: " + (lines.size() > 0 ? lines[0] : std::string()));
+    retry();
+    return;
+  }
+
+  CLog::Log(LOGINFO, "CPlexNotificationConnection::onHandshakeRead listening to %s", m_uuid.c_str());
+
+  setConnected(true);
+  m_retryDelay = 1;
+  m_client->OnConnected(m_uuid, true);
+
+  // the server might have sent something right away
+  m_buffer = data.substr(bytes);
+  if (!processFrames())
+  {
+    disconnect("invalid frame");
+    retry();
+    return;
+  }
+
+  read();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::read()
+{
+  m_socket.async_read_some(boost::asio::buffer(m_readBuffer, sizeof(m_readBuffer)),
+                           boost::bind(&CPlexNotificationConnection::onRead, shared_from_this(),
+                                       boost::asio::placeholders::error,
+                                       boost::asio::placeholders::bytes_transferred));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::onRead(const boost::system::error_code& error, size_t bytes)
+{
+  if (m_closed)
+    return;
+
+  if (error)
+  {
+    disconnect("read failed: " + error.message());
+    retry();
+    return;
+  }
+
+  m_buffer.append(m_readBuffer, bytes);
+  if (!processFrames())
+  {
+    disconnect("invalid frame");
+    retry();
+    return;
+  }
+
+  read();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexNotificationConnection::processFrames()
+{
+  while (m_buffer.size() >= 2)
+  {
+    // work out if we have the whole frame before handing it to the parser
+    bool masked = ((unsigned char)m_buffer[1] & 0x80) != 0;
+    uint64_t length = (unsigned char)m_buffer[1] & 0x7f;
+    size_t lengthBytes = (length == 126) ? 2 : ((length == 127) ? 8 : 0);
+    size_t header = 2 + lengthBytes + (masked ? 4 : 0);
+
+    if (m_buffer.size() < header)
+      break;
+
+    if (lengthBytes)
+    {
+      length = 0;
+      for (size_t i = 0; i < lengthBytes; i++)
+        length = (length << 8) | (unsigned char)m_buffer[2 + i];
+    }
+
+    if (length > NOTIFICATION_MAX_FRAME)
+      return false;
+
+    if (m_buffer.size() < header + length)
+      break;
+
+    CWebSocketFrame frame(&m_buffer[0], header + length);
+    if (!frame.IsValid())
+      return false;
+
+    std::string payload;
+    if (frame.GetApplicationData())
+      payload.assign(frame.GetApplicationData(), frame.GetLength());
+
+    switch (frame.GetOpcode())
+    {
+      case WebSocketTextFrame:
+      case WebSocketBinaryFrame:
+        m_message = payload;
+        break;
+      case WebSocketContinuationFrame:
+        m_message += payload;
+        break;
+      case WebSocketPing:
+        send(WebSocketPong, payload);
+        break;
+      case WebSocketConnectionClose:
+        return false;
+      default:
+        break;
+    }
+
+    if (!frame.IsControlFrame() && frame.IsFinal())
+    {
+      m_client->OnNotification(m_uuid, m_message);
+      m_message.clear();
+    }
+
+    m_buffer.erase(0, header + length);
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::send(int opcode, const std::string& data)
+{
+  // frames from the client have to be masked
+  CWebSocketFrame frame((WebSocketFrameOpcode)opcode, data.c_str(), data.size(), true, true, rand());
+  boost::shared_ptr<std::string> buffer(new std::string(frame.GetFrameData(), frame.GetFrameLength()));
+
+  boost::asio::async_write(m_socket, boost::asio::buffer(*buffer),
+                           boost::bind(&CPlexNotificationConnection::onSent, shared_from_this(),
+                                       boost::asio::placeholders::error, buffer));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::onSent(const boost::system::error_code& error, boost::shared_ptr<std::string> data)
+{
+  if (error && !m_closed)
+    CLog::Log(LOGDEBUG, "CPlexNotificationConnection::onSent failed to write to %s: %s",
+              m_uuid.c_str(), error.message().c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::disconnect(const std::string& reason)
+{
+  boost::system::error_code ec;
+  m_socket.close(ec);
+
+  m_buffer.clear();
+  m_message.clear();
+  m_handshake.consume(m_handshake.size());
+
+  if (m_connected)
+  {
+    CLog::Log(LOGINFO, "CPlexNotificationConnection::disconnect stopped listening to %s: %s",
+              m_uuid.c_str(), reason.c_str());
+    setConnected(false);
+    m_client->OnConnected(m_uuid, false);
+  }
+  else if (!m_closed)
+  {
+    CLog::Log(LOGDEBUG, "CPlexNotificationConnection::disconnect can't listen to %s: %s",
+              m_uuid.c_str(), reason.c_str());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationConnection::setConnected(bool connected)
+{
+  CSingleLock lk(m_connectedLock);
+  m_connected = connected;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexNotificationConnection::isConnected() const
+{
+  CSingleLock lk(m_connectedLock);
+  return m_connected;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexNotificationClient::CPlexNotificationClient()
+  : CThread("PlexNotificationClient"), m_work(new boost::asio::io_service::work(m_io))
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexNotificationClient::~CPlexNotificationClient()
+{
+  Stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationClient::AddServer(const CPlexServerPtr& server)
+{
+  // shared servers don't tell us about their library, myPlex isn't a media server
+  if (!server || server->GetUUID() == "myplex" || server->IsShared() || server->GetSynced())
+    return;
+
+  CURL url = server->BuildURL(PLEX_NOTIFICATION_PATH);
+  if (url.GetHostName().empty())
+    return;
+
+  if (url.GetProtocol() == "https")
+  {
+    CLog::Log(LOGDEBUG, "CPlexNotificationClient::AddServer %s is only reachable over https, polling it instead",
+              server->GetName().c_str());
+    return;
+  }
+
+  Listen(server->GetUUID(), url);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationClient::Listen(const CStdString& uuid, const CURL& url)
+{
+  CSingleLock lk(m_lock);
+
+  if (!m_work)
+    return;
+
+  std::map<CStdString, CPlexNotificationConnectionPtr>::iterator it = m_connections.find(uuid);
+  if (it != m_connections.end())
+  {
+    if (it->second->getUrl().Get() == url.Get())
+      return;
+    it->second->close();
+  }
+
+  CPlexNotificationConnectionPtr connection(new CPlexNotificationConnection(m_io, this, uuid, url));
+  m_connections[uuid] = connection;
+  connection->start();
+
+  if (!IsRunning())
+    Create();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationClient::RemoveServer(const CStdString& uuid)
+{
+  CSingleLock lk(m_lock);
+
+  std::map<CStdString, CPlexNotificationConnectionPtr>::iterator it = m_connections.find(uuid);
+  if (it == m_connections.end())
+    return;
+
+  it->second->close();
+  m_connections.erase(it);
+  m_pendingChanges.erase(uuid);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexNotificationClient::IsListening(const CStdString& uuid)
+{
+  CSingleLock lk(m_lock);
+
+  std::map<CStdString, CPlexNotificationConnectionPtr>::const_iterator it = m_connections.find(uuid);
+  return it != m_connections.end() && it->second->isConnected();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationClient::Stop()
+{
+  {
+    CSingleLock lk(m_lock);
+
+    std::pair<CStdString, CPlexNotificationConnectionPtr> p;
+    BOOST_FOREACH(p, m_connections)
+      p.second->close();
+    m_connections.clear();
+    m_pendingChanges.clear();
+
+    if (m_work)
+    {
+      delete m_work;
+      m_work = NULL;
+    }
+  }
+
+  if (g_plexApplication.timer)
+    g_plexApplication.timer->RemoveTimeout(this);
+
+  // the closed connections finish on the io thread, after that run() returns
+  StopThread(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationClient::Process()
+{
+  while (!m_bStop)
+  {
+    try
+    {
+      m_io.run();
+      break;
+    }
+    catch (std::exception& e)
+    {
+      CLog::Log(LOGERROR, "CPlexNotificationClient::Process exception %s", e.what());
+
+      // run() won't pick up the remaining handlers again without it
+      m_io.reset();
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationClient::OnConnected(const CStdString& uuid, bool connected)
+{
+  if (g_plexApplication.directoryCache)
+    g_plexApplication.directoryCache->SetServerListening(uuid, connected);
+
+  if (!connected)
+    return;
+
+  // we don't know what happened while we weren't listening
+  bool missed;
+  {
+    CSingleLock lk(m_lock);
+    missed = !m_listened.insert(uuid).second;
+  }
+
+  if (missed)
+  {
+    std::set<int> sections;
+    sections.insert(PLEX_SECTION_UNKNOWN);
+    QueueChanges(uuid, sections);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationClient::OnNotification(const CStdString& uuid, const std::string& json)
+{
+  std::set<int> sections;
+  if (ParseNotification(json, sections))
+    QueueChanges(uuid, sections);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationClient::QueueChanges(const CStdString& uuid, const std::set<int>& sections)
+{
+  CSingleLock lk(m_lock);
+
+  // collect from the first change on, a scan keeps sending them for a long time
+  bool arm = m_pendingChanges.empty();
+  m_pendingChanges[uuid].insert(sections.begin(), sections.end());
+
+  if (!g_plexApplication.timer)
+  {
+    lk.Leave();
+    FlushChanges();
+  }
+  else if (arm)
+  {
+    g_plexApplication.timer->SetTimeout(NOTIFICATION_SETTLE_MS, this);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationClient::OnTimeout()
+{
+  FlushChanges();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationClient::FlushChanges()
+{
+  std::map<CStdString, std::set<int> > changes;
+  {
+    CSingleLock lk(m_lock);
+    changes.swap(m_pendingChanges);
+  }
+
+  std::pair<CStdString, std::set<int> > p;
+  BOOST_FOREACH(p, changes)
+    OnLibraryChanged(p.first, p.second);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexNotificationClient::OnLibraryChanged(const CStdString& uuid, const std::set<int>& sections)
+{
+  CLog::Log(LOGDEBUG, "CPlexNotificationClient::OnLibraryChanged %d sections changed on %s",
+            (int)sections.size(), uuid.c_str());
+
+  // a change we can't place touches everything on that server
+  std::set<int> changed(sections);
+  if (changed.find(PLEX_SECTION_UNKNOWN) != changed.end())
+  {
+    changed.clear();
+    changed.insert(PLEX_SECTION_UNKNOWN);
+  }
+
+  BOOST_FOREACH(int section, changed)
+  {
+    if (g_plexApplication.directoryCache)
+      g_plexApplication.directoryCache->Invalidate(uuid, section);
+
+    CGUIMessage msg(GUI_MSG_NOTIFY_ALL, PLEX_NOTIFICATION_CLIENT, 0, GUI_MSG_PLEX_LIBRARY_CHANGED, section);
+    msg.SetStringParam(uuid);
+    g_windowManager.SendThreadMessage(msg);
+  }
+
+  // the section list carries the update times and counts
+  if (g_plexApplication.dataLoader)
+    g_plexApplication.dataLoader->RefreshServer(uuid);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexNotificationClient::ParseNotification(const std::string& json, std::set<int>& sections)
+{
+  CVariant data = CJSONVariantParser::Parse((const unsigned char*)json.c_str(), json.size());
+
+  // newer servers wrap the container
+  const CVariant& container = data.isMember("NotificationContainer") ? data["NotificationContainer"] : data;
+  if (!container.isObject())
+    return false;
+
+  std::string type = container["type"].asString();
+
+  const CVariant* entries = &container["_children"];
+  if (!entries->isArray())
+  {
+    if (type == "timeline")
+      entries = &container["TimelineEntry"];
+    else if (type == "playing")
+      entries = &container["PlaySessionStateNotification"];
+  }
+
+  if (!entries->isArray())
+    return false;
+
+  for (CVariant::const_iterator_array it = entries->begin_array(); it != entries->end_array(); ++it)
+  {
+    const CVariant& entry = *it;
+
+    if (type == "timeline")
+    {
+      int state = (int)entry["state"].asInteger(-1);
+      if (state != TIMELINE_STATE_DONE && state != TIMELINE_STATE_DELETED)
+        continue;
+
+      int section = (int)entry["sectionID"].asInteger(PLEX_SECTION_UNKNOWN);
+      sections.insert(section < 0 ? PLEX_SECTION_UNKNOWN : section);
+    }
+    else if (type == "playing")
+    {
+      // stopping moves the view offset and on deck of a section we can't tell
+      if (entry["state"].asString() == "stopped")
+        sections.insert(PLEX_SECTION_UNKNOWN);
+    }
+  }
+
+  return !sections.empty();
+}
@@ -0,0 +1,138 @@
+#ifndef PLEXNOTIFICATIONCLIENT_H
+#define PLEXNOTIFICATIONCLIENT_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "StdString.h"
+#include "PlexTypes.h"
+#include "URL.h"
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+#include "Client/PlexServer.h"
+#include "Utility/PlexGlobalTimer.h"
+
+#define PLEX_NOTIFICATION_PATH "/:/websockets/notifications"
+
+/* notifications come in bursts while the server scans, they are collected this long */
+#define NOTIFICATION_SETTLE_MS 2000
+
+/* reconnecting backs off up to this */
+#define NOTIFICATION_RETRY_MAX_SEC 300
+
+class CPlexNotificationClient;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* the websocket to one server, it lives on the io_service of the client and reconnects
+ * until it is closed */
+class CPlexNotificationConnection : public boost::enable_shared_from_this<CPlexNotificationConnection>
+{
+  public:
+    CPlexNotificationConnection(boost::asio::io_service& io, CPlexNotificationClient* client,
+                                const CStdString& uuid, const CURL& url);
+
+    void start();
+    void close();
+
+    /* m_connected only changes on the io thread, everybody else asks here */
+    bool isConnected() const;
+    const CURL& getUrl() const { return m_url; }
+
+  private:
+    void shutdown();
+    void connect();
+    void retry();
+    void onRetry(const boost::system::error_code& error);
+    void onResolved(const boost::system::error_code& error, boost::asio::ip::tcp::resolver::iterator it);
+    void onConnected(const boost::system::error_code& error);
+    void onHandshakeSent(const boost::system::error_code& error);
+    void onHandshakeRead(const boost::system::error_code& error, size_t bytes);
+    void onRead(const boost::system::error_code& error, size_t bytes);
+    void read();
+    bool processFrames();
+    void send(int opcode, const std::string& data);
+    void onSent(const boost::system::error_code& error, boost::shared_ptr<std::string> data);
+    void disconnect(const std::string& reason);
+    void setConnected(bool connected);
+
+    boost::asio::io_service& m_io;
+    CPlexNotificationClient* m_client;
+    CStdString m_uuid;
+    CURL m_url;
+
+    boost::asio::ip::tcp::resolver m_resolver;
+    boost::asio::ip::tcp::socket m_socket;
+    boost::asio::deadline_timer m_retryTimer;
+    boost::asio::streambuf m_handshake;
+    char m_readBuffer[4096];
+
+    std::string m_key;
+    std::string m_request;
+    std::string m_buffer;
+    std::string m_message;
+
+    int m_retryDelay;
+    mutable CCriticalSection m_connectedLock;
+    bool m_connected;
+    bool m_closed;
+};
+
+typedef boost::shared_ptr<CPlexNotificationConnection> CPlexNotificationConnectionPtr;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* Listens to the notification stream of the servers we own. Library changes invalidate the
+ * directory cache entries of the affected sections and tell the windows and the data loader,
+ * while a server is listened to there is no need to poll it often. */
+class CPlexNotificationClient : public CThread, public IPlexGlobalTimeout
+{
+  public:
+    CPlexNotificationClient();
+    virtual ~CPlexNotificationClient();
+
+    void AddServer(const CPlexServerPtr& server);
+    void RemoveServer(const CStdString& uuid);
+    void Listen(const CStdString& uuid, const CURL& url);
+    bool IsListening(const CStdString& uuid);
+    void Stop();
+
+    void OnTimeout();
+    CStdString TimerName() const { return "notificationClient"; }
+
+    /* the sections a notification touches, PLEX_SECTION_UNKNOWN if we can't tell */
+    static bool ParseNotification(const std::string& json, std::set<int>& sections);
+
+  protected:
+    /* called on the io thread */
+    friend class CPlexNotificationConnection;
+    virtual void OnConnected(const CStdString& uuid, bool connected);
+    virtual void OnNotification(const CStdString& uuid, const std::string& json);
+
+    /* called once a burst of notifications settled */
+    virtual void OnLibraryChanged(const CStdString& uuid, const std::set<int>& sections);
+
+    void Process();
+
+  private:
+    void QueueChanges(const CStdString& uuid, const std::set<int>& sections);
+    void FlushChanges();
+
+    boost::asio::io_service m_io;
+    boost::asio::io_service::work* m_work;
+
+    CCriticalSection m_lock;
+    std::map<CStdString, CPlexNotificationConnectionPtr> m_connections;
+    std::map<CStdString, std::set<int> > m_pendingChanges;
+
+    /* servers we were listening to before, reconnecting to them means we missed something */
+    std::set<CStdString> m_listened;
+};
+
+typedef boost::shared_ptr<CPlexNotificationClient> CPlexNotificationClientPtr;
+
+#endif // PLEXNOTIFICATIONCLIENT_H
@@ -0,0 +1,354 @@
+#include "PlexPlaybackPrefetcher.h"
+#include "PlexApplication.h"
+#include "Application.h"
+#include "PlayListPlayer.h"
+#include "playlists/PlayList.h"
+#include "filesystem/File.h"
+#include "filesystem/StreamHeadCache.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/URIUtils.h"
+#include "Variant.h"
+#include "log.h"
+
+#include <boost/lexical_cast.hpp>
+
+#define PREFETCH_READ_SIZE (64 * 1024)
+
+/* a request this old didn't lead to the playback that is starting now */
+#define PREFETCH_TTFF_MAX_MS (2 * 60 * 1000)
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexPlaybackPrefetchJob::DoWork()
+{
+  if (!CPlexMediaDecisionJob::DoWork())
+    return false;
+
+  // transcodes start a session once they are opened, we don't do that on a guess
+  if (m_choosenMedia.GetProperty("plexDidTranscode").asBoolean())
+    return true;
+
+  CStdString path = m_choosenMedia.GetPath();
+  if (URIUtils::IsStack(path) || !URIUtils::IsInternetStream(path, true))
+    return true;
+
+  if (!XFILE::CStreamHeadCache::GetInstance().Contains(path))
+    ReadHead(path);
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetchJob::ReadHead(const CStdString& path)
+{
+  XFILE::CFile file;
+  if (!file.Open(path, READ_NO_CACHE | READ_TRUNCATED | READ_CHUNKED))
+  {
+    CLog::Log(LOGDEBUG, "CPlexPlaybackPrefetchJob::ReadHead failed to open %s", path.c_str());
+    return;
+  }
+
+  std::string head;
+  head.reserve(PLEX_PREFETCH_HEAD_SIZE);
+
+  std::vector<char> buffer(PREFETCH_READ_SIZE);
+  while (head.size() < PLEX_PREFETCH_HEAD_SIZE)
+  {
+    // focus moved on
+    if (ShouldCancel(head.size(), PLEX_PREFETCH_HEAD_SIZE))
+      return;
+
+    int64_t size = std::min<int64_t>(buffer.size(), PLEX_PREFETCH_HEAD_SIZE - head.size());
+    int read = file.Read(&buffer[0], size);
+    if (read <= 0)
+      break;
+
+    head.append(&buffer[0], read);
+  }
+
+  file.Close();
+
+  if (!head.empty())
+    XFILE::CStreamHeadCache::GetInstance().Store(path, head);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexPlaybackPrefetcher::CPlexPlaybackPrefetcher(unsigned int ttlMs)
+  : m_ttl(ttlMs), m_jobId(0), m_nextJobId(0), m_playEnded(0), m_playRequested(0), m_playSpeculated(false),
+    m_playHead(false)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexPlaybackPrefetcher::~CPlexPlaybackPrefetcher()
+{
+  Cancel();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CStdString CPlexPlaybackPrefetcher::GetKey(const CFileItem& item)
+{
+  // a play queue item has another path than the same item in the library
+  CStdString key;
+  if (item.HasProperty("ratingKey") && item.HasProperty("plexserver"))
+    key = item.GetProperty("plexserver").asString() + "/" + item.GetProperty("ratingKey").asString();
+  else
+    key = CURL(item.GetPath()).GetUrlWithoutOptions();
+
+  CFileItemPtr mediaItem = CPlexMediaDecisionEngine::getSelectedMediaItem(item);
+  if (mediaItem)
+    key += "#" + boost::lexical_cast<std::string>(mediaItem->GetProperty("id").asInteger());
+
+  return key;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetcher::Prefetch(const CFileItemPtr& item)
+{
+  // don't take bandwidth away from what is playing
+  if (!item || !item->IsVideo() || !item->IsPlexMediaServer() || g_application.IsPlayingVideo())
+  {
+    DropFocus();
+    return;
+  }
+
+  CStdString key = GetKey(*item);
+
+  {
+    CSingleLock lk(m_lock);
+    if (key == m_pendingKey || key == m_jobKey)
+      return;
+
+    if (m_jobId)
+    {
+      CLog::Log(LOGDEBUG, "CPlexPlaybackPrefetcher::Prefetch focus moved on from %s", m_jobKey.c_str());
+      CJobManager::GetInstance().CancelJob(m_jobId);
+      m_jobId = 0;
+      m_jobKey.clear();
+    }
+
+    m_pending.reset();
+    m_pendingKey.clear();
+
+    Expire(XbmcThreads::SystemClockMillis());
+    if (m_resolved.find(key) != m_resolved.end())
+      return;
+
+    m_pending = item;
+    m_pendingKey = key;
+  }
+
+  g_plexApplication.timer->RestartTimeout(PLEX_PREFETCH_DELAY_MS, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetcher::LookAhead()
+{
+  int next = g_playlistPlayer.GetNextSong();
+  PLAYLIST::CPlayList& playlist = g_playlistPlayer.GetPlaylist(g_playlistPlayer.GetCurrentPlaylist());
+  if (next < 0 || next >= playlist.size())
+    return;
+
+  CFileItemPtr item = playlist[next];
+  if (!item || !item->IsPlexMediaServer() || item->GetProperty("isResolved").asBoolean())
+    return;
+
+  CStdString key = GetKey(*item);
+
+  CSingleLock lk(m_lock);
+
+  // we are called until the item ends, only resolve once even if it failed
+  if (key == m_nextKey)
+    return;
+  m_nextKey = key;
+
+  Expire(XbmcThreads::SystemClockMillis());
+  if (m_resolved.find(key) != m_resolved.end())
+    return;
+
+  if (m_nextJobId)
+    CJobManager::GetInstance().CancelJob(m_nextJobId);
+
+  CLog::Log(LOGDEBUG, "CPlexPlaybackPrefetcher::LookAhead resolving the next item %s", key.c_str());
+  // this one is going to be played
+  m_nextJobId = CJobManager::GetInstance().AddJob(new CPlexPlaybackPrefetchJob(*item, key), this, CJob::PRIORITY_NORMAL);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetcher::DropFocus()
+{
+  if (g_plexApplication.timer)
+    g_plexApplication.timer->RemoveTimeout(this);
+
+  CSingleLock lk(m_lock);
+  m_pending.reset();
+  m_pendingKey.clear();
+
+  if (m_jobId)
+    CJobManager::GetInstance().CancelJob(m_jobId);
+  m_jobId = 0;
+  m_jobKey.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetcher::Cancel()
+{
+  DropFocus();
+
+  CSingleLock lk(m_lock);
+  if (m_nextJobId)
+  {
+    // it wasn't resolved, let the next look ahead try again
+    CJobManager::GetInstance().CancelJob(m_nextJobId);
+    m_nextJobId = 0;
+    m_nextKey.clear();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetcher::OnTimeout()
+{
+  CSingleLock lk(m_lock);
+  if (!m_pending)
+    return;
+
+  CLog::Log(LOGDEBUG, "CPlexPlaybackPrefetcher::OnTimeout resolving %s ahead of time", m_pendingKey.c_str());
+
+  m_jobKey = m_pendingKey;
+  m_jobId = CJobManager::GetInstance().AddJob(new CPlexPlaybackPrefetchJob(*m_pending, m_pendingKey), this, CJob::PRIORITY_LOW);
+
+  m_pending.reset();
+  m_pendingKey.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetcher::OnJobComplete(unsigned int jobID, bool success, CJob* job)
+{
+  CPlexPlaybackPrefetchJob* prefetchJob = static_cast<CPlexPlaybackPrefetchJob*>(job);
+
+  CSingleLock lk(m_lock);
+  if (jobID == m_jobId)
+  {
+    m_jobId = 0;
+    m_jobKey.clear();
+  }
+  else if (jobID == m_nextJobId)
+  {
+    m_nextJobId = 0;
+  }
+
+  if (!success || !prefetchJob)
+    return;
+
+  // the transcode URL depends on where playback starts, that isn't known yet
+  if (prefetchJob->m_choosenMedia.GetProperty("plexDidTranscode").asBoolean())
+    return;
+
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  Expire(now);
+
+  while (m_resolved.size() >= PLEX_PREFETCH_MAX_RESOLVED)
+  {
+    ResolvedMap::iterator oldest = m_resolved.begin();
+    for (ResolvedMap::iterator it = m_resolved.begin(); it != m_resolved.end(); ++it)
+    {
+      if (now - it->second.stamp > now - oldest->second.stamp)
+        oldest = it;
+    }
+    m_resolved.erase(oldest);
+  }
+
+  Resolved& resolved = m_resolved[prefetchJob->m_key];
+  resolved.item = prefetchJob->m_choosenMedia;
+  resolved.stamp = now;
+
+  CLog::Log(LOGDEBUG, "CPlexPlaybackPrefetcher::OnJobComplete %s resolved to %s",
+            prefetchJob->m_key.c_str(), resolved.item.GetPath().c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexPlaybackPrefetcher::GetResolved(const CFileItem& item, CFileItem& resolved)
+{
+  CStdString key = GetKey(item);
+
+  CSingleLock lk(m_lock);
+  Expire(XbmcThreads::SystemClockMillis());
+
+  ResolvedMap::iterator it = m_resolved.find(key);
+  if (it == m_resolved.end())
+    return false;
+
+  resolved = it->second.item;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetcher::Expire(unsigned int now)
+{
+  ResolvedMap::iterator it = m_resolved.begin();
+  while (it != m_resolved.end())
+  {
+    if (now - it->second.stamp >= m_ttl)
+      m_resolved.erase(it++);
+    else
+      ++it;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetcher::PlaybackRequested(const CFileItem& resolved, bool speculated, unsigned int requestedAt)
+{
+  CSingleLock lk(m_lock);
+  m_playRequested = requestedAt ? requestedAt : 1;
+  m_playSpeculated = speculated;
+  m_playHead = XFILE::CStreamHeadCache::GetInstance().Contains(resolved.GetPath());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetcher::PlaybackStarted()
+{
+  CSingleLock lk(m_lock);
+  if (!m_playRequested)
+    return;
+
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  unsigned int elapsed = now - m_playRequested;
+  m_playRequested = 0;
+
+  if (elapsed > PREFETCH_TTFF_MAX_MS)
+  {
+    m_playEnded = 0;
+    return;
+  }
+
+  CLog::Log(LOGINFO, "CPlexPlaybackPrefetcher::PlaybackStarted time to first frame %u ms (resolved ahead: %s, stream head: %s)",
+            elapsed, m_playSpeculated ? "yes" : "no", m_playHead ? "yes" : "no");
+
+  if (m_playEnded)
+  {
+    unsigned int gap = now - m_playEnded;
+    m_playEnded = 0;
+
+    CLog::Log(LOGINFO, "CPlexPlaybackPrefetcher::PlaybackStarted play queue handoff gap %u ms (resolved ahead: %s, stream head: %s)",
+              gap, m_playSpeculated ? "yes" : "no", m_playHead ? "yes" : "no");
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetcher::PlaybackEnded()
+{
+  CSingleLock lk(m_lock);
+  m_playEnded = XbmcThreads::SystemClockMillis();
+  if (!m_playEnded)
+    m_playEnded = 1;
+
+  m_nextKey.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexPlaybackPrefetcher::PlaybackStopped()
+{
+  CSingleLock lk(m_lock);
+  m_playEnded = 0;
+  m_nextKey.clear();
+}
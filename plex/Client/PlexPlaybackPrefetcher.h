@@ -0,0 +1,121 @@
+#ifndef PLEXPLAYBACKPREFETCHER_H
+#define PLEXPLAYBACKPREFETCHER_H
+
+#include <map>
+
+#include "FileItem.h"
+#include "JobManager.h"
+#include "PlexMediaDecisionEngine.h"
+#include "threads/CriticalSection.h"
+#include "Utility/PlexGlobalTimer.h"
+
+#include <boost/shared_ptr.hpp>
+
+/* how long focus has to rest on an item before we start resolving it */
+#define PLEX_PREFETCH_DELAY_MS 750
+
+/* how long a speculative result is trusted */
+#define PLEX_PREFETCH_TTL_MS (60 * 1000)
+
+/* how much of a direct played stream is read ahead */
+#define PLEX_PREFETCH_HEAD_SIZE (4 * 1024 * 1024)
+
+#define PLEX_PREFETCH_MAX_RESOLVED 4
+
+/* how long before the end of the playing item the next one in the play queue is resolved */
+#define PLEX_LOOKAHEAD_S 30
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* Runs the media decision for an item ahead of time and reads the start of the stream it
+ * decided on, so that pressing play only has to open it */
+class CPlexPlaybackPrefetchJob : public CPlexMediaDecisionJob
+{
+public:
+  CPlexPlaybackPrefetchJob(const CFileItem& item, const CStdString& key)
+    : CPlexMediaDecisionJob(item), m_key(key) {}
+
+  bool DoWork();
+
+  CStdString m_key;
+
+private:
+  void ReadHead(const CStdString& path);
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* Guesses what is played next from what has focus in preplay and the play queue, and from what
+ * the play queue plays after the current item. The guess is resolved in the background and kept
+ * for a while, the media decision engine takes it from here instead of blocking on the server
+ * when the guess was right. Moving on cancels the guess.
+ *
+ * Also measures the time from resolving to the first frame and the gap between two items of a
+ * play queue, with and without a guess. */
+class CPlexPlaybackPrefetcher : public IJobCallback, public IPlexGlobalTimeout
+{
+public:
+  CPlexPlaybackPrefetcher(unsigned int ttlMs = PLEX_PREFETCH_TTL_MS);
+  ~CPlexPlaybackPrefetcher();
+
+  /* item has focus now, resolve it if focus stays there */
+  void Prefetch(const CFileItemPtr& item);
+
+  /* the playing item is about to end, resolve the next one in the play queue right away */
+  void LookAhead();
+
+  /* drop the guesses that are being resolved */
+  void Cancel();
+
+  /* the speculative result for item, false if there is none or it is too old */
+  bool GetResolved(const CFileItem& item, CFileItem& resolved);
+
+  /* items resolve the same if they are the same metadata played from the same media */
+  static CStdString GetKey(const CFileItem& item);
+
+  /* time to first frame, from resolving the item to the player clock starting. The prompts
+   * before resolving wait for the user and aren't counted */
+  void PlaybackRequested(const CFileItem& resolved, bool speculated, unsigned int requestedAt);
+  void PlaybackStarted();
+
+  /* the playing item ended by itself and the play queue moves on, or playback was stopped */
+  void PlaybackEnded();
+  void PlaybackStopped();
+
+  void OnJobComplete(unsigned int jobID, bool success, CJob* job);
+
+  void OnTimeout();
+  CStdString TimerName() const { return "playbackPrefetcher"; }
+
+private:
+  struct Resolved
+  {
+    CFileItem item;
+    unsigned int stamp;
+  };
+  typedef std::map<CStdString, Resolved> ResolvedMap;
+
+  void Expire(unsigned int now);
+  void DropFocus();
+
+  CCriticalSection m_lock;
+  unsigned int m_ttl;
+
+  CFileItemPtr m_pending;
+  CStdString m_pendingKey;
+
+  unsigned int m_jobId;
+  CStdString m_jobKey;
+
+  unsigned int m_nextJobId;
+  CStdString m_nextKey;
+
+  ResolvedMap m_resolved;
+
+  unsigned int m_playEnded;
+  unsigned int m_playRequested;
+  bool m_playSpeculated;
+  bool m_playHead;
+};
+
+typedef boost::shared_ptr<CPlexPlaybackPrefetcher> CPlexPlaybackPrefetcherPtr;
+
+#endif // PLEXPLAYBACKPREFETCHER_H
@@ -0,0 +1,673 @@
+#include "PlexSearchIndex.h"
+#include "PlexApplication.h"
+#include "FileSystem/PlexAttributeParser.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "utils/URIUtils.h"
+#include "video/VideoInfoTag.h"
+#include "URL.h"
+#include "log.h"
+
+#include <boost/foreach.hpp>
+#include <algorithm>
+#include <string.h>
+
+/* write the index out a while after the last change */
+#define PLEX_SEARCH_INDEX_SAVE_DELAY 30000
+
+/* rebuild the tokens when this many entries are dead and they outnumber the live ones */
+#define PLEX_SEARCH_INDEX_COMPACT_MIN 1024
+
+#define PLEX_SEARCH_INDEX_MAGIC "PSI1"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static void writeInt(std::string& out, uint32_t value)
+{
+  out.append((const char*)&value, sizeof(value));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static void writeString(std::string& out, const std::string& str)
+{
+  writeInt(out, str.size());
+  out.append(str);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static bool readInt(const std::string& in, size_t& pos, uint32_t& value)
+{
+  if (pos + sizeof(value) > in.size())
+    return false;
+
+  memcpy(&value, in.data() + pos, sizeof(value));
+  pos += sizeof(value);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static bool readString(const std::string& in, size_t& pos, std::string& str)
+{
+  uint32_t len;
+  if (!readInt(in, pos, len) || pos + len > in.size())
+    return false;
+
+  str.assign(in, pos, len);
+  pos += len;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static std::string normalizedTitle(const std::string& title)
+{
+  std::vector<std::string> tokens;
+  CPlexSearchIndex::Tokenize(title, tokens);
+
+  std::string str;
+  BOOST_FOREACH(const std::string& token, tokens)
+  {
+    if (!str.empty())
+      str += " ";
+    str += token;
+  }
+  return str;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* postings of the same entry next to each other, the title one last */
+static bool postingLess(uint32_t a, uint32_t b)
+{
+  uint32_t idA = a & 0x7fffffff, idB = b & 0x7fffffff;
+  return idA < idB || (idA == idB && a < b);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexSearchIndex::RankLess::operator()(const std::pair<int, uint32_t>& a, const std::pair<int, uint32_t>& b) const
+{
+  if (a.first != b.first)
+    return a.first < b.first;
+
+  int cmp = strcasecmp(m_entries[a.second].title.c_str(), m_entries[b.second].title.c_str());
+  return cmp < 0 || (cmp == 0 && a.second < b.second);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexSearchIndex::CPlexSearchIndex(const std::string& path) : m_path(path), m_deadEntries(0), m_dirty(false)
+{
+  clear();
+  m_dirty = false;
+
+  if (!m_path.empty())
+    load();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexSearchIndex::IsIndexable(const CFileItem& item)
+{
+  switch (item.GetPlexDirectoryType())
+  {
+    case PLEX_DIR_TYPE_MOVIE:
+    case PLEX_DIR_TYPE_SHOW:
+    case PLEX_DIR_TYPE_EPISODE:
+    case PLEX_DIR_TYPE_ARTIST:
+    case PLEX_DIR_TYPE_ALBUM:
+    case PLEX_DIR_TYPE_TRACK:
+    case PLEX_DIR_TYPE_CLIP:
+      break;
+    default:
+      return false;
+  }
+
+  return item.HasProperty("ratingKey") && item.HasProperty("unprocessed_key") && item.HasProperty("plexserver");
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* lowercase words, anything that isn't a letter or a digit separates them. Apostrophes are
+ * dropped so that "ocean's" and "oceans" are the same word, non-ASCII UTF-8 is kept as is */
+void CPlexSearchIndex::Tokenize(const std::string& str, std::vector<std::string>& tokens)
+{
+  std::string token;
+  for (size_t i = 0; i <= str.size(); i++)
+  {
+    unsigned char c = i < str.size() ? str[i] : ' ';
+
+    if (c == '\'')
+      continue;
+
+    if (c >= 0x80 || isalnum(c))
+    {
+      token += (char)tolower(c);
+    }
+    else if (!token.empty())
+    {
+      tokens.push_back(token);
+      token.clear();
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+uint16_t CPlexSearchIndex::intern(const std::string& str)
+{
+  boost::unordered_map<std::string, uint16_t>::iterator it = m_stringMap.find(str);
+  if (it != m_stringMap.end())
+    return it->second;
+
+  uint16_t idx = m_strings.size();
+  m_strings.push_back(str);
+  m_stringMap[str] = idx;
+  return idx;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::indexEntry(uint32_t id)
+{
+  const Entry& entry = m_entries[id];
+
+  std::vector<std::string> titleTokens;
+  Tokenize(entry.title, titleTokens);
+  std::sort(titleTokens.begin(), titleTokens.end());
+  titleTokens.erase(std::unique(titleTokens.begin(), titleTokens.end()), titleTokens.end());
+
+  std::vector<std::string> nameTokens;
+  Tokenize(entry.names, nameTokens);
+  std::sort(nameTokens.begin(), nameTokens.end());
+  nameTokens.erase(std::unique(nameTokens.begin(), nameTokens.end()), nameTokens.end());
+
+  BOOST_FOREACH(const std::string& token, titleTokens)
+    m_tokens[token].push_back(id | TITLE_TOKEN);
+
+  BOOST_FOREACH(const std::string& token, nameTokens)
+  {
+    if (!std::binary_search(titleTokens.begin(), titleTokens.end(), token))
+      m_tokens[token].push_back(id);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::addEntry(const Entry& entry)
+{
+  uint32_t id = m_entries.size();
+  m_entries.push_back(entry);
+  m_entryMap[entryKey(entry)] = id;
+  indexEntry(id);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* the postings still point to the entry, searches skip it until compact() throws it out */
+void CPlexSearchIndex::removeEntry(uint32_t id)
+{
+  Entry& entry = m_entries[id];
+  m_entryMap.erase(entryKey(entry));
+
+  entry.alive = false;
+  std::string().swap(entry.key);
+  std::string().swap(entry.thumb);
+  std::string().swap(entry.names);
+
+  m_deadEntries++;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::compact()
+{
+  std::vector<Entry> entries;
+  entries.reserve(m_entries.size() - m_deadEntries);
+  BOOST_FOREACH(const Entry& entry, m_entries)
+  {
+    if (entry.alive)
+      entries.push_back(entry);
+  }
+
+  m_entries.clear();
+  m_entryMap.clear();
+  m_tokens.clear();
+  m_deadEntries = 0;
+
+  BOOST_FOREACH(const Entry& entry, entries)
+    addEntry(entry);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::indexListing(const CFileItemList& items, bool complete)
+{
+  bool changed = false;
+
+  {
+    CSingleLock lk(m_lock);
+
+    std::vector<bool> seen(m_entries.size() + items.Size(), false);
+    std::set<std::pair<uint16_t, uint16_t> > sections;
+    std::set<uint8_t> types;
+
+    for (int i = 0; i < items.Size(); i++)
+    {
+      CFileItemPtr item = items.Get(i);
+      if (!item || !IsIndexable(*item))
+        continue;
+
+      Entry entry;
+      entry.ratingKey = item->GetProperty("ratingKey").asString();
+      entry.key = item->GetProperty("unprocessed_key").asString();
+      entry.title = item->GetProperty("title").asString();
+      entry.thumb = item->GetProperty("unprocessed_thumb").asString();
+      entry.server = intern(item->GetProperty("plexserver").asString());
+      entry.section = intern(item->GetProperty("librarySectionUUID").asString());
+      entry.year = std::max<int64_t>(0, item->GetProperty("year").asInteger());
+      entry.type = item->GetPlexDirectoryType();
+      entry.folder = item->m_bIsFolder;
+      entry.alive = true;
+
+      if (entry.type == PLEX_DIR_TYPE_ALBUM)
+        entry.parentTitle = item->GetProperty("parentTitle").asString();
+      else if (entry.type == PLEX_DIR_TYPE_TRACK || entry.type == PLEX_DIR_TYPE_EPISODE)
+        entry.parentTitle = item->GetProperty("grandparentTitle").asString();
+
+      /* albums and tracks can be found by their artist, movies by their cast and directors */
+      if (entry.type == PLEX_DIR_TYPE_ALBUM || entry.type == PLEX_DIR_TYPE_TRACK)
+        entry.names = entry.parentTitle;
+
+      if (entry.type != PLEX_DIR_TYPE_EPISODE && item->HasVideoInfoTag())
+      {
+        const CVideoInfoTag* tag = item->GetVideoInfoTag();
+        BOOST_FOREACH(const SActorInfo& actor, tag->m_cast)
+          entry.names += actor.strName + "\n";
+        BOOST_FOREACH(const std::string& director, tag->m_director)
+          entry.names += director + "\n";
+      }
+
+      if (!m_strings[entry.section].empty())
+        sections.insert(std::make_pair(entry.server, entry.section));
+      types.insert(entry.type);
+
+      EntryMap::iterator it = m_entryMap.find(entryKey(entry));
+      if (it != m_entryMap.end())
+      {
+        const Entry& old = m_entries[it->second];
+        if (old.title == entry.title && old.names == entry.names && old.key == entry.key &&
+            old.thumb == entry.thumb && old.parentTitle == entry.parentTitle &&
+            old.section == entry.section && old.year == entry.year && old.folder == entry.folder)
+        {
+          seen[it->second] = true;
+          continue;
+        }
+
+        removeEntry(it->second);
+      }
+
+      seen[m_entries.size()] = true;
+      addEntry(entry);
+      changed = true;
+    }
+
+    if (complete)
+    {
+      for (uint32_t id = 0; id < m_entries.size(); id++)
+      {
+        const Entry& entry = m_entries[id];
+        if (entry.alive && !seen[id] && sections.find(std::make_pair(entry.server, entry.section)) != sections.end() &&
+            types.find(entry.type) != types.end())
+        {
+          removeEntry(id);
+          changed = true;
+        }
+      }
+    }
+
+    if (m_deadEntries > PLEX_SEARCH_INDEX_COMPACT_MIN && m_deadEntries > (int)m_entries.size() / 2)
+      compact();
+
+    if (changed)
+      m_dirty = true;
+  }
+
+  if (changed && !m_path.empty() && g_plexApplication.timer)
+    g_plexApplication.timer->SetTimeout(PLEX_SEARCH_INDEX_SAVE_DELAY, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* entry ids with tokens starting with prefix, sorted and with the title flag of all matching tokens */
+void CPlexSearchIndex::findPrefix(const std::string& prefix, std::vector<std::pair<uint32_t, bool> >& matches)
+{
+  std::vector<uint32_t> postings;
+
+  for (TokenMap::const_iterator it = m_tokens.lower_bound(prefix); it != m_tokens.end(); ++it)
+  {
+    if (it->first.compare(0, prefix.size(), prefix) != 0)
+      break;
+    postings.insert(postings.end(), it->second.begin(), it->second.end());
+  }
+
+  std::sort(postings.begin(), postings.end(), postingLess);
+
+  matches.clear();
+  BOOST_FOREACH(uint32_t posting, postings)
+  {
+    uint32_t id = posting & ~TITLE_TOKEN;
+    bool title = (posting & TITLE_TOKEN) != 0;
+
+    if (!matches.empty() && matches.back().first == id)
+      matches.back().second = matches.back().second || title;
+    else
+      matches.push_back(std::make_pair(id, title));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CFileItemPtr CPlexSearchIndex::buildItem(const Entry& entry)
+{
+  CFileItemPtr item = CFileItemPtr(new CFileItem(entry.title));
+
+  CURL url;
+  url.SetProtocol("plexserver");
+  url.SetHostName(m_strings[entry.server]);
+
+  CPlexAttributeParserKey keyParser;
+  keyParser.Process(url, "key", entry.key, item.get());
+  item->SetPath(item->GetProperty("key").asString());
+
+  if (!entry.thumb.empty())
+  {
+    CPlexAttributeParserMediaUrl thumbParser;
+    thumbParser.Process(url, "thumb", entry.thumb, item.get());
+  }
+
+  item->SetPlexDirectoryType((EPlexDirectoryType)entry.type);
+  item->m_bIsFolder = entry.folder;
+
+  item->SetProperty("plex", true);
+  item->SetProperty("plexserver", m_strings[entry.server]);
+  item->SetProperty("ratingKey", entry.ratingKey);
+  item->SetProperty("title", entry.title);
+  item->SetProperty("localSearchResult", true);
+
+  if (!m_strings[entry.section].empty())
+    item->SetProperty("librarySectionUUID", m_strings[entry.section]);
+
+  if (entry.year)
+    item->SetProperty("year", entry.year);
+
+  if (!entry.parentTitle.empty())
+    item->SetProperty(entry.type == PLEX_DIR_TYPE_ALBUM ? "parentTitle" : "grandparentTitle", entry.parentTitle);
+
+  return item;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::search(const std::string& query, const std::set<std::string>& servers, CFileItemList& results, int limit)
+{
+  std::vector<std::string> words;
+  Tokenize(query, words);
+  if (words.empty())
+    return;
+
+  CSingleLock lk(m_lock);
+
+  std::vector<std::pair<uint32_t, bool> > matches, wordMatches, both;
+  findPrefix(words[0], matches);
+
+  for (size_t i = 1; i < words.size() && !matches.empty(); i++)
+  {
+    findPrefix(words[i], wordMatches);
+
+    /* an entry only counts as a title match if all words matched its title */
+    both.clear();
+    std::vector<std::pair<uint32_t, bool> >::const_iterator a = matches.begin(), b = wordMatches.begin();
+    while (a != matches.end() && b != wordMatches.end())
+    {
+      if (a->first < b->first)
+        ++a;
+      else if (b->first < a->first)
+        ++b;
+      else
+      {
+        both.push_back(std::make_pair(a->first, a->second && b->second));
+        ++a;
+        ++b;
+      }
+    }
+    matches.swap(both);
+  }
+
+  /* titles starting with the query first, then other title matches and then the rest */
+  std::string normalizedQuery = normalizedTitle(query);
+  std::map<uint8_t, std::vector<std::pair<int, uint32_t> > > ranked;
+
+  std::pair<uint32_t, bool> match;
+  BOOST_FOREACH(match, matches)
+  {
+    const Entry& entry = m_entries[match.first];
+    if (!entry.alive || servers.find(m_strings[entry.server]) == servers.end())
+      continue;
+
+    int rank = 2;
+    if (match.second)
+    {
+      rank = 1;
+
+      /* only normalize the titles that can possibly start with the query */
+      size_t first = 0;
+      while (first < entry.title.size() && !isalnum((unsigned char)entry.title[first]) && (unsigned char)entry.title[first] < 0x80)
+        first++;
+
+      if (first < entry.title.size() && tolower((unsigned char)entry.title[first]) == (unsigned char)normalizedQuery[0] &&
+          normalizedTitle(entry.title).compare(0, normalizedQuery.size(), normalizedQuery) == 0)
+        rank = 0;
+    }
+
+    ranked[entry.type].push_back(std::make_pair(rank, match.first));
+  }
+
+  /* only the best few of each type are sorted */
+  std::map<uint8_t, std::vector<std::pair<int, uint32_t> > >::iterator it;
+  for (it = ranked.begin(); it != ranked.end(); ++it)
+  {
+    std::vector<std::pair<int, uint32_t> >& typeRanked = it->second;
+    size_t count = std::min(typeRanked.size(), (size_t)std::max(limit, 0));
+
+    std::partial_sort(typeRanked.begin(), typeRanked.begin() + count, typeRanked.end(), RankLess(m_entries));
+    for (size_t i = 0; i < count; i++)
+      results.Add(buildItem(m_entries[typeRanked[i].second]));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::clear()
+{
+  CSingleLock lk(m_lock);
+
+  m_entries.clear();
+  m_entryMap.clear();
+  m_tokens.clear();
+  m_deadEntries = 0;
+
+  m_strings.clear();
+  m_stringMap.clear();
+  intern("");
+
+  m_dirty = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexSearchIndex::serialize(std::string& data)
+{
+  CSingleLock lk(m_lock);
+
+  data = PLEX_SEARCH_INDEX_MAGIC;
+
+  writeInt(data, m_strings.size());
+  BOOST_FOREACH(const std::string& str, m_strings)
+    writeString(data, str);
+
+  writeInt(data, m_entries.size() - m_deadEntries);
+  BOOST_FOREACH(const Entry& entry, m_entries)
+  {
+    if (!entry.alive)
+      continue;
+
+    writeString(data, entry.ratingKey);
+    writeString(data, entry.key);
+    writeString(data, entry.title);
+    writeString(data, entry.parentTitle);
+    writeString(data, entry.thumb);
+    writeString(data, entry.names);
+    writeInt(data, entry.server | (entry.section << 16));
+    writeInt(data, entry.year | (entry.type << 16) | (entry.folder ? 1 << 24 : 0));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexSearchIndex::deserialize(const std::string& data)
+{
+  clear();
+
+  if (!parse(data))
+  {
+    clear();
+    return false;
+  }
+
+  m_dirty = false;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexSearchIndex::parse(const std::string& data)
+{
+  if (data.compare(0, strlen(PLEX_SEARCH_INDEX_MAGIC), PLEX_SEARCH_INDEX_MAGIC) != 0)
+    return false;
+
+  CSingleLock lk(m_lock);
+  size_t pos = strlen(PLEX_SEARCH_INDEX_MAGIC);
+
+  uint32_t count;
+  if (!readInt(data, pos, count))
+    return false;
+
+  m_strings.clear();
+  m_stringMap.clear();
+  for (uint32_t i = 0; i < count; i++)
+  {
+    std::string str;
+    if (!readString(data, pos, str))
+      return false;
+    m_strings.push_back(str);
+    m_stringMap[str] = i;
+  }
+
+  if (m_strings.empty() || !readInt(data, pos, count))
+    return false;
+
+  m_entries.reserve(count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    Entry entry;
+    uint32_t ids, flags;
+
+    if (!readString(data, pos, entry.ratingKey) || !readString(data, pos, entry.key) ||
+        !readString(data, pos, entry.title) || !readString(data, pos, entry.parentTitle) ||
+        !readString(data, pos, entry.thumb) || !readString(data, pos, entry.names) ||
+        !readInt(data, pos, ids) || !readInt(data, pos, flags))
+    {
+      CLog::Log(LOGWARNING, "CPlexSearchIndex::deserialize index is truncated after %d items", i);
+      return false;
+    }
+
+    entry.server = ids & 0xffff;
+    entry.section = ids >> 16;
+    entry.year = flags & 0xffff;
+    entry.type = (flags >> 16) & 0xff;
+    entry.folder = (flags >> 24) != 0;
+    entry.alive = true;
+
+    if (entry.server >= m_strings.size() || entry.section >= m_strings.size())
+      return false;
+
+    addEntry(entry);
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexSearchIndex::load()
+{
+  XFILE::CFile file;
+  if (!file.Open(m_path))
+  {
+    clear();
+    return false;
+  }
+
+  std::string data;
+  data.resize(file.GetLength());
+  if (!data.empty() && file.Read(&data[0], data.size()) != data.size())
+  {
+    CLog::Log(LOGWARNING, "CPlexSearchIndex::load failed to read %s", m_path.c_str());
+    clear();
+    return false;
+  }
+
+  if (!deserialize(data))
+  {
+    CLog::Log(LOGWARNING, "CPlexSearchIndex::load %s is not a search index, starting over", m_path.c_str());
+    return false;
+  }
+
+  CLog::Log(LOGDEBUG, "CPlexSearchIndex::load loaded %d items from %s", size(), m_path.c_str());
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexSearchIndex::save()
+{
+  std::string data;
+
+  {
+    CSingleLock lk(m_lock);
+    if (!m_dirty || m_path.empty())
+      return true;
+
+    serialize(data);
+    m_dirty = false;
+  }
+
+  XFILE::CDirectory::Create(URIUtils::GetDirectory(m_path));
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(m_path, true) || file.Write(data.c_str(), data.size()) != (int)data.size())
+  {
+    CLog::Log(LOGWARNING, "CPlexSearchIndex::save failed to write %s", m_path.c_str());
+    return false;
+  }
+
+  CLog::Log(LOGDEBUG, "CPlexSearchIndex::save wrote %d items, %ld bytes", size(), (long)data.size());
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+int CPlexSearchIndex::size()
+{
+  CSingleLock lk(m_lock);
+  return m_entries.size() - m_deadEntries;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* an estimate, container overhead is approximated with a few pointers per node */
+size_t CPlexSearchIndex::memoryUsage()
+{
+  CSingleLock lk(m_lock);
+
+  size_t bytes = m_entries.capacity() * sizeof(Entry);
+  BOOST_FOREACH(const Entry& entry, m_entries)
+  {
+    bytes += entry.ratingKey.capacity() + entry.key.capacity() + entry.title.capacity() +
+             entry.parentTitle.capacity() + entry.thumb.capacity() + entry.names.capacity();
+  }
+
+  bytes += m_entryMap.size() * (sizeof(EntryMap::value_type) + 2 * sizeof(void*) + 16);
+
+  for (TokenMap::const_iterator it = m_tokens.begin(); it != m_tokens.end(); ++it)
+    bytes += sizeof(TokenMap::value_type) + 4 * sizeof(void*) + it->first.capacity() + it->second.capacity() * sizeof(uint32_t);
+
+  return bytes;
+}
@@ -0,0 +1,117 @@
+#ifndef PLEXSEARCHINDEX_H
+#define PLEXSEARCHINDEX_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "FileItem.h"
+#include "PlexTypes.h"
+#include "threads/CriticalSection.h"
+#include "Utility/PlexGlobalTimer.h"
+
+#define PLEX_SEARCH_INDEX_PATH "special://plexprofile/plexsearchindex.dat"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* Word prefix index over the titles, artists and people of the library items we have already
+ * seen in section listings. It lets the search window show results while the user is still
+ * typing, the servers' own search results are merged in when they arrive.
+ *
+ * Items are keyed by server and ratingKey, indexing a listing again only touches what changed.
+ * Removed items are only marked dead, the token map is rebuilt once enough of them piled up. */
+class CPlexSearchIndex : public IPlexGlobalTimeout
+{
+  public:
+    CPlexSearchIndex(const std::string& path = PLEX_SEARCH_INDEX_PATH);
+
+    /* add or update the items of a listing, a complete listing of a section also drops
+     * the items of that section and type that are gone from the server */
+    void indexListing(const CFileItemList& items, bool complete);
+
+    /* items matching all words of query as prefixes, at most limit of each type */
+    void search(const std::string& query, const std::set<std::string>& servers, CFileItemList& results, int limit);
+
+    void clear();
+
+    bool load();
+    bool save();
+
+    /* the persisted form, only the items are stored and the tokens are rebuilt on load */
+    void serialize(std::string& data);
+    bool deserialize(const std::string& data);
+
+    int size();
+    size_t memoryUsage();
+
+    void OnTimeout() { save(); }
+    CStdString TimerName() const { return "searchIndex"; }
+
+    static bool IsIndexable(const CFileItem& item);
+    static void Tokenize(const std::string& str, std::vector<std::string>& tokens);
+
+  private:
+    struct Entry
+    {
+      std::string ratingKey;
+      std::string key;
+      std::string title;
+      std::string parentTitle;
+      std::string thumb;
+      /* artists and people, separated by newlines */
+      std::string names;
+      uint16_t server;
+      uint16_t section;
+      uint16_t year;
+      uint8_t type;
+      bool folder;
+      bool alive;
+    };
+
+    /* postings are entry ids, the top bit is set for tokens from the title */
+    typedef std::vector<uint32_t> Postings;
+    typedef std::map<std::string, Postings> TokenMap;
+    typedef boost::unordered_map<std::string, uint32_t> EntryMap;
+
+    static const uint32_t TITLE_TOKEN = 0x80000000;
+
+    /* orders ranked matches by rank and then title */
+    struct RankLess
+    {
+      RankLess(const std::vector<Entry>& entries) : m_entries(entries) {}
+      bool operator()(const std::pair<int, uint32_t>& a, const std::pair<int, uint32_t>& b) const;
+      const std::vector<Entry>& m_entries;
+    };
+
+    bool parse(const std::string& data);
+    void addEntry(const Entry& entry);
+    void removeEntry(uint32_t id);
+    void indexEntry(uint32_t id);
+    void compact();
+    void findPrefix(const std::string& prefix, std::vector<std::pair<uint32_t, bool> >& matches);
+    CFileItemPtr buildItem(const Entry& entry);
+
+    uint16_t intern(const std::string& str);
+    std::string entryKey(const Entry& entry) const { return m_strings[entry.server] + "/" + entry.ratingKey; }
+
+    std::string m_path;
+    CCriticalSection m_lock;
+
+    std::vector<Entry> m_entries;
+    EntryMap m_entryMap;
+    TokenMap m_tokens;
+    int m_deadEntries;
+
+    /* server and section UUIDs, shared by all entries */
+    std::vector<std::string> m_strings;
+    boost::unordered_map<std::string, uint16_t> m_stringMap;
+
+    bool m_dirty;
+};
+
+typedef boost::shared_ptr<CPlexSearchIndex> CPlexSearchIndexPtr;
+
+#endif // PLEXSEARCHINDEX_H
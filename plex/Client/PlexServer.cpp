@@ -476,10 +476,8 @@ CURL CPlexServer::BuildURL(const CStdString &path, const CStdString &options) co
     return CURL();
   }
 
-  CURL url = connection->BuildURL(path);
-
-  if (!options.empty())
-    url.SetOptions(options);
+  // the options go in with the token of the connection, in one go
+  CURL url = connection->BuildURL(path, options);
 
   if (!url.HasOption(connection->GetAccessTokenParameter()))
   {
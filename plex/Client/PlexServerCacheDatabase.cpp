@@ -93,16 +93,27 @@ bool CPlexServerCacheDatabase::storeServer(const CPlexServerPtr &server)
   CStdString bitrates = StringUtils::Join(server->GetTranscoderBitrates(), ",");
   CStdString resolutions = StringUtils::Join(server->GetTranscoderResolutions(), ",");
 
-  CStdString sql = PrepareSQL("insert into server (uuid, name, version, owner, synced, owned, home, serverClass, supportsDeletion,"
-                              "supportsVideoTranscoding, supportsAudioTranscoding, transcoderQualities, transcoderBitrates, transcoderResolutions) "
-                              "values ('%s', '%s', '%s', '%s', %i, %i, %i, '%s', %i, %i, %i, '%s', '%s', '%s');",
-                              server->GetUUID().c_str(), server->GetName().c_str(), server->GetVersion().c_str(), server->GetOwner().c_str(),
-                              server->GetSynced(), server->GetOwned(), server->GetHome(), server->GetServerClass().c_str(), server->SupportsDeletion(),
-                              server->SupportsVideoTranscoding(), server->SupportsAudioTranscoding(), qualities.c_str(),
-                              bitrates.c_str(), resolutions.c_str());
+  dbiplus::sql_record params;
+  params.push_back(server->GetUUID().c_str());
+  params.push_back(server->GetName().c_str());
+  params.push_back(server->GetVersion().c_str());
+  params.push_back(server->GetOwner().c_str());
+  params.push_back(server->GetSynced());
+  params.push_back(server->GetOwned());
+  params.push_back(server->GetHome());
+  params.push_back(server->GetServerClass().c_str());
+  params.push_back(server->SupportsDeletion());
+  params.push_back(server->SupportsVideoTranscoding());
+  params.push_back(server->SupportsAudioTranscoding());
+  params.push_back(qualities.c_str());
+  params.push_back(bitrates.c_str());
+  params.push_back(resolutions.c_str());
+
   try
   {
-    m_pDS->exec(sql);
+    m_pDS->exec("insert into server (uuid, name, version, owner, synced, owned, home, serverClass, supportsDeletion,"
+                "supportsVideoTranscoding, supportsAudioTranscoding, transcoderQualities, transcoderBitrates, transcoderResolutions) "
+                "values (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", params);
   }
   catch (...)
   {
@@ -131,12 +142,17 @@ bool CPlexServerCacheDatabase::storeConnection(const CStdString &uuid, const CPl
   CPlexAES aes(g_guiSettings.GetString("system.uuid"));
   token = Base64::Encode(aes.encrypt(connection->GetAccessToken()));
   
-  CStdString sql = PrepareSQL("insert into connections (serverUUID, host, port, token, type, scheme) values ('%s', '%s', %i, '%s', %i, '%s');\n",
-                              uuid.c_str(), connection->GetAddress().GetHostName().c_str(), connection->GetAddress().GetPort(),
-                              token.c_str(), connection->m_type, connection->GetAddress().GetProtocol().c_str());
+  dbiplus::sql_record params;
+  params.push_back(uuid.c_str());
+  params.push_back(connection->GetAddress().GetHostName().c_str());
+  params.push_back((int)connection->GetAddress().GetPort());
+  params.push_back(token.c_str());
+  params.push_back((int)connection->m_type);
+  params.push_back(connection->GetAddress().GetProtocol().c_str());
+
   try
   {
-    m_pDS->exec(sql);
+    m_pDS->exec("insert into connections (serverUUID, host, port, token, type, scheme) values (?, ?, ?, ?, ?, ?)", params);
   }
   catch (...)
   {
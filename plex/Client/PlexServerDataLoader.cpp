@@ -5,6 +5,7 @@
 #include "settings/GUISettings.h"
 #include "Playlists/PlexPlayQueueManager.h"
 #include "Application.h"
+#include "Client/PlexNotificationClient.h"
 
 #include "PlexTypes.h"
 
@@ -20,10 +21,19 @@ using namespace XFILE;
 #define OWNED_SERVER_REFRESH 5 * 60 * 1000
 #define SHARED_SERVER_REFRESH 10 * 60 * 1000
 
+/* servers that push their changes are only polled in case we missed something */
+#define NOTIFYING_SERVER_REFRESH 60 * 60 * 1000
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 CPlexServerDataLoader::CPlexServerDataLoader()
   : CJobQueue(false, 4, CJob::PRIORITY_NORMAL), m_stopped(false), m_forceRefresh(false)
 {
+  CPlexServerDataSnapshot* empty = new CPlexServerDataSnapshot;
+  empty->m_allSections = CFileItemListPtr(new CFileItemList);
+  empty->m_allSharedSections = CFileItemListPtr(new CFileItemList);
+  empty->m_allChannels = CFileItemListPtr(new CFileItemList);
+  m_snapshot = CPlexServerDataSnapshotPtr(empty);
+
   g_plexApplication.timer->SetTimeout(SECTION_REFRESH_INTERVAL, this);
 }
 
@@ -41,6 +51,47 @@ void CPlexServerDataLoader::LoadDataFromServer(const CPlexServerPtr& server)
     CLog::Log(LOGDEBUG, "CPlexServerDataLoader::LoadDataFromServer loading data for server %s",
               server->GetName().c_str());
     AddJob(new CPlexServerDataLoaderJob(server, shared_from_this()));
+    return;
+  }
+  lk.Leave();
+
+  // a server we know about was found reachable again, maybe over another connection
+  UpdateServerStates();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexServerDataLoader::UpdateServerStates()
+{
+  if (m_stopped)
+    return;
+
+  CSingleLock lk(m_dataLock);
+
+  CPlexServerDataSnapshotPtr current = GetSnapshot();
+  if (!ServerStatesChanged(*current))
+    return;
+
+  CLog::Log(LOGDEBUG, "CPlexServerDataLoader::UpdateServerStates a server changed, merging the lists again");
+  Publish(new CPlexServerDataSnapshot(*current));
+
+  CGUIMessage msg(GUI_MSG_NOTIFY_ALL, PLEX_DATA_LOADER, 0, GUI_MSG_PLEX_SERVER_DATA_LOADED, 0);
+  g_windowManager.SendThreadMessage(msg);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexServerDataLoader::RefreshServer(const CStdString& uuid)
+{
+  if (m_stopped)
+    return;
+
+  CSingleLock lk(m_serverLock);
+
+  ServerMap::iterator it = m_servers.find(uuid);
+  if (it != m_servers.end() && it->second)
+  {
+    CLog::Log(LOGDEBUG, "CPlexServerDataLoader::RefreshServer refreshing data for %s",
+              it->second->GetName().c_str());
+    AddJob(new CPlexServerDataLoaderJob(it->second, shared_from_this()));
   }
 }
 
@@ -54,27 +105,35 @@ void CPlexServerDataLoader::RemoveServer(const CPlexServerPtr& server)
 
   CLog::Log(LOGDEBUG, "CPlexServerDataLoader::RemoveServer removing %s", server->GetName().c_str());
 
-  if (m_sectionMap.find(server->GetUUID()) != m_sectionMap.end())
+  CPlexServerDataSnapshot* next = new CPlexServerDataSnapshot(*GetSnapshot());
+  bool removed = false;
+
+  if (next->m_sectionMap.erase(server->GetUUID()))
   {
     CLog::Log(LOG_LEVEL_DEBUG, "CPlexServerDataLoader::RemoveServer from sectionMap %s",
               server->GetName().c_str());
-    m_sectionMap.erase(server->GetUUID());
+    removed = true;
   }
 
-  if (m_sharedSectionsMap.find(server->GetUUID()) != m_sharedSectionsMap.end())
+  if (next->m_sharedSectionsMap.erase(server->GetUUID()))
   {
     CLog::Log(LOG_LEVEL_DEBUG, "CPlexServerDataLoader::RemoveServer from sharedSectionMap %s",
               server->GetName().c_str());
-    m_sharedSectionsMap.erase(server->GetUUID());
+    removed = true;
   }
 
-  if (m_channelMap.find(server->GetUUID()) != m_channelMap.end())
+  if (next->m_channelMap.erase(server->GetUUID()))
   {
     CLog::Log(LOG_LEVEL_DEBUG, "CPlexServerDataLoader::RemoveServer from channelMap %s",
               server->GetName().c_str());
-    m_channelMap.erase(server->GetUUID());
+    removed = true;
   }
 
+  if (removed)
+    Publish(next);
+  else
+    delete next;
+
   if (m_servers.find(server->GetUUID()) != m_servers.end())
     m_servers.erase(server->GetUUID());
 
@@ -90,41 +149,88 @@ void CPlexServerDataLoader::OnJobComplete(unsigned int jobID, bool success, CJob
   if (success && !m_stopped)
   {
     CSingleLock lk(m_dataLock);
+
+    CPlexServerDataSnapshotPtr current = GetSnapshot();
+    CPlexServerDataSnapshot* next = new CPlexServerDataSnapshot(*current);
+    CStdString uuid = j->m_server->GetUUID();
+    bool changed = false;
+    bool sectionsChanged = true;
+
     if (j->m_sectionList)
     {
       CFileItemListPtr sectionList = j->m_sectionList;
-      sectionList->SetProperty("serverUUID", j->m_server->GetUUID());
+      sectionList->SetProperty("serverUUID", uuid);
       sectionList->SetProperty("serverName", j->m_server->GetName());
 
-      if (!j->m_server->IsShared())
-        m_sectionMap[j->m_server->GetUUID()] = sectionList;
-      else
-        m_sharedSectionsMap[j->m_server->GetUUID()] = sectionList;
+      // published lists are never touched again, so this is done before
+      for (int i = 0; i < sectionList->Size(); i++)
+      {
+        CFileItemPtr item = sectionList->Get(i);
+        if (item->GetPlexDirectoryType() == PLEX_DIR_TYPE_MOVIE &&
+            item->GetProperty("agent").asString() == "com.plexapp.agents.none")
+          item->SetPlexDirectoryType(PLEX_DIR_TYPE_HOME_MOVIES);
+      }
+
+      ServerDataMap& sections = j->m_server->IsShared() ? next->m_sharedSectionsMap : next->m_sectionMap;
+      ServerDataMap::const_iterator it = sections.find(uuid);
+      if (it != sections.end())
+        sectionsChanged = SectionsChanged(it->second, sectionList);
+
+      if (it == sections.end() || ListChanged(it->second, sectionList))
+      {
+        sections[uuid] = sectionList;
+        changed = true;
+      }
     }
     
     if (j->m_playlistList)
     {
-      bool havePlaylists = AnyOwnedServerHasPlaylists();
-      m_serverHasPlaylist[j->m_server->GetUUID()] = (j->m_playlistList->Size() > 0);
+      bool hasPlaylist = (j->m_playlistList->Size() > 0);
+      std::map<CStdString, bool>::const_iterator it = next->m_serverHasPlaylist.find(uuid);
+      if (it == next->m_serverHasPlaylist.end() || it->second != hasPlaylist)
+      {
+        next->m_serverHasPlaylist[uuid] = hasPlaylist;
+        changed = true;
+      }
+    }
+
+    if (j->m_channelList)
+    {
+      CFileItemListPtr channelList = j->m_channelList;
+      channelList->SetProperty("serverUUID", uuid);
+      channelList->SetProperty("serverName", j->m_server->GetName());
+
+      ServerDataMap::const_iterator it = next->m_channelMap.find(uuid);
+      if (it == next->m_channelMap.end() || ListChanged(it->second, channelList))
+      {
+        next->m_channelMap[uuid] = channelList;
+        changed = true;
+      }
+    }
+
+    // a server that sends the same data again doesn't bother the readers, unless it is
+    // reached in a different way than when the lists were merged
+    if (changed || ServerStatesChanged(*current))
+    {
+      Publish(next);
 
       // server has new / no more playlists, we kick a message to notify
-      if (havePlaylists != AnyOwnedServerHasPlaylists())
+      if (current->AnyOwnedServerHasPlaylists() != GetSnapshot()->AnyOwnedServerHasPlaylists())
       {
         CGUIMessage msg(GUI_MSG_PLEX_PLAYLIST_STATUS_CHANGED, 0, 0);
         g_windowManager.SendThreadMessage(msg, g_windowManager.GetActiveWindow());
       }
     }
-
-    if (j->m_channelList)
+    else
     {
-      m_channelMap[j->m_server->GetUUID()] = j->m_channelList;
-      m_channelMap[j->m_server->GetUUID()]->SetProperty("serverUUID", j->m_server->GetUUID());
-      m_channelMap[j->m_server->GetUUID()]->SetProperty("serverName", j->m_server->GetName());
+      delete next;
     }
 
     j->m_server->DidRefresh();
 
-    CGUIMessage msg(GUI_MSG_NOTIFY_ALL, PLEX_DATA_LOADER, 0, GUI_MSG_PLEX_SERVER_DATA_LOADED);
+    // param2 tells the listeners if the content of any section changed since the last load
+    CGUIMessage msg(GUI_MSG_NOTIFY_ALL, PLEX_DATA_LOADER, 0, GUI_MSG_PLEX_SERVER_DATA_LOADED,
+                    sectionsChanged ? 1 : 0);
     msg.SetStringParam(j->m_server->GetUUID());
     g_windowManager.SendThreadMessage(msg);
   }
@@ -136,29 +242,137 @@ void CPlexServerDataLoader::OnJobComplete(unsigned int jobID, bool success, CJob
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-CFileItemListPtr CPlexServerDataLoader::GetSectionsForUUID(const CStdString& uuid)
+bool CPlexServerDataLoader::SectionsChanged(const CFileItemListPtr& oldList, const CFileItemListPtr& newList)
 {
-  CSingleLock lk(m_dataLock);
+  if (!oldList || !newList || oldList->Size() != newList->Size())
+    return true;
+
+  // the server bumps these when a scan added, changed or removed something in the section
+  for (int i = 0; i < newList->Size(); i++)
+  {
+    CFileItemPtr oldSection = oldList->Get(i);
+    CFileItemPtr newSection = newList->Get(i);
+
+    if (oldSection->GetPath() != newSection->GetPath() ||
+        oldSection->GetProperty("updatedAt") != newSection->GetProperty("updatedAt") ||
+        oldSection->GetProperty("scannedAt") != newSection->GetProperty("scannedAt"))
+      return true;
+  }
+
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexServerDataLoader::ListChanged(const CFileItemListPtr& oldList, const CFileItemListPtr& newList)
+{
+  if (!oldList || !newList || oldList->Size() != newList->Size())
+    return true;
+
+  // the merged lists carry the server name
+  if (oldList->GetProperty("serverName") != newList->GetProperty("serverName"))
+    return true;
+
+  for (int i = 0; i < newList->Size(); i++)
+  {
+    CFileItemPtr oldItem = oldList->Get(i);
+    CFileItemPtr newItem = newList->Get(i);
+
+    if (oldItem->GetPath() != newItem->GetPath() ||
+        oldItem->GetLabel() != newItem->GetLabel() ||
+        oldItem->GetPlexDirectoryType() != newItem->GetPlexDirectoryType())
+      return true;
+
+    // the preferences are in here as well
+    if (!(oldItem->GetAllProperties() == newItem->GetAllProperties()))
+      return true;
+  }
+
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexServerDataLoader::Publish(CPlexServerDataSnapshot* next)
+{
+  next->m_version = GetSnapshot()->GetVersion() + 1;
+
+  next->m_ownedServerHasPlaylists = false;
+  std::pair<CStdString, bool> p;
+  BOOST_FOREACH(p, next->m_serverHasPlaylist)
+  {
+    if (!p.second)
+      continue;
+
+    CPlexServerPtr server = g_plexApplication.serverManager->FindByUUID(p.first);
+    if (server && !server->IsShared())
+      next->m_ownedServerHasPlaylists = true;
+  }
+
+  next->m_allSections = MergeLists(next->m_sectionMap, false, false);
+  next->m_allSharedSections = MergeLists(next->m_sharedSectionsMap, true, false);
+  next->m_allChannels = MergeLists(next->m_channelMap, false, true);
+
+  next->m_serverStates.clear();
+  const ServerDataMap* maps[] = { &next->m_sectionMap, &next->m_sharedSectionsMap, &next->m_channelMap };
+  for (int i = 0; i < 3; i++)
+  {
+    BOOST_FOREACH(ServerDataPair pair, *maps[i])
+      next->m_serverStates[pair.first] = ServerState(g_plexApplication.serverManager->FindByUUID(pair.first));
+  }
 
-  if (m_sectionMap.find(uuid) != m_sectionMap.end())
-    return m_sectionMap[uuid];
+  CLog::Log(LOGDEBUG, "CPlexServerDataLoader::Publish version %u, %d sections, %d shared, %d channels",
+            next->m_version, next->m_allSections->Size(), next->m_allSharedSections->Size(),
+            next->m_allChannels->Size());
+
+  boost::atomic_store(&m_snapshot, CPlexServerDataSnapshotPtr(next));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CFileItemListPtr CPlexServerDataSnapshot::GetSectionsForUUID(const CStdString& uuid) const
+{
+  ServerDataMap::const_iterator it = m_sectionMap.find(uuid);
+  if (it != m_sectionMap.end())
+    return it->second;
 
   /* not found in our server map, check shared servers */
-  if (m_sharedSectionsMap.find(uuid) != m_sharedSectionsMap.end())
-    return m_sharedSectionsMap[uuid];
+  it = m_sharedSectionsMap.find(uuid);
+  if (it != m_sharedSectionsMap.end())
+    return it->second;
 
   return CFileItemListPtr();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-CFileItemListPtr CPlexServerDataLoader::GetChannelsForUUID(const CStdString& uuid)
+CFileItemListPtr CPlexServerDataSnapshot::GetChannelsForUUID(const CStdString& uuid) const
 {
-  CSingleLock lk(m_dataLock);
-  if (m_channelMap.find(uuid) != m_channelMap.end())
-    return m_channelMap[uuid];
+  ServerDataMap::const_iterator it = m_channelMap.find(uuid);
+  if (it != m_channelMap.end())
+    return it->second;
   return CFileItemListPtr();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexServerDataSnapshot::ServerUUIDHasPlaylist(const CStdString& uuid) const
+{
+  std::map<CStdString, bool>::const_iterator it = m_serverHasPlaylist.find(uuid);
+  return it != m_serverHasPlaylist.end() && it->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CFileItemPtr CPlexServerDataSnapshot::GetSection(const CURL& sectionUrl) const
+{
+  CFileItemListPtr sections = GetSectionsForUUID(sectionUrl.GetHostName());
+  if (sections && sections->Size() > 0)
+  {
+    for (int i = 0; i < sections->Size(); i++)
+    {
+      CFileItemPtr item = sections->Get(i);
+      if (item && item->GetPath() == sectionUrl.Get())
+        return item;
+    }
+  }
+  return CFileItemPtr();
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 CFileItemListPtr CPlexServerDataLoaderJob::FetchList(const CStdString& path)
 {
@@ -258,97 +472,78 @@ bool CPlexServerDataLoaderJob::DoWork()
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-CFileItemListPtr CPlexServerDataLoader::GetAllSharedSections() const
+CStdString CPlexServerDataLoader::ServerState(const CPlexServerPtr& server)
 {
-  CSingleLock lk(m_dataLock);
-  CFileItemList* list = new CFileItemList;
+  if (!server || !server->GetActiveConnection())
+    return "";
 
-  BOOST_FOREACH(ServerDataPair pair, m_sharedSectionsMap)
-  {
-    for (int i = 0; i < pair.second->Size(); i++)
-    {
-      CFileItemPtr item = pair.second->Get(i);
+  return server->GetName() + "\n" + server->GetOwner() + "\n" +
+         (server->GetActiveConnection()->isSSL() ? "secure" : "insecure");
+}
 
-      CStdString uuid = pair.second->GetProperty("serverUUID").asString();
-      CPlexServerPtr server = g_plexApplication.serverManager->FindByUUID(uuid);
-      if (server && server->GetActiveConnection())
-      {
-        item->SetProperty("serverName", server->GetName());
-        item->SetProperty("serverUUID", server->GetUUID());
-        item->SetProperty("serverOwner", server->GetOwner());
-        item->SetProperty("sectionNameCollision", "yes");
-        item->SetProperty("isSecure", server->GetActiveConnection()->isSSL() ? "1" : "");
-        list->Add(item);
-      }
-    }
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexServerDataLoader::ServerStatesChanged(const CPlexServerDataSnapshot& snapshot)
+{
+  std::pair<CStdString, CStdString> p;
+  BOOST_FOREACH(p, snapshot.m_serverStates)
+  {
+    if (ServerState(g_plexApplication.serverManager->FindByUUID(p.first)) != p.second)
+      return true;
   }
-
-  return CFileItemListPtr(list);
+  return false;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-CFileItemListPtr CPlexServerDataLoader::GetAllSections() const
+CFileItemListPtr CPlexServerDataLoader::MergeLists(const ServerDataMap& map, bool shared, bool channels)
 {
-  CSingleLock lk(m_dataLock);
   CFileItemList* list = new CFileItemList;
   std::map<std::string, CFileItemPtr> sectionNameMap;
 
-  BOOST_FOREACH(ServerDataPair pair, m_sectionMap)
+  BOOST_FOREACH(ServerDataPair pair, map)
   {
     if (!pair.second)
       continue;
 
+    CStdString serverUUID = pair.second->GetProperty("serverUUID").asString();
+    CPlexServerPtr server = g_plexApplication.serverManager->FindByUUID(serverUUID);
+    if (!server || !server->GetActiveConnection())
+      continue;
+
     for (int i = 0; i < pair.second->Size(); i++)
     {
-      CFileItemPtr item = pair.second->Get(i);
-      if (item)
-      {
-        CStdString serverUUID = pair.second->GetProperty("serverUUID").asString();
-        CPlexServerPtr server = g_plexApplication.serverManager->FindByUUID(serverUUID);
-        if (server && server->GetActiveConnection())
-        {
-          item->SetProperty("serverName", server->GetName());
-          item->SetProperty("serverUUID", server->GetUUID());
-          item->SetProperty("isSecure", server->GetActiveConnection()->isSSL() ? "1" : "");
-          list->Add(item);
+      if (!pair.second->Get(i))
+        continue;
 
-          if (sectionNameMap.find(item->GetLabel()) != sectionNameMap.end())
-          {
-            sectionNameMap[item->GetLabel()]->SetProperty("SectionNameCollision", "yes");
-            item->SetProperty("sectionNameCollision", "yes");
-          }
+      // the server lists are part of older snapshots as well, the merged one gets copies
+      CFileItemPtr item(new CFileItem(*pair.second->Get(i)));
+      item->SetProperty("serverName", server->GetName());
+      item->SetProperty("serverUUID", server->GetUUID());
 
-          sectionNameMap[item->GetLabel()] = item;
-        }
+      if (channels)
+      {
+        list->Add(item);
+        continue;
       }
-    }
-  }
-
-  return CFileItemListPtr(list);
-}
 
-///////////////////////////////////////////////////////////////////////////////////////////////////
-CFileItemListPtr CPlexServerDataLoader::GetAllChannels() const
-{
-  CSingleLock lk(m_dataLock);
-  CFileItemList* list = new CFileItemList;
+      item->SetProperty("isSecure", server->GetActiveConnection()->isSSL() ? "1" : "");
 
-  BOOST_FOREACH(ServerDataPair pair, m_channelMap)
-  {
-    for (int i = 0; i < pair.second->Size(); i++)
-    {
-      CFileItemPtr item = pair.second->Get(i);
-      if (item)
+      if (shared)
+      {
+        item->SetProperty("serverOwner", server->GetOwner());
+        item->SetProperty("sectionNameCollision", "yes");
+      }
+      else
       {
-        CStdString serverUUID = pair.second->GetProperty("serverUUID").asString();
-        CPlexServerPtr server = g_plexApplication.serverManager->FindByUUID(serverUUID);
-        if (server && server->GetActiveConnection())
+        if (sectionNameMap.find(item->GetLabel()) != sectionNameMap.end())
         {
-          item->SetProperty("serverName", server->GetName());
-          item->SetProperty("serverUUID", server->GetUUID());
-          list->Add(item);
+          sectionNameMap[item->GetLabel()]->SetProperty("SectionNameCollision", "yes");
+          item->SetProperty("sectionNameCollision", "yes");
         }
+
+        sectionNameMap[item->GetLabel()] = item;
       }
+
+      list->Add(item);
     }
   }
 
@@ -371,9 +566,9 @@ void CPlexServerDataLoader::OnTimeout()
   {
     CSingleLock lk(m_dataLock);
 
-    m_sectionMap.clear();
-    m_sharedSectionsMap.clear();
-    m_channelMap.clear();
+    CPlexServerDataSnapshot* next = new CPlexServerDataSnapshot;
+    next->m_serverHasPlaylist = GetSnapshot()->m_serverHasPlaylist;
+    Publish(next);
   }
 
   std::pair<CStdString, CPlexServerPtr> p;
@@ -384,9 +579,14 @@ void CPlexServerDataLoader::OnTimeout()
 
     if ((p.second->GetUUID() != "myplex") || (m_forceRefresh))
     {
+      int ownedRefresh = OWNED_SERVER_REFRESH;
+      if (g_plexApplication.notificationClient &&
+          g_plexApplication.notificationClient->IsListening(p.second->GetUUID()))
+        ownedRefresh = NOTIFYING_SERVER_REFRESH;
+
       if (m_forceRefresh ||
           (p.second->GetLastRefreshed() == 0 ||
-          ((!p.second->IsShared() && p.second->GetLastRefreshed() > OWNED_SERVER_REFRESH) ||
+          ((!p.second->IsShared() && p.second->GetLastRefreshed() > ownedRefresh) ||
           (p.second->IsShared() && p.second->GetLastRefreshed() > SHARED_SERVER_REFRESH))))
       {
         CLog::Log(LOGDEBUG, "CPlexServerDataLoader::OnTimeout refreshing data for %s",
@@ -414,22 +614,7 @@ void CPlexServerDataLoader::Stop()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 CFileItemPtr CPlexServerDataLoader::GetSection(const CURL& sectionUrl)
 {
-  CFileItemListPtr sections = GetSectionsForUUID(sectionUrl.GetHostName());
-  if (sections && sections->Size() > 0)
-  {
-    for (int i = 0; i < sections->Size(); i++)
-    {
-      CFileItemPtr item = sections->Get(i);
-      if (item && item->GetPath() == sectionUrl.Get())
-      {
-        if (item->GetPlexDirectoryType() == PLEX_DIR_TYPE_MOVIE &&
-            item->GetProperty("agent").asString() == "com.plexapp.agents.none")
-          item->SetPlexDirectoryType(PLEX_DIR_TYPE_HOME_MOVIES);
-        return item;
-      }
-    }
-  }
-  return CFileItemPtr();
+  return GetSnapshot()->GetSection(sectionUrl);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
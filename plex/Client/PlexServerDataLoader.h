@@ -19,6 +19,55 @@ typedef std::map<CStdString, CFileItemListPtr> ServerDataMap;
 typedef std::pair<CStdString, CFileItemListPtr> ServerDataPair;
 typedef std::map<CStdString, CPlexServerPtr> ServerMap;
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* What the loader knows about the sections and channels of all servers at one point in time.
+ * A snapshot is never changed once it's published, so it can be read from any thread without
+ * locking. The lists it hands out are shared by everyone and must not be modified. */
+class CPlexServerDataSnapshot
+{
+public:
+  CPlexServerDataSnapshot() : m_version(0), m_ownedServerHasPlaylists(false) {}
+
+  /* goes up with every change that was published */
+  unsigned int GetVersion() const { return m_version; }
+
+  CFileItemListPtr GetSectionsForUUID(const CStdString& uuid) const;
+  CFileItemListPtr GetChannelsForUUID(const CStdString& uuid) const;
+  CFileItemPtr GetSection(const CURL& sectionUrl) const;
+
+  CFileItemListPtr GetAllSections() const { return m_allSections; }
+  CFileItemListPtr GetAllSharedSections() const { return m_allSharedSections; }
+  CFileItemListPtr GetAllChannels() const { return m_allChannels; }
+
+  bool HasChannels() const { return m_channelMap.size() > 0; }
+  bool HasSharedSections() const { return m_sharedSectionsMap.size() > 0; }
+
+  bool AnyOwnedServerHasPlaylists() const { return m_ownedServerHasPlaylists; }
+  bool ServerUUIDHasPlaylist(const CStdString& uuid) const;
+
+private:
+  friend class CPlexServerDataLoader;
+
+  unsigned int m_version;
+
+  ServerDataMap m_sectionMap;
+  ServerDataMap m_sharedSectionsMap;
+  ServerDataMap m_channelMap;
+  std::map<CStdString, bool> m_serverHasPlaylist;
+  bool m_ownedServerHasPlaylists;
+
+  /* merged once when the snapshot is published */
+  CFileItemListPtr m_allSections;
+  CFileItemListPtr m_allSharedSections;
+  CFileItemListPtr m_allChannels;
+
+  /* uuid -> what the merged lists know about the server, see CPlexServerDataLoader::ServerState */
+  std::map<CStdString, CStdString> m_serverStates;
+};
+
+typedef boost::shared_ptr<const CPlexServerDataSnapshot> CPlexServerDataSnapshotPtr;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
 class CPlexServerDataLoader : public CJobQueue,
                               public IPlexGlobalTimeout,
                               public boost::enable_shared_from_this<CPlexServerDataLoader>
@@ -29,39 +78,44 @@ public:
   void LoadDataFromServer(const CPlexServerPtr& server);
   void RemoveServer(const CPlexServerPtr& server);
 
-  CFileItemListPtr GetSectionsForUUID(const CStdString& uuid);
+  /* publishes the merged lists again if a server has a different connection, name or owner
+   * than when they were merged */
+  void UpdateServerStates();
+
+  /* the latest published data, hold on to it to get a consistent view over several calls */
+  CPlexServerDataSnapshotPtr GetSnapshot() const
+  {
+    return boost::atomic_load(&m_snapshot);
+  }
+
+  CFileItemListPtr GetSectionsForUUID(const CStdString& uuid)
+  {
+    return GetSnapshot()->GetSectionsForUUID(uuid);
+  }
   CFileItemListPtr GetSectionsForServer(const CPlexServerPtr& server)
   {
     return GetSectionsForUUID(server->GetUUID());
   }
-  CFileItemListPtr GetChannelsForUUID(const CStdString& uuid);
+  CFileItemListPtr GetChannelsForUUID(const CStdString& uuid)
+  {
+    return GetSnapshot()->GetChannelsForUUID(uuid);
+  }
   CFileItemListPtr GetChannelsForServer(const CPlexServerPtr& server)
   {
     return GetChannelsForUUID(server->GetUUID());
   }
 
-  CFileItemListPtr GetAllSections() const;
-  CFileItemListPtr GetAllSharedSections() const;
-  CFileItemListPtr GetAllChannels() const;
-  
-  bool AnyOwnedServerHasPlaylists()
+  CFileItemListPtr GetAllSections() const { return GetSnapshot()->GetAllSections(); }
+  CFileItemListPtr GetAllSharedSections() const { return GetSnapshot()->GetAllSharedSections(); }
+  CFileItemListPtr GetAllChannels() const { return GetSnapshot()->GetAllChannels(); }
+
+  bool AnyOwnedServerHasPlaylists() const
   {
-    CSingleLock lk(m_dataLock);
-    
-    PlexServerList list = g_plexApplication.serverManager->GetAllServers(CPlexServerManager::SERVER_OWNED);
-    BOOST_FOREACH(const CPlexServerPtr& server, list)
-    {
-      if (ServerHasPlaylist(server))
-        return true;
-    }
-    return false;
+    return GetSnapshot()->AnyOwnedServerHasPlaylists();
   }
-  bool ServerUUIDHasPlaylist(const CStdString& uuid)
+  bool ServerUUIDHasPlaylist(const CStdString& uuid) const
   {
-    if (m_serverHasPlaylist.find(uuid) == m_serverHasPlaylist.end())
-      return false;
-    
-    return m_serverHasPlaylist[uuid];
+    return GetSnapshot()->ServerUUIDHasPlaylist(uuid);
   }
   
   bool ServerHasPlaylist(const CPlexServerPtr& server)
@@ -76,11 +130,11 @@ public:
 
   bool HasChannels() const
   {
-    return m_channelMap.size() > 0;
+    return GetSnapshot()->HasChannels();
   }
   bool HasSharedSections() const
   {
-    return m_sharedSectionsMap.size() > 0;
+    return GetSnapshot()->HasSharedSections();
   }
 
   void OnJobComplete(unsigned int jobID, bool success, CJob* job);
@@ -95,6 +149,9 @@ public:
     return "serverDataLoader";
   }
 
+  /* reload one server now, the notification client calls this when its library changed */
+  void RefreshServer(const CStdString& uuid);
+
   void Refresh()
   {
     CSingleLock lk(m_dataLock);
@@ -102,19 +159,29 @@ public:
     g_plexApplication.timer->RestartTimeout(5, this);
   }
 
+  static bool SectionsChanged(const CFileItemListPtr& oldList, const CFileItemListPtr& newList);
+  static bool ListChanged(const CFileItemListPtr& oldList, const CFileItemListPtr& newList);
+
+  /* what MergeLists takes from the server: if it can be reached, its name, owner and if the
+   * connection is secure. Empty for a server that can't be reached */
+  static CStdString ServerState(const CPlexServerPtr& server);
+
 private:
   bool m_stopped;
   void OnTimeout();
 
+  /* merges the lists of next and makes it the current snapshot, m_dataLock has to be held */
+  void Publish(CPlexServerDataSnapshot* next);
+  static CFileItemListPtr MergeLists(const ServerDataMap& map, bool shared, bool channels);
+  static bool ServerStatesChanged(const CPlexServerDataSnapshot& snapshot);
+
+  /* serializes the writers, readers only go through m_snapshot */
   CCriticalSection m_dataLock;
   CCriticalSection m_serverLock;
 
   ServerMap m_servers;
 
-  ServerDataMap m_sectionMap;
-  ServerDataMap m_channelMap;
-  ServerDataMap m_sharedSectionsMap;
-  std::map<CStdString, bool> m_serverHasPlaylist;
+  CPlexServerDataSnapshotPtr m_snapshot;
 
   bool m_forceRefresh;
 };
@@ -11,6 +11,7 @@
 #include "plex/PlexTypes.h"
 #include "Client/PlexConnection.h"
 #include "PlexServerDataLoader.h"
+#include "PlexNotificationClient.h"
 #include "File.h"
 
 #include "Stopwatch.h"
@@ -397,9 +398,17 @@ void CPlexServerManager::NotifyAboutServer(const CPlexServerPtr& server, bool ad
   g_windowManager.SendThreadMessage(msg);
 
   if (added)
+  {
     g_plexApplication.dataLoader->LoadDataFromServer(server);
+    if (g_plexApplication.notificationClient)
+      g_plexApplication.notificationClient->AddServer(server);
+  }
   else
+  {
     g_plexApplication.dataLoader->RemoveServer(server);
+    if (g_plexApplication.notificationClient)
+      g_plexApplication.notificationClient->RemoveServer(server->GetUUID());
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
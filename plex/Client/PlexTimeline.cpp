@@ -15,6 +15,7 @@
 #include "PlexPlayQueueManager.h"
 #include "music/tags/MusicInfoTag.h"
 #include "video/VideoInfoTag.h"
+#include "threads/SingleLock.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 CUrlOptions CPlexTimeline::getTimeline(bool forServer)
@@ -255,3 +256,31 @@ CXBMCTinyXML CPlexTimelineCollection::getTimelinesXML(int commandID)
 
   return doc;
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+std::string CPlexTimelineCollection::getTimelinesData(int commandID)
+{
+  CSingleLock lk(m_renderLock);
+
+  if (!m_rendered)
+  {
+    m_renderedData = PlexUtils::GetXMLString(getTimelinesXML(-1));
+
+    size_t pos = m_renderedData.find("<MediaContainer");
+    if (pos != std::string::npos)
+      m_commandIDOffset = pos + strlen("<MediaContainer");
+    m_rendered = true;
+  }
+
+  if (commandID == -1 || m_commandIDOffset == std::string::npos)
+    return m_renderedData;
+
+  std::string attribute = " commandID=\"" + boost::lexical_cast<std::string>(commandID) + "\"";
+
+  std::string data;
+  data.reserve(m_renderedData.size() + attribute.size());
+  data.append(m_renderedData, 0, m_commandIDOffset);
+  data.append(attribute);
+  data.append(m_renderedData, m_commandIDOffset, std::string::npos);
+  return data;
+}
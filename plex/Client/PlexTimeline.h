@@ -7,6 +7,7 @@
 
 #include "XBMCTinyXML.h"
 #include "FileItem.h"
+#include "threads/CriticalSection.h"
 
 class CPlexTimeline
 {
@@ -74,14 +75,14 @@ typedef std::map<ePlexMediaType, CPlexTimelinePtr> CPlexTimelineMap;
 class CPlexTimelineCollection
 {
   public:
-    CPlexTimelineCollection()
+    CPlexTimelineCollection() : m_rendered(false), m_commandIDOffset(std::string::npos)
     {
       m_timelines[PLEX_MEDIA_TYPE_MUSIC] = CPlexTimelinePtr(new CPlexTimeline(PLEX_MEDIA_TYPE_MUSIC));
       m_timelines[PLEX_MEDIA_TYPE_VIDEO] = CPlexTimelinePtr(new CPlexTimeline(PLEX_MEDIA_TYPE_VIDEO));
       m_timelines[PLEX_MEDIA_TYPE_PHOTO] = CPlexTimelinePtr(new CPlexTimeline(PLEX_MEDIA_TYPE_PHOTO));
     }
 
-    CPlexTimelineCollection(const CPlexTimelineMap& timelines)
+    CPlexTimelineCollection(const CPlexTimelineMap& timelines) : m_rendered(false), m_commandIDOffset(std::string::npos)
     {
       m_timelines = timelines;
     }
@@ -94,8 +95,17 @@ class CPlexTimelineCollection
 
     CXBMCTinyXML getTimelinesXML(int commandID = 0);
 
+    /* The serialized timelines XML. It's rendered once, the first call takes the
+     * snapshot, after that only the commandID is patched in for each subscriber. */
+    std::string getTimelinesData(int commandID = -1);
+
   private:
     CPlexTimelineMap m_timelines;
+
+    CCriticalSection m_renderLock;
+    bool m_rendered;
+    std::string m_renderedData;
+    size_t m_commandIDOffset;
 };
 
 typedef boost::shared_ptr<CPlexTimelineCollection> CPlexTimelineCollectionPtr;
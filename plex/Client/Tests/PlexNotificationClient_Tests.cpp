@@ -0,0 +1,273 @@
+#include "PlexTest.h"
+#include "Client/PlexNotificationClient.h"
+#include "network/websocket/WebSocket.h"
+#include "network/websocket/WebSocketV13.h"
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+using boost::asio::ip::tcp;
+
+#define TIMELINE_ADDED(section, state) \
+  "{\"type\":\"timeline\",\"size\":1,\"_children\":[{\"_elementType\":\"TimelineEntry\"," \
+  "\"sectionID\":" #section ",\"itemID\":1234,\"type\":1,\"title\":\"Heat\",\"state\":" #state "}]}"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* stands in for the notification endpoint of a server on the loopback interface, it takes one
+ * client at a time and pushes whatever the test wants it to */
+class LoopbackNotificationServer
+{
+public:
+  LoopbackNotificationServer()
+    : m_acceptor(m_io, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)),
+      m_connections(0), m_stop(false)
+  {
+    m_thread = boost::thread(boost::bind(&LoopbackNotificationServer::run, this));
+  }
+
+  ~LoopbackNotificationServer()
+  {
+    m_stop = true;
+
+    // wake up the blocking accept
+    boost::system::error_code ec;
+    tcp::socket wakeup(m_io);
+    wakeup.connect(m_acceptor.local_endpoint(), ec);
+
+    m_thread.join();
+    drop();
+  }
+
+  CURL url() const
+  {
+    return CURL("http://127.0.0.1:" + boost::lexical_cast<std::string>(m_acceptor.local_endpoint().port()) +
+                PLEX_NOTIFICATION_PATH);
+  }
+
+  bool waitForConnections(int connections, int timeoutMs = 5000)
+  {
+    boost::mutex::scoped_lock lk(m_mutex);
+    boost::system_time deadline = boost::get_system_time() + boost::posix_time::milliseconds(timeoutMs);
+    while (m_connections < connections)
+    {
+      if (!m_cond.timed_wait(lk, deadline))
+        return false;
+    }
+    return true;
+  }
+
+  void send(const std::string& json)
+  {
+    boost::mutex::scoped_lock lk(m_mutex);
+    if (!m_client)
+      return;
+
+    CWebSocketFrame frame(WebSocketTextFrame, json.c_str(), json.size());
+    boost::system::error_code ec;
+    boost::asio::write(*m_client, boost::asio::buffer(frame.GetFrameData(), frame.GetFrameLength()), ec);
+  }
+
+  void drop()
+  {
+    boost::mutex::scoped_lock lk(m_mutex);
+    if (!m_client)
+      return;
+
+    boost::system::error_code ec;
+    m_client->shutdown(tcp::socket::shutdown_both, ec);
+    m_client->close(ec);
+    m_client.reset();
+  }
+
+private:
+  typedef boost::shared_ptr<tcp::socket> socket_ptr;
+
+  void run()
+  {
+    while (!m_stop)
+    {
+      socket_ptr socket(new tcp::socket(m_io));
+      boost::system::error_code ec;
+      m_acceptor.accept(*socket, ec);
+      if (ec || m_stop)
+        break;
+
+      boost::asio::streambuf request;
+      size_t length = boost::asio::read_until(*socket, request, "\r\n\r\n", ec);
+      if (ec)
+        continue;
+
+      std::string data(boost::asio::buffers_begin(request.data()), boost::asio::buffers_begin(request.data()) + length);
+      std::string response;
+      CWebSocketV13 websocket;
+      if (!websocket.Handshake(data.c_str(), data.size(), response))
+        continue;
+
+      boost::asio::write(*socket, boost::asio::buffer(response), ec);
+      if (ec)
+        continue;
+
+      drop();
+
+      boost::mutex::scoped_lock lk(m_mutex);
+      m_client = socket;
+      m_connections++;
+      m_cond.notify_all();
+    }
+  }
+
+  boost::asio::io_service m_io;
+  tcp::acceptor m_acceptor;
+  boost::thread m_thread;
+
+  boost::mutex m_mutex;
+  boost::condition_variable m_cond;
+  socket_ptr m_client;
+  int m_connections;
+  bool m_stop;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* records the changes instead of invalidating anything */
+class RecordingNotificationClient : public CPlexNotificationClient
+{
+public:
+  bool waitForChanges(size_t count, int timeoutMs = 5000)
+  {
+    boost::mutex::scoped_lock lk(m_mutex);
+    boost::system_time deadline = boost::get_system_time() + boost::posix_time::milliseconds(timeoutMs);
+    while (m_changes.size() < count)
+    {
+      if (!m_cond.timed_wait(lk, deadline))
+        return false;
+    }
+    return true;
+  }
+
+  std::vector<std::pair<CStdString, std::set<int> > > changes()
+  {
+    boost::mutex::scoped_lock lk(m_mutex);
+    return m_changes;
+  }
+
+protected:
+  void OnLibraryChanged(const CStdString& uuid, const std::set<int>& sections)
+  {
+    boost::mutex::scoped_lock lk(m_mutex);
+    m_changes.push_back(std::make_pair(uuid, sections));
+    m_cond.notify_all();
+  }
+
+private:
+  boost::mutex m_mutex;
+  boost::condition_variable m_cond;
+  std::vector<std::pair<CStdString, std::set<int> > > m_changes;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexNotificationClientParse, timeline)
+{
+  std::set<int> sections;
+  EXPECT_TRUE(CPlexNotificationClient::ParseNotification(TIMELINE_ADDED(3, 5), sections));
+  ASSERT_EQ(1, sections.size());
+  EXPECT_EQ(3, *sections.begin());
+
+  // deleted items count as well
+  sections.clear();
+  EXPECT_TRUE(CPlexNotificationClient::ParseNotification(TIMELINE_ADDED(4, 9), sections));
+  EXPECT_EQ(4, *sections.begin());
+}
+
+TEST(PlexNotificationClientParse, timelineInProgress)
+{
+  // the item is still being matched, the listing doesn't change yet
+  std::set<int> sections;
+  EXPECT_FALSE(CPlexNotificationClient::ParseNotification(TIMELINE_ADDED(3, 0), sections));
+  EXPECT_FALSE(CPlexNotificationClient::ParseNotification(TIMELINE_ADDED(3, 3), sections));
+  EXPECT_TRUE(sections.empty());
+}
+
+TEST(PlexNotificationClientParse, container)
+{
+  std::set<int> sections;
+  EXPECT_TRUE(CPlexNotificationClient::ParseNotification(
+    "{\"NotificationContainer\":{\"type\":\"timeline\",\"size\":2,\"TimelineEntry\":["
+    "{\"sectionID\":1,\"itemID\":10,\"state\":5},{\"sectionID\":2,\"itemID\":11,\"state\":9}]}}", sections));
+  ASSERT_EQ(2, sections.size());
+  EXPECT_EQ(1, *sections.begin());
+  EXPECT_EQ(2, *sections.rbegin());
+}
+
+TEST(PlexNotificationClientParse, playing)
+{
+  std::set<int> sections;
+  EXPECT_FALSE(CPlexNotificationClient::ParseNotification(
+    "{\"type\":\"playing\",\"_children\":[{\"sessionKey\":\"1\",\"state\":\"playing\",\"viewOffset\":1000}]}", sections));
+
+  EXPECT_TRUE(CPlexNotificationClient::ParseNotification(
+    "{\"type\":\"playing\",\"_children\":[{\"sessionKey\":\"1\",\"state\":\"stopped\",\"viewOffset\":1000}]}", sections));
+  EXPECT_EQ(PLEX_SECTION_UNKNOWN, *sections.begin());
+}
+
+TEST(PlexNotificationClientParse, garbage)
+{
+  std::set<int> sections;
+  EXPECT_FALSE(CPlexNotificationClient::ParseNotification("", sections));
+  EXPECT_FALSE(CPlexNotificationClient::ParseNotification("{\"type\":\"progress\"}", sections));
+  EXPECT_FALSE(CPlexNotificationClient::ParseNotification("[1, 2", sections));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexNotificationClient, receivesChanges)
+{
+  LoopbackNotificationServer server;
+  RecordingNotificationClient client;
+
+  client.Listen("abc123", server.url());
+  ASSERT_TRUE(server.waitForConnections(1));
+
+  server.send(TIMELINE_ADDED(3, 0));
+  server.send(TIMELINE_ADDED(3, 5));
+  ASSERT_TRUE(client.waitForChanges(1));
+
+  std::vector<std::pair<CStdString, std::set<int> > > changes = client.changes();
+  EXPECT_EQ("abc123", changes[0].first);
+  ASSERT_EQ(1, changes[0].second.size());
+  EXPECT_EQ(3, *changes[0].second.begin());
+  EXPECT_TRUE(client.IsListening("abc123"));
+
+  client.Stop();
+  EXPECT_FALSE(client.IsListening("abc123"));
+}
+
+TEST(PlexNotificationClient, reconnectInvalidatesServer)
+{
+  LoopbackNotificationServer server;
+  RecordingNotificationClient client;
+
+  client.Listen("abc123", server.url());
+  ASSERT_TRUE(server.waitForConnections(1));
+
+  // we might have missed something while the connection was down
+  server.drop();
+  ASSERT_TRUE(server.waitForConnections(2));
+  ASSERT_TRUE(client.waitForChanges(1));
+
+  std::vector<std::pair<CStdString, std::set<int> > > changes = client.changes();
+  ASSERT_EQ(1, changes[0].second.size());
+  EXPECT_EQ(PLEX_SECTION_UNKNOWN, *changes[0].second.begin());
+
+  client.Stop();
+}
+
+TEST(PlexNotificationClient, refusedServer)
+{
+  // nothing listens there, we keep trying in the background
+  RecordingNotificationClient client;
+  client.Listen("abc123", CURL("http://127.0.0.1:1" PLEX_NOTIFICATION_PATH));
+  EXPECT_FALSE(client.IsListening("abc123"));
+  client.Stop();
+}
@@ -0,0 +1,119 @@
+#include "PlexTest.h"
+#include "Client/PlexPlaybackPrefetcher.h"
+#include "threads/Thread.h"
+
+class PlexPlaybackPrefetcherTests : public ::testing::Test
+{
+public:
+  CFileItem createItem(const CStdString& ratingKey, int mediaCount = 2)
+  {
+    CFileItem item;
+    item.SetPath("plexserver://abc/library/metadata/" + ratingKey);
+    item.SetProperty("ratingKey", ratingKey);
+    item.SetProperty("plexserver", "abc");
+
+    for (int i = 0; i < mediaCount; i++)
+    {
+      CFileItemPtr media(new CFileItem);
+      media->SetProperty("id", 100 + i);
+      item.m_mediaItems.push_back(media);
+    }
+    return item;
+  }
+
+  /* what the job would have come up with */
+  void complete(CPlexPlaybackPrefetcher& prefetcher, const CFileItem& item, const CStdString& path,
+                bool transcode = false)
+  {
+    CPlexPlaybackPrefetchJob job(item, CPlexPlaybackPrefetcher::GetKey(item));
+    job.m_choosenMedia = item;
+    job.m_choosenMedia.SetPath(path);
+    if (transcode)
+      job.m_choosenMedia.SetProperty("plexDidTranscode", true);
+
+    prefetcher.OnJobComplete(1, true, &job);
+  }
+};
+
+TEST_F(PlexPlaybackPrefetcherTests, keyFollowsMetadataAndMedia)
+{
+  CFileItem library = createItem("1888");
+  CFileItem queued = createItem("1888");
+  queued.SetPath("plexserver://abc/playQueues/12/items?type=video");
+  EXPECT_EQ(CPlexPlaybackPrefetcher::GetKey(library), CPlexPlaybackPrefetcher::GetKey(queued));
+
+  // nothing selected plays the first media
+  queued.SetProperty("selectedMediaItem", 100);
+  EXPECT_EQ(CPlexPlaybackPrefetcher::GetKey(library), CPlexPlaybackPrefetcher::GetKey(queued));
+
+  queued.SetProperty("selectedMediaItem", 101);
+  EXPECT_NE(CPlexPlaybackPrefetcher::GetKey(library), CPlexPlaybackPrefetcher::GetKey(queued));
+
+  EXPECT_NE(CPlexPlaybackPrefetcher::GetKey(library), CPlexPlaybackPrefetcher::GetKey(createItem("1889")));
+}
+
+TEST_F(PlexPlaybackPrefetcherTests, resolvedAhead)
+{
+  CPlexPlaybackPrefetcher prefetcher;
+  complete(prefetcher, createItem("1888"), "plexserver://abc/library/parts/1950/file.mkv");
+
+  CFileItem queued = createItem("1888");
+  queued.SetProperty("selectedMediaItem", 100);
+
+  CFileItem resolved;
+  EXPECT_TRUE(prefetcher.GetResolved(queued, resolved));
+  EXPECT_STREQ("plexserver://abc/library/parts/1950/file.mkv", resolved.GetPath().c_str());
+
+  queued.SetProperty("selectedMediaItem", 101);
+  EXPECT_FALSE(prefetcher.GetResolved(queued, resolved));
+}
+
+TEST_F(PlexPlaybackPrefetcherTests, transcodesAreNotKept)
+{
+  CPlexPlaybackPrefetcher prefetcher;
+  complete(prefetcher, createItem("1888"), "plexserver://abc/video/:/transcode/universal/start.m3u8", true);
+
+  CFileItem resolved;
+  EXPECT_FALSE(prefetcher.GetResolved(createItem("1888"), resolved));
+}
+
+TEST_F(PlexPlaybackPrefetcherTests, failedJobsAreNotKept)
+{
+  CPlexPlaybackPrefetcher prefetcher;
+  CFileItem item = createItem("1888");
+
+  CPlexPlaybackPrefetchJob job(item, CPlexPlaybackPrefetcher::GetKey(item));
+  prefetcher.OnJobComplete(1, false, &job);
+
+  CFileItem resolved;
+  EXPECT_FALSE(prefetcher.GetResolved(item, resolved));
+}
+
+TEST_F(PlexPlaybackPrefetcherTests, expires)
+{
+  CPlexPlaybackPrefetcher prefetcher(50);
+  complete(prefetcher, createItem("1888"), "plexserver://abc/library/parts/1950/file.mkv");
+
+  CFileItem resolved;
+  EXPECT_TRUE(prefetcher.GetResolved(createItem("1888"), resolved));
+
+  Sleep(100);
+  EXPECT_FALSE(prefetcher.GetResolved(createItem("1888"), resolved));
+}
+
+TEST_F(PlexPlaybackPrefetcherTests, keepsTheLatest)
+{
+  CPlexPlaybackPrefetcher prefetcher;
+  for (int i = 0; i < PLEX_PREFETCH_MAX_RESOLVED + 1; i++)
+  {
+    CStdString ratingKey;
+    ratingKey.Format("%d", 1000 + i);
+    complete(prefetcher, createItem(ratingKey), "plexserver://abc/library/parts/" + ratingKey + "/file.mkv");
+    Sleep(5);
+  }
+
+  CFileItem resolved;
+  EXPECT_FALSE(prefetcher.GetResolved(createItem("1000"), resolved));
+  EXPECT_TRUE(prefetcher.GetResolved(createItem("1001"), resolved));
+  EXPECT_TRUE(prefetcher.GetResolved(createItem("1004"), resolved));
+}
@@ -0,0 +1,329 @@
+#include "PlexTest.h"
+#include "Client/PlexSearchIndex.h"
+#include "video/VideoInfoTag.h"
+#include "threads/SystemClock.h"
+#include "filesystem/File.h"
+
+#include <boost/lexical_cast.hpp>
+#include <stdio.h>
+
+static CFileItemPtr indexItem(EPlexDirectoryType type, int ratingKey, const std::string& title,
+                              const std::string& server = "abc123", const std::string& section = "section1")
+{
+  CFileItemPtr item(new CFileItem(title));
+  item->SetPlexDirectoryType(type);
+  item->SetProperty("ratingKey", ratingKey);
+  item->SetProperty("unprocessed_key", "/library/metadata/" + boost::lexical_cast<std::string>(ratingKey));
+  item->SetProperty("title", title);
+  item->SetProperty("plexserver", server);
+  item->SetProperty("librarySectionUUID", section);
+  return item;
+}
+
+static void addActor(CFileItemPtr item, const std::string& name)
+{
+  SActorInfo actor;
+  actor.strName = name;
+  item->GetVideoInfoTag()->m_cast.push_back(actor);
+}
+
+class PlexSearchIndexTests : public ::testing::Test
+{
+public:
+  PlexSearchIndexTests() : index("")
+  {
+    servers.insert("abc123");
+  }
+
+  void SetUp()
+  {
+    CFileItemList list;
+    list.Add(indexItem(PLEX_DIR_TYPE_MOVIE, 1, "The Matrix"));
+    list.Add(indexItem(PLEX_DIR_TYPE_MOVIE, 2, "The Matrix Reloaded"));
+    list.Add(indexItem(PLEX_DIR_TYPE_MOVIE, 3, "Ocean's Eleven"));
+    list.Add(indexItem(PLEX_DIR_TYPE_MOVIE, 4, "Mad Max"));
+    addActor(list.Get(0), "Keanu Reeves");
+    addActor(list.Get(3), "Mel Gibson");
+    addActor(list.Get(3), "Joanne Samuel");
+    index.indexListing(list, true);
+  }
+
+  std::vector<std::string> search(const std::string& query, int limit = 20)
+  {
+    CFileItemList results;
+    index.search(query, servers, results, limit);
+
+    std::vector<std::string> titles;
+    for (int i = 0; i < results.Size(); i++)
+      titles.push_back(results.Get(i)->GetLabel());
+    return titles;
+  }
+
+  CPlexSearchIndex index;
+  std::set<std::string> servers;
+};
+
+TEST(PlexSearchIndexTokenize, basic)
+{
+  std::vector<std::string> tokens;
+  CPlexSearchIndex::Tokenize("Ocean's ELEVEN: (2001)", tokens);
+  ASSERT_EQ(3, tokens.size());
+  EXPECT_EQ("oceans", tokens[0]);
+  EXPECT_EQ("eleven", tokens[1]);
+  EXPECT_EQ("2001", tokens[2]);
+}
+
+TEST_F(PlexSearchIndexTests, prefix)
+{
+  std::vector<std::string> titles = search("MAT");
+  ASSERT_EQ(2, titles.size());
+  EXPECT_EQ("The Matrix", titles[0]);
+  EXPECT_EQ("The Matrix Reloaded", titles[1]);
+
+  EXPECT_EQ(1, search("ocean").size());
+  EXPECT_EQ(1, search("oceans e").size());
+  EXPECT_EQ(0, search("atrix").size());
+}
+
+TEST_F(PlexSearchIndexTests, allWordsMustMatch)
+{
+  std::vector<std::string> titles = search("matrix rel");
+  ASSERT_EQ(1, titles.size());
+  EXPECT_EQ("The Matrix Reloaded", titles[0]);
+}
+
+TEST_F(PlexSearchIndexTests, titleStartFirst)
+{
+  CFileItemList list;
+  list.Add(indexItem(PLEX_DIR_TYPE_MOVIE, 5, "Ma Vie en Rose"));
+  index.indexListing(list, false);
+
+  std::vector<std::string> titles = search("ma");
+  ASSERT_EQ(4, titles.size());
+  EXPECT_EQ("Ma Vie en Rose", titles[0]);
+  EXPECT_EQ("Mad Max", titles[1]);
+}
+
+TEST_F(PlexSearchIndexTests, people)
+{
+  std::vector<std::string> titles = search("keanu");
+  ASSERT_EQ(1, titles.size());
+  EXPECT_EQ("The Matrix", titles[0]);
+
+  // people matches come after title matches
+  titles = search("r");
+  ASSERT_EQ(2, titles.size());
+  EXPECT_EQ("The Matrix Reloaded", titles[0]);
+  EXPECT_EQ("The Matrix", titles[1]);
+}
+
+TEST_F(PlexSearchIndexTests, artists)
+{
+  CFileItemList list;
+  CFileItemPtr album = indexItem(PLEX_DIR_TYPE_ALBUM, 10, "OK Computer", "abc123", "music");
+  album->SetProperty("parentTitle", "Radiohead");
+  list.Add(album);
+  index.indexListing(list, true);
+
+  CFileItemList results;
+  index.search("radio", servers, results, 20);
+  ASSERT_EQ(1, results.Size());
+  EXPECT_EQ("OK Computer", results.Get(0)->GetLabel());
+  EXPECT_EQ("Radiohead", results.Get(0)->GetProperty("parentTitle").asString());
+  EXPECT_EQ(PLEX_DIR_TYPE_ALBUM, results.Get(0)->GetPlexDirectoryType());
+  EXPECT_TRUE(results.Get(0)->GetProperty("localSearchResult").asBoolean());
+  EXPECT_EQ("plexserver://abc123/library/metadata/10", results.Get(0)->GetPath());
+
+  // a complete music listing doesn't touch the movies
+  EXPECT_EQ(5, index.size());
+}
+
+TEST_F(PlexSearchIndexTests, update)
+{
+  CFileItemList list;
+  list.Add(indexItem(PLEX_DIR_TYPE_MOVIE, 4, "Mad Max Fury Road"));
+  index.indexListing(list, false);
+
+  EXPECT_EQ(4, index.size());
+  EXPECT_EQ(1, search("fury").size());
+  EXPECT_EQ(0, search("gibson").size());
+}
+
+TEST_F(PlexSearchIndexTests, completeListingRemoves)
+{
+  CFileItemList list;
+  list.Add(indexItem(PLEX_DIR_TYPE_MOVIE, 1, "The Matrix"));
+  index.indexListing(list, false);
+  EXPECT_EQ(4, index.size());
+
+  index.indexListing(list, true);
+  EXPECT_EQ(1, index.size());
+  EXPECT_EQ(0, search("mad").size());
+}
+
+TEST_F(PlexSearchIndexTests, onlyGivenServers)
+{
+  CFileItemList list;
+  list.Add(indexItem(PLEX_DIR_TYPE_MOVIE, 1, "Matrix Revolutions", "def456"));
+  index.indexListing(list, true);
+
+  EXPECT_EQ(2, search("matrix").size());
+
+  servers.insert("def456");
+  EXPECT_EQ(3, search("matrix").size());
+}
+
+TEST_F(PlexSearchIndexTests, limitPerType)
+{
+  CFileItemList list;
+  list.Add(indexItem(PLEX_DIR_TYPE_SHOW, 20, "The Wire"));
+  index.indexListing(list, false);
+
+  std::vector<std::string> titles = search("the", 1);
+  ASSERT_EQ(2, titles.size());
+}
+
+TEST_F(PlexSearchIndexTests, serialize)
+{
+  std::string data;
+  index.serialize(data);
+
+  CPlexSearchIndex loaded("");
+  ASSERT_TRUE(loaded.deserialize(data));
+  EXPECT_EQ(4, loaded.size());
+
+  CFileItemList results;
+  loaded.search("samuel", servers, results, 20);
+  ASSERT_EQ(1, results.Size());
+  EXPECT_EQ("Mad Max", results.Get(0)->GetLabel());
+
+  EXPECT_FALSE(loaded.deserialize(data.substr(0, data.size() / 2)));
+  EXPECT_EQ(0, loaded.size());
+}
+
+TEST(PlexSearchIndexPersist, clearedIsEmptyAfterReload)
+{
+  const std::string path = "special://temp/plexsearchindex_test.dat";
+  std::set<std::string> servers;
+  servers.insert("abc123");
+
+  CPlexSearchIndex saved(path);
+  CFileItemList list;
+  list.Add(indexItem(PLEX_DIR_TYPE_MOVIE, 1, "The Matrix"));
+  saved.indexListing(list, true);
+  ASSERT_TRUE(saved.save());
+
+  CFileItemList results;
+  CPlexSearchIndex loaded(path);
+  ASSERT_TRUE(loaded.load());
+  loaded.search("matrix", servers, results, 20);
+  EXPECT_EQ(1, results.Size());
+
+  // what the next user loads mustn't have anything of the one before
+  saved.clear();
+  ASSERT_TRUE(saved.save());
+
+  results.Clear();
+  CPlexSearchIndex reloaded(path);
+  reloaded.load();
+  reloaded.search("matrix", servers, results, 20);
+  EXPECT_EQ(0, results.Size());
+  EXPECT_EQ(0, reloaded.size());
+
+  XFILE::CFile::Delete(path);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* prints the size and latency of the index over a big library, and keeps the latency of a search
+ * well below what typing would notice */
+TEST(PlexSearchIndexBenchmark, synthetic100k)
+{
+  static const char* words[] = {
+    "the", "last", "night", "man", "love", "dark", "city", "star", "blood", "king", "war", "day",
+    "house", "girl", "dead", "road", "black", "story", "life", "world", "time", "fire", "ghost",
+    "river", "summer", "winter", "secret", "lost", "red", "moon", "heart", "shadow", "return",
+    "rise", "fall", "empire", "little", "big", "dream", "power", "high", "sky", "stone", "wild"
+  };
+  static const char* names[] = {
+    "john", "mary", "james", "anna", "robert", "linda", "michael", "sarah", "david", "emma",
+    "smith", "jones", "brown", "taylor", "wilson", "davies", "evans", "thomas", "johnson", "roberts"
+  };
+  const int numWords = sizeof(words) / sizeof(words[0]);
+  const int numNames = sizeof(names) / sizeof(names[0]);
+  const int numItems = 100000;
+
+  CPlexSearchIndex index("");
+  std::set<std::string> servers;
+  servers.insert("abc123");
+
+  CFileItemList list;
+  unsigned int seed = 1;
+  for (int i = 0; i < numItems; i++)
+  {
+    std::string title;
+    for (int w = 0; w < 2 + i % 3; w++)
+    {
+      seed = seed * 1103515245 + 12345;
+      title += std::string(w ? " " : "") + words[(seed >> 16) % numWords];
+    }
+    title += " " + boost::lexical_cast<std::string>(i);
+
+    CFileItemPtr item;
+    if (i % 4 == 0)
+    {
+      item = indexItem(PLEX_DIR_TYPE_ALBUM, i, title, "abc123", "music");
+      item->SetProperty("parentTitle", std::string(names[i % numNames]) + " " + names[(i / numNames) % numNames]);
+    }
+    else
+    {
+      item = indexItem(PLEX_DIR_TYPE_MOVIE, i, title, "abc123", "movies");
+      for (int a = 0; a < 3; a++)
+        addActor(item, std::string(names[(i + a) % numNames]) + " " + names[(i / (a + 1)) % numNames]);
+    }
+    item->SetProperty("unprocessed_thumb", "/library/metadata/" + boost::lexical_cast<std::string>(i) + "/thumb/1391593003");
+    list.Add(item);
+  }
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  index.indexListing(list, true);
+  unsigned int indexTime = XbmcThreads::SystemClockMillis() - start;
+  EXPECT_EQ(numItems, index.size());
+
+  std::string data;
+  index.serialize(data);
+
+  start = XbmcThreads::SystemClockMillis();
+  CPlexSearchIndex loaded("");
+  EXPECT_TRUE(loaded.deserialize(data));
+  unsigned int loadTime = XbmcThreads::SystemClockMillis() - start;
+  EXPECT_EQ(numItems, loaded.size());
+
+  printf("search index: %d items, indexed in %u ms, ~%lu KB in memory, %lu KB on disk, loaded in %u ms\n",
+         numItems, indexTime, (unsigned long)index.memoryUsage() / 1024, (unsigned long)data.size() / 1024, loadTime);
+
+  const char* queries[] = { "t", "th", "the", "the l", "night ki", "john", "mary sm", "12345" };
+  for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++)
+  {
+    const int runs = 10;
+    CFileItemList results;
+
+    start = XbmcThreads::SystemClockMillis();
+    for (int r = 0; r < runs; r++)
+    {
+      results.Clear();
+      index.search(queries[q], servers, results, 20);
+    }
+    unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+    printf("search index: \"%s\" %d results in %.1f ms\n", queries[q], results.Size(), (float)elapsed / runs);
+
+    // typing must never wait on the index
+    EXPECT_LT(elapsed / runs, 100);
+
+    // at most 20 movies and 20 albums, only one title has that number
+    EXPECT_GT(results.Size(), 0);
+    EXPECT_LE(results.Size(), 40);
+    if (std::string(queries[q]) == "12345")
+      EXPECT_EQ(1, results.Size());
+  }
+}
@@ -0,0 +1,78 @@
+#include "PlexTest.h"
+#include "Client/PlexServerDataLoader.h"
+#include "Client/PlexConnection.h"
+
+static CFileItemListPtr sectionList(const std::string& updatedAt = "1391593003")
+{
+  CFileItemListPtr list(new CFileItemList);
+  for (int i = 1; i <= 3; i++)
+  {
+    CStdString path;
+    path.Format("plexserver://abc123/library/sections/%d", i);
+    CFileItemPtr item(new CFileItem(path, true));
+    item->SetLabel(path.Right(1));
+    item->SetPlexDirectoryType(PLEX_DIR_TYPE_MOVIE);
+    item->SetProperty("updatedAt", updatedAt);
+    item->SetProperty("pref_includeInGlobal", true);
+    list->Add(item);
+  }
+  return list;
+}
+
+TEST(PlexServerDataLoaderListChanged, same)
+{
+  EXPECT_FALSE(CPlexServerDataLoader::ListChanged(sectionList(), sectionList()));
+  EXPECT_FALSE(CPlexServerDataLoader::SectionsChanged(sectionList(), sectionList()));
+}
+
+TEST(PlexServerDataLoaderListChanged, content)
+{
+  EXPECT_TRUE(CPlexServerDataLoader::ListChanged(sectionList(), sectionList("1391593004")));
+  EXPECT_TRUE(CPlexServerDataLoader::SectionsChanged(sectionList(), sectionList("1391593004")));
+}
+
+TEST(PlexServerDataLoaderListChanged, renamed)
+{
+  // a new name has to be published but the content is still the same
+  CFileItemListPtr list = sectionList();
+  list->Get(1)->SetLabel("Movies");
+  EXPECT_TRUE(CPlexServerDataLoader::ListChanged(sectionList(), list));
+  EXPECT_FALSE(CPlexServerDataLoader::SectionsChanged(sectionList(), list));
+}
+
+TEST(PlexServerDataLoaderListChanged, preference)
+{
+  CFileItemListPtr list = sectionList();
+  list->Get(2)->SetProperty("pref_includeInGlobal", false);
+  EXPECT_TRUE(CPlexServerDataLoader::ListChanged(sectionList(), list));
+}
+
+TEST(PlexServerDataLoaderListChanged, removed)
+{
+  CFileItemListPtr list = sectionList();
+  list->Remove(0);
+  EXPECT_TRUE(CPlexServerDataLoader::ListChanged(sectionList(), list));
+  EXPECT_TRUE(CPlexServerDataLoader::ListChanged(CFileItemListPtr(), list));
+}
+
+TEST(PlexServerDataLoaderServerState, connection)
+{
+  CPlexConnectionPtr conn(new CPlexConnection(CPlexConnection::CONNECTION_MANUAL, "10.10.10.10", 32400));
+  CPlexServerPtr server(new CPlexServer(conn));
+
+  // not reachable, its sections aren't merged
+  EXPECT_TRUE(CPlexServerDataLoader::ServerState(server).empty());
+  EXPECT_TRUE(CPlexServerDataLoader::ServerState(CPlexServerPtr()).empty());
+
+  server->SetActiveConnection(conn);
+  CStdString insecure = CPlexServerDataLoader::ServerState(server);
+  EXPECT_FALSE(insecure.empty());
+
+  // the same server found over https has to be merged again
+  CPlexConnectionPtr secure(new CPlexConnection(CPlexConnection::CONNECTION_MANUAL, "10.10.10.10", 32400, "https"));
+  server->SetActiveConnection(secure);
+  EXPECT_NE(insecure, CPlexServerDataLoader::ServerState(server));
+
+  server->SetActiveConnection(conn);
+  EXPECT_EQ(insecure, CPlexServerDataLoader::ServerState(server));
+}
@@ -197,6 +197,8 @@ void CPlexAttributeParserMediaUrl::Process(const CURL &url, const CStdString &ke
 {
   if (key == "thumb")
   {
+    /* kept so the search index can build the URLs again */
+    item->SetProperty("unprocessed_thumb", value);
     item->SetArt("smallThumb", GetImageURL(url, value, SMALL_SIZE, SMALL_SIZE));
     item->SetArt("thumb", GetImageURL(url, value, MEDIUM_SIZE, MEDIUM_SIZE));
     item->SetArt("bigThumb", GetImageURL(url, value, LARGE_SIZE, LARGE_SIZE));
@@ -48,6 +48,7 @@
 #include "AdvancedSettings.h"
 #include "PlexDirectoryCache.h"
 #include "Client/PlexServerVersion.h"
+#include "Client/PlexSearchIndex.h"
 #include "StringUtils.h"
 
 
@@ -100,6 +101,28 @@ bool CPlexDirectory::GetXMLData(CStdString& data)
   return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* section listings feed the local search index, only an unfiltered and unpaged
+ * listing of everything tells it which items are gone */
+static void IndexSectionListing(const CURL& url, const CFileItemList& items)
+{
+  if (!g_plexApplication.searchIndex || !boost::starts_with(url.GetFileName(), "library/sections/"))
+    return;
+
+  bool complete = boost::ends_with(url.GetFileName(), "/all");
+
+  std::map<CStdString, CStdString> options;
+  url.GetOptions(options);
+  BOOST_FOREACH(const PlexStringPair& option, options)
+  {
+    if (option.first != "sort" && (!boost::starts_with(option.first, "X-Plex-") ||
+                                   boost::starts_with(option.first, "X-Plex-Container-")))
+      complete = false;
+  }
+
+  g_plexApplication.searchIndex->indexListing(items, complete);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 bool CPlexDirectory::GetDirectory(const CURL& url, CFileItemList& fileItems)
 {
@@ -159,6 +182,20 @@ bool CPlexDirectory::GetDirectory(const CURL& url, CFileItemList& fileItems)
     m_url.RemoveProtocolOption("containerStart");
   }
 
+  // servers that push their changes tell us when a cached listing is outdated
+  unsigned int generation = 0;
+  if (m_cacheStrategy != CPlexDirectoryCache::CACHE_STARTEGY_NONE && m_verb == "GET" && m_body.empty() &&
+      g_plexApplication.directoryCache)
+  {
+    generation = g_plexApplication.directoryCache->GetGeneration(m_url.GetHostName());
+    if (generation && g_plexApplication.directoryCache->GetUnchangedHit(m_url.Get(), fileItems))
+    {
+      CLog::Log(LOGDEBUG, "CPlexDirectory::GetDirectory %s hasn't changed on the server, returning %d cached items",
+                m_url.Get().c_str(), fileItems.Size());
+      return true;
+    }
+  }
+
   if (!GetXMLData(m_data))
     return false;
 
@@ -171,7 +208,7 @@ bool CPlexDirectory::GetDirectory(const CURL& url, CFileItemList& fileItems)
     // first compute the hash on retrieved xml
      newHash = PlexUtils::GetFastHash(m_data);
 
-   if (g_plexApplication.directoryCache->GetCacheHit(cacheURL,newHash,fileItems))
+   if (g_plexApplication.directoryCache->GetCacheHit(cacheURL,newHash,fileItems,generation))
     {
      float elapsed = timer.GetElapsedSeconds();
      CLog::Log(LOGDEBUG, "CPlexDirectory::GetDirectory::Timing returning a directory after total %f seconds with %d items with content %s", elapsed, fileItems.Size(), fileItems.GetContent().c_str());
@@ -193,7 +230,7 @@ bool CPlexDirectory::GetDirectory(const CURL& url, CFileItemList& fileItems)
       newHash = PlexUtils::GetFastHash(m_data);
 
       if (g_plexApplication.directoryCache &&
-          g_plexApplication.directoryCache->GetCacheHit(cacheURL, newHash, fileItems))
+          g_plexApplication.directoryCache->GetCacheHit(cacheURL, newHash, fileItems, generation))
       {
         float elapsed = timer.GetElapsedSeconds();
         CLog::Log(LOGDEBUG, "CPlexDirectory::GetDirectory::Timing returning a directory after total %f seconds with %d items with content %s", elapsed, fileItems.Size(), fileItems.GetContent().c_str());
@@ -249,13 +286,15 @@ bool CPlexDirectory::GetDirectory(const CURL& url, CFileItemList& fileItems)
     }
 #endif
 
+    IndexSectionListing(m_url, fileItems);
+
     // add evetually to the cache
     if (g_plexApplication.directoryCache)
-      g_plexApplication.directoryCache->AddToCache(cacheURL, newHash, fileItems, m_cacheStrategy);
+      g_plexApplication.directoryCache->AddToCache(cacheURL, newHash, fileItems, m_cacheStrategy, generation);
   }
 
   // add evetually to the cache
-  g_plexApplication.directoryCache->AddToCache(cacheURL, newHash, fileItems, m_cacheStrategy);
+  g_plexApplication.directoryCache->AddToCache(cacheURL, newHash, fileItems, m_cacheStrategy, generation);
 
   float elapsed = timer.GetElapsedSeconds();
 
@@ -893,7 +932,8 @@ bool CPlexDirectory::GetChannelDirectory(CFileItemList &items)
   CFileItemListPtr channels = g_plexApplication.dataLoader->GetAllChannels();
   for (int i = 0; i < channels->Size(); i ++)
   {
-    CFileItemPtr channel = channels->Get(i);
+    // the loader shares its list, ours gets changed below
+    CFileItemPtr channel(new CFileItem(*channels->Get(i)));
     
     CStdString window, type;
     CURL p(channel->GetPath());
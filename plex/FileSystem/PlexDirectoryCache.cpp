@@ -3,9 +3,14 @@
 #include <boost/unordered_map.hpp>
 #include <boost/foreach.hpp>
 #include "log.h"
+#include "URL.h"
+#include "threads/SystemClock.h"
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 
 
 int CPlexDirectoryCache::CACHE_THESHOLD_COUNT = 20;
+unsigned int CPlexDirectoryCache::CACHE_UNCHANGED_MAX_AGE_MS = 30000;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 CPlexDirectoryCache::~CPlexDirectoryCache()
@@ -14,7 +19,8 @@ CPlexDirectoryCache::~CPlexDirectoryCache()
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-bool CPlexDirectoryCache::GetCacheHit(const std::string path, const unsigned long newHash, CFileItemList &List)
+bool CPlexDirectoryCache::GetCacheHit(const std::string path, const unsigned long newHash, CFileItemList &List,
+                                      unsigned int generation)
 {
   CSingleLock lk(m_cacheLock);
 
@@ -31,6 +37,13 @@ bool CPlexDirectoryCache::GetCacheHit(const std::string path, const unsigned lon
     if (it->second.hash == newHash)
     {
       List.Copy(*it->second.pitemList);
+
+      // the server just confirmed it, the entry is good for this generation
+      std::map<std::string, unsigned int>::const_iterator gen = m_generations.find(it->second.serverUUID);
+      if (generation && gen != m_generations.end() && gen->second == generation)
+        it->second.generation = generation;
+      it->second.confirmed = XbmcThreads::SystemClockMillis();
+
       return true;
     }
   }
@@ -41,7 +54,8 @@ bool CPlexDirectoryCache::GetCacheHit(const std::string path, const unsigned lon
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-void CPlexDirectoryCache::AddToCache(const std::string path, const unsigned long newHash, CFileItemList &List,CacheStrategies Startegy)
+void CPlexDirectoryCache::AddToCache(const std::string path, const unsigned long newHash, CFileItemList &List,CacheStrategies Startegy,
+                                     unsigned int generation)
 {
   CSingleLock lk(m_cacheLock);
 
@@ -75,8 +89,113 @@ void CPlexDirectoryCache::AddToCache(const std::string path, const unsigned long
     m_cacheMap[path].pitemList = CFileItemListPtr(new CFileItemList());
 
   // set the new item properties
-  m_cacheMap[path].hash = newHash;
-  m_cacheMap[path].pitemList->Copy(List);
+  CPlexDirectoryCacheEntry& entry = m_cacheMap[path];
+  entry.hash = newHash;
+  entry.pitemList->Copy(List);
+  entry.confirmed = XbmcThreads::SystemClockMillis();
+
+  CURL url(path);
+  entry.serverUUID = url.GetHostName();
+  entry.sectionID = (int)List.GetProperty("librarySectionID").asInteger(PLEX_SECTION_UNKNOWN);
+
+  std::string fileName = url.GetFileName();
+  std::vector<std::string> parts;
+  boost::split(parts, fileName, boost::is_any_of("/"));
+  if (entry.sectionID == PLEX_SECTION_UNKNOWN && parts.size() > 2 && parts[0] == "library" && parts[1] == "sections")
+  {
+    try
+    {
+      entry.sectionID = boost::lexical_cast<int>(parts[2]);
+    }
+    catch (...)
+    {
+    }
+  }
+
+  // something changed while it was loading, we can't vouch for it
+  std::map<std::string, unsigned int>::const_iterator it = m_generations.find(entry.serverUUID);
+  entry.generation = (it != m_generations.end() && it->second == generation) ? generation : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int CPlexDirectoryCache::GetGeneration(const std::string& serverUUID)
+{
+  CSingleLock lk(m_cacheLock);
+
+  std::map<std::string, unsigned int>::const_iterator it = m_generations.find(serverUUID);
+  return it != m_generations.end() ? it->second : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexDirectoryCache::GetUnchangedHit(const std::string path, CFileItemList &List)
+{
+  CSingleLock lk(m_cacheLock);
+
+  if (!m_bEnabled)
+    return false;
+
+  CacheMapIterator it = m_cacheMap.find(path);
+  if (it == m_cacheMap.end() || it->second.generation == 0)
+    return false;
+
+  std::map<std::string, unsigned int>::const_iterator gen = m_generations.find(it->second.serverUUID);
+  if (gen == m_generations.end() || gen->second != it->second.generation)
+    return false;
+
+  // the server gets asked again now and then, it doesn't tell us about all changes
+  if (XbmcThreads::SystemClockMillis() - it->second.confirmed >= CACHE_UNCHANGED_MAX_AGE_MS)
+    return false;
+
+  List.Copy(*it->second.pitemList);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDirectoryCache::SetServerListening(const std::string& serverUUID, bool listening)
+{
+  CSingleLock lk(m_cacheLock);
+
+  // what was loaded before has to be checked against the server again
+  if (listening)
+    m_generations[serverUUID] = ++m_lastGeneration;
+  else
+    m_generations.erase(serverUUID);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexDirectoryCache::Invalidate(const std::string& serverUUID, int sectionID)
+{
+  CSingleLock lk(m_cacheLock);
+
+  unsigned int oldGeneration = 0, newGeneration = 0;
+  std::map<std::string, unsigned int>::iterator gen = m_generations.find(serverUUID);
+  if (gen != m_generations.end())
+  {
+    // loads that are still running when this happens won't be trusted
+    oldGeneration = gen->second;
+    newGeneration = gen->second = ++m_lastGeneration;
+  }
+
+  int removed = 0;
+  for (CacheMapIterator it = m_cacheMap.begin(); it != m_cacheMap.end();)
+  {
+    CPlexDirectoryCacheEntry& entry = it->second;
+    if (entry.serverUUID == serverUUID &&
+        (sectionID == PLEX_SECTION_UNKNOWN || entry.sectionID == PLEX_SECTION_UNKNOWN ||
+         entry.sectionID == sectionID))
+    {
+      it = m_cacheMap.erase(it);
+      removed++;
+      continue;
+    }
+
+    if (entry.serverUUID == serverUUID && oldGeneration && entry.generation == oldGeneration)
+      entry.generation = newGeneration;
+    ++it;
+  }
+
+  CLog::Log(LOGDEBUG, "CPlexDirectoryCache::Invalidate dropped %d entries of section %d on %s",
+            removed, sectionID, serverUUID.c_str());
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -98,5 +217,6 @@ void CPlexDirectoryCache::LogStats()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void CPlexDirectoryCache::Clear()
 {
+  CSingleLock lk(m_cacheLock);
   m_cacheMap.clear();
 }
@@ -1,19 +1,30 @@
 #ifndef PLEXDIRECTORYCACHE_H
 #define PLEXDIRECTORYCACHE_H
 
+#include <map>
 #include <string>
 #include "FileItem.h"
 #include <boost/unordered_map.hpp>
 #include "threads/SingleLock.h"
+#include "PlexTypes.h"
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 class CPlexDirectoryCacheEntry
 {
 public:
+  CPlexDirectoryCacheEntry() : hash(0), sectionID(PLEX_SECTION_UNKNOWN), generation(0), confirmed(0) {}
   ~CPlexDirectoryCacheEntry() {}
   unsigned long hash;
   CFileItemListPtr pitemList;
+
+  std::string serverUUID;
+  /* PLEX_SECTION_UNKNOWN when the listing isn't tied to one section */
+  int sectionID;
+  /* the generation of the server it was loaded in, 0 if nobody tells us about changes */
+  unsigned int generation;
+  /* when the server last gave us this listing */
+  unsigned int confirmed;
 };
 
 
@@ -29,6 +40,10 @@ private:
   CCriticalSection m_cacheLock;
   bool  m_bEnabled;
 
+  /* servers that push their changes to us, the generation moves on with every change */
+  std::map<std::string, unsigned int> m_generations;
+  unsigned int m_lastGeneration;
+
 public:
 
   enum CacheStrategies
@@ -40,11 +55,29 @@ public:
 
   static int CACHE_THESHOLD_COUNT;
 
-  CPlexDirectoryCache() : m_bEnabled(true) {}
+  /* the server doesn't tell us about everything that changes, watched states and edits made on
+   * other clients among them. Unchanged listings are only served without asking for this long. */
+  static unsigned int CACHE_UNCHANGED_MAX_AGE_MS;
+
+  CPlexDirectoryCache() : m_bEnabled(true), m_lastGeneration(0) {}
   ~CPlexDirectoryCache();
-  bool GetCacheHit(const std::string path, const unsigned long newHash, CFileItemList &List);
-  void AddToCache(const std::string path, const unsigned long newHash, CFileItemList &List, CacheStrategies Startegy);
+  bool GetCacheHit(const std::string path, const unsigned long newHash, CFileItemList &List,
+                   unsigned int generation = 0);
+  void AddToCache(const std::string path, const unsigned long newHash, CFileItemList &List, CacheStrategies Startegy,
+                  unsigned int generation = 0);
+
+  /* while a server pushes its changes, an entry loaded in the current generation is still
+   * good without asking the server again, until it gets older than CACHE_UNCHANGED_MAX_AGE_MS */
+  unsigned int GetGeneration(const std::string& serverUUID);
+  bool GetUnchangedHit(const std::string path, CFileItemList &List);
+  void SetServerListening(const std::string& serverUUID, bool listening);
+
+  /* drop the entries of a section and those we can't place,
+   * PLEX_SECTION_UNKNOWN drops all of the server */
+  void Invalidate(const std::string& serverUUID, int sectionID);
   void LogStats();
+
+  /* everything, when the user changes the listings of the one before aren't theirs */
   void Clear();
   inline void Enable(bool bEnable) { m_bEnabled = bEnable; }
 
@@ -2,6 +2,7 @@
 #include "Client/PlexServerManager.h"
 #include "utils/log.h"
 #include "settings/GUISettings.h"
+#include "settings/AdvancedSettings.h"
 #include "boost/lexical_cast.hpp"
 #include <boost/assign.hpp>
 #include <boost/foreach.hpp>
@@ -113,10 +114,11 @@ bool CPlexFile::BuildHTTPURL(CURL& url)
   }
 
   newUrl = server->BuildURL(url.GetFileName(), url.GetOptions());
-  if (newUrl.Get().empty())
+  // without a connection it is empty, no need to put it together to tell
+  if (newUrl.GetProtocol().empty())
     return false;
 
-  if (url.HasProtocolOption("ssl") && url.GetProtocolOption("ssl") == "1")
+  if (url.GetProtocolOption("ssl") == "1")
   {
     newUrl.SetProtocol("https");
     if (url.GetPort() == 32400)
@@ -128,7 +130,9 @@ bool CPlexFile::BuildHTTPURL(CURL& url)
   if (!url.GetPassWord().empty())
     newUrl.SetPassword(url.GetPassWord());
 
-  CLog::Log(LOGDEBUG, "CPlexFile::BuildHTTPURL translated '%s' to '%s'", PlexUtils::MakeUrlSecret(url).Get().c_str(), PlexUtils::MakeUrlSecret(newUrl).Get().c_str());
+  // done for every request and image, the secret copies are only worth making when they are logged
+  if (g_advancedSettings.m_logLevel >= LOG_LEVEL_DEBUG)
+    CLog::Log(LOGDEBUG, "CPlexFile::BuildHTTPURL translated '%s' to '%s'", PlexUtils::MakeUrlSecret(url).Get().c_str(), PlexUtils::MakeUrlSecret(newUrl).Get().c_str());
   url = newUrl;
 
   return true;
@@ -86,3 +86,98 @@ TEST_F(PlexCacheDirectoryTests, Enable)
   g_plexApplication.directoryCache->AddToCache("Test",1234567890,List,CPlexDirectoryCache::CACHE_STRATEGY_ALWAYS);
   EXPECT_FALSE(g_plexApplication.directoryCache->GetCacheHit("Test",1234567890,List));
 }
+
+TEST_F(PlexCacheDirectoryTests, UnchangedHitNeedsListening)
+{
+  CFileItemList List;
+  List.Add(CFileItemPtr(new CFileItem));
+
+  // nobody tells us about changes, the server has to be asked
+  g_plexApplication.directoryCache->AddToCache("plexserver://abc123/library/sections/1/all", 1, List,
+                                               CPlexDirectoryCache::CACHE_STRATEGY_ALWAYS,
+                                               g_plexApplication.directoryCache->GetGeneration("abc123"));
+  EXPECT_FALSE(g_plexApplication.directoryCache->GetUnchangedHit("plexserver://abc123/library/sections/1/all", List));
+
+  g_plexApplication.directoryCache->SetServerListening("abc123", true);
+  EXPECT_FALSE(g_plexApplication.directoryCache->GetUnchangedHit("plexserver://abc123/library/sections/1/all", List));
+
+  g_plexApplication.directoryCache->AddToCache("plexserver://abc123/library/sections/1/all", 1, List,
+                                               CPlexDirectoryCache::CACHE_STRATEGY_ALWAYS,
+                                               g_plexApplication.directoryCache->GetGeneration("abc123"));
+  EXPECT_TRUE(g_plexApplication.directoryCache->GetUnchangedHit("plexserver://abc123/library/sections/1/all", List));
+
+  g_plexApplication.directoryCache->SetServerListening("abc123", false);
+  EXPECT_FALSE(g_plexApplication.directoryCache->GetUnchangedHit("plexserver://abc123/library/sections/1/all", List));
+}
+
+TEST_F(PlexCacheDirectoryTests, InvalidateSection)
+{
+  CFileItemList List;
+  List.Add(CFileItemPtr(new CFileItem));
+
+  CPlexDirectoryCachePtr cache = g_plexApplication.directoryCache;
+  cache->SetServerListening("abc123", true);
+  unsigned int generation = cache->GetGeneration("abc123");
+
+  cache->AddToCache("plexserver://abc123/library/sections/1/all", 1, List, CPlexDirectoryCache::CACHE_STRATEGY_ALWAYS, generation);
+  cache->AddToCache("plexserver://abc123/library/sections/2/all", 2, List, CPlexDirectoryCache::CACHE_STRATEGY_ALWAYS, generation);
+  cache->AddToCache("plexserver://abc123/library/onDeck", 3, List, CPlexDirectoryCache::CACHE_STRATEGY_ALWAYS, generation);
+  cache->AddToCache("plexserver://def456/library/sections/1/all", 4, List, CPlexDirectoryCache::CACHE_STRATEGY_ALWAYS);
+
+  cache->Invalidate("abc123", 1);
+
+  EXPECT_FALSE(cache->GetCacheHit("plexserver://abc123/library/sections/1/all", 1, List));
+  EXPECT_FALSE(cache->GetCacheHit("plexserver://abc123/library/onDeck", 3, List));
+  EXPECT_TRUE(cache->GetCacheHit("plexserver://def456/library/sections/1/all", 4, List));
+
+  // the other section is still trusted after the change
+  EXPECT_TRUE(cache->GetUnchangedHit("plexserver://abc123/library/sections/2/all", List));
+
+  cache->Invalidate("abc123", PLEX_SECTION_UNKNOWN);
+  EXPECT_FALSE(cache->GetCacheHit("plexserver://abc123/library/sections/2/all", 2, List));
+  cache->Clear();
+}
+
+TEST_F(PlexCacheDirectoryTests, InvalidateDuringLoad)
+{
+  CFileItemList List;
+  List.Add(CFileItemPtr(new CFileItem));
+
+  CPlexDirectoryCachePtr cache = g_plexApplication.directoryCache;
+  cache->SetServerListening("abc123", true);
+
+  // the load started before the change arrived
+  unsigned int generation = cache->GetGeneration("abc123");
+  cache->Invalidate("abc123", 1);
+  cache->AddToCache("plexserver://abc123/library/sections/1/all", 1, List, CPlexDirectoryCache::CACHE_STRATEGY_ALWAYS, generation);
+
+  EXPECT_FALSE(cache->GetUnchangedHit("plexserver://abc123/library/sections/1/all", List));
+
+  // once the server confirms the hash it is trusted again
+  EXPECT_TRUE(cache->GetCacheHit("plexserver://abc123/library/sections/1/all", 1, List, cache->GetGeneration("abc123")));
+  EXPECT_TRUE(cache->GetUnchangedHit("plexserver://abc123/library/sections/1/all", List));
+  cache->Clear();
+}
+
+TEST_F(PlexCacheDirectoryTests, UnchangedHitExpires)
+{
+  CFileItemList List;
+  List.Add(CFileItemPtr(new CFileItem));
+
+  CPlexDirectoryCachePtr cache = g_plexApplication.directoryCache;
+  cache->SetServerListening("abc123", true);
+  cache->AddToCache("plexserver://abc123/library/onDeck", 1, List, CPlexDirectoryCache::CACHE_STRATEGY_ALWAYS,
+                    cache->GetGeneration("abc123"));
+  EXPECT_TRUE(cache->GetUnchangedHit("plexserver://abc123/library/onDeck", List));
+
+  // watched states changed on another client don't reach us, after a while we ask again
+  unsigned int maxAge = CPlexDirectoryCache::CACHE_UNCHANGED_MAX_AGE_MS;
+  CPlexDirectoryCache::CACHE_UNCHANGED_MAX_AGE_MS = 0;
+  EXPECT_FALSE(cache->GetUnchangedHit("plexserver://abc123/library/onDeck", List));
+
+  // the server said it is the same, that starts it over
+  CPlexDirectoryCache::CACHE_UNCHANGED_MAX_AGE_MS = maxAge;
+  EXPECT_TRUE(cache->GetCacheHit("plexserver://abc123/library/onDeck", 1, List, cache->GetGeneration("abc123")));
+  EXPECT_TRUE(cache->GetUnchangedHit("plexserver://abc123/library/onDeck", List));
+  cache->Clear();
+}
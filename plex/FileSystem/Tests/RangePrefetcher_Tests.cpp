@@ -0,0 +1,209 @@
+#include "PlexTest.h"
+#include "filesystem/RangePrefetcher.h"
+#include "threads/SystemClock.h"
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+using namespace XFILE;
+using boost::asio::ip::tcp;
+
+static char dataAt(size_t pos)
+{
+  return (char)(pos % 251);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* serves a generated resource on the loopback interface, answering byte range
+ * requests after a fixed delay to simulate a far away server */
+class LoopbackRangeServer
+{
+public:
+  LoopbackRangeServer(size_t size, unsigned int latency, bool honourRanges = true)
+    : m_acceptor(m_io, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)),
+      m_size(size), m_latency(latency), m_honourRanges(honourRanges),
+      m_active(0), m_maxActive(0), m_stop(false)
+  {
+    m_thread = boost::thread(boost::bind(&LoopbackRangeServer::run, this));
+  }
+
+  ~LoopbackRangeServer()
+  {
+    m_stop = true;
+
+    // wake up the blocking accept
+    boost::system::error_code ec;
+    tcp::socket wakeup(m_io);
+    wakeup.connect(m_acceptor.local_endpoint(), ec);
+
+    m_thread.join();
+    m_clients.join_all();
+  }
+
+  std::string url() const
+  {
+    return "http://127.0.0.1:" + boost::lexical_cast<std::string>(m_acceptor.local_endpoint().port()) + "/file.mkv";
+  }
+
+  int maxActive()
+  {
+    boost::mutex::scoped_lock lk(m_mutex);
+    return m_maxActive;
+  }
+
+private:
+  typedef boost::shared_ptr<tcp::socket> socket_ptr;
+
+  void run()
+  {
+    while (!m_stop)
+    {
+      socket_ptr socket(new tcp::socket(m_io));
+      boost::system::error_code ec;
+      m_acceptor.accept(*socket, ec);
+      if (ec || m_stop)
+        break;
+
+      m_clients.create_thread(boost::bind(&LoopbackRangeServer::serve, this, socket));
+    }
+  }
+
+  void serve(socket_ptr socket)
+  {
+    boost::system::error_code ec;
+    boost::asio::streambuf request;
+    boost::asio::read_until(*socket, request, "\r\n\r\n", ec);
+    if (ec)
+      return;
+
+    size_t start = 0, end = m_size - 1;
+    bool ranged = false;
+
+    std::istream stream(&request);
+    std::string line;
+    while (std::getline(stream, line) && line != "\r")
+    {
+      unsigned long first, last;
+      if (m_honourRanges && sscanf(line.c_str(), "Range: bytes=%lu-%lu", &first, &last) == 2)
+      {
+        start = first;
+        end = std::min<size_t>(last, m_size - 1);
+        ranged = true;
+      }
+    }
+
+    {
+      boost::mutex::scoped_lock lk(m_mutex);
+      m_maxActive = std::max(m_maxActive, ++m_active);
+    }
+
+    boost::this_thread::sleep(boost::posix_time::milliseconds(m_latency));
+
+    std::string header;
+    if (ranged)
+      header = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes " +
+               boost::lexical_cast<std::string>(start) + "-" + boost::lexical_cast<std::string>(end) + "/" +
+               boost::lexical_cast<std::string>(m_size) + "\r\n";
+    else
+      header = "HTTP/1.1 200 OK\r\n";
+    header += "Content-Length: " + boost::lexical_cast<std::string>(end - start + 1) + "\r\n";
+    header += "Accept-Ranges: bytes\r\nConnection: close\r\n\r\n";
+
+    std::vector<char> body(end - start + 1);
+    for (size_t i = 0; i < body.size(); i++)
+      body[i] = dataAt(start + i);
+
+    boost::asio::write(*socket, boost::asio::buffer(header), ec);
+    if (!ec)
+      boost::asio::write(*socket, boost::asio::buffer(body), ec);
+    socket->close(ec);
+
+    boost::mutex::scoped_lock lk(m_mutex);
+    m_active--;
+  }
+
+  boost::asio::io_service m_io;
+  tcp::acceptor m_acceptor;
+  boost::thread m_thread;
+  boost::thread_group m_clients;
+
+  size_t m_size;
+  unsigned int m_latency;
+  bool m_honourRanges;
+
+  boost::mutex m_mutex;
+  int m_active;
+  int m_maxActive;
+  volatile bool m_stop;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static bool readAll(CRangePrefetcher& prefetcher, size_t pos, size_t len)
+{
+  std::vector<char> buf(64 * 1024);
+  while (len > 0)
+  {
+    int read = prefetcher.Read(&buf[0], std::min(buf.size(), len), 10000);
+    if (read <= 0)
+      return false;
+
+    for (int i = 0; i < read; i++)
+    {
+      if (buf[i] != dataAt(pos + i))
+        return false;
+    }
+    pos += read;
+    len -= read;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(RangePrefetcherTests, readsInOrder)
+{
+  const size_t size = 4 * 1024 * 1024 + 1000;
+  const unsigned int latency = 100;
+  LoopbackRangeServer server(size, latency);
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+
+  CRangePrefetcher prefetcher(server.url(), size, 4, 256 * 1024);
+  prefetcher.Start(0);
+  EXPECT_TRUE(readAll(prefetcher, 0, size));
+
+  char c;
+  EXPECT_EQ(0, prefetcher.Read(&c, 1, 1000));
+  EXPECT_EQ(size, prefetcher.GetPosition());
+
+  // 17 ranges one after the other would take at least 1.7 seconds
+  EXPECT_LT(XbmcThreads::SystemClockMillis() - start, 17 * latency);
+  EXPECT_GT(server.maxActive(), 1);
+}
+
+TEST(RangePrefetcherTests, restartsAtPosition)
+{
+  const size_t size = 2 * 1024 * 1024;
+  LoopbackRangeServer server(size, 20);
+
+  CRangePrefetcher prefetcher(server.url(), size, 2, 256 * 1024);
+  prefetcher.Start(0);
+  EXPECT_TRUE(readAll(prefetcher, 0, 1000));
+
+  prefetcher.Start(1024 * 1024 + 123);
+  EXPECT_TRUE(readAll(prefetcher, 1024 * 1024 + 123, 300 * 1024));
+}
+
+TEST(RangePrefetcherTests, failsWithoutRangeSupport)
+{
+  const size_t size = 1024 * 1024;
+  LoopbackRangeServer server(size, 0, false);
+
+  CRangePrefetcher prefetcher(server.url(), size, 2, 256 * 1024);
+  prefetcher.Start(0);
+
+  char buf[1024];
+  EXPECT_EQ(-1, prefetcher.Read(buf, sizeof(buf), 10000));
+}
@@ -0,0 +1,205 @@
+#include "PlexTest.h"
+#include "filesystem/SegmentCache.h"
+
+#include <vector>
+
+using namespace XFILE;
+
+class SegmentCacheTests : public ::testing::Test
+{
+public:
+  SegmentCacheTests() : cache(1024 * 1024, 1024 * 1024) {}
+
+  void SetUp()
+  {
+    cache.Open();
+  }
+
+  void TearDown()
+  {
+    cache.Close();
+  }
+
+  /* fill the cache with a known pattern, as the source would from pos */
+  void Fill(int64_t pos, size_t len)
+  {
+    std::vector<char> buf(len);
+    for (size_t i = 0; i < len; i++)
+      buf[i] = (char)((pos + i) & 0xff);
+
+    size_t written = 0;
+    while (written < len)
+    {
+      int ret = cache.WriteToCache(&buf[written], len - written);
+      ASSERT_GT(ret, 0);
+      written += ret;
+    }
+  }
+
+  bool Check(int64_t pos, size_t len)
+  {
+    std::vector<char> buf(len);
+    size_t read = 0;
+    while (read < len)
+    {
+      int ret = cache.ReadFromCache(&buf[read], len - read);
+      if (ret <= 0)
+        return false;
+      read += ret;
+    }
+
+    for (size_t i = 0; i < len; i++)
+    {
+      if (buf[i] != (char)((pos + i) & 0xff))
+        return false;
+    }
+    return true;
+  }
+
+  CSegmentCache cache;
+};
+
+TEST_F(SegmentCacheTests, readWritten)
+{
+  Fill(0, 300 * 1024);
+  EXPECT_EQ(300 * 1024, cache.WaitForData(0, 0));
+  EXPECT_TRUE(Check(0, 300 * 1024));
+  EXPECT_EQ(CACHE_RC_WOULD_BLOCK, cache.ReadFromCache(NULL, 1));
+}
+
+TEST_F(SegmentCacheTests, seekBackIsCached)
+{
+  Fill(0, 512 * 1024);
+  EXPECT_TRUE(Check(0, 512 * 1024));
+
+  EXPECT_EQ(1000, cache.Seek(1000));
+  EXPECT_TRUE(Check(1000, 4000));
+}
+
+TEST_F(SegmentCacheTests, keepsRangesOverSourceSeek)
+{
+  Fill(0, 200 * 1024);
+
+  // the source restarts further on, what we had before stays
+  cache.Reset(1024 * 1024);
+  Fill(1024 * 1024, 100 * 1024);
+  EXPECT_TRUE(Check(1024 * 1024, 100 * 1024));
+
+  EXPECT_EQ(5000, cache.Seek(5000));
+  EXPECT_TRUE(Check(5000, 1000));
+  EXPECT_EQ(200 * 1024, cache.CachedDataEnd(0));
+
+  // nothing was ever written between the ranges
+  EXPECT_LT(cache.Seek(600 * 1024), 0);
+}
+
+TEST_F(SegmentCacheTests, endOfInput)
+{
+  Fill(0, 1000);
+  cache.EndOfInput();
+  EXPECT_TRUE(Check(0, 1000));
+
+  char c;
+  EXPECT_EQ(0, cache.ReadFromCache(&c, 1));
+}
+
+/* the smallest cache there is, four blocks of memory and whatever disk we give it */
+class CSmallSegmentCache : public CSegmentCache
+{
+public:
+  CSmallSegmentCache(size_t disk) : CSegmentCache(0, 0, disk) {}
+
+  size_t BlocksInMemory() const { return m_memBlocks; }
+  uint64_t BytesSpilled() const { return m_bytesSpilled; }
+};
+
+TEST(SegmentCacheBudgetTests, leastRecentlyUsedIsDropped)
+{
+  CSmallSegmentCache small(0);
+  small.Open();
+
+  std::vector<char> buf(1024 * 1024);
+  size_t done = 0;
+  while (done < buf.size())
+    done += small.WriteToCache(&buf[done], buf.size() - done);
+  done = 0;
+  while (done < buf.size())
+    done += small.ReadFromCache(&buf[done], buf.size() - done);
+
+  // going back to the start makes the second block the one used the longest ago
+  char c;
+  EXPECT_EQ(0, small.Seek(0));
+  EXPECT_EQ(1, small.ReadFromCache(&c, 1));
+
+  // the source goes on where it left off
+  small.Reset(1024 * 1024);
+
+  EXPECT_EQ(256 * 1024, small.WriteToCache(&buf[0], 256 * 1024));
+  EXPECT_EQ(4u, small.BlocksInMemory());
+
+  EXPECT_LT(small.Seek(256 * 1024), 0);
+  EXPECT_EQ(0, small.Seek(0));
+  EXPECT_EQ(256 * 1024, small.CachedDataEnd(0));
+  EXPECT_EQ(512 * 1024, small.Seek(512 * 1024));
+  EXPECT_EQ(1280 * 1024, small.CachedDataEnd(512 * 1024));
+  small.Close();
+}
+
+TEST(SegmentCacheBudgetTests, dataAheadIsKept)
+{
+  CSmallSegmentCache small(0);
+  small.Open();
+
+  std::vector<char> buf(1024 * 1024);
+  size_t done = 0;
+  while (done < buf.size())
+    done += small.WriteToCache(&buf[done], buf.size() - done);
+
+  // nothing was read yet, the source has to wait for the reader
+  EXPECT_EQ(0, small.WriteToCache(&buf[0], 1));
+  EXPECT_EQ(256 * 1024, small.ReadFromCache(&buf[0], 256 * 1024));
+  EXPECT_EQ(1, small.WriteToCache(&buf[0], 1));
+  small.Close();
+}
+
+TEST(SegmentCacheBudgetTests, spillsBeyondMemory)
+{
+  CSmallSegmentCache small(2 * 1024 * 1024);
+  small.Open();
+
+  std::vector<char> buf(2 * 1024 * 1024);
+  for (size_t i = 0; i < buf.size(); i++)
+    buf[i] = (char)((i * 7) & 0xff);
+
+  // read the first half as it comes in, so the second half pushes it out of memory
+  std::vector<char> read(buf.size());
+  size_t done = 0;
+  while (done < buf.size() / 2)
+    done += small.WriteToCache(&buf[done], buf.size() / 2 - done);
+  done = 0;
+  while (done < buf.size() / 2)
+    done += small.ReadFromCache(&read[done], buf.size() / 2 - done);
+  done = buf.size() / 2;
+  while (done < buf.size())
+    done += small.WriteToCache(&buf[done], buf.size() - done);
+
+  EXPECT_EQ(4u, small.BlocksInMemory());
+  EXPECT_EQ(1024 * 1024u, small.BytesSpilled());
+
+  // all of it comes back, from disk where it has to
+  EXPECT_EQ(0, small.Seek(0));
+  EXPECT_EQ(2 * 1024 * 1024, small.CachedDataEnd(0));
+  done = 0;
+  while (done < read.size())
+  {
+    int ret = small.ReadFromCache(&read[done], read.size() - done);
+    ASSERT_GT(ret, 0);
+    done += ret;
+    EXPECT_LE(small.BlocksInMemory(), 4u);
+  }
+  EXPECT_TRUE(read == buf);
+
+  char c;
+  EXPECT_EQ(CACHE_RC_WOULD_BLOCK, small.ReadFromCache(&c, 1));
+  small.Close();
+}
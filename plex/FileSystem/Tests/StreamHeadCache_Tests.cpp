@@ -0,0 +1,77 @@
+#include "PlexTest.h"
+#include "filesystem/StreamHeadCache.h"
+#include "threads/Thread.h"
+
+using namespace XFILE;
+
+TEST(StreamHeadCache, storeAndLookup)
+{
+  CStreamHeadCache cache;
+  cache.Store("plexserver://abc/library/parts/1/file.mkv", "head");
+
+  std::string data;
+  EXPECT_TRUE(cache.Lookup("plexserver://abc/library/parts/1/file.mkv", data));
+  EXPECT_EQ("head", data);
+  EXPECT_FALSE(cache.Lookup("plexserver://abc/library/parts/2/file.mkv", data));
+  EXPECT_EQ(4, cache.GetSize());
+}
+
+TEST(StreamHeadCache, ignoresTokenAndHeaders)
+{
+  CStreamHeadCache cache;
+  cache.Store("http://10.0.0.1:32400/library/parts/1/file.mkv?X-Plex-Token=abc|User-Agent=foo", "head");
+
+  std::string data;
+  EXPECT_TRUE(cache.Lookup("http://10.0.0.1:32400/library/parts/1/file.mkv?X-Plex-Token=def", data));
+  EXPECT_TRUE(cache.Contains("http://10.0.0.1:32400/library/parts/1/file.mkv"));
+
+  // other options select something else
+  EXPECT_FALSE(cache.Contains("http://10.0.0.1:32400/library/parts/1/file.mkv?offset=10"));
+}
+
+TEST(StreamHeadCache, replaceAndRemove)
+{
+  CStreamHeadCache cache;
+  cache.Store("http://host/a", "first");
+  cache.Store("http://host/a", "second head");
+  EXPECT_EQ(11, cache.GetSize());
+
+  std::string data;
+  EXPECT_TRUE(cache.Lookup("http://host/a", data));
+  EXPECT_EQ("second head", data);
+
+  cache.Remove("http://host/a");
+  EXPECT_FALSE(cache.Contains("http://host/a"));
+  EXPECT_EQ(0, cache.GetSize());
+}
+
+TEST(StreamHeadCache, budgetDropsOldest)
+{
+  CStreamHeadCache cache(10);
+  cache.Store("http://host/a", "aaaa");
+  Sleep(10);
+  cache.Store("http://host/b", "bbbb");
+  Sleep(10);
+  cache.Store("http://host/c", "cccc");
+
+  EXPECT_FALSE(cache.Contains("http://host/a"));
+  EXPECT_TRUE(cache.Contains("http://host/b"));
+  EXPECT_TRUE(cache.Contains("http://host/c"));
+  EXPECT_EQ(8, cache.GetSize());
+
+  // more than all of it isn't kept at all
+  cache.Store("http://host/d", "ddddddddddd");
+  EXPECT_FALSE(cache.Contains("http://host/d"));
+  EXPECT_TRUE(cache.Contains("http://host/c"));
+}
+
+TEST(StreamHeadCache, expires)
+{
+  CStreamHeadCache cache(1024, 50);
+  cache.Store("http://host/a", "aaaa");
+  EXPECT_TRUE(cache.Contains("http://host/a"));
+
+  Sleep(100);
+  EXPECT_FALSE(cache.Contains("http://host/a"));
+  EXPECT_EQ(0, cache.GetSize());
+}
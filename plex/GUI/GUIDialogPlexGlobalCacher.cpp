@@ -17,7 +17,8 @@ void CGUIDialogPlexGlobalCacher::LoadSections()
   CLog::Log(LOGNOTICE, "Global Cache : found %d Shared Sections", pAllSharedSections->Size());
 
   // get all the sections names
-  m_Sections = g_plexApplication.dataLoader->GetAllSections();
+  m_Sections = CFileItemListPtr(new CFileItemList());
+  m_Sections->Append(*g_plexApplication.dataLoader->GetAllSections());
   m_Sections->Append(*pAllSharedSections);
   CLog::Log(LOGNOTICE, "Global Cache : found %d Regular Sections", m_Sections->Size());
 
@@ -74,6 +74,9 @@ bool CGUIPlexMediaWindow::OnMessage(CGUIMessage &message)
       dialog->Close();
 
     SaveSelection();
+
+    m_thumbCache.Clear();
+    m_thumbItemsVersion = 0;
   }
 
   bool ret = CGUIMediaWindow::OnMessage(message);
@@ -284,9 +287,19 @@ void CGUIPlexMediaWindow::InsertPage(CFileItemList* items, int Where)
   for (int i = 0; i < items->Size(); i ++)
     m_vecItems->Insert(Where + i, items->Get(i));
 
+  bool thumbsUpToDate = (m_thumbItemsVersion == m_viewControl.GetItemsVersion());
   m_viewControl.SetItems(*m_vecItems);
   m_viewControl.SetSelectedItem(strSelected);
 
+#ifndef TARGET_RASPBERRY_PI
+  // only the new page needs its art, FrameMove doesn't have to start over
+  if (thumbsUpToDate)
+  {
+    m_thumbCache.Replace(Where, *items);
+    m_thumbItemsVersion = m_viewControl.GetItemsVersion();
+  }
+#endif
+
   delete items;
 #endif
 }
@@ -601,6 +614,26 @@ bool CGUIPlexMediaWindow::OnAction(const CAction &action)
   return ret;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CGUIPlexMediaWindow::FrameMove()
+{
+#ifndef TARGET_RASPBERRY_PI
+  // cache the art of what is on screen first, then what we scroll towards
+  if (m_viewControl.GetItemsVersion() != m_thumbItemsVersion)
+  {
+    m_thumbItemsVersion = m_viewControl.GetItemsVersion();
+    m_thumbCache.Clear();
+    m_thumbCache.Load(*m_vecItems);
+  }
+
+  int first, last;
+  if (m_viewControl.GetVisibleRange(first, last))
+    m_thumbCache.SetViewport(first, last);
+#endif
+
+  CGUIMediaWindow::FrameMove();
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 bool CGUIPlexMediaWindow::GetDirectory(const CStdString &strDirectory, CFileItemList &items)
 {
@@ -659,10 +692,6 @@ bool CGUIPlexMediaWindow::GetDirectory(const CStdString &strDirectory, CFileItem
 
   bool ret = CGUIMediaWindow::GetDirectory(u.Get(), items);
 
-#ifndef TARGET_RASPBERRY_PI
-  m_thumbCache.Load(items);
-#endif
-
   if (server && server->GetActiveConnection() && server->GetActiveConnection()->IsLocal())
     g_directoryCache.ClearDirectory(u.Get());
   
@@ -20,6 +20,7 @@
 #include "PlexNavigationHelper.h"
 #include "gtest/gtest_prod.h"
 #include "FileSystem/PlexExtraDataLoader.h"
+#include "Utility/PlexThumbCacher.h"
 #include <set>
 
 // for trunc.
@@ -63,8 +64,9 @@ class CGUIPlexMediaWindow : public CGUIMediaWindow, public IJobCallback
 
   public:
     CGUIPlexMediaWindow(int windowId = WINDOW_VIDEO_NAV, const CStdString &xml = "MyVideoNav.xml") :
-      CGUIMediaWindow(windowId, xml), m_returningFromSkinLoad(false), m_hasAdvancedFilters(false), m_filterValuesEvent(true), m_clearFilterButton(NULL) { m_loadType = LOAD_ON_GUI_INIT; };
+      CGUIMediaWindow(windowId, xml), m_returningFromSkinLoad(false), m_hasAdvancedFilters(false), m_filterValuesEvent(true), m_clearFilterButton(NULL), m_thumbItemsVersion(0) { m_loadType = LOAD_ON_GUI_INIT; };
     bool OnMessage(CGUIMessage &message);
+    void FrameMove();
     bool OnAction(const CAction& action);
     virtual bool GetDirectory(const CStdString &strDirectory, CFileItemList &items);
     void GetContextButtons(int itemNumber, CContextButtons &buttons);
@@ -140,6 +142,7 @@ private:
     void InsertPage(CFileItemList *items, int Where);
 
     CPlexThumbCacher m_thumbCache;
+    unsigned int m_thumbItemsVersion;
     CPlexSectionFilterPtr m_sectionFilter;
     std::map<std::string, bool> m_contentMatch;
     EPlexDirectoryType m_directoryType;
@@ -5,6 +5,7 @@
 #include "GUIUserMessages.h"
 #include "Application.h"
 #include "GUIPlexDefaultActionHandler.h"
+#include "Client/PlexPlaybackPrefetcher.h"
 
 #define MEDIAITEMLIST_ID 54
 
@@ -142,6 +143,7 @@ bool CGUIWindowPlexPlayQueue::OnMessage(CGUIMessage& message)
 
     case GUI_MSG_WINDOW_DEINIT:
       m_vecItems->SetProperty("PlexEditMode", "");
+      g_plexApplication.playbackPrefetcher->Cancel();
       break;
   }
 
@@ -227,6 +229,11 @@ bool CGUIWindowPlexPlayQueue::OnAction(const CAction &action)
   
   bool ret = CGUIPlexMediaWindow::OnAction(action);
 
+  // resolve what the cursor rests on, it's likely to be played next
+  int selectedID = m_viewControl.GetSelectedItem();
+  if (selectedID != oldSelectedID && m_vecItems->GetProperty("PlexEditMode").asString().empty())
+    g_plexApplication.playbackPrefetcher->Prefetch(m_vecItems->Get(selectedID));
+
   // handle cursor move if we are in editmode for PQ
   if (!m_vecItems->GetProperty("PlexEditMode").asString().empty())
   {
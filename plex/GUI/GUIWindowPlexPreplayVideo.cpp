@@ -11,6 +11,7 @@
 #include "ApplicationMessenger.h"
 #include "PlexApplication.h"
 #include "PlexThemeMusicPlayer.h"
+#include "Client/PlexPlaybackPrefetcher.h"
 
 #include "dialogs/GUIDialogBusy.h"
 #include "dialogs/GUIDialogOK.h"
@@ -55,6 +56,7 @@ bool CGUIWindowPlexPreplayVideo::OnMessage(CGUIMessage &message)
   {
     CFileItemPtr item = g_plexApplication.m_preplayItem;
     g_plexApplication.m_preplayItem.reset();
+    g_plexApplication.playbackPrefetcher->Cancel();
 
     if (g_plexApplication.serverManager)
     {
@@ -372,6 +374,9 @@ void CGUIWindowPlexPreplayVideo::UpdateItem(bool reload)
   {
     g_plexApplication.m_preplayItem = m_vecItems->Get(0);
 
+    // play is the likely next step from here
+    g_plexApplication.playbackPrefetcher->Prefetch(m_vecItems->Get(0));
+
     if (reload)
     {
       m_extraDataLoader.loadDataForItem(m_vecItems->Get(0));
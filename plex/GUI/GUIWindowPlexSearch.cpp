@@ -47,6 +47,7 @@
 #include "PlexJobs.h"
 #include "settings/GUISettings.h"
 #include "Playlists/PlexPlayQueueManager.h"
+#include "Client/PlexSearchIndex.h"
 
 #define CTL_LABEL_EDIT       310
 #define CTL_BUTTON_BACKSPACE 8
@@ -54,6 +55,7 @@
 #define CTL_BUTTON_SPACE     32
 
 #define SEARCH_DELAY         750
+#define SEARCH_LOCAL_RESULTS 20
 
 using namespace XFILE;
 using namespace std;
@@ -90,18 +92,21 @@ CStdString CGUIWindowPlexSearch::GetString()
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-void CGUIWindowPlexSearch::OnTimeout()
+PlexServerList CGUIWindowPlexSearch::GetSearchServers() const
 {
-  CGUIMessage msg(GUI_MSG_LABEL_RESET, GetID(), GetID());
-  CApplicationMessenger::Get().SendGUIMessage(msg, GetID(), false);
+  CPlexServerManager::CPlexServerOwnedModifier modifier = g_guiSettings.GetBool("myplex.searchsharedlibraries") ? CPlexServerManager::SERVER_ALL : CPlexServerManager::SERVER_OWNED;
+  return g_plexApplication.serverManager->GetAllServers(modifier, true);
+}
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CGUIWindowPlexSearch::OnTimeout()
+{
   CStdString str = GetString();
 
   if (str.empty())
     return;
 
-  CPlexServerManager::CPlexServerOwnedModifier modifier = g_guiSettings.GetBool("myplex.searchsharedlibraries") ? CPlexServerManager::SERVER_ALL : CPlexServerManager::SERVER_OWNED;
-  PlexServerList list = g_plexApplication.serverManager->GetAllServers(modifier, true);
+  PlexServerList list = GetSearchServers();
 
   CSingleLock lk(m_threadsSection);
   m_currentSearchString = str;
@@ -138,6 +143,8 @@ void CGUIWindowPlexSearch::UpdateSearch()
 
   if (!str.empty())
   {
+    // show what we know right away, the servers' results are added when they come in
+    ShowLocalResults(str);
     g_plexApplication.timer->SetTimeout(SEARCH_DELAY, this);
   }
   else
@@ -402,6 +409,56 @@ void CGUIWindowPlexSearch::ProcessResults(CFileItemList* results)
     }
   }
 
+  BindResults(mappedRes, server->GetName());
+
+  delete results;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CGUIWindowPlexSearch::ShowLocalResults(const CStdString& str)
+{
+  Reset();
+
+  if (!g_plexApplication.searchIndex)
+    return;
+
+  std::map<std::string, CPlexServerPtr> servers;
+  std::set<std::string> uuids;
+  BOOST_FOREACH(CPlexServerPtr server, GetSearchServers())
+  {
+    if (!server->GetActiveConnection())
+      continue;
+
+    servers[server->GetUUID()] = server;
+    uuids.insert(server->GetUUID());
+  }
+
+  CFileItemList results;
+  g_plexApplication.searchIndex->search(str, uuids, results, SEARCH_LOCAL_RESULTS);
+
+  std::map<int, CFileItemListPtr> mappedRes;
+  for (int i = 0; i < results.Size(); i ++)
+  {
+    CFileItemPtr item = results.Get(i);
+    if (m_resultMap.find(item->GetPlexDirectoryType()) == m_resultMap.end())
+      continue;
+
+    CPlexServerPtr server = servers[item->GetProperty("plexserver").asString()];
+    item->SetProperty("serverName", server->GetName());
+    item->SetProperty("serverOwner", server->GetOwner());
+
+    CFileItemListPtr& list = mappedRes[item->GetPlexDirectoryType()];
+    if (!list)
+      list = CFileItemListPtr(new CFileItemList);
+    list->Add(item);
+  }
+
+  BindResults(mappedRes, "the search index");
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CGUIWindowPlexSearch::BindResults(std::map<int, CFileItemListPtr>& mappedRes, const CStdString& source)
+{
   std::pair<int, CFileItemListPtr> pair;
   BOOST_FOREACH(pair, mappedRes)
   {
@@ -413,9 +470,32 @@ void CGUIWindowPlexSearch::ProcessResults(CFileItemList* results)
 
       int i = 0;
       BOOST_FOREACH(CGUIListItemPtr item, cList)
-        list->AddFront(boost::static_pointer_cast<CFileItem>(item), i++);
+      {
+        CFileItemPtr fileItem = boost::static_pointer_cast<CFileItem>(item);
 
-      CLog::Log(LOGDEBUG, "CPlexWindowSearch::ProcessResults adding %d items to %d from %s", list->Size(), pair.first, server->GetName().c_str());
+        // the server's own result takes the place of the one from the search index
+        int match = -1;
+        if (fileItem->GetProperty("localSearchResult").asBoolean())
+        {
+          for (int j = i; j < list->Size() && match == -1; j++)
+          {
+            if (list->Get(j)->GetProperty("ratingKey").asString() == fileItem->GetProperty("ratingKey").asString() &&
+                list->Get(j)->GetProperty("plexserver").asString() == fileItem->GetProperty("plexserver").asString())
+              match = j;
+          }
+        }
+
+        if (match != -1)
+        {
+          CFileItemPtr serverItem = list->Get(match);
+          list->Remove(match);
+          fileItem = serverItem;
+        }
+
+        list->AddFront(fileItem, i++);
+      }
+
+      CLog::Log(LOGDEBUG, "CPlexWindowSearch::BindResults adding %d items to %d from %s", list->Size(), pair.first, source.c_str());
 
       CGUIMessage msg(GUI_MSG_LABEL_BIND, GetID(), container->GetID(), 0, 0, list.get());
       OnMessage(msg);
@@ -425,11 +505,9 @@ void CGUIWindowPlexSearch::ProcessResults(CFileItemList* results)
     }
     else
     {
-      CLog::Log(LOGDEBUG, "CGUIWindowPlexSearch::ProcessResults Could not find container %d", m_resultMap[pair.first]);
+      CLog::Log(LOGDEBUG, "CGUIWindowPlexSearch::BindResults Could not find container %d", m_resultMap[pair.first]);
     }
   }
-
-  delete results;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -30,6 +30,7 @@
 #include "PlexGlobalTimer.h"
 #include "threads/CriticalSection.h"
 #include "PlexNavigationHelper.h"
+#include "Client/PlexServer.h"
 
 class CGUIWindowPlexSearch : public CGUIWindow, public IJobCallback, public IPlexGlobalTimeout
 {
@@ -58,6 +59,9 @@ class CGUIWindowPlexSearch : public CGUIWindow, public IJobCallback, public IPle
     CStdString GetString();
     void HideAllLists();
     void ProcessResults(CFileItemList *results);
+    void ShowLocalResults(const CStdString& str);
+    void BindResults(std::map<int, CFileItemListPtr>& mappedRes, const CStdString& source);
+    PlexServerList GetSearchServers() const;
     void Reset();
     CGUIEditControl *GetEditControl() const;
 
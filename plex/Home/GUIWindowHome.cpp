@@ -112,7 +112,8 @@ using namespace boost;
 typedef std::pair<CStdString, CPlexSectionFanout*> nameSectionPair;
 
 //////////////////////////////////////////////////////////////////////////////
-CGUIWindowHome::CGUIWindowHome(void) : CGUIWindow(WINDOW_HOME, "Home.xml"), m_globalArt(false), m_lastSelectedItem("Search")
+CGUIWindowHome::CGUIWindowHome(void) : CGUIWindow(WINDOW_HOME, "Home.xml"), m_globalArt(false), m_lastSelectedItem("Search"),
+  m_sectionsVersion(0)
 {
   m_loadType = LOAD_ON_GUI_INIT;
   AddSection("global://art/", CPlexSectionFanout::SECTION_TYPE_GLOBAL_FANART, true);
@@ -418,13 +419,22 @@ bool CGUIWindowHome::OnMessage(CGUIMessage& message)
           if (message.GetParam1() == GUI_MSG_PLEX_SERVER_DATA_UNLOADED)
             RemoveSectionsForServer(message.GetStringParam());
 
-          UpdateSections();
+          // several servers finishing at once only need one update
+          if (message.GetParam1() == GUI_MSG_PLEX_SERVER_DATA_UNLOADED ||
+              g_plexApplication.dataLoader->GetSnapshot()->GetVersion() != m_sectionsVersion)
+            UpdateSections();
           
-          // we have a new section, refresh it
-          if (message.GetParam1() == GUI_MSG_PLEX_SERVER_DATA_LOADED)
+          // something changed on the server, refresh its sections
+          if (message.GetParam1() == GUI_MSG_PLEX_SERVER_DATA_LOADED && message.GetParam2())
             RefreshSectionsForServer(message.GetStringParam());
           break;
         }
+
+        case GUI_MSG_PLEX_LIBRARY_CHANGED:
+        {
+          RefreshSectionsForServer(message.GetStringParam(), message.GetParam2());
+          break;
+        }
       }
       break;
     }
@@ -526,7 +536,10 @@ void CGUIWindowHome::OnSectionLoaded(const CGUIMessage& message)
   {
     if (url == sectionToLoad)
     {
-      HideAllLists();
+      // another section is showing, start from scratch
+      if (url != m_boundSection)
+        HideAllLists();
+      m_boundSection = url;
 
       std::vector<int> types;
       if (GetContentTypesFromSection(url, types))
@@ -537,6 +550,20 @@ void CGUIWindowHome::OnSectionLoaded(const CGUIMessage& message)
           GetContentListFromSection(url, p, list);
           if(list.Size() > 0)
           {
+            // the list is already showing this section, only apply what changed
+            CGUIBaseContainer* container = (CGUIBaseContainer*)GetControl(p);
+            std::vector<CPlexSectionFanout::ListDelta> deltas;
+            if (container && container->IsVisible() &&
+                CPlexSectionFanout::ComputeDelta(container->GetItems(), list, deltas))
+            {
+              if (deltas.size() > 0)
+              {
+                CLog::Log(LOGDEBUG, "CGUIWindowHome::OnSectionLoaded applying %d changes to %d", (int)deltas.size(), p);
+                ApplyListDeltas(p, deltas);
+              }
+              continue;
+            }
+
             int selectedItem = 0;
             if (!m_lastSelectedSubItem.empty())
             {
@@ -565,6 +592,23 @@ void CGUIWindowHome::OnSectionLoaded(const CGUIMessage& message)
 
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CGUIWindowHome::ApplyListDeltas(int controlId, const std::vector<CPlexSectionFanout::ListDelta>& deltas)
+{
+  BOOST_FOREACH(const CPlexSectionFanout::ListDelta& delta, deltas)
+  {
+    int msgId = GUI_MSG_LIST_UPDATE_ITEM;
+    if (delta.m_operation == CPlexSectionFanout::ListDelta::DELTA_INSERT)
+      msgId = GUI_MSG_LIST_INSERT_ITEM;
+    else if (delta.m_operation == CPlexSectionFanout::ListDelta::DELTA_REMOVE)
+      msgId = GUI_MSG_LIST_REMOVE_ITEM;
+
+    // indexes are one based, zero means no item for these messages
+    CGUIMessage msg(msgId, GetID(), controlId, delta.m_index + 1, 0, delta.m_item);
+    OnMessage(msg);
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 bool CGUIWindowHome::OnClick(const CGUIMessage& message)
 {
@@ -756,6 +800,10 @@ void CGUIWindowHome::UpdateSections()
     return;
   }
 
+  // one view of the server data for the whole update
+  CPlexServerDataSnapshotPtr data = g_plexApplication.dataLoader->GetSnapshot();
+  m_sectionsVersion = data->GetVersion();
+
   bool listUpdated = false;
 
   vector<CGUIListItemPtr> oldList;
@@ -767,7 +815,8 @@ void CGUIWindowHome::UpdateSections()
       listUpdated = true;
   }
 
-  CFileItemListPtr sections = g_plexApplication.dataLoader->GetAllSections();
+  CFileItemList sections;
+  sections.Append(*data->GetAllSections());
   vector<CGUIListItemPtr> newList;
   vector<CGUIListItemPtr> newSections;
 
@@ -777,11 +826,8 @@ void CGUIWindowHome::UpdateSections()
   bool havePlaylists = false;
   bool havePlayqueues = false;
 
-  if (g_guiSettings.GetBool("myplex.sharedsectionsonhome") && g_plexApplication.dataLoader->HasSharedSections())
-  {
-    CFileItemListPtr sharedSections = g_plexApplication.dataLoader->GetAllSharedSections();
-	sections->Append(*sharedSections.get());
-  }
+  if (g_guiSettings.GetBool("myplex.sharedsectionsonhome") && data->HasSharedSections())
+    sections.Append(*data->GetAllSharedSections());
 
   for (int i = 0; i < oldList.size(); i ++)
   {
@@ -791,7 +837,7 @@ void CGUIWindowHome::UpdateSections()
       if (item->HasProperty("plexshared"))
       {
         haveShared = true;
-        if (g_plexApplication.dataLoader->HasSharedSections())
+        if (data->HasSharedSections())
           newList.push_back(item);
         else
           listUpdated = true;
@@ -799,7 +845,7 @@ void CGUIWindowHome::UpdateSections()
       else if (item->HasProperty("plexchannels"))
       {
         haveChannels = true;
-        if (!g_guiSettings.GetBool("myplex.hidechannels") && g_plexApplication.dataLoader->HasChannels())
+        if (!g_guiSettings.GetBool("myplex.hidechannels") && data->HasChannels())
           newList.push_back(item);
         else
           listUpdated = true;
@@ -807,7 +853,7 @@ void CGUIWindowHome::UpdateSections()
       else if (item->HasProperty("playlists"))
       {
         havePlaylists = true;
-        if (g_plexApplication.serverManager->GetBestServer() && g_plexApplication.dataLoader->AnyOwnedServerHasPlaylists())
+        if (g_plexApplication.serverManager->GetBestServer() && data->AnyOwnedServerHasPlaylists())
           newList.push_back(item);
         else
           listUpdated = true;
@@ -833,9 +879,9 @@ void CGUIWindowHome::UpdateSections()
     else
     {
       CFileItemPtr foundItem;
-      for (int y = 0; y < sections->Size(); y++)
+      for (int y = 0; y < sections.Size(); y++)
       {
-        CFileItemPtr sectionItem = sections->Get(y);
+        CFileItemPtr sectionItem = sections.Get(y);
         if(sectionItem->GetPath() == item->GetProperty("sectionPath").asString())
           foundItem = sectionItem;
       }
@@ -858,9 +904,9 @@ void CGUIWindowHome::UpdateSections()
     }
   }
 
-  for (int i = 0; i < sections->Size(); i++)
+  for (int i = 0; i < sections.Size(); i++)
   {
-    CFileItemPtr sectionItem = sections->Get(i);
+    CFileItemPtr sectionItem = sections.Get(i);
     bool found = false;
 
     for(int y = 0; y < newSections.size(); y++)
@@ -886,7 +932,7 @@ void CGUIWindowHome::UpdateSections()
     newList.push_back(item);
   }
 
-  if (!g_guiSettings.GetBool("myplex.hidechannels") && g_plexApplication.dataLoader->HasChannels() && !haveChannels)
+  if (!g_guiSettings.GetBool("myplex.hidechannels") && data->HasChannels() && !haveChannels)
   {
     /* We need the channel button as well */
     CGUIStaticItemPtr item = CGUIStaticItemPtr(new CGUIStaticItem);
@@ -904,7 +950,7 @@ void CGUIWindowHome::UpdateSections()
   }
 
 
-  if (!g_guiSettings.GetBool("myplex.sharedsectionsonhome") && g_plexApplication.dataLoader->HasSharedSections() && !haveShared)
+  if (!g_guiSettings.GetBool("myplex.sharedsectionsonhome") && data->HasSharedSections() && !haveShared)
   {
     CGUIStaticItemPtr item = CGUIStaticItemPtr(new CGUIStaticItem);
     item->SetLabel(g_localizeStrings.Get(44020));
@@ -919,7 +965,7 @@ void CGUIWindowHome::UpdateSections()
 
   if (!havePlaylists &&
       g_plexApplication.serverManager->GetBestServer() &&
-      g_plexApplication.dataLoader->AnyOwnedServerHasPlaylists())
+      data->AnyOwnedServerHasPlaylists())
     AddPlaylists(newList, listUpdated);
 
   if (listUpdated)
@@ -970,6 +1016,8 @@ void CGUIWindowHome::HideAllLists()
     SET_CONTROL_HIDDEN(id);
     SET_CONTROL_HIDDEN(id-1000);
   }
+
+  m_boundSection.clear();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1106,15 +1154,31 @@ void CGUIWindowHome::RefreshAllSections(bool force)
 
 }
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-void CGUIWindowHome::RefreshSectionsForServer(const CStdString &uuid)
+void CGUIWindowHome::RefreshSectionsForServer(const CStdString &uuid, int sectionID)
 {
+  CStdString sectionPath;
+  if (sectionID != PLEX_SECTION_UNKNOWN)
+    sectionPath.Format("library/sections/%d", sectionID);
+
   BOOST_FOREACH(nameSectionPair p, m_sections)
   {
     CURL sectionUrl(p.first);
-    if (sectionUrl.GetHostName() == uuid)
+    if (sectionUrl.GetHostName() != uuid)
+      continue;
+
+    // library/sections/1 shouldn't match library/sections/10
+    CStdString fileName = sectionUrl.GetFileName();
+    if (!sectionPath.empty() && fileName != sectionPath && !boost::starts_with(fileName, sectionPath + "/"))
+      continue;
+
     {
       CLog::Log(LOGDEBUG, "CGUIWindowHome::RefreshSectionsForServer refreshing section %s because it belongs to server %s", p.first.c_str(), uuid.c_str());
-      p.second->m_needsRefresh = true;
+
+      // the one we are showing is refreshed right away, the window gets the changes
+      if (p.first == m_boundSection)
+        p.second->Refresh();
+      else
+        p.second->m_needsRefresh = true;
     }
   }
 }
@@ -65,7 +65,7 @@ private:
   void RestoreSection();
   void RefreshSection(const CStdString& url, CPlexSectionFanout::SectionTypes type);
   void RefreshAllSections(bool force = true);
-  void RefreshSectionsForServer(const CStdString &uuid);
+  void RefreshSectionsForServer(const CStdString &uuid, int sectionID = PLEX_SECTION_UNKNOWN);
   void RemoveSectionsForServer(const CStdString &uuid);
   void AddSection(const CStdString& url, CPlexSectionFanout::SectionTypes sectionType, bool useGlobalSlideshow);
   void RemoveSection(const CStdString& url);
@@ -78,6 +78,7 @@ private:
   void OpenItem(CFileItemPtr item);
   bool OnClick(const CGUIMessage& message);
   void OnSectionLoaded(const CGUIMessage& message);
+  void ApplyListDeltas(int controlId, const std::vector<CPlexSectionFanout::ListDelta>& deltas);
   void OnWatchStateChanged(const CGUIMessage& message);
 
   void AddPlaylists(std::vector<CGUIListItemPtr>& list, bool& updated);
@@ -118,6 +119,9 @@ private:
   CStdString                 m_lastSelectedItem;
   CStdString                 m_currentFanArt;
   CStdString                 m_lastSelectedSubItem;
+  CStdString                 m_boundSection;
+  /* the server data version the main menu was last built from */
+  unsigned int               m_sectionsVersion;
   CEvent                     m_loadNavigationEvent;
   bool                       m_cacheLoadFail;
   CPlexNavigationHelper      m_navHelper;
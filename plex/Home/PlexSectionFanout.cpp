@@ -10,6 +10,8 @@
 #include "Playlists/PlexPlayQueueManager.h"
 #include "PlayListPlayer.h"
 
+#include <algorithm>
+
 using namespace XFILE;
 using namespace std;
 
@@ -19,6 +21,7 @@ CPlexSectionFanout::CPlexSectionFanout(const CStdString& url, SectionTypes secti
   : m_sectionType(sectionType),
     m_needsRefresh(true),
     m_url(url),
+    m_listsChanged(false),
     m_useGlobalSlideshow(useGlobalSlideshow)
 {
 }
@@ -204,17 +207,95 @@ void CPlexSectionFanout::LoadArts(bool force)
   LoadSection(artsUrl, CONTENT_LIST_FANART);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+static CStdString GetDeltaKey(const CGUIListItem& item)
+{
+  /* the same item can be queued more than once */
+  if (item.HasProperty("playQueueItemID"))
+    return "pq" + item.GetProperty("playQueueItemID").asString();
+  if (item.HasProperty("ratingKey"))
+    return item.GetProperty("ratingKey").asString();
+  if (item.IsFileItem())
+    return ((const CFileItem&)item).GetPath();
+  return item.GetLabel();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+static bool IsSameVersion(const CGUIListItem& a, const CGUIListItem& b)
+{
+  return a.GetProperty("updatedAt") == b.GetProperty("updatedAt") &&
+         a.GetProperty("viewOffset") == b.GetProperty("viewOffset") &&
+         a.GetProperty("viewCount") == b.GetProperty("viewCount") &&
+         a.GetLabel() == b.GetLabel();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+bool CPlexSectionFanout::ComputeDelta(const std::vector<CGUIListItemPtr>& oldItems,
+                                      const CFileItemList& newList, std::vector<ListDelta>& deltas)
+{
+  std::map<CStdString, int> oldIndex, newIndex;
+
+  for (size_t i = 0; i < oldItems.size(); i++)
+  {
+    if (!oldIndex.insert(std::make_pair(GetDeltaKey(*oldItems[i]), (int)i)).second)
+      return false;
+  }
+
+  for (int i = 0; i < newList.Size(); i++)
+  {
+    if (!newIndex.insert(std::make_pair(GetDeltaKey(*newList.Get(i)), i)).second)
+      return false;
+  }
+
+  /* remove from the back so that the indexes in front stay valid */
+  std::vector<CStdString> kept;
+  for (int i = (int)oldItems.size() - 1; i >= 0; i--)
+  {
+    CStdString key = GetDeltaKey(*oldItems[i]);
+    if (newIndex.find(key) == newIndex.end())
+      deltas.push_back(ListDelta(ListDelta::DELTA_REMOVE, i));
+    else
+      kept.push_back(key);
+  }
+  std::reverse(kept.begin(), kept.end());
+
+  /* what stays has to stay in the same order, after that inserting and updating in
+   * ascending order always lands on the right index */
+  size_t nextKept = 0;
+  for (int i = 0; i < newList.Size(); i++)
+  {
+    CFileItemPtr item = newList.Get(i);
+    CStdString key = GetDeltaKey(*item);
+
+    std::map<CStdString, int>::const_iterator it = oldIndex.find(key);
+    if (it == oldIndex.end())
+    {
+      deltas.push_back(ListDelta(ListDelta::DELTA_INSERT, i, item));
+      continue;
+    }
+
+    if (nextKept >= kept.size() || kept[nextKept] != key)
+      return false;
+    nextKept++;
+
+    if (!IsSameVersion(*oldItems[it->second], *item))
+      deltas.push_back(ListDelta(ListDelta::DELTA_UPDATE, i, item));
+  }
+
+  return true;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 void CPlexSectionFanout::OnJobComplete(unsigned int jobID, bool success, CJob* job)
 {
   CPlexSectionFetchJob* load = (CPlexSectionFetchJob*)job;
+
+  CSingleLock lk(m_critical);
+
+  bool changed = false;
   if (success)
   {
-    CSingleLock lk(m_critical);
-
     int type = load->m_contentType;
-    if (m_fileLists.find(type) != m_fileLists.end() && m_fileLists[type] != NULL)
-      delete m_fileLists[type];
 
     CFileItemList* newList = new CFileItemList;
     newList->Assign(load->m_items, false);
@@ -229,7 +310,31 @@ void CPlexSectionFanout::OnJobComplete(unsigned int jobID, bool success, CJob* j
       }
     }
 
-    m_fileLists[type] = newList;
+    changed = true;
+    if (m_fileLists.find(type) != m_fileLists.end() && m_fileLists[type] != NULL)
+    {
+      CFileItemList* oldList = m_fileLists[type];
+
+      std::vector<CGUIListItemPtr> oldItems;
+      for (int i = 0; i < oldList->Size(); i++)
+        oldItems.push_back(oldList->Get(i));
+
+      std::vector<ListDelta> deltas;
+      if (ComputeDelta(oldItems, *newList, deltas) && deltas.empty())
+        changed = false;
+    }
+
+    if (changed)
+    {
+      if (m_fileLists.find(type) != m_fileLists.end() && m_fileLists[type] != NULL)
+        delete m_fileLists[type];
+      m_fileLists[type] = newList;
+    }
+    else
+    {
+      CLog::Log(LOGDEBUG, "CPlexSectionFanout::OnJobComplete list %d of %s didn't change", type, m_url.Get().c_str());
+      delete newList;
+    }
 
     /* Pre-cache stuff */
 #if 0
@@ -245,13 +350,20 @@ void CPlexSectionFanout::OnJobComplete(unsigned int jobID, bool success, CJob* j
   if (it != m_outstandingJobs.end())
     m_outstandingJobs.erase(it);
 
-  if (m_outstandingJobs.size() == 0 && load->m_contentType != CONTENT_LIST_FANART)
+  if (load->m_contentType != CONTENT_LIST_FANART)
   {
-    CGUIMessage msg(GUI_MSG_PLEX_SECTION_LOADED, WINDOW_HOME, 300, m_sectionType);
-    msg.SetStringParam(m_url.Get());
-    g_windowManager.SendThreadMessage(msg, g_windowManager.GetActiveWindow());
+    m_listsChanged = m_listsChanged || changed;
+
+    /* the window already shows what we have, only tell it when there is something new */
+    if (m_outstandingJobs.size() == 0 && m_listsChanged)
+    {
+      m_listsChanged = false;
+      CGUIMessage msg(GUI_MSG_PLEX_SECTION_LOADED, WINDOW_HOME, 300, m_sectionType);
+      msg.SetStringParam(m_url.Get());
+      g_windowManager.SendThreadMessage(msg, g_windowManager.GetActiveWindow());
+    }
   }
-  else if (load->m_contentType == CONTENT_LIST_FANART)
+  else
   {
     m_artsAge.restart();
     CGUIMessage msg(GUI_MSG_PLEX_SECTION_LOADED, WINDOW_HOME, 300, CONTENT_LIST_FANART);
@@ -263,15 +375,15 @@ void CPlexSectionFanout::OnJobComplete(unsigned int jobID, bool success, CJob* j
 //////////////////////////////////////////////////////////////////////////////
 void CPlexSectionFanout::Show()
 {
+  /* show what we have straight away, a refresh only sends the lists that changed */
+  CGUIMessage msg(GUI_MSG_PLEX_SECTION_LOADED, WINDOW_HOME, 300, m_sectionType);
+  msg.SetStringParam(m_url.Get());
+  g_windowManager.SendThreadMessage(msg, g_windowManager.GetActiveWindow());
+
   if (NeedsRefresh())
     Refresh();
   else
   {
-    /* we are up to date, just send the messages */
-    CGUIMessage msg(GUI_MSG_PLEX_SECTION_LOADED, WINDOW_HOME, 300, m_sectionType);
-    msg.SetStringParam(m_url.Get());
-    g_windowManager.SendThreadMessage(msg, g_windowManager.GetActiveWindow());
-
     CGUIMessage msg2(GUI_MSG_PLEX_SECTION_LOADED, WINDOW_HOME, 300, CONTENT_LIST_FANART);
     msg2.SetStringParam(m_url.Get());
     g_windowManager.SendThreadMessage(msg2, g_windowManager.GetActiveWindow());
@@ -287,10 +399,7 @@ bool CPlexSectionFanout::NeedsRefresh()
     return true;
   }
 
-  int refreshTime = 5;
-  if (m_sectionType == SECTION_TYPE_ALBUM || m_sectionType == SECTION_TYPE_QUEUE ||
-      m_sectionType >= SECTION_TYPE_CHANNELS)
-    refreshTime = 20;
+  int refreshTime = SECTION_MAX_AGE_SEC;
 
   if (m_sectionType == SECTION_TYPE_GLOBAL_FANART)
     refreshTime = ARTS_DISPLAY_TIME_SEC * ARTS_PAGE_SIZE;
@@ -8,6 +8,7 @@
 #include "PlexTimer.h"
 #include "threads/CriticalSection.h"
 #include "PlexJobs.h"
+#include "GUIMessage.h"
 
 typedef std::pair<int, CFileItemList*> contentListPair;
 
@@ -24,6 +25,9 @@ typedef std::pair<int, CFileItemList*> contentListPair;
 #define ARTS_PAGE_SIZE  50
 #define ARTS_DISPLAY_TIME_SEC  5
 
+/* sections are refreshed when something tells us they changed, this is only the fallback */
+#define SECTION_MAX_AGE_SEC  120
+
 class CPlexSectionFanout : public IJobCallback
 {
 public:
@@ -41,6 +45,25 @@ public:
     SECTION_TYPE_PLAYQUEUES
   };
 
+  /* one step of turning a bound list into a newly loaded one, indexes are valid
+   * at the time the step is applied */
+  struct ListDelta
+  {
+    enum Operation
+    {
+      DELTA_INSERT,
+      DELTA_REMOVE,
+      DELTA_UPDATE
+    };
+
+    ListDelta(Operation op, int index, CFileItemPtr item = CFileItemPtr())
+      : m_operation(op), m_index(index), m_item(item) {}
+
+    Operation m_operation;
+    int m_index;
+    CFileItemPtr m_item;
+  };
+
   CPlexSectionFanout(const CStdString& url, SectionTypes sectionType, bool useGlobalSlideshow);
 
   void GetContentTypes(std::vector<int>& types);
@@ -52,6 +75,11 @@ public:
   bool NeedsRefresh();
   static CStdString GetBestServerUrl(const CStdString& extraUrl = "");
 
+  /* diff the items by key and update time, returns false if the items that stayed
+   * in the list were reordered and it has to be bound again */
+  static bool ComputeDelta(const std::vector<CGUIListItemPtr>& oldItems, const CFileItemList& newList,
+                           std::vector<ListDelta>& deltas);
+
   SectionTypes m_sectionType;
   bool m_needsRefresh;
   void ShowPlayQueue();
@@ -69,6 +97,7 @@ public:
 
   CCriticalSection m_critical;
   std::vector<int> m_outstandingJobs;
+  bool m_listsChanged;
   bool m_useGlobalSlideshow;
 };
 
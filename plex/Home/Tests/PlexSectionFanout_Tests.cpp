@@ -0,0 +1,124 @@
+#include "PlexTest.h"
+#include "Home/PlexSectionFanout.h"
+
+#include <boost/lexical_cast.hpp>
+
+static CFileItemPtr fanoutItem(int ratingKey, int updatedAt = 1391593003)
+{
+  CFileItemPtr item(new CFileItem("item " + boost::lexical_cast<std::string>(ratingKey)));
+  item->SetProperty("ratingKey", ratingKey);
+  item->SetProperty("updatedAt", updatedAt);
+  return item;
+}
+
+class PlexSectionFanoutDeltaTests : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    for (int i = 1; i <= 4; i++)
+      bound.push_back(fanoutItem(i));
+  }
+
+  /* apply the deltas like the window does to its containers */
+  void apply(const std::vector<CPlexSectionFanout::ListDelta>& deltas)
+  {
+    for (size_t i = 0; i < deltas.size(); i++)
+    {
+      const CPlexSectionFanout::ListDelta& delta = deltas[i];
+      if (delta.m_operation == CPlexSectionFanout::ListDelta::DELTA_INSERT)
+        bound.insert(bound.begin() + delta.m_index, delta.m_item);
+      else if (delta.m_operation == CPlexSectionFanout::ListDelta::DELTA_REMOVE)
+        bound.erase(bound.begin() + delta.m_index);
+      else
+        bound[delta.m_index] = delta.m_item;
+    }
+  }
+
+  void expectBound(const CFileItemList& list)
+  {
+    ASSERT_EQ(list.Size(), bound.size());
+    for (int i = 0; i < list.Size(); i++)
+    {
+      EXPECT_EQ(list.Get(i)->GetLabel(), bound[i]->GetLabel());
+      EXPECT_EQ(list.Get(i)->GetProperty("updatedAt"), bound[i]->GetProperty("updatedAt"));
+    }
+  }
+
+  std::vector<CGUIListItemPtr> bound;
+};
+
+TEST_F(PlexSectionFanoutDeltaTests, unchanged)
+{
+  CFileItemList list;
+  for (int i = 1; i <= 4; i++)
+    list.Add(fanoutItem(i));
+
+  std::vector<CPlexSectionFanout::ListDelta> deltas;
+  EXPECT_TRUE(CPlexSectionFanout::ComputeDelta(bound, list, deltas));
+  EXPECT_EQ(0, deltas.size());
+}
+
+TEST_F(PlexSectionFanoutDeltaTests, insertRemoveUpdate)
+{
+  // 5 was added in front, 2 was watched and 3 got new metadata
+  CFileItemList list;
+  list.Add(fanoutItem(5));
+  list.Add(fanoutItem(1));
+  list.Add(fanoutItem(3, 1391600000));
+  list.Add(fanoutItem(4));
+
+  std::vector<CPlexSectionFanout::ListDelta> deltas;
+  ASSERT_TRUE(CPlexSectionFanout::ComputeDelta(bound, list, deltas));
+  EXPECT_EQ(3, deltas.size());
+
+  CGUIListItemPtr first = bound[0];
+  apply(deltas);
+  expectBound(list);
+
+  // untouched items are the ones we already had
+  EXPECT_EQ(first, bound[1]);
+}
+
+TEST_F(PlexSectionFanoutDeltaTests, viewOffsetIsAnUpdate)
+{
+  CFileItemList list;
+  for (int i = 1; i <= 4; i++)
+    list.Add(fanoutItem(i));
+  list.Get(2)->SetProperty("viewOffset", 120000);
+
+  std::vector<CPlexSectionFanout::ListDelta> deltas;
+  ASSERT_TRUE(CPlexSectionFanout::ComputeDelta(bound, list, deltas));
+  ASSERT_EQ(1, deltas.size());
+  EXPECT_EQ(CPlexSectionFanout::ListDelta::DELTA_UPDATE, deltas[0].m_operation);
+  EXPECT_EQ(2, deltas[0].m_index);
+}
+
+TEST_F(PlexSectionFanoutDeltaTests, reorderNeedsRebind)
+{
+  CFileItemList list;
+  list.Add(fanoutItem(2));
+  list.Add(fanoutItem(1));
+  list.Add(fanoutItem(3));
+  list.Add(fanoutItem(4));
+
+  std::vector<CPlexSectionFanout::ListDelta> deltas;
+  EXPECT_FALSE(CPlexSectionFanout::ComputeDelta(bound, list, deltas));
+}
+
+TEST_F(PlexSectionFanoutDeltaTests, playQueueDuplicates)
+{
+  // the same item queued twice is two different entries
+  CFileItemList list;
+  for (int i = 0; i < 2; i++)
+  {
+    CFileItemPtr item = fanoutItem(1);
+    item->SetProperty("playQueueItemID", 100 + i);
+    list.Add(item);
+  }
+
+  std::vector<CPlexSectionFanout::ListDelta> deltas;
+  ASSERT_TRUE(CPlexSectionFanout::ComputeDelta(bound, list, deltas));
+  apply(deltas);
+  expectBound(list);
+}
@@ -167,7 +167,7 @@ class NetworkInterface
   }
 
   /// Equality test.
-  bool operator==(const NetworkInterface& rhs)
+  bool operator==(const NetworkInterface& rhs) const
   {
     return (   index() == rhs.index() &&
                 name() == rhs.name() &&
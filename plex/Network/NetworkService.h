@@ -10,6 +10,7 @@
 #include <boost/asio.hpp>
 
 #define NS_BROWSE_REFRESH_INTERVAL  5000
+#define NS_NETWORK_SETTLE_TIME      2000
 
 #define NS_MAX_PACKET_SIZE    8096
 #define NS_BROADCAST_ADDR     boost::asio::ip::address::from_string("239.0.0.250")
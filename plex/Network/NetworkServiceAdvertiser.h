@@ -21,7 +21,6 @@
 
 class NetworkServiceAdvertiser;
 typedef boost::shared_ptr<NetworkServiceAdvertiser> NetworkServiceAdvertiserPtr;
-typedef pair<udp_socket_ptr, std::string> socket_string_pair;
 
 /////////////////////////////////////////////////////////////////////////////
 class NetworkServiceAdvertiser : public NetworkServiceBase
@@ -54,13 +53,7 @@ class NetworkServiceAdvertiser : public NetworkServiceBase
     // Send out the BYE message synchronously and close the sockets.
     dprintf("NetworkService: Stopping advertisement.");
     broadcastMessage("BYE");
-    if (m_broadcastSocket)
-      m_broadcastSocket->close();
-    m_broadcastSocket.reset();
-    BOOST_FOREACH(const socket_string_pair& pair, m_sockets)
-      pair.first->close();
-    m_sockets.clear();
-    m_ignoredAddresses.clear();
+    closeSockets();
   }
   
   /// Advertise an update to the service.
@@ -87,75 +80,48 @@ class NetworkServiceAdvertiser : public NetworkServiceBase
   /// Handle network change.
   virtual void handleNetworkChange(const vector<NetworkInterface>& interfaces)
   {
-    dprintf("Network change for advertiser, closing %lu advertiser sockets.", m_sockets.size());
-
-    // Close the old sockets.
-    if (m_broadcastSocket)
-      m_broadcastSocket->close();
-    m_broadcastSocket.reset();
-    BOOST_FOREACH(const socket_string_pair& pair, m_sockets)
-      pair.first->close();
-    m_sockets.clear();
-    m_ignoredAddresses.clear();
-
-    // Create new broadcast socket.
-    m_broadcastSocket = udp_socket_ptr(new boost::asio::ip::udp::socket(m_ioService));
-    setupListener(m_broadcastSocket, "0.0.0.0", m_port);
-
-    // Wait for data.
-    m_broadcastSocket->async_receive_from(boost::asio::buffer(m_data, NS_MAX_PACKET_SIZE), m_endpoint, boost::bind(&NetworkServiceAdvertiser::handleRead, this, m_broadcastSocket, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred, -1));
-
-    int interfaceIndex = 0;
-    BOOST_FOREACH(const NetworkInterface& xface, interfaces)
-    {
-      // Don't add loopback or virtual interfaces.
-      if (!xface.loopback() && xface.name()[0] != 'v')
-      {
-        string broadcast = xface.broadcast();
-        dprintf("NetworkService: Advertising on interface %s on broadcast address %s (index: %d)", xface.address().c_str(), broadcast.c_str(), interfaceIndex);
+    dprintf("Network change for advertiser, %lu advertiser sockets open.", m_sockets.size());
 
-        // Create new multicast socket for network interface.
-        udp_socket_ptr socket = udp_socket_ptr(new boost::asio::ip::udp::socket(m_ioService));
-        setupMulticastListener(socket, xface.address(), m_notifyEndpoint.address(), m_port, true);
-        m_sockets.push_back(socket_string_pair(socket, broadcast));
-
-        // Wait for data.
-        socket->async_receive_from(boost::asio::buffer(m_data, NS_MAX_PACKET_SIZE), m_endpoint, boost::bind(&NetworkServiceAdvertiser::handleRead, this, socket, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred, interfaceIndex));
-        interfaceIndex++;
-      }
-      else
-      {
-        // Sometimes we get packets from these interfaces, not sure why, but we'll ignore them.
-        // We get packets from these interfaces because we are listening on 0.0.0.0
-        m_ignoredAddresses.insert(xface.address());
-      }
-    }
+    // Only the sockets of interfaces that changed are touched.
+    openBroadcastSocket(m_port);
+    vector<socket_string_pair> added = updateSockets(interfaces, m_port);
 
-    // Always send out the HELLO packet, just in case.
-    broadcastMessage("HELLO");
+    // Say HELLO on the new interfaces, the others know about us already.
+    string msg = "HELLO * HTTP/1.0\r\n" + createReplyMessage();
+    BOOST_FOREACH(const socket_string_pair& pair, added)
+      sendMessage(pair, msg);
   }
 
   void broadcastMessage(const string& action, const string& parameter="")
   {
     // Send out the message.
+    string msg = action + " * HTTP/1.0\r\n" + createReplyMessage(parameter);
+    BOOST_FOREACH(const interface_socket_map::value_type& pair, m_sockets)
+      sendMessage(pair.second, msg);
+  }
+
+  void sendMessage(const socket_string_pair& pair, const string& msg)
+  {
     try
     {
-      string msg = action + " * HTTP/1.0\r\n" + createReplyMessage(parameter);
-      BOOST_FOREACH(const socket_string_pair& pair, m_sockets)
-      {
-        //// Multicast.
-        //pair.first->send_to(boost::asio::buffer(msg), m_notifyEndpoint);
+      //// Multicast.
+      //pair.first->send_to(boost::asio::buffer(msg), m_notifyEndpoint);
 
-        // Broadcast.
-        boost::asio::ip::udp::endpoint broadcastEndpoint(boost::asio::ip::address::from_string(pair.second), m_port + 1);
-        pair.first->send_to(boost::asio::buffer(msg), broadcastEndpoint);
-      }
+      // Broadcast.
+      boost::asio::ip::udp::endpoint broadcastEndpoint(boost::asio::ip::address::from_string(pair.second), m_port + 1);
+      pair.first->send_to(boost::asio::buffer(msg), broadcastEndpoint);
     }
     catch (std::exception& e)
     {
       eprintf("NetworkServiceAdvertiser: Error broadcasting message: %s", e.what());
     }
   }
+
+  /// Start receiving on a socket.
+  virtual void startReceive(const udp_socket_ptr& socket, int interfaceIndex)
+  {
+    socket->async_receive_from(boost::asio::buffer(m_data, NS_MAX_PACKET_SIZE), m_endpoint, boost::bind(&NetworkServiceAdvertiser::handleRead, this, socket, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred, interfaceIndex));
+  }
   
   /// Handle incoming data.
   void handleRead(const udp_socket_ptr& socket, const boost::system::error_code& error, size_t bytes, int interfaceIndex)
@@ -199,7 +165,7 @@ class NetworkServiceAdvertiser : public NetworkServiceBase
     
     // If the socket is open, keep receiving (On XP we need to abandon a socket for 10022 - An invalid argument was supplied - as well).
     if (socket->is_open() && error != boost::asio::error::invalid_argument)
-      socket->async_receive_from(boost::asio::buffer(m_data, NS_MAX_PACKET_SIZE), m_endpoint, boost::bind(&NetworkServiceAdvertiser::handleRead, this, socket, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred, interfaceIndex));
+      startReceive(socket, interfaceIndex);
     else
       iprintf("Network Service: Abandoning advertise socket, it was closed.");
   }
@@ -233,9 +199,6 @@ class NetworkServiceAdvertiser : public NetworkServiceBase
   }
   
   unsigned short                   m_port;
-  udp_socket_ptr                   m_broadcastSocket;
-  vector<socket_string_pair>       m_sockets;
-  std::set<std::string>            m_ignoredAddresses;
   boost::asio::ip::udp::endpoint   m_endpoint;
   boost::asio::ip::udp::endpoint   m_notifyEndpoint;
   char                             m_data[NS_MAX_PACKET_SIZE];
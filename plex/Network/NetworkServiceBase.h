@@ -1,31 +1,128 @@
 #pragma once
 
+#include <map>
+#include <set>
+
 #include <boost/asio.hpp>
+#include <boost/foreach.hpp>
 
 #include "Network/NetworkInterface.h"
 #include "Network/NetworkService.h"
 
 typedef boost::shared_ptr<boost::asio::ip::udp::socket> udp_socket_ptr;
 typedef pair<string, udp_socket_ptr> address_socket_pair;
+typedef pair<udp_socket_ptr, std::string> socket_string_pair;
+
+/// The per interface sockets and their broadcast address, keyed by interface address.
+typedef map<string, socket_string_pair> interface_socket_map;
 
 class NetworkServiceBase
 {
+  /// Network changes come from the loop.
+  friend class NetworkServiceLoop;
+
  protected:
 
   /// Constructor.
   NetworkServiceBase(boost::asio::io_service& ioService)
     : m_ioService(ioService)
-    , m_timer(ioService, boost::posix_time::seconds(2))
-    , m_firstChange(true)
   {
-    // Register for network changes.
-    dprintf("%p: Creating new Network Service and registering for notifications.", this);
-    NetworkInterface::RegisterObserver(boost::bind(&NetworkServiceBase::onNetworkChanged, this, _1));
+    dprintf("%p: Creating new Network Service.", this);
   }
   
   /// Destructor.
   virtual ~NetworkServiceBase() {}
 
+  /// Whether we use an interface at all, loopback and virtual interfaces are skipped.
+  static bool isServiceInterface(const NetworkInterface& xface)
+  {
+    return !xface.loopback() && xface.name()[0] != 'v';
+  }
+
+  /// Open the socket listening on all interfaces, unless it is open already.
+  void openBroadcastSocket(unsigned short port)
+  {
+    if (m_broadcastSocket && m_broadcastSocket->is_open())
+      return;
+
+    m_broadcastSocket = udp_socket_ptr(new boost::asio::ip::udp::socket(m_ioService));
+    setupListener(m_broadcastSocket, "0.0.0.0", port);
+    startReceive(m_broadcastSocket, -1);
+  }
+
+  /// Bring the per interface sockets in line with the interfaces. Sockets of interfaces that are
+  /// gone are closed and new interfaces get one, the others are left alone. Returns the new ones.
+  vector<socket_string_pair> updateSockets(const vector<NetworkInterface>& interfaces, unsigned short port)
+  {
+    vector<socket_string_pair> added;
+    std::set<string> current;
+
+    m_ignoredAddresses.clear();
+    BOOST_FOREACH(const NetworkInterface& xface, interfaces)
+    {
+      if (!isServiceInterface(xface))
+      {
+        // Sometimes we get packets from these interfaces, not sure why, but we'll ignore them.
+        // We get packets from these interfaces because we are listening on 0.0.0.0
+        m_ignoredAddresses.insert(xface.address());
+        continue;
+      }
+
+      string broadcast = xface.broadcast();
+      current.insert(xface.address());
+
+      interface_socket_map::iterator it = m_sockets.find(xface.address());
+      if (it != m_sockets.end())
+      {
+        if (it->second.second == broadcast && it->second.first->is_open())
+          continue;
+
+        it->second.first->close();
+        m_sockets.erase(it);
+      }
+
+      dprintf("NetworkService: Opening socket on interface %s on broadcast address %s (index: %d)", xface.address().c_str(), broadcast.c_str(), xface.index());
+
+      // Create new multicast socket for network interface.
+      udp_socket_ptr socket = udp_socket_ptr(new boost::asio::ip::udp::socket(m_ioService));
+      setupMulticastListener(socket, xface.address(), NS_BROADCAST_ADDR, port, true);
+      m_sockets[xface.address()] = socket_string_pair(socket, broadcast);
+      added.push_back(socket_string_pair(socket, broadcast));
+
+      // Wait for data.
+      startReceive(socket, xface.index());
+    }
+
+    // Close the sockets of the interfaces that went away.
+    for (interface_socket_map::iterator it = m_sockets.begin(); it != m_sockets.end();)
+    {
+      if (current.find(it->first) == current.end())
+      {
+        dprintf("NetworkService: Closing socket on interface %s, it went away.", it->first.c_str());
+        it->second.first->close();
+        m_sockets.erase(it++);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+
+    return added;
+  }
+
+  /// Close all sockets.
+  void closeSockets()
+  {
+    if (m_broadcastSocket)
+      m_broadcastSocket->close();
+    m_broadcastSocket.reset();
+    BOOST_FOREACH(const interface_socket_map::value_type& pair, m_sockets)
+      pair.second.first->close();
+    m_sockets.clear();
+    m_ignoredAddresses.clear();
+  }
+
   /// Utility to set up a listener.
   void setupListener(const udp_socket_ptr& socket, const string& bindAddress, unsigned short port)
   {
@@ -76,32 +173,11 @@ class NetworkServiceBase
   /// For subclasses to fill in.
   virtual void handleNetworkChange(const vector<NetworkInterface>& interfaces) = 0;
 
-  boost::asio::io_service& m_ioService;
-  boost::mutex m_mutex;
-  boost::asio::deadline_timer m_timer;
-  bool m_firstChange;
-
- private:
+  /// For subclasses to fill in, start receiving on a socket.
+  virtual void startReceive(const udp_socket_ptr& socket, int interfaceIndex) = 0;
 
-  void onNetworkChanged(const vector<NetworkInterface>& interfaces)
-  {
-    boost::mutex::scoped_lock lk(m_mutex);
-    
-    dprintf("%p: NetworkService got notification of changed network (first change: %d)", this, m_firstChange);
-    
-    if (m_firstChange)
-    {
-      // Dispatch the notification in an ASIO thread's context.
-      dprintf("NetworkService: Quick dispatch of network change.");
-      m_ioService.dispatch(boost::bind(&NetworkServiceBase::handleNetworkChange, this, interfaces));
-      m_firstChange = false;
-    }
-    else
-    {
-      // Dispatch the change with a two second delay.
-      dprintf("NetworkService: Dispatch network change after two second delay.");
-      m_timer.expires_from_now(boost::posix_time::seconds(2));
-      m_timer.async_wait(boost::bind(&NetworkServiceBase::handleNetworkChange, this, interfaces));
-    }
-  }
+  boost::asio::io_service& m_ioService;
+  udp_socket_ptr           m_broadcastSocket;
+  interface_socket_map     m_sockets;
+  std::set<std::string>    m_ignoredAddresses;
 };
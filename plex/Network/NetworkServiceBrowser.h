@@ -28,7 +28,6 @@
 class NetworkServiceBrowser;
 typedef boost::shared_ptr<NetworkServiceBrowser> NetworkServiceBrowserPtr;
 typedef pair<boost::asio::ip::address, NetworkServicePtr> address_service_pair;
-typedef pair<udp_socket_ptr, std::string> socket_string_pair;
 
 /////////////////////////////////////////////////////////////////////////////
 class NetworkServiceBrowser : public NetworkServiceBase
@@ -58,13 +57,7 @@ class NetworkServiceBrowser : public NetworkServiceBase
   virtual ~NetworkServiceBrowser()
   {
     m_timer.cancel();
-    if (m_broadcastSocket)
-      m_broadcastSocket->close();
-    m_broadcastSocket.reset();
-    BOOST_FOREACH(const socket_string_pair& pair, m_sockets)
-      pair.first->close();
-    m_sockets.clear();
-    m_ignoredAddresses.clear();
+    closeSockets();
   }
   
   /// Notify of a new service.
@@ -95,58 +88,28 @@ class NetworkServiceBrowser : public NetworkServiceBase
   /// Handle network change.
   virtual void handleNetworkChange(const vector<NetworkInterface>& interfaces)
   {
-    dprintf("Network change for browser, closing %lu browse sockets.", m_sockets.size());
+    dprintf("Network change for browser, %lu browse sockets open.", m_sockets.size());
 
-    // Close the old sockets.
-    if (m_broadcastSocket)
-      m_broadcastSocket->close();
-    m_broadcastSocket.reset();
-    BOOST_FOREACH(const socket_string_pair& pair, m_sockets)
-      pair.first->close();
-    m_sockets.clear();
-    m_ignoredAddresses.clear();
+    // Only the sockets of interfaces that changed are touched.
+    openBroadcastSocket(m_port + 1);
+    vector<socket_string_pair> added = updateSockets(interfaces, m_port + 1);
 
-    // Create new broadcast socket.
-    m_broadcastSocket = udp_socket_ptr(new boost::asio::ip::udp::socket(m_ioService));
-    setupListener(m_broadcastSocket, "0.0.0.0", m_port + 1);
-
-    // Wait for data.
-    m_broadcastSocket->async_receive_from(boost::asio::buffer(m_data, NS_MAX_PACKET_SIZE), m_endpoint, boost::bind(&NetworkServiceBrowser::handleRead, this, m_broadcastSocket, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred, -1));
-
-    int interfaceIndex = 0;
-    BOOST_FOREACH(const NetworkInterface& xface, interfaces)
-    {
-      // Don't add loopback or virtual interfaces.
-      if (!xface.loopback() && xface.name()[0] != 'v')
-      {
-        string broadcast = xface.broadcast();
-        dprintf("NetworkService: Browsing on interface %s on broadcast address %s (index: %d)", xface.address().c_str(), broadcast.c_str(), interfaceIndex);
-
-        // Create new multicast socket for network interface.
-        udp_socket_ptr socket = udp_socket_ptr(new boost::asio::ip::udp::socket(m_ioService));
-        setupMulticastListener(socket, xface.address(), m_notifyEndpoint.address(), m_port + 1, true);
-        m_sockets.push_back(socket_string_pair(socket, broadcast));
-
-        // Wait for data.
-        socket->async_receive_from(boost::asio::buffer(m_data, NS_MAX_PACKET_SIZE), m_endpoint, boost::bind(&NetworkServiceBrowser::handleRead, this, socket, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred, interfaceIndex));
-        interfaceIndex++;
-      }
-      else
-      {
-        // Sometimes we get packets from these interfaces, not sure why, but we'll ignore them.
-        // We get packets from these interfaces because we are listening on 0.0.0.0
-        m_ignoredAddresses.insert(xface.address());
-      }
-    }
-
-    // Always send out the M-SEARCH packet, just in case.
-    sendSearch();
+    // Search on the new interfaces right away, the others are searched by the timer anyway.
+    BOOST_FOREACH(const socket_string_pair& pair, added)
+      sendSearch(pair);
   }
 
   private:
 
-  /// Send out the search request.
+  /// Send out the search request on all interfaces.
   void sendSearch()
+  {
+    BOOST_FOREACH(const interface_socket_map::value_type& pair, m_sockets)
+      sendSearch(pair.second);
+  }
+
+  /// Send out the search request on one interface.
+  void sendSearch(const socket_string_pair& pair)
   {
     // Send the search message.
     string msg = NS_SEARCH_MSG;
@@ -154,21 +117,24 @@ class NetworkServiceBrowser : public NetworkServiceBase
     try
     {
       // Yoohoo! Anyone there?
-      BOOST_FOREACH(const socket_string_pair& pair, m_sockets)
-      {
-        //// Multicast.
-        //pair.first->send_to(boost::asio::buffer(msg), m_notifyEndpoint);
+      //// Multicast.
+      //pair.first->send_to(boost::asio::buffer(msg), m_notifyEndpoint);
 
-        // Broadcast.
-        boost::asio::ip::udp::endpoint broadcastEndpoint(boost::asio::ip::address::from_string(pair.second), m_port);
-        pair.first->send_to(boost::asio::buffer(msg), broadcastEndpoint);
-      }
+      // Broadcast.
+      boost::asio::ip::udp::endpoint broadcastEndpoint(boost::asio::ip::address::from_string(pair.second), m_port);
+      pair.first->send_to(boost::asio::buffer(msg), broadcastEndpoint);
     }
     catch (std::exception& e)
     {
       eprintf("NetworkServiceBrowser: Error sending out discover packet: %s", e.what());
     }
   }
+
+  /// Start receiving on a socket.
+  virtual void startReceive(const udp_socket_ptr& socket, int interfaceIndex)
+  {
+    socket->async_receive_from(boost::asio::buffer(m_data, NS_MAX_PACKET_SIZE), m_endpoint, boost::bind(&NetworkServiceBrowser::handleRead, this, socket, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred, interfaceIndex));
+  }
   
   /// Find a network service by resource identifier.
   NetworkServicePtr findServiceByIdentifier(const string& identifier)
@@ -285,7 +251,7 @@ class NetworkServiceBrowser : public NetworkServiceBase
     
     // If the socket is open, keep receiving (On XP we need to abandon a socket for 10022 - An invalid argument was supplied - as well).
     if (socket->is_open() && error != boost::asio::error::invalid_argument)
-      socket->async_receive_from(boost::asio::buffer(m_data, NS_MAX_PACKET_SIZE), m_endpoint, boost::bind(&NetworkServiceBrowser::handleRead, this, socket, boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred, interfaceIndex));
+      startReceive(socket, interfaceIndex);
     else
       iprintf("Network Service: Abandoning browse socket, it was closed.");
   }
@@ -379,9 +345,6 @@ class NetworkServiceBrowser : public NetworkServiceBase
   }
   
   unsigned short                   m_port;
-  udp_socket_ptr                   m_broadcastSocket;
-  vector<socket_string_pair>       m_sockets;
-  std::set<std::string>            m_ignoredAddresses;
   boost::mutex                     m_mutex;
   boost::asio::deadline_timer      m_timer;
   int                              m_refreshTime;
@@ -0,0 +1,154 @@
+/*
+ *  Copyright (C) 2014 Plex, Inc.
+ */
+
+#pragma once
+
+#include <algorithm>
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "NetworkInterface.h"
+#include "NetworkService.h"
+#include "NetworkServiceBase.h"
+
+/////////////////////////////////////////////////////////////////////////////
+/// The one place the network services hear about interface changes. It is
+/// the only observer of NetworkInterface, collects the changes until the
+/// interfaces settled and then hands them to all services on the io_service
+/// they share. A flapping interface that comes back as it was is not
+/// reported at all.
+///
+class NetworkServiceLoop
+{
+ public:
+
+  /// Constructor.
+  NetworkServiceLoop(boost::asio::io_service& ioService, int settleTime=NS_NETWORK_SETTLE_TIME)
+    : m_ioService(ioService)
+    , m_timer(ioService)
+    , m_settleTime(settleTime)
+    , m_firstChange(true)
+    , m_haveInterfaces(false)
+  {
+  }
+
+  /// Start listening to interface changes, once.
+  void watch()
+  {
+    dprintf("NetworkServiceLoop: Registering for network change notifications.");
+    NetworkInterface::RegisterObserver(boost::bind(&NetworkServiceLoop::onNetworkChanged, this, _1));
+  }
+
+  /// Add a service, it is told about the current interfaces right away.
+  void addService(NetworkServiceBase* service)
+  {
+    boost::mutex::scoped_lock lk(m_servicesMutex);
+    m_services.push_back(service);
+
+    if (m_haveInterfaces)
+      m_ioService.post(boost::bind(&NetworkServiceLoop::dispatchTo, this, service, m_interfaces));
+  }
+
+  /// Remove a service, it isn't called anymore once this returns.
+  void removeService(NetworkServiceBase* service)
+  {
+    boost::mutex::scoped_lock lk(m_servicesMutex);
+    m_services.erase(std::remove(m_services.begin(), m_services.end(), service), m_services.end());
+  }
+
+ private:
+
+  /// Called on the thread watching the interfaces.
+  void onNetworkChanged(const vector<NetworkInterface>& interfaces)
+  {
+    boost::mutex::scoped_lock lk(m_mutex);
+    m_pending = interfaces;
+
+    if (m_firstChange)
+    {
+      dprintf("NetworkServiceLoop: Quick dispatch of network change.");
+      m_ioService.post(boost::bind(&NetworkServiceLoop::handleSettled, this, boost::system::error_code()));
+      m_firstChange = false;
+    }
+    else
+    {
+      m_ioService.post(boost::bind(&NetworkServiceLoop::restartTimer, this));
+    }
+  }
+
+  /// Every change starts the wait again, the interfaces have to be quiet for a while.
+  void restartTimer()
+  {
+    dprintf("NetworkServiceLoop: Dispatch network change after %d ms without changes.", m_settleTime);
+    m_timer.expires_from_now(boost::posix_time::milliseconds(m_settleTime));
+    m_timer.async_wait(boost::bind(&NetworkServiceLoop::handleSettled, this, boost::asio::placeholders::error));
+  }
+
+  /// Called on the io_service once the interfaces settled.
+  void handleSettled(const boost::system::error_code& error)
+  {
+    if (error == boost::asio::error::operation_aborted)
+      return;
+
+    vector<NetworkInterface> interfaces;
+    {
+      boost::mutex::scoped_lock lk(m_mutex);
+      interfaces = m_pending;
+    }
+
+    boost::mutex::scoped_lock lk(m_servicesMutex);
+    if (m_haveInterfaces && sameInterfaces(interfaces, m_interfaces))
+    {
+      dprintf("NetworkServiceLoop: Interfaces are back to what they were, nothing to do.");
+      return;
+    }
+
+    m_interfaces = interfaces;
+    m_haveInterfaces = true;
+
+    dprintf("NetworkServiceLoop: Network settled with %lu interfaces.", interfaces.size());
+    BOOST_FOREACH(NetworkServiceBase* service, m_services)
+      service->handleNetworkChange(interfaces);
+  }
+
+  /// Called on the io_service for a service that was just added.
+  void dispatchTo(NetworkServiceBase* service, const vector<NetworkInterface>& interfaces)
+  {
+    boost::mutex::scoped_lock lk(m_servicesMutex);
+    if (std::find(m_services.begin(), m_services.end(), service) != m_services.end())
+      service->handleNetworkChange(interfaces);
+  }
+
+  static bool sameInterfaces(const vector<NetworkInterface>& a, const vector<NetworkInterface>& b)
+  {
+    if (a.size() != b.size())
+      return false;
+
+    for (size_t i=0; i<a.size(); i++)
+    {
+      if (!(a[i] == b[i]) || a[i].netmask() != b[i].netmask())
+        return false;
+    }
+
+    return true;
+  }
+
+  boost::asio::io_service&    m_ioService;
+  boost::asio::deadline_timer m_timer;
+  int                         m_settleTime;
+
+  /// Guards what the watcher thread hands over, never held while calling out.
+  boost::mutex                m_mutex;
+  vector<NetworkInterface>    m_pending;
+  bool                        m_firstChange;
+
+  /// Guards the services, held while they are called so they can go away safely.
+  boost::mutex                m_servicesMutex;
+  vector<NetworkServiceBase*> m_services;
+  vector<NetworkInterface>    m_interfaces;
+  bool                        m_haveInterfaces;
+};
@@ -24,6 +24,7 @@
 #include "utils/JobManager.h"
 #include "FileItem.h"
 #include "PlexJobs.h"
+#include "PlexThumbCacher.h"
 
 #define kJobTypeMediaFlags "mediaflags"
 
@@ -50,26 +51,3 @@ private:
   virtual void OnLoaderStart();
   virtual void OnLoaderFinish();
 };
-
-class CPlexThumbCacher : public CJobQueue
-{
-public:
-  CPlexThumbCacher() : CJobQueue(true, 5, CJob::PRIORITY_LOW), m_stop(false) {};
-  ~CPlexThumbCacher() {}
-  void Stop() { m_stop = true; CancelJobs(); }
-  void Start() { m_stop = false; }
-  void Load(const CFileItemList &list)
-  {
-    if (m_stop)
-      return;
-
-    for (int i = 0; i < list.Size(); i++)
-    {
-      CFileItemPtr item = list.Get(i);
-      if (item->IsPlexMediaServer())
-        AddJob(new CPlexVideoThumbLoaderJob(item));
-    }
-  }
-
-  bool m_stop;
-};
\ No newline at end of file
@@ -35,7 +35,11 @@
 #include "Client/PlexTranscoderClient.h"
 #include "music/tags/MusicInfoTag.h"
 #include "FileSystem/PlexDirectoryCache.h"
+#include "Client/PlexSearchIndex.h"
+#include "Client/PlexNotificationClient.h"
 #include "GUI/GUIPlexDefaultActionHandler.h"
+#include "Client/PlexPlaybackPrefetcher.h"
+#include "Utility/PlexTextureResidency.h"
 
 #include "network/UdpClient.h"
 #include "DNSNameCache.h"
@@ -60,6 +64,7 @@ void PlexApplication::Start()
   myPlexManager = new CMyPlexManager;
 
   dataLoader = CPlexServerDataLoaderPtr(new CPlexServerDataLoader);
+  notificationClient = CPlexNotificationClientPtr(new CPlexNotificationClient);
   serverManager = CPlexServerManagerPtr(new CPlexServerManager);
   remoteSubscriberManager = new CPlexRemoteSubscriberManager;
   mediaServerClient = CPlexMediaServerClientPtr(new CPlexMediaServerClient);
@@ -72,7 +77,10 @@ void PlexApplication::Start()
   extraInfo = new CPlexExtraInfoLoader;
   playQueueManager = CPlexPlayQueueManagerPtr(new CPlexPlayQueueManager);
   directoryCache = CPlexDirectoryCachePtr(new CPlexDirectoryCache);
+  searchIndex = CPlexSearchIndexPtr(new CPlexSearchIndex);
   defaultActionHandler = CGUIPlexDefaultActionHandlerPtr(new CGUIPlexDefaultActionHandler);
+  playbackPrefetcher = CPlexPlaybackPrefetcherPtr(new CPlexPlaybackPrefetcher);
+  textureResidency = CPlexTextureResidencyPtr(new CPlexTextureResidency);
 
   serverManager->load();
 
@@ -274,7 +282,9 @@ void PlexApplication::preShutdown()
   myPlexManager->Stop();
   serverManager->Stop();
   dataLoader->Stop();
+  notificationClient->Stop();
   timelineManager->Stop();
+  playbackPrefetcher->Cancel();
   busy.CancelJobs();
 }
 
@@ -288,10 +298,13 @@ void PlexApplication::Shutdown()
   SAFE_DELETE(myPlexManager);
   SAFE_DELETE(analytics);
 
+  playbackPrefetcher.reset();
+  textureResidency.reset();
   timer.reset();
 
   serverManager.reset();
   dataLoader.reset();
+  notificationClient.reset();
 
   timelineManager.reset();
 
@@ -307,6 +320,10 @@ void PlexApplication::Shutdown()
   CPlexTranscoderClient::DeleteInstance();
 
   directoryCache.reset();
+
+  searchIndex->save();
+  searchIndex.reset();
+
   defaultActionHandler.reset();
 
   themeMusicPlayer.reset();
@@ -71,8 +71,20 @@ typedef boost::shared_ptr<CPlexPlayQueueManager> CPlexPlayQueueManagerPtr;
 class CPlexDirectoryCache;
 typedef boost::shared_ptr<CPlexDirectoryCache> CPlexDirectoryCachePtr;
 
+class CPlexSearchIndex;
+typedef boost::shared_ptr<CPlexSearchIndex> CPlexSearchIndexPtr;
+
+class CPlexNotificationClient;
+typedef boost::shared_ptr<CPlexNotificationClient> CPlexNotificationClientPtr;
+
 class CGUIPlexDefaultActionHandler;
 typedef boost::shared_ptr<CGUIPlexDefaultActionHandler> CGUIPlexDefaultActionHandlerPtr;
+
+class CPlexPlaybackPrefetcher;
+typedef boost::shared_ptr<CPlexPlaybackPrefetcher> CPlexPlaybackPrefetcherPtr;
+
+class CPlexTextureResidency;
+typedef boost::shared_ptr<CPlexTextureResidency> CPlexTextureResidencyPtr;
 ///
 /// The hub of all Plex goodness.
 ///
@@ -125,7 +137,11 @@ public:
   CPlexPlayQueueManagerPtr playQueueManager;
   CPlexBusyIndicator busy;
   CPlexDirectoryCachePtr directoryCache;
+  CPlexSearchIndexPtr searchIndex;
+  CPlexNotificationClientPtr notificationClient;
   CGUIPlexDefaultActionHandlerPtr defaultActionHandler;
+  CPlexPlaybackPrefetcherPtr playbackPrefetcher;
+  CPlexTextureResidencyPtr textureResidency;
 
   void setNetworkLogging(bool);
   void OnTimeout();
@@ -29,6 +29,8 @@
 #include "GUISettings.h"
 #include "PlexPlayQueueManager.h"
 #include "ApplicationMessenger.h"
+#include "Client/PlexPlaybackPrefetcher.h"
+#include "threads/SystemClock.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 bool CPlexMediaDecisionEngine::checkItemPlayability(const CFileItem& item)
@@ -107,8 +109,27 @@ bool CPlexMediaDecisionEngine::resolveItem(const CFileItem& _item, CFileItem &re
         return false;
     }
 
-    g_plexApplication.busy.blockWaitingForJob(new CPlexMediaDecisionJob(item), this);
-    CLog::Log(LOGDEBUG, "CPlexMediaDecisionEngine::BlockAndResolve resolve done, success: %s", m_success ? "Yes" : "No");
+    unsigned int requestedAt = XbmcThreads::SystemClockMillis();
+
+    // the item might have been resolved while it had focus
+    CPlexPlaybackPrefetcherPtr prefetcher = g_plexApplication.playbackPrefetcher;
+    bool speculated = prefetcher && prefetcher->GetResolved(item, m_resolvedItem);
+    if (prefetcher)
+      prefetcher->Cancel();
+
+    if (speculated)
+    {
+      m_success = true;
+      CLog::Log(LOGDEBUG, "CPlexMediaDecisionEngine::resolveItem item was resolved ahead of time");
+    }
+    else
+    {
+      g_plexApplication.busy.blockWaitingForJob(new CPlexMediaDecisionJob(item), this);
+      CLog::Log(LOGDEBUG, "CPlexMediaDecisionEngine::BlockAndResolve resolve done, success: %s", m_success ? "Yes" : "No");
+    }
+
+    if (prefetcher && m_success)
+      prefetcher->PlaybackRequested(m_resolvedItem, speculated, requestedAt);
   }
   else
   {
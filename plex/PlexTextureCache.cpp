@@ -5,13 +5,24 @@
 #include "log.h"
 #include "File.h"
 #include "PlexJobs.h"
+#include "TextureCacheJob.h"
+#include "threads/SingleLock.h"
+#include "settings/AdvancedSettings.h"
+#include "windowing/WindowingFactory.h"
+#include "utils/JobManager.h"
 
 using namespace XFILE;
 
+/* art we count the loads of before we forget the ones only shown once */
+static const size_t MAX_SHOW_COUNTS = 1000;
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void CPlexTextureCache::Deinitialize()
 {
   CancelJobs();
+
+  CSingleLock lock(m_showCountSection);
+  m_showCounts.clear();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -48,6 +59,49 @@ bool CPlexTextureCache::AddCachedTexture(const CStdString &url, const CTextureDe
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void CPlexTextureCache::IncrementUseCount(const CTextureDetails &details)
 {
+  // a .dds only pays off for the art that is shown again and again, and where the gpu takes DXT as is.
+  // Everything else would be decompressed on the cpu again on each load
+  if (!g_advancedSettings.m_useDDSFanart || details.file.empty() || !g_Windowing.SupportsDXT())
+    return;
+
+  CSingleLock lock(m_showCountSection);
+  ShowCountMap::iterator it = m_showCounts.find(details.file);
+  if (it == m_showCounts.end())
+  {
+    if (m_showCounts.size() >= MAX_SHOW_COUNTS)
+    {
+      // browsing a large library shows a lot of art only once
+      for (ShowCountMap::iterator count = m_showCounts.begin(); count != m_showCounts.end();)
+      {
+        if (count->second <= 1)
+          m_showCounts.erase(count++);
+        else
+          ++count;
+      }
+      if (m_showCounts.size() >= MAX_SHOW_COUNTS)
+        m_showCounts.clear();
+    }
+    it = m_showCounts.insert(std::make_pair(details.file, 0)).first;
+  }
+
+  if (++it->second < g_advancedSettings.m_ddsMinUseCount)
+    return;
+  m_showCounts.erase(it);
+  lock.Leave();
+
+  CStdString path = GetCachedPath(details.file);
+  if (CFile::Exists(URIUtils::ReplaceExtension(path, ".dds")))
+    return;
+
+  // not on our own queue, compressing would hold up the downloads for the screen
+  CJobManager::GetInstance().AddJob(new CTextureDDSJob(path), NULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTextureCache::ForgetUseCount(const CStdString &file)
+{
+  CSingleLock lock(m_showCountSection);
+  m_showCounts.erase(file);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2,6 +2,9 @@
 #define PLEXTEXTURECACHE_H
 
 #include "TextureCache.h"
+#include "threads/CriticalSection.h"
+
+#include <map>
 
 class CPlexTextureCache : public CTextureCache
 {
@@ -16,6 +19,14 @@ public:
   virtual void IncrementUseCount(const CTextureDetails &details);
   virtual bool SetCachedTextureValid(const CStdString &url, bool updateable);
   virtual bool ClearCachedTexture(const CStdString &url, CStdString &cacheFile);
+
+  /* the original was downloaded again, its loads start over */
+  void ForgetUseCount(const CStdString &file);
+
+private:
+  typedef std::map<CStdString, unsigned int> ShowCountMap;
+  ShowCountMap m_showCounts; // cached file -> times it was loaded as a large texture
+  CCriticalSection m_showCountSection;
 };
 
 #endif // PLEXTEXTURECACHE_H
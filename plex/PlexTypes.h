@@ -149,6 +149,8 @@ enum ePlexMediaFilterTypes
 #define GUI_MSG_FILTER_LOADED GUI_MSG_USER + 51
 #define GUI_MSG_FILTER_VALUES_LOADED GUI_MSG_USER + 52
 
+#define GUI_MSG_LIST_INSERT_ITEM GUI_MSG_USER + 68
+#define GUI_MSG_LIST_UPDATE_ITEM GUI_MSG_USER + 69
 #define GUI_MSG_LIST_REMOVE_ITEM GUI_MSG_USER + 70
 
 #define GUI_MSG_PLEX_SECTION_LOADED GUI_MSG_USER + 71
@@ -165,10 +167,15 @@ enum ePlexMediaFilterTypes
 #define GUI_MSG_PLEX_PLAYLIST_STATUS_CHANGED + 82
 #define GUI_MSG_PLEX_EXIT_USER_WINDOW + 83
 #define GUI_MSG_PLEX_USERLIST_FETCHED + 84
+#define GUI_MSG_PLEX_LIBRARY_CHANGED GUI_MSG_USER + 85
 
 #define PLEX_DATA_LOADER 99990
 #define PLEX_SERVER_MANAGER 99991
 #define PLEX_AUTO_UPDATER 99993
+#define PLEX_NOTIFICATION_CLIENT 99994
+
+/* a library change that isn't tied to one section */
+#define PLEX_SECTION_UNKNOWN -1
 
 #define PLEX_STREAM_VIDEO    1
 #define PLEX_STREAM_AUDIO    2
@@ -198,6 +205,11 @@ class CMusicThumbLoader;
 #define SYSTEM_CURRENT_USER_THUMB   5012
 #define SYSTEM_IS_SIGNED_IN         5013
 #define SYSTEM_USER_IS_IN_HOME      5014
+#define SYSTEM_TEXTURE_MEMORY_SKIN  5015
+#define SYSTEM_TEXTURE_MEMORY_FONTS 5016
+#define SYSTEM_TEXTURE_MEMORY_ART   5017
+#define SYSTEM_TEXTURE_MEMORY_TOTAL 5018
+#define SYSTEM_TEXTURE_UPLOADS      5019
 #define SLIDESHOW_SHOW_DESCRIPTION  990
 
 #define LISTITEM_STAR_DIFFUSE       (LISTITEM_START + 110)
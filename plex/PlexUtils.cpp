@@ -201,6 +201,10 @@ string PlexUtils::GetHostName()
 ///////////////////////////////////////////////////////////////////////////////
 bool PlexUtils::IsPlexMediaServer(const CStdString& strFile)
 {
+  // asked for every item that is shown, most of them are ours and don't need parsing to tell
+  if (boost::istarts_with(strFile, "plexserver://") || boost::istarts_with(strFile, "plex://"))
+    return true;
+
   CURL url(strFile);
   if (url.GetProtocol() == "plexserver" || url.GetProtocol() == "plex")
     return true;
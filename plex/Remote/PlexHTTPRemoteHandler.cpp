@@ -25,6 +25,9 @@
 #include "Client/PlexTimelineManager.h"
 
 #include <boost/asio/detail/socket_ops.hpp>
+#include <boost/bind.hpp>
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
 #include "PlexApplication.h"
 
 #include "settings/GUISettings.h"
@@ -52,6 +55,15 @@ static CPlexRemotePlayHandler* playHandler;
 
 #define LEGACY 1
 
+/* a poll that can't be suspended (HTTP/1.0 can't take a chunked answer) holds a webserver thread
+ * while it waits, only this many wait the full PLEX_REMOTE_POLL_TIMEOUT and leave the rest of the
+ * pool to everybody else */
+#define PLEX_REMOTE_MAX_BLOCKING_POLLS 2
+static volatile long blockingPolls = 0;
+
+/* the others wait this long, so that they come back about once a second instead of right away */
+#define PLEX_REMOTE_THROTTLED_POLL_WAIT 1000
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 CPlexHTTPRemoteHandler::CPlexHTTPRemoteHandler()
@@ -62,6 +74,16 @@ CPlexHTTPRemoteHandler::CPlexHTTPRemoteHandler()
   playHandler = new CPlexRemotePlayHandler;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexHTTPRemoteHandler::~CPlexHTTPRemoteHandler()
+{
+  if (m_pollResult)
+  {
+    CSingleLock lk(m_pollResult->lock);
+    m_pollResult->abandoned = true;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 bool CPlexHTTPRemoteHandler::CheckHTTPRequest(const HTTPRequest &request)
 {
@@ -421,16 +443,60 @@ CPlexRemoteResponse CPlexHTTPRemoteHandler::poll(const HTTPRequest &request, con
       wait = true;
   }
 
-  CXBMCTinyXML xmlDoc;
+  std::string data;
+  m_responseHeaderFields.insert(std::make_pair("Access-Control-Expose-Headers", "X-Plex-Client-Identifier"));
 
-  if (wait)
-    xmlDoc = pollSubscriber->waitForTimeline();
-  else
-    xmlDoc = g_plexApplication.timelineManager->GetCurrentTimeLines()->getTimelinesXML(pollSubscriber->getCommandID());
+  if (wait && CWebServer::CanSuspendRequest(request))
+  {
+    m_pollResult = PollResultPtr(new PollResult);
+    if (pollSubscriber->parkPoll(boost::bind(&CPlexHTTPRemoteHandler::pollCompleted, m_pollResult, request.connection, _1), data))
+    {
+      m_responseType = HTTPSuspended;
+      return CPlexRemoteResponse();
+    }
+  }
+  else if (wait)
+  {
+    // the ones that don't get to hold a thread for long still don't poll in a tight loop
+    bool blocking = AtomicIncrement(&blockingPolls) <= PLEX_REMOTE_MAX_BLOCKING_POLLS;
+    data = pollSubscriber->waitForTimeline(blocking ? PLEX_REMOTE_POLL_TIMEOUT * 1000 : PLEX_REMOTE_THROTTLED_POLL_WAIT);
+    AtomicDecrement(&blockingPolls);
+  }
 
-  m_responseHeaderFields.insert(std::make_pair("Access-Control-Expose-Headers", "X-Plex-Client-Identifier"));
+  if (!wait)
+    data = g_plexApplication.timelineManager->GetCurrentTimeLines()->getTimelinesData(pollSubscriber->getCommandID());
+
+  CPlexRemoteResponse response;
+  response.body = data;
+  return response;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexHTTPRemoteHandler::pollCompleted(PollResultPtr result, struct MHD_Connection* connection, const std::string& data)
+{
+  CSingleLock lk(result->lock);
+
+  // the connection was closed, somebody else might be using it by now
+  if (result->abandoned)
+    return;
+
+  result->data = data;
 
-  return CPlexRemoteResponse(xmlDoc);
+  // still under the lock, the request can't go away while it is resumed
+  CWebServer::ResumeRequest(connection);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+int CPlexHTTPRemoteHandler::ResumeHTTPRequest(const HTTPRequest &request)
+{
+  if (!m_pollResult)
+    return MHD_NO;
+
+  CSingleLock lk(m_pollResult->lock);
+  m_data = m_pollResult->data;
+  m_responseType = HTTPMemoryDownloadNoFreeCopy;
+
+  return MHD_YES;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
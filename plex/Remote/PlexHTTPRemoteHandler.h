@@ -15,6 +15,8 @@
 #include "PlexUtils.h"
 
 #include "utils/XBMCTinyXML.h"
+#include "threads/CriticalSection.h"
+#include <boost/shared_ptr.hpp>
 
 typedef std::map<std::string, std::string> ArgMap;
 
@@ -62,6 +64,7 @@ class CPlexHTTPRemoteHandler : public IHTTPRequestHandler
 {
 public:
   CPlexHTTPRemoteHandler();
+  virtual ~CPlexHTTPRemoteHandler();
   virtual IHTTPRequestHandler* GetInstance()
   {
     return new CPlexHTTPRemoteHandler();
@@ -69,6 +72,7 @@ public:
 
   virtual bool CheckHTTPRequest(const HTTPRequest& request);
   virtual int HandleHTTPRequest(const HTTPRequest& request);
+  virtual int ResumeHTTPRequest(const HTTPRequest& request);
 
   virtual void* GetHTTPResponseData() const;
   virtual size_t GetHTTPResonseDataLength() const;
@@ -89,8 +93,21 @@ private:
   CPlexRemoteResponse resources();
   CPlexRemoteResponse showDetails(const ArgMap &arguments);
 
+  /* a poll parked with the subscriber, filled in when it completes */
+  struct PollResult
+  {
+    PollResult() : abandoned(false) {}
+    CCriticalSection lock;
+    std::string data;
+    /* the request is gone, its connection must not be resumed anymore */
+    bool abandoned;
+  };
+  typedef boost::shared_ptr<PollResult> PollResultPtr;
+  static void pollCompleted(PollResultPtr result, struct MHD_Connection* connection, const std::string& data);
+
   CStdString m_data;
   int m_formerWindow;
+  PollResultPtr m_pollResult;
 };
 
 #endif /* defined(__Plex_Home_Theater__PlexHTTPRemoteHandler__) */
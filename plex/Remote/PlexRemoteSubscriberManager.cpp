@@ -23,9 +23,28 @@
 #include "Client/PlexTimeline.h"
 #include "Client/PlexTimelineManager.h"
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class CPlexTimelineSendJob : public CJob
+{
+  public:
+    CPlexTimelineSendJob(const CPlexRemoteSubscriberPtr& subscriber, const CURL& url, const std::string& data)
+      : m_subscriber(subscriber), m_url(url), m_data(data) {}
+
+    bool DoWork()
+    {
+      return m_subscriber->postTimeline(m_url, m_data);
+    }
+
+    const char* GetType() const { return "plexTimelineSendJob"; }
+
+    CPlexRemoteSubscriberPtr m_subscriber;
+    CURL m_url;
+    std::string m_data;
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////
 CPlexRemoteSubscriber::CPlexRemoteSubscriber(bool poller, const std::string &uuid, int commandID, const std::string &ipaddress, int port, const std::string &protocol)
-  : CThread(std::string("RemoteSubscriber: " + uuid).c_str()), m_outgoingTimelines(20)
+  : m_outgoingTimelines(20), m_sendFailures(0), m_retryScheduled(false), m_stopped(false)
 {
   if (!protocol.empty() && !ipaddress.empty())
   {
@@ -37,74 +56,154 @@ CPlexRemoteSubscriber::CPlexRemoteSubscriber(bool poller, const std::string &uui
   m_poller = poller;
   m_commandID = commandID;
   m_uuid = uuid;
+
+  m_file.SetTimeout(PLEX_REMOTE_SEND_CONNECT_TIMEOUT);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-void CPlexRemoteSubscriber::Process()
+void CPlexRemoteSubscriber::Stop()
 {
-  while (!m_bStop)
+  m_outgoingTimelines.cancel();
+  g_plexApplication.timer->RemoveTimeout(this);
+
   {
-    CPlexTimelineCollectionPtr timelines;
+    CSingleLock lk(m_sendLock);
+    m_stopped = true;
+    m_pendingTimeline.reset();
+  }
 
-    if (!m_outgoingTimelines.waitPop(timelines) || !timelines)
-      continue;
+  // a post that is still going frees up its sender right away, and one that hasn't started
+  // yet fails as soon as it does
+  m_file.Cancel();
 
-    int numFails = 0;
-    while (!sendTimeline(timelines))
-    {
-      CLog::Log(LOGWARNING, "CPlexRemoteSubscriber::sendTimeline failed to send timeline to %s", getName().c_str());
-      Sleep(500);
-      if ((++ numFails > 5) || m_bStop)
-      {
-        CLog::Log(LOGDEBUG, "CPlexRemoteSubcriber::Process aborting timeline thread for subscriber %s", getName().c_str());
-        return;
-      }
-    }
+  // don't leave a parked poll hanging
+  PlexPollCompletion completion;
+  {
+    CSingleLock lk(m_pollLock);
+    completion.swap(m_parkedPoll);
   }
-  CLog::Log(LOGDEBUG, "CPlexRemoteSubcriber::Process exiting timeline thread for subscriber %s", getName().c_str());
+  if (completion)
+    completion(std::string());
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-void CPlexRemoteSubscriber::Stop()
+std::string CPlexRemoteSubscriber::waitForTimeline(int timeout)
 {
-  if (IsRunning())
-    StopThread(false);
+  CPlexTimelineCollectionPtr timelines;
 
-  m_outgoingTimelines.cancel();
-  m_file.Cancel();
+  if (!m_outgoingTimelines.waitPop(timelines, timeout) || !timelines)
+    return g_plexApplication.timelineManager->GetCurrentTimeLines()->getTimelinesData(0);
 
-  if (IsRunning())
-    WaitForThreadExit(0xFFFFFFFF);
+  return timelines->getTimelinesData(m_commandID);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-CXBMCTinyXML CPlexRemoteSubscriber::waitForTimeline()
+bool CPlexRemoteSubscriber::parkPoll(const PlexPollCompletion& completion, std::string& data)
 {
-  CPlexTimelineCollectionPtr timelines;
+  PlexPollCompletion previous;
+
+  {
+    CSingleLock lk(m_pollLock);
+
+    CPlexTimelineCollectionPtr timelines;
+    if (m_outgoingTimelines.tryPop(timelines) && timelines)
+    {
+      data = timelines->getTimelinesData(m_commandID);
+      return false;
+    }
+
+    previous = m_parkedPoll;
+    m_parkedPoll = completion;
+  }
+
+  // a client only waits on one poll at a time, the one it gave up on gets the current state
+  if (previous)
+    previous(g_plexApplication.timelineManager->GetCurrentTimeLines()->getTimelinesData(m_commandID));
 
-  while (true)
+  g_plexApplication.timer->RestartTimeout(PLEX_REMOTE_POLL_TIMEOUT * 1000, this);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexRemoteSubscriber::OnTimeout()
+{
+  if (!m_poller)
   {
-    if (!m_outgoingTimelines.waitPop(timelines, 10 * 1000) || !timelines)
-      return g_plexApplication.timelineManager->GetCurrentTimeLines()->getTimelinesXML();
+    CSingleLock lk(m_sendLock);
+    m_retryScheduled = false;
+    sendPendingTimeline();
+    return;
+  }
 
-    return timelines->getTimelinesXML(m_commandID);
+  PlexPollCompletion completion;
+  {
+    CSingleLock lk(m_pollLock);
+    completion.swap(m_parkedPoll);
   }
 
-  // should never happen!
-  return CXBMCTinyXML();
+  if (completion)
+    completion(g_plexApplication.timelineManager->GetCurrentTimeLines()->getTimelinesData(0));
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-bool CPlexRemoteSubscriber::sendTimeline(const CPlexTimelineCollectionPtr &timelines)
+/* needs m_sendLock */
+void CPlexRemoteSubscriber::sendPendingTimeline()
 {
+  if (m_stopped || m_sendingTimeline || m_retryScheduled || !m_pendingTimeline)
+    return;
+
+  m_sendingTimeline = m_pendingTimeline;
+  m_pendingTimeline.reset();
+
   CURL u(m_url);
   u.SetFileName(":/timeline");
 
-  CXBMCTinyXML xml = timelines->getTimelinesXML(m_commandID);
-  std::string data = PlexUtils::GetXMLString(xml);
+  g_plexApplication.remoteSubscriberManager->sendTimeline(shared_from_this(), u, m_sendingTimeline->getTimelinesData(m_commandID));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* called on one of the manager's senders */
+bool CPlexRemoteSubscriber::postTimeline(const CURL &url, const std::string &data)
+{
   CStdString ret;
+  return m_file.Post(url.Get(), data, ret);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexRemoteSubscriber::timelineSent(bool success)
+{
+  CSingleLock lk(m_sendLock);
+
+  CPlexTimelineCollectionPtr sent = m_sendingTimeline;
+  m_sendingTimeline.reset();
+
+  // cancelled by Stop(), there is nobody to retry for
+  if (m_stopped)
+    return;
+
+  if (success)
+  {
+    m_sendFailures = 0;
+  }
+  else if (++m_sendFailures > PLEX_REMOTE_SEND_RETRIES)
+  {
+    CLog::Log(LOGDEBUG, "CPlexRemoteSubscriber::timelineSent giving up on timeline for subscriber %s", getName().c_str());
+    m_sendFailures = 0;
+  }
+  else
+  {
+    CLog::Log(LOGWARNING, "CPlexRemoteSubscriber::timelineSent failed to send timeline to %s", getName().c_str());
+
+    // retry later, unless a newer timeline came in meanwhile
+    if (!m_pendingTimeline)
+      m_pendingTimeline = sent;
+
+    m_retryScheduled = true;
+    g_plexApplication.timer->SetTimeout(PLEX_REMOTE_SEND_BACKOFF << (m_sendFailures - 1), this);
+    return;
+  }
 
-  return m_file.Post(u.Get(), data, ret);
+  sendPendingTimeline();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -122,6 +221,29 @@ bool CPlexRemoteSubscriber::shouldRemove() const
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 bool CPlexRemoteSubscriber::queueTimeline(const CPlexTimelineCollectionPtr &timeline)
 {
+  if (!m_poller)
+  {
+    // only the newest timeline matters, one still waiting to be sent is replaced
+    CSingleLock lk(m_sendLock);
+    m_pendingTimeline = timeline;
+    sendPendingTimeline();
+    return true;
+  }
+
+  CSingleLock lk(m_pollLock);
+
+  // hand it straight to a waiting poll
+  if (m_parkedPoll)
+  {
+    PlexPollCompletion completion;
+    completion.swap(m_parkedPoll);
+    lk.Leave();
+
+    g_plexApplication.timer->RemoveTimeout(this);
+    completion(timeline->getTimelinesData(m_commandID));
+    return true;
+  }
+
   if (!m_outgoingTimelines.tryEnqueue(timeline))
   {
     // This means that the queue is full, the client is not reading fast enough!
@@ -178,8 +300,6 @@ CPlexRemoteSubscriberPtr CPlexRemoteSubscriberManager::addSubscriber(CPlexRemote
                                             subscriber->getName().empty() ? CStdString(subscriber->getURL().GetHostName()) : CStdString(subscriber->getName()),
                                             TOAST_DISPLAY_TIME, false);
 
-    if (!subscriber->isPoller())
-      subscriber->Create();
   }
 
   g_plexApplication.timer->SetTimeout(PLEX_REMOTE_SUBSCRIBER_CHECK_INTERVAL * 1000, this);
@@ -302,4 +422,22 @@ void CPlexRemoteSubscriberManager::Stop()
 
   BOOST_FOREACH(CPlexRemoteSubscriberPtr sub, allSubs)
     removeSubscriber(sub);
+
+  CancelJobs();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexRemoteSubscriberManager::sendTimeline(const CPlexRemoteSubscriberPtr &subscriber, const CURL &url, const std::string &data)
+{
+  AddJob(new CPlexTimelineSendJob(subscriber, url, data));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexRemoteSubscriberManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CPlexTimelineSendJob *sendJob = static_cast<CPlexTimelineSendJob*>(job);
+  if (sendJob)
+    sendJob->m_subscriber->timelineSent(success);
+
+  CJobQueue::OnJobComplete(jobID, success, job);
 }
@@ -11,6 +11,8 @@
 
 #include <map>
 #include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/enable_shared_from_this.hpp>
 #include <boost/timer.hpp>
 #include "PlexGlobalTimer.h"
 #include "threads/Event.h"
@@ -21,6 +23,7 @@
 #include "XBMCTinyXML.h"
 #include "Client/PlexTimeline.h"
 #include "PlexQueue.h"
+#include "JobManager.h"
 
 class CPlexRemoteSubscriber;
 typedef boost::shared_ptr<CPlexRemoteSubscriber> CPlexRemoteSubscriberPtr;
@@ -31,7 +34,22 @@ typedef boost::shared_ptr<CPlexRemoteSubscriber> CPlexRemoteSubscriberPtr;
 /* check all subscribers every 10th second */
 #define PLEX_REMOTE_SUBSCRIBER_CHECK_INTERVAL 10
 
-class CPlexRemoteSubscriber : public CThread
+/* answer a waiting poll with the current timelines after 10 seconds */
+#define PLEX_REMOTE_POLL_TIMEOUT 10
+
+/* number of timelines posted to subscribers at the same time */
+#define PLEX_REMOTE_SENDERS 3
+
+/* a failed post is retried this often, waiting twice as long each time */
+#define PLEX_REMOTE_SEND_RETRIES 5
+#define PLEX_REMOTE_SEND_BACKOFF 500
+
+/* a controller that doesn't take the connection within this many seconds doesn't hold up a sender */
+#define PLEX_REMOTE_SEND_CONNECT_TIMEOUT 2
+
+typedef boost::function<void(const std::string&)> PlexPollCompletion;
+
+class CPlexRemoteSubscriber : public IPlexGlobalTimeout, public boost::enable_shared_from_this<CPlexRemoteSubscriber>
 {
   public:
     static CPlexRemoteSubscriberPtr NewSubscriber(const std::string &uuid, const std::string &ipaddress, int port, int commandID = -1, const std::string &protocol = "http")
@@ -47,10 +65,18 @@ class CPlexRemoteSubscriber : public CThread
 
     CPlexRemoteSubscriber(bool poller, const std::string &uuid, int commandID, const std::string &ipaddress="", int port=32400, const std::string& protocol="http");
 
-    void Process();
     void Stop();
 
-    CXBMCTinyXML waitForTimeline();
+    std::string waitForTimeline(int timeout = PLEX_REMOTE_POLL_TIMEOUT * 1000);
+
+    /* Long poll without holding on to the calling thread. Returns false with data set
+     * if a timeline is ready already, otherwise completion is called once one is
+     * queued or PLEX_REMOTE_POLL_TIMEOUT has passed */
+    bool parkPoll(const PlexPollCompletion& completion, std::string& data);
+
+    /* poll timeout for pollers, send retry for everybody else */
+    void OnTimeout();
+    CStdString TimerName() const { return m_poller ? "remoteSubscriberPoll" : "remoteSubscriberRetry"; }
 
     void refresh(CPlexRemoteSubscriberPtr sub);
     bool shouldRemove() const;
@@ -67,28 +93,45 @@ class CPlexRemoteSubscriber : public CThread
     std::string getName() const { return m_name; }
 
     bool queueTimeline(const CPlexTimelineCollectionPtr& timeline);
+    bool postTimeline(const CURL& url, const std::string& data);
+    void timelineSent(bool success);
 
   
   private:
-    bool sendTimeline(const CPlexTimelineCollectionPtr& timelines);
+    void sendPendingTimeline();
+
+    /* pollers collect their timelines here */
     CPlexQueue<CPlexTimelineCollectionPtr> m_outgoingTimelines;
 
+    CCriticalSection m_pollLock;
+    PlexPollCompletion m_parkedPoll;
+
+    /* everybody else gets the newest timeline posted by the manager's senders */
+    CCriticalSection m_sendLock;
+    CPlexTimelineCollectionPtr m_pendingTimeline;
+    CPlexTimelineCollectionPtr m_sendingTimeline;
+    int m_sendFailures;
+    bool m_retryScheduled;
+    bool m_stopped;
+
+    /* only one post is in flight at a time, Stop() cancels it */
+    XFILE::CPlexFile m_file;
+
     int m_commandID;
     CURL m_url;
     CPlexTimer m_lastUpdated;
     std::string m_uuid;
     bool m_poller;
     std::string m_name;
-    XFILE::CPlexFile m_file;
 };
 
 typedef std::map<std::string, CPlexRemoteSubscriberPtr> SubscriberMap;
 typedef std::pair<std::string, CPlexRemoteSubscriberPtr> SubscriberPair;
 
-class CPlexRemoteSubscriberManager : public IPlexGlobalTimeout
+class CPlexRemoteSubscriberManager : public IPlexGlobalTimeout, public CJobQueue
 {
   public:
-    CPlexRemoteSubscriberManager() : m_stopped(false) {}
+    CPlexRemoteSubscriberManager() : CJobQueue(false, PLEX_REMOTE_SENDERS, CJob::PRIORITY_NORMAL), m_stopped(false) {}
     CPlexRemoteSubscriberPtr addSubscriber(CPlexRemoteSubscriberPtr subscriber);
     void updateSubscriberCommandID(CPlexRemoteSubscriberPtr subscriber);
     void removeSubscriber(CPlexRemoteSubscriberPtr subscriber);
@@ -101,6 +144,9 @@ class CPlexRemoteSubscriberManager : public IPlexGlobalTimeout
     CStdString TimerName() const { return "remoteSubscriberManager"; }
     void Stop();
 
+    void sendTimeline(const CPlexRemoteSubscriberPtr& subscriber, const CURL& url, const std::string& data);
+    void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
   private:
     void OnTimeout();
   
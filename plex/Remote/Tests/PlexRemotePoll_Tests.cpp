@@ -0,0 +1,195 @@
+#include "PlexTest.h"
+#include "network/WebServer.h"
+#include "PlexHTTPRemoteHandler.h"
+#include "PlexRemoteSubscriberManager.h"
+#include "Client/PlexTimelineManager.h"
+#include "PlexGlobalTimer.h"
+#include "PlexApplication.h"
+#include "threads/SystemClock.h"
+
+#include <algorithm>
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#ifdef HAS_WEB_SERVER
+
+#define POLL_TEST_CLIENTS 50
+
+using boost::asio::ip::tcp;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* whatever the system gives us, some other process might be on any fixed port */
+static int freePort()
+{
+  boost::asio::io_service io;
+  tcp::acceptor acceptor(io, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+  return acceptor.local_endpoint().port();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static void doRequest(int port, const std::string& path, const std::string& clientID, std::string* body,
+                      const std::string& version = "HTTP/1.1")
+{
+  try
+  {
+    boost::asio::io_service io;
+    tcp::socket socket(io);
+    socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port));
+
+    std::string request = "GET " + path + " " + version + "\r\nHost: 127.0.0.1\r\n"
+                          "X-Plex-Client-Identifier: " + clientID + "\r\nConnection: close\r\n\r\n";
+    boost::asio::write(socket, boost::asio::buffer(request));
+
+    boost::system::error_code ec;
+    boost::asio::streambuf response;
+    boost::asio::read(socket, response, boost::asio::transfer_all(), ec);
+
+    std::string data((std::istreambuf_iterator<char>(&response)), std::istreambuf_iterator<char>());
+    size_t headerEnd = data.find("\r\n\r\n");
+    if (headerEnd != std::string::npos)
+      *body = data.substr(headerEnd + 4);
+  }
+  catch (...)
+  {
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static void doPoll(int port, const std::string& clientID, const std::string& version, std::string* body,
+                   unsigned int* took)
+{
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  doRequest(port, "/player/timeline/poll?wait=1&commandID=1", clientID, body, version);
+  *took = XbmcThreads::SystemClockMillis() - start;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* the remote handler as the application runs it, with the subscribers and timelines it needs */
+class PlexRemotePollTests : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    g_plexApplication.timer = CPlexGlobalTimerPtr(new CPlexGlobalTimer);
+    g_plexApplication.timelineManager = CPlexTimelineManagerPtr(new CPlexTimelineManager);
+    g_plexApplication.remoteSubscriberManager = new CPlexRemoteSubscriberManager;
+
+    CWebServer::RegisterRequestHandler(&handler);
+    port = freePort();
+    ASSERT_TRUE(server.Start(port, "", ""));
+  }
+
+  void TearDown()
+  {
+    server.Stop();
+    CWebServer::UnregisterRequestHandler(&handler);
+
+    g_plexApplication.timer->StopAllTimers();
+    g_plexApplication.remoteSubscriberManager->Stop();
+    g_plexApplication.timelineManager->Stop();
+    delete g_plexApplication.remoteSubscriberManager;
+    g_plexApplication.remoteSubscriberManager = NULL;
+    g_plexApplication.timelineManager.reset();
+    g_plexApplication.timer.reset();
+  }
+
+  bool waitForPollers(size_t count, unsigned int timeout)
+  {
+    XbmcThreads::EndTime timer(timeout);
+    while (g_plexApplication.remoteSubscriberManager->getSubscribers().size() < count && !timer.IsTimePast())
+      boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    return g_plexApplication.remoteSubscriberManager->getSubscribers().size() == count;
+  }
+
+  void startPollers(int count, const std::string& version = "HTTP/1.1")
+  {
+    bodies.resize(count);
+    took.resize(count);
+    for (int i = 0; i < count; i++)
+      pollers.create_thread(boost::bind(&doPoll, port, "poller" + boost::lexical_cast<std::string>(i), version,
+                                        &bodies[i], &took[i]));
+  }
+
+  CWebServer server;
+  CPlexHTTPRemoteHandler handler;
+  int port;
+
+  boost::thread_group pollers;
+  std::vector<std::string> bodies;
+  std::vector<unsigned int> took;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexRemotePollTests, manyPollersDontBlockOtherRequests)
+{
+  startPollers(POLL_TEST_CLIENTS);
+
+  // many more pollers than webserver threads are waiting now
+  EXPECT_TRUE(waitForPollers(POLL_TEST_CLIENTS, 10000));
+
+  std::string timelines;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  doRequest(port, "/player/timeline/poll?commandID=1", "other", &timelines);
+  EXPECT_NE(std::string::npos, timelines.find("<MediaContainer"));
+  EXPECT_LT(XbmcThreads::SystemClockMillis() - start, 2000);
+
+  // a new timeline answers all of them
+  g_plexApplication.timelineManager->RefreshSubscribers();
+  pollers.join_all();
+
+  for (int i = 0; i < POLL_TEST_CLIENTS; i++)
+  {
+    EXPECT_NE(std::string::npos, bodies[i].find("commandID=\"1\""));
+    EXPECT_LT(took[i], PLEX_REMOTE_POLL_TIMEOUT * 1000);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexRemotePollTests, stopAnswersParkedPolls)
+{
+  startPollers(1);
+  EXPECT_TRUE(waitForPollers(1, 10000));
+
+  server.Stop();
+  pollers.join_all();
+  EXPECT_LT(took[0], PLEX_REMOTE_POLL_TIMEOUT * 1000);
+
+  ASSERT_TRUE(server.Start(port, "", ""));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* HTTP/1.0 can't take an answer that comes later, only two of those polls hold on to a thread and
+ * the others still don't come back right away */
+TEST_F(PlexRemotePollTests, http10PollersOverTheLimitAreThrottled)
+{
+  startPollers(3, "HTTP/1.0");
+  EXPECT_TRUE(waitForPollers(3, 10000));
+
+  // the third one only gets a short wait, the other two are still waiting after it
+  boost::this_thread::sleep(boost::posix_time::milliseconds(3000));
+  g_plexApplication.timelineManager->RefreshSubscribers();
+  pollers.join_all();
+
+  std::sort(took.begin(), took.end());
+  EXPECT_GE(took[0], 900u);
+  EXPECT_LT(took[0], 2500u);
+  EXPECT_GE(took[1], 2500u);
+
+  for (int i = 0; i < 3; i++)
+    EXPECT_NE(std::string::npos, bodies[i].find("<MediaContainer"));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexRemotePollTests, pollWithoutWaitIsAnsweredRightAway)
+{
+  std::string body;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  doRequest(port, "/player/timeline/poll?commandID=3", "client", &body);
+
+  EXPECT_NE(std::string::npos, body.find("commandID=\"3\""));
+  EXPECT_LT(XbmcThreads::SystemClockMillis() - start, 2000);
+}
+
+#endif
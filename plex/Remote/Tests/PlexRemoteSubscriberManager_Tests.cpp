@@ -0,0 +1,84 @@
+#include "PlexTest.h"
+#include "PlexRemoteSubscriberManager.h"
+#include "Client/PlexTimelineManager.h"
+#include "PlexGlobalTimer.h"
+#include "PlexApplication.h"
+#include "threads/SystemClock.h"
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+using boost::asio::ip::tcp;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class PlexRemoteSubscriberManagerTests : public ::testing::Test
+{
+public:
+  PlexRemoteSubscriberManagerTests()
+    : acceptor(io, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)), socket(io) {}
+
+  void SetUp()
+  {
+    g_plexApplication.timer = CPlexGlobalTimerPtr(new CPlexGlobalTimer);
+    g_plexApplication.timelineManager = CPlexTimelineManagerPtr(new CPlexTimelineManager);
+    g_plexApplication.remoteSubscriberManager = new CPlexRemoteSubscriberManager;
+  }
+
+  void TearDown()
+  {
+    g_plexApplication.timer->StopAllTimers();
+    g_plexApplication.remoteSubscriberManager->Stop();
+    g_plexApplication.timelineManager->Stop();
+    delete g_plexApplication.remoteSubscriberManager;
+    g_plexApplication.remoteSubscriberManager = NULL;
+    g_plexApplication.timelineManager.reset();
+    g_plexApplication.timer.reset();
+  }
+
+  /* a controller that takes the timeline post and never answers it */
+  CPlexRemoteSubscriberPtr addHangingSubscriber()
+  {
+    CPlexRemoteSubscriberPtr sub = CPlexRemoteSubscriber::NewSubscriber("client", "127.0.0.1", acceptor.local_endpoint().port());
+    sub = g_plexApplication.remoteSubscriberManager->addSubscriber(sub);
+    sub->queueTimeline(CPlexTimelineCollectionPtr(new CPlexTimelineCollection));
+    acceptor.accept(socket);
+    return sub;
+  }
+
+  boost::asio::io_service io;
+  tcp::acceptor acceptor;
+  tcp::socket socket;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexRemoteSubscriberManagerTests, removeCancelsPost)
+{
+  CPlexRemoteSubscriberPtr sub = addHangingSubscriber();
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  g_plexApplication.remoteSubscriberManager->removeSubscriber(sub);
+  EXPECT_LT(XbmcThreads::SystemClockMillis() - start, 2000);
+
+  // the connection was dropped, nothing else comes in
+  boost::system::error_code ec;
+  boost::asio::streambuf request;
+  boost::asio::read(socket, request, boost::asio::transfer_all(), ec);
+  EXPECT_EQ(boost::asio::error::eof, ec);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexRemoteSubscriberManagerTests, stoppedSubscriberDoesntPost)
+{
+  CPlexRemoteSubscriberPtr sub = addHangingSubscriber();
+  sub->Stop();
+
+  // neither a retry of the cancelled post nor a new timeline goes out
+  EXPECT_TRUE(sub->queueTimeline(CPlexTimelineCollectionPtr(new CPlexTimelineCollection)));
+  boost::this_thread::sleep(boost::posix_time::milliseconds(PLEX_REMOTE_SEND_BACKOFF * 2));
+
+  acceptor.non_blocking(true);
+  tcp::socket another(io);
+  boost::system::error_code ec;
+  acceptor.accept(another, ec);
+  EXPECT_EQ(boost::asio::error::would_block, ec);
+}
@@ -3,6 +3,17 @@
 #include <boost/foreach.hpp>
 #include "log.h"
 
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexGlobalTimer::CPlexGlobalTimer()
+  : CThread("CPlexGlobalTimer"), m_wheel(XbmcThreads::SystemClockMillis()), m_running(false)
+{
+  m_lastClock = XbmcThreads::SystemClockMillis();
+  m_clock = m_lastClock;
+  Create();
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 CPlexGlobalTimer::~CPlexGlobalTimer()
 {
@@ -11,13 +22,22 @@ CPlexGlobalTimer::~CPlexGlobalTimer()
   m_timerEvent.Set();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+int64_t CPlexGlobalTimer::Now()
+{
+  unsigned int clock = XbmcThreads::SystemClockMillis();
+  m_clock += (unsigned int)(clock - m_lastClock);
+  m_lastClock = clock;
+  return m_clock;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void CPlexGlobalTimer::StopAllTimers()
 {
   CSingleLock lk(m_timerLock);
 
   m_running = false;
-  m_timeouts.clear();
+  m_wheel.clear();
   CLog::Log(LOGDEBUG, "CPlexGlobalTimer::StopAllTimers signaling the timer thread to quit");
   m_timerEvent.Set();
 
@@ -30,44 +50,16 @@ void CPlexGlobalTimer::StopAllTimers()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void CPlexGlobalTimer::SetTimeout(int64_t msec, IPlexGlobalTimeout *callback)
 {
-  int64_t absoluteTime = XbmcThreads::SystemClockMillis() + msec;
-  timeoutPair newPair = std::make_pair(absoluteTime, callback);
-
   CSingleLock lk(m_timerLock);
-  if (m_timeouts.size() == 0)
-  {
-    m_timeouts.push_back(newPair);
-    m_timerEvent.Set();
-    return;
-  }
 
-  int idx = 0;
-  BOOST_FOREACH(timeoutPair tmout, m_timeouts)
-  {
-    if (tmout.second == callback)
-    {
-      m_timeouts.erase(m_timeouts.begin() + idx);
-      break;
-    }
-    idx++;
-  }
-
-  idx = 0;
-  BOOST_FOREACH(timeoutPair tmout, m_timeouts)
-  {
-    if (absoluteTime < tmout.first)
-      break;
-
-    idx ++;
-  }
+  int64_t now = Now();
+  int64_t next = m_wheel.nextEvent();
 
-  CLog::Log(LOGDEBUG, "CPlexGlobalTimer::SetTimeout adding timeout: %s at pos %d [%lld]", callback->TimerName().c_str(), idx, msec);
-  if (idx > m_timeouts.size())
-    m_timeouts.push_back(newPair);
-  else
-    m_timeouts.insert(m_timeouts.begin() + idx, newPair);
+  CLog::Log(LOGDEBUG, "CPlexGlobalTimer::SetTimeout adding timeout: %s [%lld]", callback->TimerName().c_str(), msec);
+  m_wheel.add(callback, now, now + msec);
 
-  if (idx == 0)
+  // only wake the timer thread if it has to wake up earlier now
+  if (next == -1 || m_wheel.nextEvent() < next)
     m_timerEvent.Set();
 }
 
@@ -76,41 +68,14 @@ void CPlexGlobalTimer::RemoveTimeout(IPlexGlobalTimeout *callback)
 {
   CSingleLock lk(m_timerLock);
 
-  if (m_timeouts.size() == 0)
-    return;
-
-  CLog::Log(LOGDEBUG, "CPlexGlobalTimer::RemoveTimeout want to remove %s", callback->TimerName().c_str());
-
-  int idx = -1, i = 0;
-  BOOST_FOREACH(timeoutPair tmout, m_timeouts)
-  {
-    if (callback == tmout.second)
-    {
-      idx = i;
-      break;
-    }
-    i ++;
-  }
-
-  CLog::Log(LOGDEBUG, "CPlexGlobaltimer::RemoveTimeout idx is %d for %s", idx, callback->TimerName().c_str());
-
-  if (idx == -1)
-    return;
-
-  if (idx > m_timeouts.size())
-    return;
-
-  CLog::Log(LOGDEBUG, "CPlexGlobaltimer::RemoveTimeout removing %s %d", callback->TimerName().c_str(), idx);
-  m_timeouts.erase(m_timeouts.begin() + idx);
-
-  if (idx == 0)
-    m_timerEvent.Set();
+  // the timer thread finds out by itself when it wakes up for nothing
+  if (m_wheel.remove(callback))
+    CLog::Log(LOGDEBUG, "CPlexGlobaltimer::RemoveTimeout removing %s", callback->TimerName().c_str());
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void CPlexGlobalTimer::RestartTimeout(int64_t msec, IPlexGlobalTimeout *callback)
 {
-  RemoveTimeout(callback);
   SetTimeout(msec, callback);
 }
 
@@ -118,28 +83,48 @@ void CPlexGlobalTimer::RestartTimeout(int64_t msec, IPlexGlobalTimeout *callback
 void CPlexGlobalTimer::RemoveAllTimeoutsByName(const CStdString &name)
 {
   CSingleLock lk(m_timerLock);
-  std::vector<timeoutPair> toRemove;
+  std::vector<timeoutPair> timeouts;
+  m_wheel.getAll(timeouts);
 
-  BOOST_FOREACH(timeoutPair p, m_timeouts)
+  BOOST_FOREACH(timeoutPair p, timeouts)
   {
     if (name == p.second->TimerName())
-      toRemove.push_back(p);
+      RemoveTimeout(p.second);
   }
+}
 
-  BOOST_FOREACH(timeoutPair p, toRemove)
-    RemoveTimeout(p.second);
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexGlobalTimer::HasTimeout(IPlexGlobalTimeout *callback)
+{
+  CSingleLock lk(m_timerLock);
+  return m_wheel.contains(callback);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexGlobalTimer::Stats CPlexGlobalTimer::GetStats()
+{
+  CSingleLock lk(m_timerLock);
+  return m_stats;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void CPlexGlobalTimer::DumpDebug()
 {
 #ifdef _DEBUG
-  CLog::Log(LOGDEBUG, "CPlexGlobalTimer::DumpDebug ******");
+  CLog::Log(LOGDEBUG, "CPlexGlobalTimer::DumpDebug ****** %lu timeouts, %llu fired, %lld ms late on average, %lld ms at most",
+            m_wheel.size(), m_stats.fired, m_stats.fired ? m_stats.totalLateness / (int64_t)m_stats.fired : 0, m_stats.maxLateness);
+
+  std::vector<timeoutPair> timeouts;
+  m_wheel.getAll(timeouts);
+  std::sort(timeouts.begin(), timeouts.end());
+
+  int64_t now = Now();
   int i = 0;
-  BOOST_FOREACH(timeoutPair p, m_timeouts)
+  BOOST_FOREACH(timeoutPair p, timeouts)
   {
-    CLog::Log(LOGDEBUG, "CPlexGlobalTimer::DumpDebug %d - %s (%lld)", i, p.second->TimerName().c_str(), p.first - XbmcThreads::SystemClockMillis());
-    i++;
+    CLog::Log(LOGDEBUG, "CPlexGlobalTimer::DumpDebug %d - %s (%lld)", i, p.second->TimerName().c_str(), p.first - now);
+    if (++i == 20)
+      break;
   }
 #endif
 }
@@ -151,37 +136,43 @@ void CPlexGlobalTimer::Process()
   m_running = true;
   while (m_running)
   {
-    while (m_timeouts.size() == 0)
+    int64_t now = Now();
+
+    std::vector<CPlexTimerWheel::Expired> expired;
+    m_wheel.advance(now, expired);
+
+    BOOST_FOREACH(const CPlexTimerWheel::Expired& e, expired)
     {
-      CLog::Log(LOGDEBUG, "CPlexGlobalTimer::Process no more timeouts, waiting for them.");
-      lk.unlock();
-      m_timerEvent.Wait();
-      CLog::Log(LOGDEBUG, "CPlexGlobalTimer::StopAllTimers timer thread waking up");
+      int64_t lateness = std::max<int64_t>(now - e.expires, 0);
+      m_stats.fired++;
+      m_stats.totalLateness += lateness;
+      m_stats.maxLateness = std::max(m_stats.maxLateness, lateness);
 
-      lk.lock();
-      if (!m_running)
-        return;
+      // more than the slack means the thread didn't get to run
+      if (lateness > 2 * PLEX_TIMER_MAX_SLACK_MS)
+        CLog::Log(LOGWARNING, "CPlexGlobalTimer::Process %s fired %lld ms late", e.callback->TimerName().c_str(), lateness);
+
+      CLog::Log(LOGDEBUG, "CPlexGlobalTimer::Process firing callback %s - %lld ms late", e.callback->TimerName().c_str(), lateness);
+      CJobManager::GetInstance().AddJob(new CPlexGlobalTimerJob(e.callback), NULL, CJob::PRIORITY_HIGH);
     }
 
-    timeoutPair p = m_timeouts.at(0);
-    int64_t msecsToSleep = p.first - XbmcThreads::SystemClockMillis();
+    if (!expired.empty())
+      DumpDebug();
+
+    int64_t next = m_wheel.nextEvent();
 
     m_timerEvent.Reset();
     lk.unlock();
-    CLog::Log(LOGDEBUG, "CPlexGlobalTimer::Process waiting %lld milliseconds for %s...", msecsToSleep, p.second->TimerName().c_str());
-    if (msecsToSleep <= 0 || !m_timerEvent.WaitMSec(msecsToSleep))
+
+    if (next == -1)
     {
-      lk.lock();
-      if (!m_running)
-        return;
-      
-      int64_t didSleep = p.first - XbmcThreads::SystemClockMillis();
-
-      CLog::Log(LOGDEBUG, "CPlexGlobalTimer::Process firing callback %s - spent %lld in queue", p.second->TimerName().c_str(), didSleep);
-      m_timeouts.erase(m_timeouts.begin());
-      DumpDebug();
-      CJobManager::GetInstance().AddJob(new CPlexGlobalTimerJob(p.second), NULL, CJob::PRIORITY_HIGH);
-      lk.unlock();
+      CLog::Log(LOGDEBUG, "CPlexGlobalTimer::Process no more timeouts, waiting for them.");
+      m_timerEvent.Wait();
+    }
+    else if (next > now)
+    {
+      CLog::Log(LOGDEBUG, "CPlexGlobalTimer::Process waiting %lld milliseconds...", next - now);
+      m_timerEvent.WaitMSec(next - now);
     }
 
     lk.lock();
@@ -6,6 +6,7 @@
 #include "JobManager.h"
 
 #include "StdString.h"
+#include "PlexTimerWheel.h"
 
 #include <boost/shared_ptr.hpp>
 
@@ -33,26 +34,45 @@ class CPlexGlobalTimerJob : public CJob
     IPlexGlobalTimeout* m_callback;
 };
 
+/* the timeouts live in a timer wheel, the callbacks are run as jobs so a slow one doesn't hold up
+ * the others. Timeouts far enough out may fire a little late so that they can share a wakeup */
 class CPlexGlobalTimer : public CThread
 {
   public:
-    CPlexGlobalTimer() : CThread("CPlexGlobalTimer"), m_running(false) { Create(); }
+    /* how late the timeouts fired compared to when they were asked for */
+    struct Stats
+    {
+      Stats() : fired(0), totalLateness(0), maxLateness(0) {}
+      uint64_t fired;
+      int64_t totalLateness;
+      int64_t maxLateness;
+    };
+
+    CPlexGlobalTimer();
     ~CPlexGlobalTimer();
     void SetTimeout(int64_t msec, IPlexGlobalTimeout* callback);
     void RemoveTimeout(IPlexGlobalTimeout* callback);
     void RestartTimeout(int64_t msec, IPlexGlobalTimeout* callback);
     void RemoveAllTimeoutsByName(const CStdString& name);
+    bool HasTimeout(IPlexGlobalTimeout* callback);
+
+    Stats GetStats();
 
     void StopAllTimers();
   private:
     void Process();
-    void SetTimer();
     void DumpDebug();
+    int64_t Now();
 
     CCriticalSection m_timerLock;
-    std::vector<timeoutPair> m_timeouts;
+    CPlexTimerWheel m_wheel;
     CEvent m_timerEvent;
     bool m_running;
+    Stats m_stats;
+
+    /* SystemClockMillis wraps, the wheel wants a clock that doesn't */
+    unsigned int m_lastClock;
+    int64_t m_clock;
 };
 
 typedef boost::shared_ptr<CPlexGlobalTimer> CPlexGlobalTimerPtr;
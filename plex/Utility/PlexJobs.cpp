@@ -12,7 +12,9 @@
 #include "FileSystem/PlexFile.h"
 
 #include "TextureCache.h"
+#include "PlexTextureCache.h"
 #include "File.h"
+#include "URIUtils.h"
 #include "utils/Crc32.h"
 #include "PlexFile.h"
 #include "video/VideoInfoTag.h"
@@ -84,9 +86,11 @@ bool CPlexVideoThumbLoaderJob::DoWork()
   int i = 0;
   BOOST_FOREACH(CStdString artKey, art)
   {
-    if (m_item->HasArt(artKey) &&
-        !CTextureCache::Get().HasCachedImage(m_item->GetArt(artKey)))
-      CTextureCache::Get().BackgroundCacheImage(m_item->GetArt(artKey));
+    // cached right here and not queued on the texture cache, the order of these jobs is what
+    // decides which art shows up first
+    CTextureDetails details;
+    if (m_item->HasArt(artKey))
+      CTextureCache::Get().CacheImage(m_item->GetArt(artKey), details);
 
     if (ShouldCancel(i++, art.size()))
       return false;
@@ -513,6 +517,12 @@ bool CPlexTextureCacheJob::CacheTexture(CBaseTexture **texture)
     m_outputFile.Flush();
     m_inputFile.Close();
     m_outputFile.Close();
+
+    // a .dds made from what was there before is stale now, and so is how often it was shown
+    CStdString ddsPath = URIUtils::ReplaceExtension(CTextureCache::GetCachedPath(m_details.file), ".dds");
+    if (CFile::Exists(ddsPath))
+      CFile::Delete(ddsPath);
+    static_cast<CPlexTextureCache&>(CTextureCache::Get()).ForgetUseCount(m_details.file);
 	
     if (texture)
       *texture = CTextureCacheJob::LoadImage(CTextureCache::GetCachedPath(m_details.file), width, height, additional_info, true);
@@ -0,0 +1,82 @@
+#include "PlexTextureResidency.h"
+#include "system.h"
+#include "GUILargeTextureManager.h"
+#include "guilib/GUIFontManager.h"
+#include "guilib/TextureManager.h"
+#include "settings/AdvancedSettings.h"
+#include "log.h"
+
+/* FreeArt everything that isn't on screen */
+static const uint64_t ALL_OF_IT = (uint64_t)-1;
+
+static const uint64_t MEGABYTE = 1024 * 1024;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexTextureResidency::CPlexTextureResidency() : m_lowMemory(false)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexTextureResidency::Usage CPlexTextureResidency::GetUsage() const
+{
+  Usage usage;
+  usage.skin = g_TextureManager.GetMemoryUsage();
+  usage.fonts = g_fontManager.GetTextureMemoryUsage();
+  usage.art = g_largeTextureManager.GetMemoryUsage();
+  return usage;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTextureResidency::Process()
+{
+  // the signal comes in on some other thread, only the application thread can free textures
+  if (m_lowMemory)
+  {
+    m_lowMemory = false;
+    FreeArt(ALL_OF_IT, "low memory");
+  }
+
+  if (g_advancedSettings.m_guiLowMemoryThreshold)
+  {
+    MEMORYSTATUSEX stat;
+    stat.dwLength = sizeof(MEMORYSTATUSEX);
+    GlobalMemoryStatusEx(&stat);
+    if (stat.ullAvailPhys < (uint64_t)g_advancedSettings.m_guiLowMemoryThreshold * MEGABYTE)
+      FreeArt(ALL_OF_IT, "free memory below threshold");
+  }
+
+  if (g_advancedSettings.m_guiTextureMemoryBudget)
+  {
+    uint64_t budget = (uint64_t)g_advancedSettings.m_guiTextureMemoryBudget * MEGABYTE;
+    uint64_t total = GetUsage().Total();
+    if (total > budget)
+      FreeArt(total - budget, "over budget");
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTextureResidency::OnLowMemory()
+{
+  m_lowMemory = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTextureResidency::PlaybackStarting()
+{
+  FreeArt(ALL_OF_IT, "playback starting");
+
+  // the textures we dropped only give their memory back once the gpu handles are gone
+  g_TextureManager.FreeUnusedTextures();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTextureResidency::FreeArt(uint64_t bytes, const char *reason)
+{
+  uint64_t freed = g_largeTextureManager.FreeMemory(bytes);
+  if (freed == 0)
+    return;
+
+  Usage usage = GetUsage();
+  CLog::Log(LOGDEBUG, "CPlexTextureResidency::FreeArt %s, freed %.1fMB, now skin %.1fMB fonts %.1fMB art %.1fMB",
+            reason, (float)freed / MEGABYTE, (float)usage.skin / MEGABYTE, (float)usage.fonts / MEGABYTE, (float)usage.art / MEGABYTE);
+}
@@ -0,0 +1,51 @@
+#ifndef PLEXTEXTURERESIDENCY_H
+#define PLEXTEXTURERESIDENCY_H
+
+#include <boost/shared_ptr.hpp>
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* Keeps the textures of the GUI within a budget. The skin, fonts and art each have their own
+ * manager that unloads what isn't used after a while, none of them know how much the others
+ * hold. On boards where the GPU shares a few hundred MB with everything else that isn't enough:
+ * a library full of fanart leaves the video player without room for its buffers.
+ *
+ * We add up what the three hold and when it goes over the budget unload art that nothing shows
+ * anymore, the one released the longest ago first. What is on screen is never touched. Before
+ * playback, or when free memory runs low, all of the unused textures are dropped right away.
+ *
+ * Sizes are what was uploaded, the drivers don't tell us what they actually allocate. */
+class CPlexTextureResidency
+{
+public:
+  struct Usage
+  {
+    Usage() : skin(0), fonts(0), art(0) {}
+    uint64_t Total() const { return skin + fonts + art; }
+
+    uint64_t skin;
+    uint64_t fonts;
+    uint64_t art;
+  };
+
+  CPlexTextureResidency();
+
+  Usage GetUsage() const;
+
+  /* called from the application thread every now and then, enforces the budget and looks at
+   * the free memory */
+  void Process();
+
+  /* called before playback starts and when the system tells us memory is low */
+  void OnLowMemory();
+  void PlaybackStarting();
+
+private:
+  void FreeArt(uint64_t bytes, const char *reason);
+
+  bool m_lowMemory;
+};
+
+typedef boost::shared_ptr<CPlexTextureResidency> CPlexTextureResidencyPtr;
+
+#endif // PLEXTEXTURERESIDENCY_H
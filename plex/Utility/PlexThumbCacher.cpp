@@ -0,0 +1,269 @@
+#include "PlexThumbCacher.h"
+#include "PlexJobs.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "log.h"
+
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexThumbCacher::CPlexThumbCacher()
+  : m_stop(false), m_hasViewport(false), m_first(0), m_last(-1), m_direction(1), m_visiblePos(0),
+    m_aheadPos(0), m_behindPos(-1), m_aheadPicks(0), m_viewportStamp(0), m_visibleMissing(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexThumbCacher::~CPlexThumbCacher()
+{
+  Clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexThumbCacher::Load(const CFileItemList& list)
+{
+  CSingleLock lk(m_lock);
+
+  for (int i = 0; i < list.Size(); i++)
+  {
+    Item item;
+    item.item = list.Get(i);
+    item.state = InitialState(item.item);
+    m_items.push_back(item);
+  }
+
+  Fill();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexThumbCacher::Replace(int where, const CFileItemList& list)
+{
+  CSingleLock lk(m_lock);
+
+  int end = std::min(where + list.Size(), (int)m_items.size());
+  if (where < 0 || where >= end)
+    return;
+
+  // what was being cached for the old items is of no use anymore
+  std::map<unsigned int, int>::iterator it = m_jobs.begin();
+  while (it != m_jobs.end())
+  {
+    if (it->second >= where && it->second < end)
+    {
+      CancelItem(it->first);
+      m_jobs.erase(it++);
+    }
+    else
+      ++it;
+  }
+
+  for (int i = where; i < end; i++)
+  {
+    m_items[i].item = list.Get(i - where);
+    m_items[i].state = InitialState(m_items[i].item);
+  }
+
+  // the cursors may have gone past the range already, everything else is still done
+  ResetCursors();
+  if (m_hasViewport && where <= m_last && end > m_first)
+    CountVisibleMissing();
+
+  Fill();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexThumbCacher::Clear()
+{
+  CSingleLock lk(m_lock);
+
+  for (std::map<unsigned int, int>::iterator it = m_jobs.begin(); it != m_jobs.end(); ++it)
+    CancelItem(it->first);
+  m_jobs.clear();
+
+  m_items.clear();
+  m_hasViewport = false;
+  m_first = 0;
+  m_last = -1;
+  m_direction = 1;
+  m_viewportStamp = 0;
+  ResetCursors();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexThumbCacher::SetViewport(int first, int last)
+{
+  CSingleLock lk(m_lock);
+
+  first = std::max(first, 0);
+  last = std::min(last, (int)m_items.size() - 1);
+  if (first > last)
+    return;
+
+  if (m_hasViewport && first == m_first && last == m_last)
+    return;
+
+  if (m_hasViewport && first != m_first)
+    m_direction = first > m_first ? 1 : -1;
+
+  m_hasViewport = true;
+  m_first = first;
+  m_last = last;
+
+  // what is far away now can wait, it is picked again once we get there
+  int keep = (last - first + 1) * PLEX_THUMB_CACHER_CANCEL_PAGES;
+  std::map<unsigned int, int>::iterator it = m_jobs.begin();
+  while (it != m_jobs.end())
+  {
+    if (it->second < first - keep || it->second > last + keep)
+    {
+      CancelItem(it->first);
+      m_items[it->second].state = ITEM_PENDING;
+      m_jobs.erase(it++);
+    }
+    else
+      ++it;
+  }
+
+  ResetCursors();
+  CountVisibleMissing();
+
+  Fill();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexThumbCacher::Start()
+{
+  CSingleLock lk(m_lock);
+  m_stop = false;
+  Fill();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexThumbCacher::Stop()
+{
+  CSingleLock lk(m_lock);
+  m_stop = true;
+  Clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexThumbCacher::OnJobComplete(unsigned int jobID, bool success, CJob* job)
+{
+  CSingleLock lk(m_lock);
+
+  // cancelled or cleared while it completed
+  std::map<unsigned int, int>::iterator it = m_jobs.find(jobID);
+  if (it == m_jobs.end())
+    return;
+
+  int index = it->second;
+  m_jobs.erase(it);
+
+  // art that failed isn't tried again, the GUI will try when it shows it
+  m_items[index].state = ITEM_DONE;
+
+  if (m_viewportStamp && index >= m_first && index <= m_last && --m_visibleMissing == 0)
+  {
+    CLog::Log(LOGDEBUG, "CPlexThumbCacher::OnJobComplete art for items %d-%d is visible after %u ms",
+              m_first, m_last, XbmcThreads::SystemClockMillis() - m_viewportStamp);
+    m_viewportStamp = 0;
+  }
+
+  Fill();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int CPlexThumbCacher::QueueItem(const CFileItemPtr& item, bool visible)
+{
+  return CJobManager::GetInstance().AddJob(new CPlexVideoThumbLoaderJob(item), this,
+                                           visible ? CJob::PRIORITY_NORMAL : CJob::PRIORITY_LOW);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexThumbCacher::CancelItem(unsigned int jobID)
+{
+  CJobManager::GetInstance().CancelJob(jobID);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexThumbCacher::Fill()
+{
+  while (!m_stop && m_jobs.size() < PLEX_THUMB_CACHER_JOBS)
+  {
+    int index = PickNext();
+    if (index < 0)
+      break;
+
+    m_items[index].state = ITEM_QUEUED;
+    m_jobs[QueueItem(m_items[index].item, index >= m_first && index <= m_last)] = index;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexThumbCacher::ResetCursors()
+{
+  m_visiblePos = m_first;
+  m_aheadPos = m_direction > 0 ? m_last + 1 : m_first - 1;
+  m_behindPos = m_direction > 0 ? m_first - 1 : m_last + 1;
+  m_aheadPicks = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexThumbCacher::ItemState CPlexThumbCacher::InitialState(const CFileItemPtr& item)
+{
+  // keep them anyway so that the indexes match the list
+  return (item && item->IsPlexMediaServer()) ? ITEM_PENDING : ITEM_DONE;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexThumbCacher::CountVisibleMissing()
+{
+  m_visibleMissing = 0;
+  for (int i = m_first; i <= m_last; i++)
+  {
+    if (m_items[i].state != ITEM_DONE)
+      m_visibleMissing++;
+  }
+  m_viewportStamp = m_visibleMissing ? XbmcThreads::SystemClockMillis() : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+int CPlexThumbCacher::NextPending(int& pos, int step) const
+{
+  while (pos >= 0 && pos < (int)m_items.size())
+  {
+    if (m_items[pos].state == ITEM_PENDING)
+      return pos;
+    pos += step;
+  }
+  return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+int CPlexThumbCacher::PickNext()
+{
+  // what is on screen first
+  while (m_visiblePos <= m_last)
+  {
+    if (m_items[m_visiblePos].state == ITEM_PENDING)
+      return m_visiblePos;
+    m_visiblePos++;
+  }
+
+  int ahead = NextPending(m_aheadPos, m_direction);
+  int behind = NextPending(m_behindPos, -m_direction);
+
+  if (ahead >= 0 && (behind < 0 || m_aheadPicks < PLEX_THUMB_CACHER_AHEAD))
+  {
+    m_aheadPicks++;
+    return ahead;
+  }
+
+  if (behind >= 0)
+  {
+    m_aheadPicks = 0;
+    return behind;
+  }
+
+  return -1;
+}
@@ -0,0 +1,103 @@
+#ifndef PLEXTHUMBCACHER_H
+#define PLEXTHUMBCACHER_H
+
+#include <map>
+#include <vector>
+
+#include "FileItem.h"
+#include "JobManager.h"
+#include "threads/CriticalSection.h"
+
+/* how many items have their art cached at the same time */
+#define PLEX_THUMB_CACHER_JOBS 4
+
+/* outside the viewport this many items are taken in the scroll direction for every one behind */
+#define PLEX_THUMB_CACHER_AHEAD 2
+
+/* items that are being cached and end up this many viewports away are cancelled */
+#define PLEX_THUMB_CACHER_CANCEL_PAGES 2
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* Caches the art of a list in the background, the items on screen first. Whoever shows the list
+ * tells us which range of it is visible, from there we go outwards and further in the direction
+ * the list is scrolled in. When the viewport jumps what is far away from it is cancelled and
+ * picked up again later, so a jump into the middle of a large section doesn't wait for all the
+ * posters in front of it.
+ *
+ * Only a few items are handed to the job manager at a time, the rest are chosen when one of them
+ * completes. The time from a viewport change until all of its art is cached is logged. */
+class CPlexThumbCacher : public IJobCallback
+{
+public:
+  CPlexThumbCacher();
+  virtual ~CPlexThumbCacher();
+
+  /* adds the items of list, they are cached in list order until there is a viewport */
+  void Load(const CFileItemList& list);
+
+  /* the items from where on were replaced by those of list, only they are cached again. What
+   * the rest of the items is at and the viewport are kept */
+  void Replace(int where, const CFileItemList& list);
+
+  /* forgets the items and cancels what is being cached */
+  void Clear();
+
+  /* the items from first to last are on screen, they index what was loaded */
+  void SetViewport(int first, int last);
+
+  void Start();
+  void Stop();
+
+  void OnJobComplete(unsigned int jobID, bool success, CJob* job);
+
+protected:
+  /* starts caching the item, returns the job that does it */
+  virtual unsigned int QueueItem(const CFileItemPtr& item, bool visible);
+  virtual void CancelItem(unsigned int jobID);
+
+private:
+  enum ItemState
+  {
+    ITEM_PENDING,
+    ITEM_QUEUED,
+    ITEM_DONE
+  };
+
+  struct Item
+  {
+    CFileItemPtr item;
+    ItemState state;
+  };
+
+  /* the next item to cache, -1 if there is none */
+  int PickNext();
+  int NextPending(int& pos, int step) const;
+  static ItemState InitialState(const CFileItemPtr& item);
+  void CountVisibleMissing();
+  void Fill();
+  void ResetCursors();
+
+  CCriticalSection m_lock;
+  bool m_stop;
+
+  std::vector<Item> m_items;
+
+  /* job id -> index of the item it caches */
+  std::map<unsigned int, int> m_jobs;
+
+  bool m_hasViewport;
+  int m_first;
+  int m_last;
+  int m_direction;
+
+  /* everything between the viewport and the cursors has been picked */
+  int m_visiblePos;
+  int m_aheadPos;
+  int m_behindPos;
+  int m_aheadPicks;
+
+  unsigned int m_viewportStamp;
+  int m_visibleMissing;
+};
+
+#endif // PLEXTHUMBCACHER_H
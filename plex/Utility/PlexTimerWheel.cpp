@@ -0,0 +1,239 @@
+#include "PlexTimerWheel.h"
+
+#include <algorithm>
+#include <string.h>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexTimerWheel::CPlexTimerWheel(int64_t now, int tickMs) : m_tickMs(tickMs), m_tick(now / tickMs)
+{
+  memset(m_root, 0, sizeof(m_root));
+  memset(m_levels, 0, sizeof(m_levels));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+CPlexTimerWheel::~CPlexTimerWheel()
+{
+  clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+int64_t CPlexTimerWheel::scheduledTime(int64_t now, int64_t expires) const
+{
+  int64_t tick = (expires + m_tickMs - 1) / m_tickMs;
+
+  // round up to a power of two of ticks within the slack, timeouts that end up on the same
+  // boundary fire together
+  int64_t slack = std::min<int64_t>(std::max<int64_t>(expires - now, 0) / PLEX_TIMER_SLACK_DIVISOR,
+                                    PLEX_TIMER_MAX_SLACK_MS) / m_tickMs;
+  int64_t granule = 1;
+  while (granule * 2 <= slack)
+    granule *= 2;
+
+  tick = (tick + granule - 1) / granule * granule;
+  return tick * m_tickMs;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTimerWheel::add(IPlexGlobalTimeout* callback, int64_t now, int64_t expires)
+{
+  Entry* entry;
+
+  boost::unordered_map<IPlexGlobalTimeout*, Entry*>::iterator it = m_entries.find(callback);
+  if (it != m_entries.end())
+  {
+    entry = it->second;
+    unlink(entry);
+  }
+  else
+  {
+    entry = new Entry;
+    entry->callback = callback;
+    m_entries[callback] = entry;
+  }
+
+  entry->expires = expires;
+  entry->tick = scheduledTime(now, expires) / m_tickMs;
+  place(entry);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexTimerWheel::remove(IPlexGlobalTimeout* callback)
+{
+  boost::unordered_map<IPlexGlobalTimeout*, Entry*>::iterator it = m_entries.find(callback);
+  if (it == m_entries.end())
+    return false;
+
+  unlink(it->second);
+  delete it->second;
+  m_entries.erase(it);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool CPlexTimerWheel::contains(IPlexGlobalTimeout* callback) const
+{
+  return m_entries.find(callback) != m_entries.end();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTimerWheel::clear()
+{
+  for (boost::unordered_map<IPlexGlobalTimeout*, Entry*>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    delete it->second;
+  m_entries.clear();
+
+  memset(m_root, 0, sizeof(m_root));
+  memset(m_levels, 0, sizeof(m_levels));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTimerWheel::getAll(std::vector<std::pair<int64_t, IPlexGlobalTimeout*> >& timeouts) const
+{
+  for (boost::unordered_map<IPlexGlobalTimeout*, Entry*>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    timeouts.push_back(std::make_pair(it->second->expires, it->first));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTimerWheel::link(Entry* entry, Entry** slot)
+{
+  entry->prev = NULL;
+  entry->next = *slot;
+  if (entry->next)
+    entry->next->prev = entry;
+  *slot = entry;
+  entry->slot = slot;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTimerWheel::unlink(Entry* entry)
+{
+  if (entry->prev)
+    entry->prev->next = entry->next;
+  else
+    *entry->slot = entry->next;
+
+  if (entry->next)
+    entry->next->prev = entry->prev;
+
+  entry->prev = entry->next = NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTimerWheel::place(Entry* entry)
+{
+  int64_t delta = entry->tick - m_tick;
+
+  // overdue ones go into the slot processed next
+  if (delta < ROOT_SIZE)
+  {
+    link(entry, &m_root[(delta < 0 ? m_tick : entry->tick) & ROOT_MASK]);
+    return;
+  }
+
+  // the ones too far out are parked in the last slot that can hold them, they are placed
+  // again when that slot moves down
+  int64_t tick = std::min(entry->tick, m_tick + maxTicks());
+
+  int level = 0;
+  while (level < LEVELS - 1 && delta >= ((int64_t)1 << levelShift(level + 1)))
+    level++;
+
+  link(entry, &m_levels[level][(tick >> levelShift(level)) & LEVEL_MASK]);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTimerWheel::cascade(int level, int index)
+{
+  Entry* entry = m_levels[level][index];
+  m_levels[level][index] = NULL;
+
+  while (entry)
+  {
+    Entry* next = entry->next;
+    place(entry);
+    entry = next;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void CPlexTimerWheel::advance(int64_t now, std::vector<Expired>& expired)
+{
+  int64_t nowTick = now / m_tickMs;
+
+  while (m_tick <= nowTick)
+  {
+    // skip straight over the ticks where nothing happens
+    int64_t next = nextEvent();
+    if (next < 0 || next / m_tickMs > nowTick)
+    {
+      m_tick = nowTick + 1;
+      break;
+    }
+    m_tick = std::max(m_tick, next / m_tickMs);
+
+    // move the timeouts of the coming block down a level
+    int index = m_tick & ROOT_MASK;
+    for (int level = 0; index == 0 && level < LEVELS; level++)
+    {
+      index = (m_tick >> levelShift(level)) & LEVEL_MASK;
+      cascade(level, index);
+    }
+
+    Entry* entry = m_root[m_tick & ROOT_MASK];
+    m_root[m_tick & ROOT_MASK] = NULL;
+
+    while (entry)
+    {
+      Entry* nextEntry = entry->next;
+
+      Expired e = { entry->callback, entry->expires };
+      expired.push_back(e);
+      m_entries.erase(entry->callback);
+      delete entry;
+
+      entry = nextEntry;
+    }
+
+    m_tick++;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+int64_t CPlexTimerWheel::nextEvent() const
+{
+  if (m_entries.empty())
+    return -1;
+
+  int64_t next = -1;
+
+  for (int i = 0; i < ROOT_SIZE; i++)
+  {
+    if (m_root[(m_tick + i) & ROOT_MASK])
+    {
+      next = m_tick + i;
+      break;
+    }
+  }
+
+  // a slot of the levels above is due when the ticks reach the start of its block
+  for (int level = 0; level < LEVELS; level++)
+  {
+    int64_t block = (int64_t)1 << levelShift(level);
+    int64_t start = (m_tick + block - 1) & ~(block - 1);
+
+    for (int i = 0; i < LEVEL_SIZE; i++)
+    {
+      int64_t tick = start + i * block;
+      if (next != -1 && tick >= next)
+        break;
+
+      if (m_levels[level][(tick >> levelShift(level)) & LEVEL_MASK])
+      {
+        next = tick;
+        break;
+      }
+    }
+  }
+
+  return next == -1 ? -1 : next * m_tickMs;
+}
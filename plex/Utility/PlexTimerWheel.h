@@ -0,0 +1,102 @@
+#ifndef PLEXTIMERWHEEL_H
+#define PLEXTIMERWHEEL_H
+
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+class IPlexGlobalTimeout;
+
+/* the resolution of the wheel */
+#define PLEX_TIMER_TICK_MS 10
+
+/* timeouts may fire up to 1/16th of their delay late, at most this much, so that the ones
+ * that are close to each other fire together and the timer thread wakes up less often */
+#define PLEX_TIMER_SLACK_DIVISOR 16
+#define PLEX_TIMER_MAX_SLACK_MS 1000
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* Hierarchical timing wheel holding one timeout per callback. Adding and removing a timeout are
+ * O(1), advancing costs O(1) per tick plus the timeouts that expire or move down a level. The
+ * first level covers 2.56 seconds at tick resolution, each of the three levels above covers 64
+ * times the one below, timeouts further out than that (about a week) are clamped.
+ *
+ * Times are absolute milliseconds on a clock the owner chooses, the wheel is not locked. */
+class CPlexTimerWheel
+{
+  public:
+    struct Expired
+    {
+      IPlexGlobalTimeout* callback;
+      /* the time the timeout was asked for */
+      int64_t expires;
+    };
+
+    CPlexTimerWheel(int64_t now, int tickMs = PLEX_TIMER_TICK_MS);
+    ~CPlexTimerWheel();
+
+    /* schedules callback at expires, replacing the timeout it had */
+    void add(IPlexGlobalTimeout* callback, int64_t now, int64_t expires);
+    bool remove(IPlexGlobalTimeout* callback);
+    bool contains(IPlexGlobalTimeout* callback) const;
+    void clear();
+
+    /* moves the wheel up to now and appends the timeouts that expired, in order */
+    void advance(int64_t now, std::vector<Expired>& expired);
+
+    /* the time advance has something to do next, the expiry of the next timeout or the time it
+     * moves down a level. -1 when the wheel is empty */
+    int64_t nextEvent() const;
+
+    /* the requested expiry of every timeout, not in any order */
+    void getAll(std::vector<std::pair<int64_t, IPlexGlobalTimeout*> >& timeouts) const;
+
+    size_t size() const { return m_entries.size(); }
+
+    /* the time a timeout will actually be scheduled for */
+    int64_t scheduledTime(int64_t now, int64_t expires) const;
+
+  private:
+    struct Entry
+    {
+      IPlexGlobalTimeout* callback;
+      int64_t expires;
+      int64_t tick;
+      Entry* prev;
+      Entry* next;
+      Entry** slot;
+    };
+
+    enum
+    {
+      ROOT_BITS = 8,
+      LEVEL_BITS = 6,
+      ROOT_SIZE = 1 << ROOT_BITS,
+      LEVEL_SIZE = 1 << LEVEL_BITS,
+      ROOT_MASK = ROOT_SIZE - 1,
+      LEVEL_MASK = LEVEL_SIZE - 1,
+      LEVELS = 3
+    };
+
+    void place(Entry* entry);
+    void link(Entry* entry, Entry** slot);
+    void unlink(Entry* entry);
+    void cascade(int level, int index);
+
+    static int levelShift(int level) { return ROOT_BITS + level * LEVEL_BITS; }
+    static int64_t maxTicks() { return ((int64_t)1 << levelShift(LEVELS)) - 1; }
+
+    int m_tickMs;
+
+    /* the next tick advance will process */
+    int64_t m_tick;
+
+    Entry* m_root[ROOT_SIZE];
+    Entry* m_levels[LEVELS][LEVEL_SIZE];
+
+    boost::unordered_map<IPlexGlobalTimeout*, Entry*> m_entries;
+};
+
+#endif // PLEXTIMERWHEEL_H
@@ -0,0 +1,249 @@
+#include "PlexTest.h"
+#include "PlexThumbCacher.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/* records the items it is asked to cache instead of running jobs for them */
+class RecordingThumbCacher : public CPlexThumbCacher
+{
+public:
+  RecordingThumbCacher() : m_nextId(1) {}
+  ~RecordingThumbCacher() { Clear(); }
+
+  /* completes the job for the item at index, as if its art was cached */
+  void complete(int index)
+  {
+    std::map<int, unsigned int>::iterator it = m_queued.find(index);
+    ASSERT_TRUE(it != m_queued.end());
+    unsigned int id = it->second;
+    m_queued.erase(it);
+    OnJobComplete(id, true, NULL);
+  }
+
+  bool isQueued(int index) const { return m_queued.find(index) != m_queued.end(); }
+
+  std::vector<int> m_order;
+  std::vector<int> m_cancelled;
+  std::map<int, unsigned int> m_queued; // index -> job id
+
+protected:
+  unsigned int QueueItem(const CFileItemPtr& item, bool visible)
+  {
+    int index = item->GetProperty("index").asInteger();
+    m_order.push_back(index);
+    m_queued[index] = m_nextId;
+    return m_nextId++;
+  }
+
+  void CancelItem(unsigned int jobID)
+  {
+    for (std::map<int, unsigned int>::iterator it = m_queued.begin(); it != m_queued.end(); ++it)
+    {
+      if (it->second == jobID)
+      {
+        m_cancelled.push_back(it->first);
+        m_queued.erase(it);
+        return;
+      }
+    }
+  }
+
+  unsigned int m_nextId;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+static void fillList(CFileItemList& list, int count)
+{
+  for (int i = 0; i < count; i++)
+  {
+    CFileItemPtr item(new CFileItem("item"));
+    item->SetPath("plexserver://abc123/library/metadata/" + boost::lexical_cast<std::string>(i));
+    item->SetProperty("plex", true);
+    item->SetProperty("index", i);
+    list.Add(item);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexThumbCacher, listOrderWithoutViewport)
+{
+  CFileItemList list;
+  fillList(list, 10);
+
+  RecordingThumbCacher cacher;
+  cacher.Load(list);
+
+  ASSERT_EQ((size_t)PLEX_THUMB_CACHER_JOBS, cacher.m_order.size());
+  for (int i = 0; i < PLEX_THUMB_CACHER_JOBS; i++)
+    EXPECT_EQ(i, cacher.m_order[i]);
+
+  cacher.complete(0);
+  EXPECT_EQ(PLEX_THUMB_CACHER_JOBS, cacher.m_order.back());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexThumbCacher, visibleFirstAndFarAwayCancelled)
+{
+  CFileItemList list;
+  fillList(list, 1000);
+
+  RecordingThumbCacher cacher;
+  cacher.Load(list);
+  cacher.m_order.clear();
+
+  // jump into the middle of the list
+  cacher.SetViewport(500, 509);
+
+  EXPECT_EQ((size_t)PLEX_THUMB_CACHER_JOBS, cacher.m_cancelled.size());
+  ASSERT_EQ((size_t)PLEX_THUMB_CACHER_JOBS, cacher.m_order.size());
+  for (int i = 0; i < PLEX_THUMB_CACHER_JOBS; i++)
+    EXPECT_EQ(500 + i, cacher.m_order[i]);
+
+  // the rest of the viewport before anything else
+  for (int i = 0; i < 10; i++)
+    cacher.complete(500 + i);
+
+  for (int i = 0; i < 10; i++)
+    EXPECT_EQ(500 + i, cacher.m_order[i]);
+
+  // what was cancelled isn't lost
+  cacher.SetViewport(0, 9);
+  EXPECT_TRUE(cacher.isQueued(0));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexThumbCacher, aheadInScrollDirection)
+{
+  CFileItemList list;
+  fillList(list, 100);
+
+  RecordingThumbCacher cacher;
+  cacher.Load(list);
+  cacher.SetViewport(0, 3);
+  for (int i = 0; i < 4; i++)
+    cacher.complete(i);
+
+  // scrolling down, what was queued ahead of the old viewport is too far away now
+  cacher.m_order.clear();
+  cacher.SetViewport(20, 23);
+  ASSERT_EQ((size_t)4, cacher.m_order.size());
+  EXPECT_EQ(20, cacher.m_order[0]);
+  EXPECT_EQ(23, cacher.m_order[3]);
+
+  cacher.m_order.clear();
+  for (int i = 20; i < 26; i++)
+    cacher.complete(i);
+
+  // two below the viewport for each one above it
+  std::vector<int> expected;
+  expected.push_back(24);
+  expected.push_back(25);
+  expected.push_back(19);
+  expected.push_back(26);
+  expected.push_back(27);
+  expected.push_back(18);
+  EXPECT_EQ(expected, cacher.m_order);
+
+  // and the other way round when scrolling up, 18 and 19 are still being cached
+  cacher.SetViewport(10, 13);
+  cacher.m_order.clear();
+  for (int i = 10; i < 14; i++)
+    cacher.complete(i);
+  cacher.complete(18);
+  cacher.complete(19);
+
+  expected.clear();
+  expected.push_back(12);
+  expected.push_back(13);
+  expected.push_back(9);
+  expected.push_back(8);
+  expected.push_back(14);
+  expected.push_back(7);
+  EXPECT_EQ(expected, cacher.m_order);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexThumbCacher, replacedPageOnly)
+{
+  CFileItemList list;
+  fillList(list, 40);
+
+  RecordingThumbCacher cacher;
+  cacher.Load(list);
+  cacher.SetViewport(0, 3);
+  for (int i = 0; i < 12; i++)
+    cacher.complete(i);
+
+  // a page at 20 came in while 12-15 are being cached
+  CFileItemList page;
+  fillList(page, 30);
+  for (int i = 0; i < 20; i++)
+    page.Remove(0);
+
+  cacher.m_order.clear();
+  cacher.Replace(20, page);
+  EXPECT_TRUE(cacher.m_cancelled.empty());
+  EXPECT_TRUE(cacher.m_order.empty());
+
+  // what was done isn't cached again, the page is once the cursors get there
+  for (int i = 12; i < 40; i++)
+    cacher.complete(i);
+  for (size_t i = 0; i < cacher.m_order.size(); i++)
+    EXPECT_GE(cacher.m_order[i], 16);
+  EXPECT_EQ((size_t)24, cacher.m_order.size());
+  EXPECT_TRUE(cacher.m_queued.empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexThumbCacher, replacingCancelsTheOldItems)
+{
+  CFileItemList list;
+  fillList(list, 10);
+
+  RecordingThumbCacher cacher;
+  cacher.Load(list);
+  cacher.SetViewport(0, 3);
+
+  CFileItemList page;
+  fillList(page, 2);
+  cacher.m_order.clear();
+  cacher.Replace(0, page);
+
+  std::vector<int> expected;
+  expected.push_back(0);
+  expected.push_back(1);
+  EXPECT_EQ(expected, cacher.m_cancelled);
+  EXPECT_EQ(expected, cacher.m_order);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexThumbCacher, clearForgetsEverything)
+{
+  CFileItemList list;
+  fillList(list, 10);
+
+  RecordingThumbCacher cacher;
+  cacher.Load(list);
+  cacher.Clear();
+
+  EXPECT_EQ((size_t)PLEX_THUMB_CACHER_JOBS, cacher.m_cancelled.size());
+  EXPECT_TRUE(cacher.m_queued.empty());
+
+  // a late completion is ignored
+  cacher.OnJobComplete(1, true, NULL);
+  EXPECT_EQ((size_t)PLEX_THUMB_CACHER_JOBS, cacher.m_order.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PlexThumbCacher, stoppedDoesNothing)
+{
+  CFileItemList list;
+  fillList(list, 10);
+
+  RecordingThumbCacher cacher;
+  cacher.Stop();
+  cacher.Load(list);
+  EXPECT_TRUE(cacher.m_order.empty());
+
+  cacher.Start();
+  EXPECT_EQ((size_t)PLEX_THUMB_CACHER_JOBS, cacher.m_order.size());
+}
@@ -0,0 +1,252 @@
+#include "PlexTest.h"
+#include "PlexTimerWheel.h"
+#include "PlexGlobalTimer.h"
+#include "threads/Event.h"
+
+#include <map>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class CountingTimeout : public IPlexGlobalTimeout
+{
+public:
+  CountingTimeout(CCriticalSection& lock, CEvent& done, int& remaining)
+    : m_lock(lock), m_done(done), m_remaining(remaining), fired(0) {}
+
+  void OnTimeout()
+  {
+    CSingleLock lk(m_lock);
+    fired++;
+    if (--m_remaining == 0)
+      m_done.Set();
+  }
+
+  CStdString TimerName() const { return "counting"; }
+
+  CCriticalSection& m_lock;
+  CEvent& m_done;
+  int& m_remaining;
+  int fired;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class PlexTimerWheelTests : public ::testing::Test
+{
+public:
+  PlexTimerWheelTests() : wheel(1000), remaining(0)
+  {
+    for (int i = 0; i < 8; i++)
+      timeouts.push_back(new CountingTimeout(lock, done, remaining));
+  }
+
+  ~PlexTimerWheelTests()
+  {
+    for (size_t i = 0; i < timeouts.size(); i++)
+      delete timeouts[i];
+  }
+
+  std::vector<IPlexGlobalTimeout*> advance(int64_t now)
+  {
+    std::vector<CPlexTimerWheel::Expired> expired;
+    wheel.advance(now, expired);
+
+    std::vector<IPlexGlobalTimeout*> callbacks;
+    for (size_t i = 0; i < expired.size(); i++)
+      callbacks.push_back(expired[i].callback);
+    return callbacks;
+  }
+
+  CPlexTimerWheel wheel;
+  std::vector<CountingTimeout*> timeouts;
+
+  CCriticalSection lock;
+  CEvent done;
+  int remaining;
+};
+
+TEST_F(PlexTimerWheelTests, firesInOrder)
+{
+  wheel.add(timeouts[0], 1000, 1100);
+  wheel.add(timeouts[1], 1000, 1050);
+  EXPECT_EQ(2, wheel.size());
+  EXPECT_EQ(1050, wheel.nextEvent());
+
+  EXPECT_TRUE(advance(1049).empty());
+
+  std::vector<IPlexGlobalTimeout*> fired = advance(1050);
+  ASSERT_EQ(1, fired.size());
+  EXPECT_EQ(timeouts[1], fired[0]);
+  EXPECT_EQ(1100, wheel.nextEvent());
+
+  fired = advance(1200);
+  ASSERT_EQ(1, fired.size());
+  EXPECT_EQ(timeouts[0], fired[0]);
+  EXPECT_EQ(0, wheel.size());
+  EXPECT_EQ(-1, wheel.nextEvent());
+}
+
+TEST_F(PlexTimerWheelTests, overdue)
+{
+  advance(5000);
+  wheel.add(timeouts[0], 5000, 4000);
+
+  std::vector<CPlexTimerWheel::Expired> expired;
+  wheel.advance(5010, expired);
+  ASSERT_EQ(1, expired.size());
+  EXPECT_EQ(4000, expired[0].expires);
+}
+
+TEST_F(PlexTimerWheelTests, removeAndRestart)
+{
+  wheel.add(timeouts[0], 1000, 1500);
+  wheel.add(timeouts[1], 1000, 1500);
+  EXPECT_TRUE(wheel.remove(timeouts[0]));
+  EXPECT_FALSE(wheel.remove(timeouts[0]));
+  EXPECT_FALSE(wheel.contains(timeouts[0]));
+
+  // adding it again moves it
+  wheel.add(timeouts[1], 1000, 3000);
+  EXPECT_EQ(1, wheel.size());
+  EXPECT_TRUE(advance(2000).empty());
+  EXPECT_EQ(1, advance(3500).size());
+}
+
+TEST_F(PlexTimerWheelTests, longTimeoutsCascade)
+{
+  // one on each level and one beyond the wheel
+  const int64_t delays[] = { 200, 30 * 1000, 10 * 60 * 1000, 3 * 3600 * 1000LL, 14 * 24 * 3600 * 1000LL };
+  for (int i = 0; i < 5; i++)
+    wheel.add(timeouts[i], 1000, 1000 + delays[i]);
+
+  for (int i = 0; i < 5; i++)
+  {
+    int64_t expires = 1000 + delays[i];
+    int64_t scheduled = wheel.scheduledTime(1000, expires);
+    EXPECT_GE(scheduled, expires);
+    EXPECT_LE(scheduled, expires + PLEX_TIMER_MAX_SLACK_MS + PLEX_TIMER_TICK_MS);
+
+    // the wheel only wakes up to move things down before that
+    int64_t now = 1000;
+    while (true)
+    {
+      int64_t next = wheel.nextEvent();
+      ASSERT_GT(next, now);
+      ASSERT_LE(next, scheduled);
+
+      now = next;
+      std::vector<IPlexGlobalTimeout*> fired = advance(now);
+      if (!fired.empty())
+      {
+        ASSERT_EQ(1, fired.size());
+        EXPECT_EQ(timeouts[i], fired[0]);
+        EXPECT_EQ(scheduled, now);
+        break;
+      }
+    }
+  }
+
+  EXPECT_EQ(0, wheel.size());
+}
+
+TEST_F(PlexTimerWheelTests, coalesce)
+{
+  // close long timeouts share a wakeup, short ones stay precise
+  wheel.add(timeouts[0], 1000, 1000 + 60 * 1000);
+  wheel.add(timeouts[1], 1000, 1000 + 60 * 1000 + 230);
+  EXPECT_EQ(wheel.scheduledTime(1000, 61000), wheel.scheduledTime(1000, 61230));
+
+  EXPECT_EQ(1030, wheel.scheduledTime(1000, 1030));
+  EXPECT_EQ(1040, wheel.scheduledTime(1000, 1031));
+
+  EXPECT_EQ(2, advance(wheel.nextEvent()).size());
+}
+
+TEST_F(PlexTimerWheelTests, thousands)
+{
+  const int count = 20000;
+  std::vector<CountingTimeout*> many;
+  std::map<IPlexGlobalTimeout*, int64_t> expiry;
+
+  unsigned int seed = 1;
+  for (int i = 0; i < count; i++)
+  {
+    many.push_back(new CountingTimeout(lock, done, remaining));
+
+    seed = seed * 1103515245 + 12345;
+    int64_t expires = 1000 + (seed >> 8) % (2 * 3600 * 1000);
+    wheel.add(many[i], 1000, expires);
+    expiry[many[i]] = expires;
+  }
+
+  // restart some and drop some
+  for (int i = 0; i < count; i += 10)
+  {
+    wheel.add(many[i], 1000, 5000);
+    expiry[many[i]] = 5000;
+  }
+  for (int i = 5; i < count; i += 10)
+  {
+    wheel.remove(many[i]);
+    expiry.erase(many[i]);
+  }
+  EXPECT_EQ(expiry.size(), wheel.size());
+
+  int fired = 0;
+  int64_t now = 1000;
+  while (wheel.size())
+  {
+    now += 777;
+
+    std::vector<CPlexTimerWheel::Expired> expired;
+    wheel.advance(now, expired);
+
+    for (size_t i = 0; i < expired.size(); i++)
+    {
+      ASSERT_EQ(1, expiry.count(expired[i].callback));
+      int64_t expires = expiry[expired[i].callback];
+      EXPECT_EQ(expires, expired[i].expires);
+      EXPECT_LE(wheel.scheduledTime(1000, expires), now);
+      EXPECT_GT(wheel.scheduledTime(1000, expires), now - 777);
+      expiry.erase(expired[i].callback);
+      fired++;
+    }
+  }
+
+  EXPECT_EQ(count - count / 10, fired);
+  EXPECT_TRUE(expiry.empty());
+
+  for (int i = 0; i < count; i++)
+    delete many[i];
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(PlexTimerWheelTests, globalTimerThousands)
+{
+  const int count = 2000;
+  std::vector<CountingTimeout*> many;
+
+  remaining = count;
+  CPlexGlobalTimer timer;
+  for (int i = 0; i < count; i++)
+  {
+    many.push_back(new CountingTimeout(lock, done, remaining));
+    timer.SetTimeout(10 + i % 500, many[i]);
+  }
+
+  // restarting doesn't fire twice
+  for (int i = 0; i < count; i += 4)
+    timer.RestartTimeout(20 + i % 300, many[i]);
+
+  EXPECT_TRUE(done.WaitMSec(10000));
+  timer.StopAllTimers();
+
+  for (int i = 0; i < count; i++)
+  {
+    EXPECT_EQ(1, many[i]->fired);
+    delete many[i];
+  }
+
+  CPlexGlobalTimer::Stats stats = timer.GetStats();
+  EXPECT_EQ(count, stats.fired);
+  printf("global timer: %d timeouts, %lld ms late on average, %lld ms at most\n",
+         count, (long long)(stats.totalLateness / (int64_t)stats.fired), (long long)stats.maxLateness);
+}
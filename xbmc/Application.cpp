@@ -360,6 +360,8 @@
 #include "plex/GUI/GUIWindowPlexMyChannels.h"
 #include "settings/GUISettings.h"
 #include "plex/PlexMediaDecisionEngine.h"
+#include "plex/Client/PlexPlaybackPrefetcher.h"
+#include "plex/Utility/PlexTextureResidency.h"
 #include "plex/Remote/PlexHTTPRemoteHandler.h"
 #include "plex/Remote/PlexRemoteSubscriberManager.h"
 #include "plex/CrashReporter/Breakpad.h"
@@ -2595,6 +2597,11 @@ void CApplication::Render()
   if(!g_Windowing.BeginRender())
     return;
 
+  /* PLEX */
+  // what was decoded since the last frame, as much as fits into this one
+  g_largeTextureManager.UploadTextures();
+  /* END PLEX */
+
   CDirtyRegionList dirtyRegions = g_windowManager.GetDirty();
   if (RenderNoPresent())
     hasRendered = true;
@@ -2604,7 +2611,12 @@ void CApplication::Render()
   // reset our info cache - we do this at the end of Render so that it is
   // fresh for the next process(), or after a windowclose animation (where process()
   // isn't called)
+#ifndef __PLEX__
   g_infoManager.ResetCache();
+#else
+  // only conditions whose inputs changed since the last frame get re-evaluated
+  g_infoManager.NewFrame();
+#endif
   lock.Leave();
 
   unsigned int now = XbmcThreads::SystemClockMillis();
@@ -4582,6 +4594,10 @@ bool CApplication::PlayFile(const CFileItem& item_, bool bRestart)
   {
     /* PLEX */
     g_plexApplication.themeMusicPlayer->pauseThemeMusic();
+
+    // the video player needs the memory the art we aren't showing holds
+    if (item.IsVideo() && g_plexApplication.textureResidency)
+      g_plexApplication.textureResidency->PlaybackStarting();
     /* END PLEX */
 
     // don't hold graphicscontext here since player
@@ -5408,6 +5424,12 @@ bool CApplication::OnMessage(CGUIMessage& message)
 
       DimLCDOnPlayback(true);
 
+      /* PLEX */
+      // the video player reports its first frame itself
+      if (IsPlayingAudio() && g_plexApplication.playbackPrefetcher)
+        g_plexApplication.playbackPrefetcher->PlaybackStarted();
+      /* END PLEX */
+
       if (IsPlayingAudio())
       {
         // Start our cdg parser as appropriate
@@ -5456,6 +5478,20 @@ bool CApplication::OnMessage(CGUIMessage& message)
 
       // ok, grab the next song
       CFileItem file(*playlist[iNext]);
+
+      /* PLEX */
+      // hand the player what was resolved ahead, there is no time to block on the server here
+      if (file.IsPlexMediaServer() && !file.GetProperty("isResolved").asBoolean() && g_plexApplication.playbackPrefetcher)
+      {
+        CFileItem resolved;
+        if (g_plexApplication.playbackPrefetcher->GetResolved(file, resolved))
+        {
+          CLog::Log(LOGDEBUG, "CApplication::OnMessage queueing %s, it was resolved ahead", resolved.GetPath().c_str());
+          file = resolved;
+        }
+      }
+      /* END PLEX */
+
       // handle plugin://
       CURL url(file.GetPath());
       if (url.GetProtocol() == "plugin")
@@ -5511,6 +5547,16 @@ bool CApplication::OnMessage(CGUIMessage& message)
         }
       }
 
+      /* PLEX */
+      if (g_plexApplication.playbackPrefetcher)
+      {
+        if (message.GetMessage() == GUI_MSG_PLAYBACK_ENDED)
+          g_plexApplication.playbackPrefetcher->PlaybackEnded();
+        else
+          g_plexApplication.playbackPrefetcher->PlaybackStopped();
+      }
+      /* END PLEX */
+
       // In case playback ended due to user eg. skipping over the end, clear
       // our resume bookmark here
       if (message.GetMessage() == GUI_MSG_PLAYBACK_ENDED && m_progressTrackingPlayCountUpdate && g_advancedSettings.m_videoIgnorePercentAtEnd > 0)
@@ -5714,6 +5760,16 @@ void CApplication::ProcessSlow()
   // Store our file state for use on close()
   UpdateFileState();
 
+  /* PLEX */
+  // resolve the next item of the play queue before this one ends
+  if (g_plexApplication.playbackPrefetcher && IsPlaying() && !IsPaused() && m_itemCurrentFile->IsPlexMediaServer())
+  {
+    double totalTime = GetTotalTime();
+    if (totalTime > 0 && totalTime - GetTime() < PLEX_LOOKAHEAD_S)
+      g_plexApplication.playbackPrefetcher->LookAhead();
+  }
+  /* END PLEX */
+
   if (IsPlayingAudio())
   {
     CLastfmScrobbler::GetInstance()->UpdateStatus();
@@ -5768,6 +5824,11 @@ void CApplication::ProcessSlow()
   if (!IsPlayingVideo())
     g_largeTextureManager.CleanupUnusedImages();
 
+  /* PLEX */
+  if (g_plexApplication.textureResidency)
+    g_plexApplication.textureResidency->Process();
+  /* END PLEX */
+
   g_TextureManager.FreeUnusedTextures();
 
 #ifdef HAS_DVD_DRIVE
@@ -84,6 +84,7 @@
 /* PLEX */
 #include "ThumbLoader.h"
 #include "guilib/GUILabelControl.h"
+#include "guilib/GUITexture.h"
 #include "GUI/GUIWindowPlexSearch.h"
 #include "GUI/GUIWindowNowPlaying.h"
 #include "playlists/PlayList.h"
@@ -95,6 +96,8 @@
 #include "GUI/GUIPlexMediaWindow.h"
 #include "Playlists/PlexPlayQueueManager.h"
 #include "GUI/GUIDialogPlexUserSelect.h"
+#include "Utility/PlexTextureResidency.h"
+#include "GUILargeTextureManager.h"
 
 using namespace PLAYLIST;
 /* END PLEX */
@@ -136,6 +139,14 @@ CGUIInfoManager::CGUIInfoManager(void) :
   /* PLEX */
   m_slideshowShowDescription = false;
   m_musicThumbLoader = new CMusicThumbLoader();//(1, 200);
+
+  m_dependencyCounter = m_updateTime;
+  for (unsigned int i = 0; i < INFO_DEPENDS_COUNT; i++)
+    m_dependencyVersions[i] = m_updateTime;
+  m_dependencyPlaying = false;
+  m_dependencyWindowVersion = 0;
+  m_frameEvaluations = m_frameSkips = 0;
+  m_lastFrameEvaluations = m_lastFrameSkips = 0;
   /* END PLEX */
 
   ResetLibraryBools();
@@ -163,10 +174,20 @@ bool CGUIInfoManager::OnMessage(CGUIMessage &message)
       if (m_currentFile->IsSamePath(item.get()))
       {
         m_currentFile->UpdateInfo(*item);
+        /* PLEX */
+        InvalidateDependencies(INFO_DEPENDS_PLAYER);
+        /* END PLEX */
         return true;
       }
     }
   }
+
+  /* PLEX */
+  // server, myPlex and play queue changes are all announced through these
+  int msg = message.GetMessage() == GUI_MSG_NOTIFY_ALL ? message.GetParam1() : message.GetMessage();
+  if (msg >= GUI_MSG_PLEX_SECTION_LOADED && msg <= GUI_MSG_PLEX_PLAYQUEUE_UPDATED)
+    InvalidateDependencies(INFO_DEPENDS_PLEX);
+  /* END PLEX */
   return false;
 }
 
@@ -321,6 +342,11 @@ const infomap system_labels[] =  {{ "hasnetwork",       SYSTEM_ETHERNET_LINK_ACT
                                   { "alarmpos",         SYSTEM_ALARM_POS },
                                   { "isinhibit",        SYSTEM_ISINHIBIT },
                                   { "hasshutdown",      SYSTEM_HAS_SHUTDOWN },
+                                  /* PLEX */
+                                  { "guidrawcalls",     SYSTEM_GUI_DRAWCALLS },
+                                  { "guivertices",      SYSTEM_GUI_VERTICES },
+                                  { "infoevaluations",  SYSTEM_INFO_EVALUATIONS },
+                                  /* END PLEX */
                                   { "haspvr",           SYSTEM_HAS_PVR }};
 
 const infomap system_param[] =   {{ "hasalarm",         SYSTEM_HAS_ALARM },
@@ -964,6 +990,14 @@ int CGUIInfoManager::TranslateSingleString(const CStdString &strCondition)
           else if (param == "total") return SYSTEM_TOTAL_MEMORY;
         }
         /* PLEX */
+        else if (prop.name == "texturememory")
+        {
+          if (param == "skin") return SYSTEM_TEXTURE_MEMORY_SKIN;
+          else if (param == "fonts") return SYSTEM_TEXTURE_MEMORY_FONTS;
+          else if (param == "art") return SYSTEM_TEXTURE_MEMORY_ART;
+          else if (param == "total") return SYSTEM_TEXTURE_MEMORY_TOTAL;
+          else if (param == "uploads") return SYSTEM_TEXTURE_UPLOADS;
+        }
         else if (prop.name == "issystem")
         {
           if (param == "rasplex") return SYSTEM_ISRASPLEX;
@@ -1452,6 +1486,19 @@ CStdString CGUIInfoManager::GetLabel(int info, int contextWindow, CStdString *fa
   case SYSTEM_FPS:
     strLabel.Format("%02.2f", m_fps);
     break;
+  /* PLEX */
+#if defined(HAS_GL)
+  case SYSTEM_GUI_DRAWCALLS:
+    strLabel.Format("%u (%u textures)", CGUITextureGL::GetFrameStats().drawCalls, CGUITextureGL::GetFrameStats().textures);
+    break;
+  case SYSTEM_GUI_VERTICES:
+    strLabel.Format("%u", CGUITextureGL::GetFrameStats().vertices);
+    break;
+#endif
+  case SYSTEM_INFO_EVALUATIONS:
+    strLabel.Format("%u evaluated, %u skipped", m_lastFrameEvaluations, m_lastFrameSkips);
+    break;
+  /* END PLEX */
   case PLAYER_VOLUME:
     strLabel.Format("%2.1f dB", CAEUtil::PercentToGain(g_settings.m_fVolumeLevel));
     break;
@@ -1796,6 +1843,32 @@ CStdString CGUIInfoManager::GetLabel(int info, int contextWindow, CStdString *fa
         strLabel.Format("%luMB", (ULONG)(stat.ullTotalPhys/MB));
     }
     break;
+  /* PLEX */
+  case SYSTEM_TEXTURE_MEMORY_SKIN:
+  case SYSTEM_TEXTURE_MEMORY_FONTS:
+  case SYSTEM_TEXTURE_MEMORY_ART:
+  case SYSTEM_TEXTURE_MEMORY_TOTAL:
+    if (g_plexApplication.textureResidency)
+    {
+      CPlexTextureResidency::Usage usage = g_plexApplication.textureResidency->GetUsage();
+      uint64_t bytes = usage.Total();
+      if (info == SYSTEM_TEXTURE_MEMORY_SKIN)
+        bytes = usage.skin;
+      else if (info == SYSTEM_TEXTURE_MEMORY_FONTS)
+        bytes = usage.fonts;
+      else if (info == SYSTEM_TEXTURE_MEMORY_ART)
+        bytes = usage.art;
+      strLabel.Format("%.1fMB", (float)bytes / MB);
+    }
+    break;
+  case SYSTEM_TEXTURE_UPLOADS:
+    {
+      CGUILargeTextureManager::UploadStats stats = g_largeTextureManager.GetUploadStats();
+      strLabel.Format("%u textures, %.1fMB in %u frames, %u over budget, longest %.1f ms",
+                      stats.textures, (float)stats.bytes / MB, stats.frames, stats.spikes, stats.maxTime);
+    }
+    break;
+  /* END PLEX */
   case SYSTEM_SCREEN_MODE:
     strLabel = g_settings.m_ResInfo[g_graphicsContext.GetVideoResolution()].strMode;
     break;
@@ -2216,11 +2289,150 @@ bool CGUIInfoManager::EvaluateBool(const CStdString &expression, int contextWind
  */
 bool CGUIInfoManager::GetBoolValue(unsigned int expression, const CGUIListItem *item)
 {
+#ifndef __PLEX__
   if (expression && --expression < m_bools.size())
     return m_bools[expression]->Get(m_updateTime, item);
+#else
+  if (expression && --expression < m_bools.size())
+  {
+    InfoBool *info = m_bools[expression];
+    unsigned int version = GetDependencyVersion(info->GetDependencies());
+    if (item || info->IsDirty(version))
+      m_frameEvaluations++;
+    else
+      m_frameSkips++;
+    return info->Get(version, item);
+  }
+#endif
   return false;
 }
 
+/* PLEX */
+unsigned int CGUIInfoManager::GetBoolDependencies(unsigned int expression) const
+{
+  if (expression && --expression < m_bools.size())
+    return m_bools[expression]->GetDependencies();
+  return INFO_DEPENDS_NONE;
+}
+
+unsigned int CGUIInfoManager::GetConditionDependencies(int condition) const
+{
+  int info = abs(condition);
+  if (info >= MULTI_INFO_START && info <= MULTI_INFO_END)
+  {
+    if ((unsigned int)(info - MULTI_INFO_START) >= m_multiInfo.size())
+      return INFO_DEPENDS_FRAME;
+    info = m_multiInfo[info - MULTI_INFO_START].m_info;
+  }
+
+  switch (info)
+  {
+  case SYSTEM_ALWAYS_TRUE:
+  case SYSTEM_ALWAYS_FALSE:
+  case SYSTEM_ETHERNET_LINK_ACTIVE:
+  case SYSTEM_PLATFORM_LINUX:
+  case SYSTEM_PLATFORM_WINDOWS:
+  case SYSTEM_PLATFORM_DARWIN:
+  case SYSTEM_PLATFORM_DARWIN_OSX:
+  case SYSTEM_PLATFORM_DARWIN_IOS:
+  case SYSTEM_PLATFORM_DARWIN_ATV2:
+  case SYSTEM_PLATFORM_ANDROID:
+  case SYSTEM_ISRASPLEX:
+  case SYSTEM_ISOPENELEC:
+    return INFO_DEPENDS_NONE;
+
+  case WINDOW_IS_ACTIVE:
+  case WINDOW_IS_VISIBLE:
+  case WINDOW_IS_TOPMOST:
+  case WINDOW_IS_MEDIA:
+  case WINDOW_NEXT:
+  case WINDOW_PREVIOUS:
+    return INFO_DEPENDS_WINDOW;
+
+  case VIDEOPLAYER_ISFULLSCREEN:
+    return INFO_DEPENDS_PLAYER | INFO_DEPENDS_WINDOW;
+
+  case SYSTEM_NO_PLEX_SERVERS:
+  case SYSTEM_IS_SIGNED_IN:
+  case SYSTEM_USER_ISRESTRICTED:
+  case SYSTEM_USER_IS_IN_HOME:
+    return INFO_DEPENDS_PLEX;
+
+  case SYSTEM_PLEX_PLAYQUEUE:
+    // also matches against the playing item's content, see GetMultiInfoBool
+    return INFO_DEPENDS_PLEX | INFO_DEPENDS_PLAYER;
+
+  // these can change while nothing is playing
+  case PLAYER_VOLUME:
+  case PLAYER_MUTED:
+  case MUSICPLAYER_PLAYLISTLEN:
+  case MUSICPLAYER_PLAYLISTPOS:
+  case MUSICPLAYER_HASPREVIOUS:
+  case MUSICPLAYER_HASNEXT:
+  case MUSICPLAYER_EXISTS:
+  case MUSICPLAYER_PLAYLISTPLAYING:
+  case VIDEOPLAYER_PLAYLISTLEN:
+  case VIDEOPLAYER_PLAYLISTPOS:
+  case VIDEOPLAYER_HASNEXT:
+    return INFO_DEPENDS_FRAME;
+  }
+
+  if ((info >= PLAYER_HAS_MEDIA && info <= PLAYER_TITLE) ||
+      (info >= MUSICPLAYER_TITLE && info <= MUSICPLAYER_CHANNEL_GROUP) ||
+      (info >= VIDEOPLAYER_TITLE && info <= VIDEOPLAYER_PLEXCONTENT_STRING))
+    return INFO_DEPENDS_PLAYER;
+
+  return INFO_DEPENDS_FRAME;
+}
+
+void CGUIInfoManager::InvalidateDependencies(unsigned int dependencies)
+{
+  unsigned int version = ++m_dependencyCounter;
+  for (unsigned int i = 0; i < INFO_DEPENDS_COUNT; i++)
+  {
+    if (dependencies & (1 << i))
+      m_dependencyVersions[i] = version;
+  }
+}
+
+unsigned int CGUIInfoManager::GetDependencyVersion(unsigned int dependencies) const
+{
+  // all versions come from the same counter, so the newest one tells us whether
+  // anything we depend on changed since we last looked
+  unsigned int version = m_updateTime;
+  for (unsigned int i = 0; i < INFO_DEPENDS_COUNT; i++)
+  {
+    if ((dependencies & (1 << i)) && m_dependencyVersions[i] > version)
+      version = m_dependencyVersions[i];
+  }
+  return version;
+}
+
+void CGUIInfoManager::NewFrame()
+{
+  m_containerMoves.clear();
+
+  unsigned int changed = INFO_DEPENDS_FRAME;
+
+  // player state is live while something is playing, and changes once more when it stops
+  bool playing = g_application.IsPlaying();
+  if (playing || playing != m_dependencyPlaying)
+    changed |= INFO_DEPENDS_PLAYER;
+  m_dependencyPlaying = playing;
+
+  unsigned int windowVersion = g_windowManager.GetStateVersion();
+  if (windowVersion != m_dependencyWindowVersion)
+    changed |= INFO_DEPENDS_WINDOW;
+  m_dependencyWindowVersion = windowVersion;
+
+  InvalidateDependencies(changed);
+
+  m_lastFrameEvaluations = m_frameEvaluations;
+  m_lastFrameSkips = m_frameSkips;
+  m_frameEvaluations = m_frameSkips = 0;
+}
+/* END PLEX */
+
 // checks the condition and returns it as necessary.  Currently used
 // for toggle button controls and visibility of images.
 bool CGUIInfoManager::GetBool(int condition1, int contextWindow, const CGUIListItem *item)
@@ -4333,6 +4545,8 @@ CStdString CGUIInfoManager::GetCurrentPlayTimeRemaining(TIME_FORMAT format) cons
 void CGUIInfoManager::ResetCurrentItem()
 {
   /* PLEX */
+  InvalidateDependencies(INFO_DEPENDS_PLAYER);
+
   CStdString art;
   if (m_currentFile->HasArt("thumb") && m_currentFile->GetArt("thumb") == "special://temp/airtunes_album_thumb.jpg")
     art = m_currentFile->GetArt("thumb");
@@ -5633,7 +5847,12 @@ void CGUIInfoManager::ResetCache()
 {
   // reset any animation triggers as well
   m_containerMoves.clear();
+#ifndef __PLEX__
   m_updateTime++;
+#else
+  // everything is suspect, including conditions that don't depend on anything
+  m_updateTime = ++m_dependencyCounter;
+#endif
 }
 
 // Called from tuxbox service thread to update current status
@@ -40,6 +40,7 @@
 /* PLEX */
 #include "ThumbLoader.h"
 #include "music/MusicThumbLoader.h"
+#include "interfaces/info/InfoBool.h"
 /* END PLEX */
 
 namespace MUSIC_INFO
@@ -193,6 +194,11 @@ namespace INFO
 #define SYSTEM_ISINHIBIT            184
 #define SYSTEM_HAS_SHUTDOWN         185
 #define SYSTEM_HAS_PVR              186
+/* PLEX */
+#define SYSTEM_GUI_DRAWCALLS        187
+#define SYSTEM_GUI_VERTICES         188
+#define SYSTEM_INFO_EVALUATIONS     189
+/* END PLEX */
 
 #define NETWORK_IP_ADDRESS          190
 #define NETWORK_MAC_ADDRESS         191
@@ -743,6 +749,29 @@ public:
    */
   bool GetBoolValue(unsigned int expression, const CGUIListItem *item = NULL);
 
+  /* PLEX */
+  /*! \brief Get the INFO::InfoDependency flags of a translated condition
+   \sa TranslateSingleString
+   */
+  unsigned int GetConditionDependencies(int condition) const;
+
+  /*! \brief Get the INFO::InfoDependency flags of a previously registered boolean expression
+   \sa Register
+   */
+  unsigned int GetBoolDependencies(unsigned int expression) const;
+
+  /*! \brief Flag state as changed so that registered conditions reading it get re-evaluated
+   \param dependencies INFO::InfoDependency flags of the state that changed
+   */
+  void InvalidateDependencies(unsigned int dependencies);
+
+  /*! \brief Per-frame housekeeping of the info cache
+   Works out which state changed since the last frame and invalidates the conditions
+   depending on it. Replaces ResetCache() at the end of every rendered frame.
+   */
+  void NewFrame();
+  /* END PLEX */
+
   /*! \brief Evaluate a boolean expression
    \param expression the expression to evaluate
    \param context the context in which to evaluate the expression (currently windows)
@@ -822,8 +851,13 @@ public:
   void UpdateFPS();
   inline float GetFPS() const { return m_fps; };
 
+#ifndef __PLEX__
   void SetNextWindow(int windowID) { m_nextWindowID = windowID; };
   void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
+#else
+  void SetNextWindow(int windowID) { m_nextWindowID = windowID; InvalidateDependencies(INFO::INFO_DEPENDS_WINDOW); };
+  void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; InvalidateDependencies(INFO::INFO_DEPENDS_WINDOW); };
+#endif
 
   void ResetCache();
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
@@ -982,6 +1016,17 @@ protected:
   bool GetItemBool(const CGUIListItem *item, int condition, int secondCondition=0) const;
   bool m_slideshowShowDescription;
   CMusicThumbLoader *m_musicThumbLoader;
+
+  unsigned int GetDependencyVersion(unsigned int dependencies) const;
+
+  unsigned int m_dependencyCounter;                        // source of all version numbers below
+  unsigned int m_dependencyVersions[INFO_DEPENDS_COUNT];   // version at which each dependency last changed
+  bool m_dependencyPlaying;
+  unsigned int m_dependencyWindowVersion;
+  unsigned int m_frameEvaluations;
+  unsigned int m_frameSkips;
+  unsigned int m_lastFrameEvaluations;
+  unsigned int m_lastFrameSkips;
   /* END PLEX */
 };
 
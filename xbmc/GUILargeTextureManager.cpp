@@ -28,6 +28,11 @@
 #include "guilib/GraphicContext.h"
 #include "utils/log.h"
 #include "TextureCache.h"
+/* PLEX */
+#include "settings/AdvancedSettings.h"
+
+#include <algorithm>
+/* END PLEX */
 
 using namespace std;
 
@@ -43,6 +48,19 @@ CImageLoader::~CImageLoader()
   delete(m_texture);
 }
 
+/* PLEX */
+bool CImageLoader::operator==(const CJob *job) const
+{
+  if (strcmp(job->GetType(), GetType()) == 0)
+  {
+    const CImageLoader *loader = dynamic_cast<const CImageLoader*>(job);
+    if (loader && loader->m_path == m_path)
+      return true;
+  }
+  return false;
+}
+/* END PLEX */
+
 bool CImageLoader::DoWork()
 {
   bool needsChecking = false;
@@ -85,6 +103,11 @@ CGUILargeTextureManager::CLargeTexture::CLargeTexture(const CStdString &path)
   m_path = path;
   m_refCount = 1;
   m_timeToDelete = 0;
+  /* PLEX */
+  m_loaded = false;
+  m_loadedTextures = 0;
+  m_size = 0;
+  /* END PLEX */
 }
 
 CGUILargeTextureManager::CLargeTexture::~CLargeTexture()
@@ -134,10 +157,42 @@ void CGUILargeTextureManager::CLargeTexture::SetTexture(CBaseTexture* texture)
   assert(!m_texture.size());
   if (texture)
     m_texture.Set(texture, texture->GetWidth(), texture->GetHeight());
+  /* PLEX */
+  // nothing to load for one that failed, GetImage can tell right away
+  m_loaded = !texture;
+  for (unsigned int i = 0; i < m_texture.m_textures.size(); i++)
+    m_size += m_texture.m_textures[i]->GetPitch() * m_texture.m_textures[i]->GetRows();
+  /* END PLEX */
 }
 
+/* PLEX */
+bool CGUILargeTextureManager::CLargeTexture::LoadToGPU(unsigned int maxBytes, unsigned int &loaded)
+{
+  loaded = 0;
+  while (m_loadedTextures < m_texture.m_textures.size() && loaded < maxBytes)
+  {
+    unsigned int bytes = 0;
+    bool done = m_texture.m_textures[m_loadedTextures]->LoadToGPUPartially(maxBytes - loaded, bytes);
+    loaded += bytes;
+    if (!done)
+      break;
+    m_loadedTextures++;
+  }
+  m_loaded = m_loadedTextures == m_texture.m_textures.size();
+  return m_loaded;
+}
+/* END PLEX */
+
 CGUILargeTextureManager::CGUILargeTextureManager()
+/* PLEX */
+#ifdef __PLEX__
+  : CJobQueue(true, LARGE_TEXTURE_DECODE_JOBS, CJob::PRIORITY_NORMAL)
+#endif
+/* END PLEX */
 {
+  /* PLEX */
+  memset(&m_uploadStats, 0, sizeof(m_uploadStats));
+  /* END PLEX */
 }
 
 CGUILargeTextureManager::~CGUILargeTextureManager()
@@ -171,6 +226,11 @@ bool CGUILargeTextureManager::GetImage(const CStdString &path, CTextureArray &te
     {
       if (firstRequest)
         image->AddRef();
+      /* PLEX */
+      // decoded but not on the gpu yet, see UploadTextures
+      if (!image->IsLoaded())
+        return true;
+      /* END PLEX */
       texture = image->GetTexture();
       return texture.size() > 0;
     }
@@ -227,9 +287,9 @@ void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediat
   /* END PLEX */
     for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
     {
-      unsigned int id = it->first;
       CLargeTexture *image = it->second;
 #ifndef __PLEX__
+      unsigned int id = it->first;
       if (image->GetPath() == path && image->DecrRef(true))
       {
         // cancel this job
@@ -242,7 +302,7 @@ void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediat
       {
         if (image->DecrRef(false))
         {
-          CJobManager::GetInstance().CancelJob(id);
+          CancelJob(it->first);
           m_queued.erase(it);
           texturesToDelete.push_back(image);
           break;
@@ -275,8 +335,15 @@ void CGUILargeTextureManager::QueueImage(const CStdString &path)
 
   // queue the item
   CLargeTexture *image = new CLargeTexture(path);
+#ifndef __PLEX__
   unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path), this, CJob::PRIORITY_NORMAL);
   m_queued.push_back(make_pair(jobID, image));
+#else
+  // decoded by a few at a time instead of every free worker, what is on screen now first
+  CImageLoader *loader = new CImageLoader(path);
+  m_queued.push_back(make_pair((CJob *)loader, image));
+  AddJob(loader);
+#endif
 }
 
 void CGUILargeTextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
@@ -285,7 +352,11 @@ void CGUILargeTextureManager::OnJobComplete(unsigned int jobID, bool success, CJ
   CSingleLock lock(m_listSection);
   for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
   {
+#ifndef __PLEX__
     if (it->first == jobID)
+#else
+    if (it->first == job)
+#endif
     { // found our job
       CImageLoader *loader = (CImageLoader *)job;
       CLargeTexture *image = it->second;
@@ -293,10 +364,104 @@ void CGUILargeTextureManager::OnJobComplete(unsigned int jobID, bool success, CJ
       loader->m_texture = NULL; // we want to keep the texture, and jobs are auto-deleted.
       m_queued.erase(it);
       m_allocated.push_back(image);
-      return;
+      break;
     }
   }
+
+#ifdef __PLEX__
+  // on to the next one
+  CJobQueue::OnJobComplete(jobID, success, job);
+#endif
+}
+
+/* PLEX */
+void CGUILargeTextureManager::UploadTextures()
+{
+  int64_t start = CurrentHostCounter();
+  float elapsed = 0;
+  unsigned int budget = g_advancedSettings.m_guiTextureUploadSize;
+  unsigned int bytes = 0, textures = 0;
+
+  // oldest first, m_allocated is in the order they were decoded
+  CSingleLock lock(m_listSection);
+  for (listIterator it = m_allocated.begin(); it != m_allocated.end() && bytes < budget; ++it)
+  {
+    CLargeTexture *image = *it;
+    if (image->IsLoaded())
+      continue;
+
+    unsigned int loaded = 0;
+    if (image->LoadToGPU(budget - bytes, loaded))
+      textures++;
+    bytes += loaded;
+
+    elapsed = (float)(CurrentHostCounter() - start) * 1000 / CurrentHostFrequency();
+    if (elapsed >= g_advancedSettings.m_guiTextureUploadTime)
+      break;
+  }
+
+  if (!bytes)
+    return;
+
+  m_uploadStats.textures += textures;
+  m_uploadStats.bytes += bytes;
+  m_uploadStats.frames++;
+  m_uploadStats.maxTime = std::max(m_uploadStats.maxTime, elapsed);
+  if (elapsed > g_advancedSettings.m_guiTextureUploadTime)
+  {
+    // a texture that can't be loaded in parts, or a driver that stalls on them
+    m_uploadStats.spikes++;
+    CLog::Log(LOGDEBUG, "CGUILargeTextureManager::UploadTextures took %.1f ms for %u kB, the budget is %u ms",
+              elapsed, bytes / 1024, g_advancedSettings.m_guiTextureUploadTime);
+  }
+}
+
+CGUILargeTextureManager::UploadStats CGUILargeTextureManager::GetUploadStats()
+{
+  CSingleLock lock(m_listSection);
+  return m_uploadStats;
+}
+
+uint64_t CGUILargeTextureManager::GetMemoryUsage()
+{
+  uint64_t bytes = 0;
+  CSingleLock lock(m_listSection);
+  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+    bytes += (*it)->GetSize();
+  return bytes;
 }
 
+bool CGUILargeTextureManager::ReleasedEarlier(const CLargeTexture *a, const CLargeTexture *b)
+{
+  return a->GetTimeToDelete() < b->GetTimeToDelete();
+}
+
+uint64_t CGUILargeTextureManager::FreeMemory(uint64_t bytes)
+{
+  // deleted once the lock is gone, see ReleaseImage
+  std::vector<CLargeTexture*> texturesToDelete;
+  uint64_t freed = 0;
+
+  CSingleLock lock(m_listSection);
+  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  {
+    if ((*it)->IsUnused())
+      texturesToDelete.push_back(*it);
+  }
+  std::sort(texturesToDelete.begin(), texturesToDelete.end(), ReleasedEarlier);
 
+  size_t count = 0;
+  while (count < texturesToDelete.size() && freed < bytes)
+  {
+    freed += texturesToDelete[count]->GetSize();
+    m_allocated.erase(std::find(m_allocated.begin(), m_allocated.end(), texturesToDelete[count]));
+    count++;
+  }
+  texturesToDelete.resize(count);
+  lock.Leave();
 
+  for (listIterator it = texturesToDelete.begin(); it != texturesToDelete.end(); ++it)
+    delete *it;
+  return freed;
+}
+/* END PLEX */
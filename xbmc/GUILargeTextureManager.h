@@ -22,6 +22,9 @@
 
 #include "threads/CriticalSection.h"
 #include "utils/Job.h"
+/* PLEX */
+#include "utils/JobManager.h"
+/* END PLEX */
 #include "guilib/TextureManager.h"
 
 /*!
@@ -43,6 +46,11 @@ public:
    */
   virtual bool DoWork();
 
+  /* PLEX */
+  virtual const char *GetType() const { return "imageloader"; }
+  virtual bool operator==(const CJob *job) const;
+  /* END PLEX */
+
   CStdString    m_path; ///< path of image to load
   CBaseTexture *m_texture; ///< Texture object to load the image into \sa CBaseTexture.
 };
@@ -56,7 +64,16 @@ public:
 
  \sa IJobCallback, CGUITexture
  */
+/* PLEX */
+/* how many images are decoded at the same time, the most recently requested first */
+#define LARGE_TEXTURE_DECODE_JOBS 2
+/* END PLEX */
+
+#ifndef __PLEX__
 class CGUILargeTextureManager : public IJobCallback
+#else
+class CGUILargeTextureManager : public CJobQueue
+#endif
 {
 public:
   CGUILargeTextureManager();
@@ -111,6 +128,46 @@ public:
    */
   void CleanupUnusedImages(bool immediately = false);
 
+  /* PLEX */
+  /*!
+   \brief Load decoded textures to the GPU, within the budget of one frame.
+
+   Decoded textures are only handed out by GetImage once they are on the GPU, so that a poster wall
+   scrolling in doesn't load all of its posters in one frame. Must be called once per frame from the
+   render thread.
+
+   \sa CAdvancedSettings::m_guiTextureUploadSize, CAdvancedSettings::m_guiTextureUploadTime
+   */
+  void UploadTextures();
+
+  /*!
+   \brief What UploadTextures has loaded so far, shown by System.TextureMemory(uploads).
+   */
+  struct UploadStats
+  {
+    unsigned int textures; ///< textures loaded to the GPU
+    uint64_t     bytes;    ///< bytes loaded to the GPU
+    unsigned int frames;   ///< frames that loaded anything
+    unsigned int spikes;   ///< frames that spent longer than the budget loading
+    float        maxTime;  ///< the longest a frame spent loading, in ms
+  };
+  UploadStats GetUploadStats();
+
+  /*!
+   \brief Bytes of the textures that are loaded, whether in use or waiting to be unloaded.
+   */
+  uint64_t GetMemoryUsage();
+
+  /*!
+   \brief Unload textures that are no longer in use right away, the least recently released first.
+
+   \param bytes how much to free, textures that are still in use are never unloaded.
+   \return how much was freed.
+   \sa CleanupUnusedImages
+   */
+  uint64_t FreeMemory(uint64_t bytes);
+  /* END PLEX */
+
 private:
   class CLargeTexture
   {
@@ -122,6 +179,13 @@ private:
     bool DecrRef(bool deleteImmediately);
     bool DeleteIfRequired(bool deleteImmediately = false);
     void SetTexture(CBaseTexture* texture);
+    /* PLEX */
+    bool LoadToGPU(unsigned int maxBytes, unsigned int &loaded);
+    bool IsLoaded() const { return m_loaded; };
+    bool IsUnused() const { return m_refCount == 0; };
+    unsigned int GetTimeToDelete() const { return m_timeToDelete; };
+    unsigned int GetSize() const { return m_size; };
+    /* END PLEX */
 
     const CStdString &GetPath() const { return m_path; };
     const CTextureArray &GetTexture() const { return m_texture; };
@@ -133,16 +197,35 @@ private:
     CStdString m_path;
     CTextureArray m_texture;
     unsigned int m_timeToDelete;
+    /* PLEX */
+    bool m_loaded;                 ///< all of it is on the GPU
+    unsigned int m_loadedTextures; ///< frames of m_texture on the GPU so far
+    unsigned int m_size;           ///< bytes of all frames of m_texture
+    /* END PLEX */
   };
 
   void QueueImage(const CStdString &path);
+  /* PLEX */
+  static bool ReleasedEarlier(const CLargeTexture *a, const CLargeTexture *b);
+  /* END PLEX */
 
+#ifndef __PLEX__
   std::vector< std::pair<unsigned int, CLargeTexture *> > m_queued;
+#else
+  std::vector< std::pair<CJob *, CLargeTexture *> > m_queued;
+#endif
   std::vector<CLargeTexture *> m_allocated;
   typedef std::vector<CLargeTexture *>::iterator listIterator;
+#ifndef __PLEX__
   typedef std::vector< std::pair<unsigned int, CLargeTexture *> >::iterator queueIterator;
+#else
+  typedef std::vector< std::pair<CJob *, CLargeTexture *> >::iterator queueIterator;
+#endif
 
   CCriticalSection m_listSection;
+  /* PLEX */
+  UploadStats m_uploadStats;
+  /* END PLEX */
 };
 
 extern CGUILargeTextureManager g_largeTextureManager;
@@ -31,6 +31,9 @@ CGUIViewControl::CGUIViewControl(void)
   m_viewAsControl = -1;
   m_parentWindow = WINDOW_INVALID;
   m_fileItems = NULL;
+  /* PLEX */
+  m_itemsVersion = 0;
+  /* END PLEX */
   Reset();
 }
 
@@ -132,6 +135,9 @@ void CGUIViewControl::SetItems(CFileItemList &items)
 {
 //  CLog::Log(LOGDEBUG,"SetItems: %i", m_currentView);
   m_fileItems = &items;
+  /* PLEX */
+  m_itemsVersion++;
+  /* END PLEX */
   // update our current view control...
   UpdateView();
 }
@@ -280,7 +286,22 @@ void CGUIViewControl::Clear()
 
   CGUIMessage msg(GUI_MSG_LABEL_RESET, m_parentWindow, m_visibleViews[m_currentView]->GetID(), 0);
   g_windowManager.SendMessage(msg);
+
+  /* PLEX */
+  m_itemsVersion++;
+  /* END PLEX */
+}
+
+/* PLEX */
+bool CGUIViewControl::GetVisibleRange(int &first, int &last) const
+{
+  if (m_currentView < 0 || m_currentView >= (int)m_visibleViews.size())
+    return false; // no valid current view!
+
+  const CGUIBaseContainer *container = dynamic_cast<const CGUIBaseContainer *>(m_visibleViews[m_currentView]);
+  return container && container->GetVisibleRange(first, last);
 }
+/* END PLEX */
 
 int CGUIViewControl::GetView(VIEW_TYPE type, int id) const
 {
@@ -54,6 +54,17 @@ public:
 
   void Clear();
 
+  /* PLEX */
+  /*! \brief Range of the items that the current view shows
+   \sa CGUIBaseContainer::GetVisibleRange
+   */
+  bool GetVisibleRange(int &first, int &last) const;
+
+  /*! \brief Changes whenever the view is given other items or cleared
+   */
+  unsigned int GetItemsVersion() const { return m_itemsVersion; }
+  /* END PLEX */
+
 protected:
   int GetSelectedItem(const CGUIControl *control) const;
   void UpdateContents(const CGUIControl *control, int currentItem);
@@ -70,4 +81,8 @@ protected:
   int                   m_viewAsControl;
   int                   m_parentWindow;
   int                   m_currentView;
+
+  /* PLEX */
+  unsigned int          m_itemsVersion;
+  /* END PLEX */
 };
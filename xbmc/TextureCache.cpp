@@ -152,7 +152,14 @@ bool CTextureCache::CanCacheImageURL(const CURL &url)
 CStdString CTextureCache::CheckCachedImage(const CStdString &url, bool returnDDS, bool &needsRecaching)
 {
   CTextureDetails details;
+  /* PLEX */
+  // only the loads that can take a .dds count as a use, see CPlexTextureCache::IncrementUseCount
+#ifdef __PLEX__
+  CStdString path(GetCachedImage(url, details, returnDDS));
+#else
   CStdString path(GetCachedImage(url, details, true));
+#endif
+  /* END PLEX */
   needsRecaching = !details.hash.empty();
   if (!path.IsEmpty())
   {
@@ -161,8 +168,13 @@ CStdString CTextureCache::CheckCachedImage(const CStdString &url, bool returnDDS
       CStdString ddsPath = URIUtils::ReplaceExtension(path, ".dds");
       if (CFile::Exists(ddsPath))
         return ddsPath;
+      /* PLEX */
+      // only the art that is shown often gets one, see CPlexTextureCache::IncrementUseCount
+#ifndef __PLEX__
       if (g_advancedSettings.m_useDDSFanart)
         AddJob(new CTextureDDSJob(path));
+#endif
+      /* END PLEX */
     }
     return path;
   }
@@ -324,8 +336,12 @@ void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
   m_completeEvent.Set();
 
   // TODO: call back to the UI indicating that it can update it's image...
+  /* PLEX */
+#ifndef __PLEX__
   if (success && g_advancedSettings.m_useDDSFanart && !job->m_details.file.empty())
     AddJob(new CTextureDDSJob(GetCachedPath(job->m_details.file)));
+#endif
+  /* END PLEX */
 }
 
 void CTextureCache::OnJobComplete(unsigned int jobID, bool success, CJob *job)
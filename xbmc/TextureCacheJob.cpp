@@ -38,6 +38,10 @@
 #include "cores/omxplayer/OMXImage.h"
 #endif
 
+/* PLEX */
+#include "guilib/GraphicContext.h"
+/* END PLEX */
+
 CTextureCacheJob::CTextureCacheJob(const CStdString &url, const CStdString &oldHash)
 {
   m_url = url;
@@ -266,6 +270,35 @@ bool CTextureDDSJob::DoWork()
 {
   if (URIUtils::GetExtension(m_original).Equals(".dds"))
     return false;
+  /* PLEX */
+#ifdef __PLEX__
+  CStdString ddsPath = URIUtils::ReplaceExtension(m_original, ".dds");
+  if (XFILE::CFile::Exists(ddsPath))
+    return true;
+
+  // no larger than CImageLoader would load the original
+  CBaseTexture *texture = CBaseTexture::LoadFromFile(m_original, g_graphicsContext.GetWidth(), g_graphicsContext.GetHeight());
+  if (!texture)
+    return false;
+
+  // an uncompressed one takes as much texture memory as the original and far more disk, skip those.
+  // It is written aside and moved in place so CheckCachedImage never returns half a file.
+  CDDSImage dds;
+  CStdString tmpPath = ddsPath + ".tmp";
+  bool ret = dds.CreateCompressed(tmpPath, texture->GetWidth(), texture->GetHeight(), texture->GetPitch(), texture->GetPixels(), 40);
+  delete texture;
+  if (ret)
+    ret = XFILE::CFile::Rename(tmpPath, ddsPath);
+  if (!ret)
+  {
+    CLog::Log(LOGDEBUG, "CTextureDDSJob::DoWork no DDS version of: %s", m_original.c_str());
+    if (XFILE::CFile::Exists(tmpPath))
+      XFILE::CFile::Delete(tmpPath);
+    return false;
+  }
+  CLog::Log(LOGDEBUG, "CTextureDDSJob::DoWork created DDS version of: %s", m_original.c_str());
+  return true;
+#else
   CBaseTexture *texture = CBaseTexture::LoadFromFile(m_original);
   if (texture)
   { // convert to DDS
@@ -276,6 +309,8 @@ bool CTextureDDSJob::DoWork()
     return ret;
   }
   return false;
+#endif
+  /* END PLEX */
 }
 
 CTextureUseCountJob::CTextureUseCountJob(const std::vector<CTextureDetails> &textures) : m_textures(textures)
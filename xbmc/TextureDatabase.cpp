@@ -142,8 +142,13 @@ bool CTextureDatabase::UpdateOldVersion(int version)
 
 bool CTextureDatabase::IncrementUseCount(const CTextureDetails &details)
 {
-  CStdString sql = PrepareSQL("UPDATE sizes SET usecount=usecount+1, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=%u AND width=%u AND height=%u", details.id, details.width, details.height);
-  return ExecuteQuery(sql);
+  /* PLEX */
+  dbiplus::sql_record params;
+  params.push_back(details.id);
+  params.push_back(details.width);
+  params.push_back(details.height);
+  return ExecuteQuery("UPDATE sizes SET usecount=usecount+1, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=? AND width=? AND height=?", params);
+  /* END PLEX */
 }
 
 bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &details)
@@ -153,8 +158,11 @@ bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString sql = PrepareSQL("SELECT id, cachedurl, lasthashcheck, imagehash, width, height FROM texture JOIN sizes ON (texture.id=sizes.idtexture AND sizes.size=1) WHERE url='%s'", url.c_str());
-    m_pDS->query(sql.c_str());
+    /* PLEX */
+    dbiplus::sql_record params;
+    params.push_back(url.c_str());
+    m_pDS->query("SELECT id, cachedurl, lasthashcheck, imagehash, width, height FROM texture JOIN sizes ON (texture.id=sizes.idtexture AND sizes.size=1) WHERE url=?", params);
+    /* END PLEX */
     if (!m_pDS->eof())
     { // have some information
       details.id = m_pDS->fv(0).get_asInt();
@@ -180,8 +188,12 @@ bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &
 bool CTextureDatabase::SetCachedTextureValid(const CStdString &url, bool updateable)
 {
   CStdString date = updateable ? CDateTime::GetCurrentDateTime().GetAsDBDateTime() : "";
-  CStdString sql = PrepareSQL("UPDATE texture SET lasthashcheck='%s' WHERE url='%s'", date.c_str(), url.c_str());
-  return ExecuteQuery(sql);
+  /* PLEX */
+  dbiplus::sql_record params;
+  params.push_back(date.c_str());
+  params.push_back(url.c_str());
+  return ExecuteQuery("UPDATE texture SET lasthashcheck=? WHERE url=?", params);
+  /* END PLEX */
 }
 
 bool CTextureDatabase::AddCachedTexture(const CStdString &url, const CTextureDetails &details)
@@ -191,21 +203,37 @@ bool CTextureDatabase::AddCachedTexture(const CStdString &url, const CTextureDet
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString sql = PrepareSQL("DELETE FROM texture WHERE url='%s'", url.c_str());
-    m_pDS->exec(sql.c_str());
+    /* PLEX */
+    // one transaction instead of a sync for each of them
+    BeginTransaction();
+
+    dbiplus::sql_record params;
+    params.push_back(url.c_str());
+    m_pDS->exec("DELETE FROM texture WHERE url=?", params);
 
     CStdString date = details.updateable ? CDateTime::GetCurrentDateTime().GetAsDBDateTime() : "";
-    sql = PrepareSQL("INSERT INTO texture (id, url, cachedurl, imagehash, lasthashcheck) VALUES(NULL, '%s', '%s', '%s', '%s')", url.c_str(), details.file.c_str(), details.hash.c_str(), date.c_str());
-    m_pDS->exec(sql.c_str());
+    params.push_back(details.file.c_str());
+    params.push_back(details.hash.c_str());
+    params.push_back(date.c_str());
+    m_pDS->exec("INSERT INTO texture (id, url, cachedurl, imagehash, lasthashcheck) VALUES(NULL, ?, ?, ?, ?)", params);
     int textureID = (int)m_pDS->lastinsertid();
 
     // set the size information
-    sql = PrepareSQL("INSERT INTO sizes (idtexture, size, usecount, lastusetime, width, height) VALUES(%u, 1, 1, CURRENT_TIMESTAMP, %u, %u)", textureID, details.width, details.height);
-    m_pDS->exec(sql.c_str());
+    params.clear();
+    params.push_back(textureID);
+    params.push_back(details.width);
+    params.push_back(details.height);
+    m_pDS->exec("INSERT INTO sizes (idtexture, size, usecount, lastusetime, width, height) VALUES(?, 1, 1, CURRENT_TIMESTAMP, ?, ?)", params);
+
+    CommitTransaction();
+    /* END PLEX */
   }
   catch (...)
   {
     CLog::Log(LOGERROR, "%s failed on url '%s'", __FUNCTION__, url.c_str());
+    /* PLEX */
+    RollbackTransaction();
+    /* END PLEX */
   }
   return true;
 }
@@ -256,8 +284,12 @@ CStdString CTextureDatabase::GetTextureForPath(const CStdString &url, const CStd
     if (url.empty())
       return "";
 
-    CStdString sql = PrepareSQL("select texture from path where url='%s' and type='%s'", url.c_str(), type.c_str());
-    m_pDS->query(sql.c_str());
+    /* PLEX */
+    dbiplus::sql_record params;
+    params.push_back(url.c_str());
+    params.push_back(type.c_str());
+    m_pDS->query("select texture from path where url=? and type=?", params);
+    /* END PLEX */
 
     if (!m_pDS->eof())
     { // have some information
@@ -284,21 +316,27 @@ void CTextureDatabase::SetTextureForPath(const CStdString &url, const CStdString
     if (url.empty())
       return;
 
-    CStdString sql = PrepareSQL("select id from path where url='%s' and type='%s'", url.c_str(), type.c_str());
-    m_pDS->query(sql.c_str());
+    /* PLEX */
+    dbiplus::sql_record params;
+    params.push_back(url.c_str());
+    params.push_back(type.c_str());
+    m_pDS->query("select id from path where url=? and type=?", params);
     if (!m_pDS->eof())
     { // update
       int pathID = m_pDS->fv(0).get_asInt();
       m_pDS->close();
-      sql = PrepareSQL("update path set texture='%s' where id=%u", texture.c_str(), pathID);
-      m_pDS->exec(sql.c_str());
+      params.clear();
+      params.push_back(texture.c_str());
+      params.push_back(pathID);
+      m_pDS->exec("update path set texture=? where id=?", params);
     }
     else
     { // add the texture
       m_pDS->close();
-      sql = PrepareSQL("insert into path (id, url, type, texture) values(NULL, '%s', '%s', '%s')", url.c_str(), type.c_str(), texture.c_str());
-      m_pDS->exec(sql.c_str());
+      params.push_back(texture.c_str());
+      m_pDS->exec("insert into path (id, url, type, texture) values(NULL, ?, ?, ?)", params);
     }
+    /* END PLEX */
   }
   catch (...)
   {
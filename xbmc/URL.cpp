@@ -27,6 +27,14 @@
 #include "FileItem.h"
 #include "filesystem/StackDirectory.h"
 #include "addons/Addon.h"
+/* PLEX */
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+
+#include <list>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+/* END PLEX */
 #ifndef _LINUX
 #include <sys\types.h>
 #include <sys\stat.h>
@@ -42,6 +50,85 @@ CStdString URLEncodeInline(const CStdString& strData)
   return buffer;
 }
 
+/* PLEX */
+namespace
+{
+/* the urls parsed last, by the string they were parsed from */
+class CURLCacheShard
+{
+public:
+  bool Get(const std::string &url, CURL &parsed)
+  {
+    CSingleLock lock(m_section);
+    Index::iterator it = m_index.find(url);
+    if (it == m_index.end())
+      return false;
+
+    m_urls.splice(m_urls.begin(), m_urls, it->second);
+    parsed = it->second->second;
+    return true;
+  }
+
+  void Add(const std::string &url, const CURL &parsed)
+  {
+    CSingleLock lock(m_section);
+    if (m_index.find(url) != m_index.end())
+      return;
+
+    m_urls.push_front(std::make_pair(url, parsed));
+    m_index[url] = m_urls.begin();
+
+    if (m_index.size() > URL_CACHE_SIZE / URL_CACHE_SHARDS)
+    {
+      m_index.erase(m_urls.back().first);
+      m_urls.pop_back();
+    }
+  }
+
+private:
+  typedef std::list<std::pair<std::string, CURL> > URLList;
+  typedef boost::unordered_map<std::string, URLList::iterator> Index;
+
+  CCriticalSection m_section;
+  URLList m_urls;
+  Index m_index;
+};
+
+/* urls are parsed on every thread, one lock for all of them would have them wait on each other */
+class CURLCache
+{
+public:
+  bool Get(const std::string &url, CURL &parsed)
+  {
+    return ShardOf(url).Get(url, parsed);
+  }
+
+  void Add(const std::string &url, const CURL &parsed)
+  {
+    ShardOf(url).Add(url, parsed);
+  }
+
+private:
+  CURLCacheShard &ShardOf(const std::string &url)
+  {
+    return m_shards[boost::hash<std::string>()(url) % URL_CACHE_SHARDS];
+  }
+
+  CURLCacheShard m_shards[URL_CACHE_SHARDS];
+};
+}
+
+static CURLCache &GetURLCache()
+{
+  // never deleted, urls are still parsed while the other statics go away
+  static CURLCache *cache = new CURLCache;
+  return *cache;
+}
+
+// made before main() starts any threads, urls parsed before this get it from GetURLCache() too
+static CURLCache &g_urlCache = GetURLCache();
+/* END PLEX */
+
 CURL::CURL(const CStdString& strURL1)
 {
   Parse(strURL1);
@@ -68,12 +155,32 @@ void CURL::Reset()
   m_strFileType.clear();
   m_strOptions.clear();
   m_strProtocolOptions.clear();
+#ifndef __PLEX__
   m_options.Clear();
   m_protocolOptions.Clear();
+#else
+  m_options.reset();
+  m_protocolOptions.reset();
+#endif
   m_iPort = 0;
 }
 
-void CURL::Parse(const CStdString& strURL1)
+/* PLEX */
+void CURL::Parse(const CStdString& strURL)
+{
+  // without a protocol it can be a path into an archive, whether it is depends on what is on disk
+  bool cacheable = strURL.size() <= URL_CACHE_MAX_LENGTH && strURL.Find("://") >= 0;
+  if (cacheable && GetURLCache().Get(strURL, *this))
+    return;
+
+  ParseURL(strURL);
+
+  if (cacheable)
+    GetURLCache().Add(strURL, *this);
+}
+/* END PLEX */
+
+void CURL::ParseURL(const CStdString& strURL1)
 {
   Reset();
   // start by validating the path
@@ -215,7 +322,11 @@ void CURL::Parse(const CStdString& strURL1)
       else
         m_strOptions = strURL.substr(iOptions);
       iEnd = iOptions;
+#ifndef __PLEX__
       m_options.AddOptions(m_strOptions);
+#else
+      m_options = ParseOptions(m_strOptions);
+#endif
     }
   }
 
@@ -397,13 +508,21 @@ void CURL::SetProtocol(const CStdString& strProtocol)
 void CURL::SetOptions(const CStdString& strOptions)
 {
   m_strOptions.Empty();
+#ifndef __PLEX__
   m_options.Clear();
+#else
+  m_options.reset();
+#endif
   if( strOptions.length() > 0)
   {
     if( strOptions[0] == '?' || strOptions[0] == '#' || strOptions[0] == ';' || strOptions.Find("xml") >=0 )
     {
       m_strOptions = strOptions;
+#ifndef __PLEX__
       m_options.AddOptions(m_strOptions);
+#else
+      m_options = ParseOptions(m_strOptions);
+#endif
     }
     else
       CLog::Log(LOGWARNING, "%s - Invalid options specified for url %s", __FUNCTION__, strOptions.c_str());
@@ -413,14 +532,22 @@ void CURL::SetOptions(const CStdString& strOptions)
 void CURL::SetProtocolOptions(const CStdString& strOptions)
 {
   m_strProtocolOptions.Empty();
+#ifndef __PLEX__
   m_protocolOptions.Clear();
+#else
+  m_protocolOptions.reset();
+#endif
   if (strOptions.length() > 0)
   {
     if (strOptions[0] == '|')
       m_strProtocolOptions = strOptions.Mid(1);
     else
       m_strProtocolOptions = strOptions;
+#ifndef __PLEX__
     m_protocolOptions.AddOptions(m_strProtocolOptions);
+#else
+    m_protocolOptions = ParseOptions(m_strProtocolOptions);
+#endif
   }
 }
 
@@ -786,20 +913,24 @@ CStdString CURL::TranslateProtocol(const CStdString& prot)
 
 void CURL::GetOptions(std::map<CStdString, CStdString> &options) const
 {
-  CUrlOptions::UrlOptions optionsMap = m_options.GetOptions();
+  /* PLEX */
+  if (!m_options)
+    return;
+  /* END PLEX */
+  const CUrlOptions::UrlOptions &optionsMap = m_options->GetOptions();
   for (CUrlOptions::UrlOptions::const_iterator option = optionsMap.begin(); option != optionsMap.end(); option++)
     options[option->first] = option->second.asString();
 }
 
 bool CURL::HasOption(const CStdString &key) const
 {
-  return m_options.HasOption(key);
+  return m_options && m_options->HasOption(key);
 }
 
 bool CURL::GetOption(const CStdString &key, CStdString &value) const
 {
   CVariant valueObj;
-  if (!m_options.GetOption(key, valueObj))
+  if (!m_options || !m_options->GetOption(key, valueObj))
     return false;
 
   value = valueObj.asString();
@@ -817,21 +948,25 @@ CStdString CURL::GetOption(const CStdString &key) const
 
 void CURL::SetOption(const CStdString &key, const CStdString &value)
 {
-  m_options.AddOption(key, value);
 #ifndef __PLEX__
+  m_options.AddOption(key, value);
   SetOptions(m_options.GetOptionsString(true));
 #else
-  m_strOptions = m_options.GetOptionsString(true);
+  CUrlOptions &options = WritableOptions(m_options);
+  options.AddOption(key, value);
+  m_strOptions = options.GetOptionsString(true);
 #endif
 }
 
 void CURL::RemoveOption(const CStdString &key)
 {
-  m_options.RemoveOption(key);
 #ifndef __PLEX__
+  m_options.RemoveOption(key);
   SetOptions(m_options.GetOptionsString(true));
 #else
-  m_strOptions = m_options.GetOptionsString(true);
+  CUrlOptions &options = WritableOptions(m_options);
+  options.RemoveOption(key);
+  m_strOptions = options.GetOptionsString(true);
 #endif
 }
 
@@ -849,29 +984,53 @@ CStdString CURL::GetUrlWithoutOptions() const
 
 void CURL::AddOptions(const CUrlOptions &options)
 {
+  CUrlOptions &ownOptions = WritableOptions(m_options);
   for (CUrlOptions::UrlOptions::const_iterator option = options.GetOptions().begin(); option != options.GetOptions().end(); option++)
-    m_options.AddOption(option->first, option->second.asString());
+    ownOptions.AddOption(option->first, option->second.asString());
 
-  m_strOptions = m_options.GetOptionsString(true);
+  m_strOptions = ownOptions.GetOptionsString(true);
+}
+
+CURL::CUrlOptionsPtr CURL::ParseOptions(const CStdString &strOptions)
+{
+  if (strOptions.empty())
+    return CUrlOptionsPtr();
+
+  return CUrlOptionsPtr(new CUrlOptions(strOptions));
+}
+
+CUrlOptions& CURL::WritableOptions(CUrlOptionsPtr &options)
+{
+  // the copies of a url share its options, the one that changes them gets its own
+  if (!options)
+    options.reset(new CUrlOptions);
+  else if (!options.unique())
+    options.reset(new CUrlOptions(*options));
+
+  return *options;
 }
 /* END PLEX */
 
 void CURL::GetProtocolOptions(std::map<CStdString, CStdString> &options) const
 {
-  CUrlOptions::UrlOptions optionsMap = m_protocolOptions.GetOptions();
+  /* PLEX */
+  if (!m_protocolOptions)
+    return;
+  /* END PLEX */
+  const CUrlOptions::UrlOptions &optionsMap = m_protocolOptions->GetOptions();
   for (CUrlOptions::UrlOptions::const_iterator option = optionsMap.begin(); option != optionsMap.end(); option++)
     options[option->first] = option->second.asString();
 }
 
 bool CURL::HasProtocolOption(const CStdString &key) const
 {
-  return m_protocolOptions.HasOption(key);
+  return m_protocolOptions && m_protocolOptions->HasOption(key);
 }
 
 bool CURL::GetProtocolOption(const CStdString &key, CStdString &value) const
 {
   CVariant valueObj;
-  if (!m_protocolOptions.GetOption(key, valueObj))
+  if (!m_protocolOptions || !m_protocolOptions->GetOption(key, valueObj))
     return false;
   
   value = valueObj.asString();
@@ -889,12 +1048,24 @@ CStdString CURL::GetProtocolOption(const CStdString &key) const
 
 void CURL::SetProtocolOption(const CStdString &key, const CStdString &value)
 {
+#ifndef __PLEX__
   m_protocolOptions.AddOption(key, value);
   m_strProtocolOptions = m_protocolOptions.GetOptionsString(false);
+#else
+  CUrlOptions &options = WritableOptions(m_protocolOptions);
+  options.AddOption(key, value);
+  m_strProtocolOptions = options.GetOptionsString(false);
+#endif
 }
 
 void CURL::RemoveProtocolOption(const CStdString &key)
 {
+#ifndef __PLEX__
   m_protocolOptions.RemoveOption(key);
   m_strProtocolOptions = m_protocolOptions.GetOptionsString(false);
+#else
+  CUrlOptions &options = WritableOptions(m_protocolOptions);
+  options.RemoveOption(key);
+  m_strProtocolOptions = options.GetOptionsString(false);
+#endif
 }
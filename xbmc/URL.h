@@ -28,8 +28,20 @@
 
 /* PLEX */
 #include <map>
+#include <boost/shared_ptr.hpp>
 /* END PLEX */
 
+/* PLEX */
+/* parsed urls are kept for when the same string is parsed again, up to this many of them */
+#define URL_CACHE_SIZE 1024
+/* in this many parts with a lock each, the part is picked by the hash of the string */
+#define URL_CACHE_SHARDS 16
+/* and only the ones up to this long, longer ones are rarely seen twice */
+#define URL_CACHE_MAX_LENGTH 2048
+
+/* The parsed options are shared by the copies of a CURL, the first one to change them gets its
+ * own. Copying a url is cheap that way and reading one from several threads is still safe. */
+/* END PLEX */
 class CURL
 {
 public:
@@ -99,6 +111,14 @@ public:
   void RemoveProtocolOption(const CStdString &key);
 
 protected:
+  /* PLEX */
+  typedef boost::shared_ptr<CUrlOptions> CUrlOptionsPtr;
+
+  void ParseURL(const CStdString& strURL);
+  static CUrlOptionsPtr ParseOptions(const CStdString& strOptions);
+  static CUrlOptions& WritableOptions(CUrlOptionsPtr& options);
+  /* END PLEX */
+
   int m_iPort;
   CStdString m_strHostName;
   CStdString m_strShareName;
@@ -110,6 +130,11 @@ protected:
   CStdString m_strFileType;
   CStdString m_strOptions;
   CStdString m_strProtocolOptions;
+#ifndef __PLEX__
   CUrlOptions m_options;
   CUrlOptions m_protocolOptions;
+#else
+  CUrlOptionsPtr m_options;         ///< NULL without options
+  CUrlOptionsPtr m_protocolOptions; ///< NULL without protocol options
+#endif
 };
@@ -87,12 +87,18 @@ bool CViewDatabase::GetViewState(const CStdString &path, int window, CViewState
     URIUtils::AddSlashAtEnd(path1);
     if (path1.IsEmpty()) path1 = "root://";
 
-    CStdString sql;
+    /* PLEX */
+    dbiplus::sql_record params;
+    params.push_back(window);
+    params.push_back(path1.c_str());
     if (skin.IsEmpty())
-      sql = PrepareSQL("select * from view where window = %i and path='%s'", window, path1.c_str());
+      m_pDS->query("select * from view where window = ? and path=?", params);
     else
-      sql = PrepareSQL("select * from view where window = %i and path='%s' and skin='%s'", window, path1.c_str(), skin.c_str());
-    m_pDS->query(sql.c_str());
+    {
+      params.push_back(skin.c_str());
+      m_pDS->query("select * from view where window = ? and path=? and skin=?", params);
+    }
+    /* END PLEX */
 
     if (!m_pDS->eof())
     { // have some information
@@ -122,21 +128,36 @@ bool CViewDatabase::SetViewState(const CStdString &path, int window, const CView
     URIUtils::AddSlashAtEnd(path1);
     if (path1.IsEmpty()) path1 = "root://";
 
-    CStdString sql = PrepareSQL("select idView from view where window = %i and path='%s' and skin='%s'", window, path1.c_str(), skin.c_str());
-    m_pDS->query(sql.c_str());
+    /* PLEX */
+    dbiplus::sql_record params;
+    params.push_back(window);
+    params.push_back(path1.c_str());
+    params.push_back(skin.c_str());
+    m_pDS->query("select idView from view where window = ? and path=? and skin=?", params);
     if (!m_pDS->eof())
     { // update the view
       int idView = m_pDS->fv("idView").get_asInt();
       m_pDS->close();
-      sql = PrepareSQL("update view set viewMode=%i,sortMethod=%i,sortOrder=%i where idView=%i", state.m_viewMode, (int)state.m_sortMethod, (int)state.m_sortOrder, idView);
-      m_pDS->exec(sql.c_str());
+      params.clear();
+      params.push_back(state.m_viewMode);
+      params.push_back((int)state.m_sortMethod);
+      params.push_back((int)state.m_sortOrder);
+      params.push_back(idView);
+      m_pDS->exec("update view set viewMode=?,sortMethod=?,sortOrder=? where idView=?", params);
     }
     else
     { // add the view
       m_pDS->close();
-      sql = PrepareSQL("insert into view (idView, path, window, viewMode, sortMethod, sortOrder, skin) values(NULL, '%s', %i, %i, %i, %i, '%s')", path1.c_str(), window, state.m_viewMode, (int)state.m_sortMethod, (int)state.m_sortOrder, skin.c_str());
-      m_pDS->exec(sql.c_str());
+      params.clear();
+      params.push_back(path1.c_str());
+      params.push_back(window);
+      params.push_back(state.m_viewMode);
+      params.push_back((int)state.m_sortMethod);
+      params.push_back((int)state.m_sortOrder);
+      params.push_back(skin.c_str());
+      m_pDS->exec("insert into view (idView, path, window, viewMode, sortMethod, sortOrder, skin) values(NULL, ?, ?, ?, ?, ?, ?)", params);
     }
+    /* END PLEX */
   }
   catch (...)
   {
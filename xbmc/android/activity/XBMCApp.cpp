@@ -44,6 +44,10 @@
 #include "guilib/GUIWindowManager.h"
 #include "utils/log.h"
 #include "ApplicationMessenger.h"
+/* PLEX */
+#include "plex/PlexApplication.h"
+#include "plex/Utility/PlexTextureResidency.h"
+/* END PLEX */
 
 #define GIGABYTES       1073741824
 
@@ -184,6 +188,11 @@ void CXBMCApp::onLowMemory()
 {
   android_printf("%s: %d", __PRETTY_FUNCTION__, m_state.appState);
   // can't do much as we don't want to close completely
+  /* PLEX */
+  // but the art that isn't on screen can go
+  if (g_plexApplication.textureResidency)
+    g_plexApplication.textureResidency->OnLowMemory();
+  /* END PLEX */
 }
 
 void CXBMCApp::onCreateWindow(ANativeWindow* window)
@@ -39,6 +39,9 @@
 #include "guilib/Texture.h"
 #include "guilib/LocalizeStrings.h"
 #include "guilib/MatrixGLES.h"
+/* PLEX */
+#include "guilib/GUITexture.h"
+/* END PLEX */
 #include "threads/SingleLock.h"
 #include "DllSwScale.h"
 #include "utils/log.h"
@@ -612,6 +615,10 @@ void CLinuxRendererGL::RenderUpdate(bool clear, DWORD flags, DWORD alpha)
     return;
   }
 
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+
   ManageDisplay();
   ManageTextures();
 
@@ -52,9 +52,55 @@
 /* PLEX */
 #include "guilib/LocalizeStrings.h"
 #include "FileSystem/PlexFile.h"
+#include "filesystem/StreamHeadCache.h"
+#include "threads/SingleLock.h"
 #include <boost/foreach.hpp>
+#include <list>
 
 typedef std::pair<std::string, std::string> stringPair;
+
+// what avformat_find_stream_info found out about the streams of a part, opening
+// the same part again takes it from here instead of probing again
+#define PROBE_CACHE_SIZE 16
+
+struct SProbedStream
+{
+  int         type;
+  int         codec_id;
+  unsigned    codec_tag;
+  int         width;
+  int         height;
+  int         pix_fmt;
+  int         has_b_frames;
+  AVRational  sample_aspect_ratio;
+  int         sample_rate;
+  int         channels;
+  uint64_t    channel_layout;
+  int         sample_fmt;
+  int         block_align;
+  int         bits_per_coded_sample;
+  int         bit_rate;
+  int         profile;
+  int         level;
+  AVRational  r_frame_rate;
+  AVRational  avg_frame_rate;
+  int64_t     start_time;
+  int64_t     duration;
+  std::string extradata;
+};
+
+struct SProbedPart
+{
+  CStdString                 key;
+  int64_t                    length;
+  int64_t                    start_time;
+  int64_t                    duration;
+  int                        bit_rate;
+  std::vector<SProbedStream> streams;
+};
+
+static CCriticalSection        g_probeCacheSection;
+static std::list<SProbedPart>  g_probeCache;
 /* END PLEX */
 
 void CDemuxStreamAudioFFmpeg::GetStreamInfo(std::string& strInfo)
@@ -511,6 +557,15 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
     if(m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD))
       m_dllAvUtil.av_opt_set_int(m_pFormatContext, "analyzeduration", 500000, 0);
 
+    /* PLEX */
+    CStdString probeKey = GetProbeKey();
+    if (!probeKey.empty() && ApplyProbedStreams(probeKey))
+    {
+      CLog::Log(LOGDEBUG, "%s - using the stream info of an earlier open", __FUNCTION__);
+    }
+    else
+    {
+    /* END PLEX */
 
     CLog::Log(LOGDEBUG, "%s - avformat_find_stream_info starting", __FUNCTION__);
     int iErr = m_dllAvFormat.avformat_find_stream_info(m_pFormatContext, NULL);
@@ -528,6 +583,12 @@ bool CDVDDemuxFFmpeg::Open(CDVDInputStream* pInput)
       }
     }
     CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
+
+    /* PLEX */
+      if (iErr >= 0 && !probeKey.empty())
+        StoreProbedStreams(probeKey);
+    }
+    /* END PLEX */
   }
   // reset any timeout
   m_timeout.SetInfinite();
@@ -1498,6 +1559,157 @@ int CDVDDemuxFFmpeg::GetStreamBitrate()
     return aggregateBitrate;
 }
 
+/* Only parts whose container describes all streams in its header are worth it,
+ * transcoder output is different every time. */
+CStdString CDVDDemuxFFmpeg::GetProbeKey()
+{
+  if (!m_bMatroska && !strstr(m_pFormatContext->iformat->name, "mp4"))
+    return "";
+
+  if (m_dllAvUtil.av_dict_get(m_pFormatContext->metadata, "plex.total_duration", NULL, 0))
+    return "";
+
+  CURL url(m_pInput->GetFileName());
+  if (url.GetFileName().Find("transcode") != -1)
+    return "";
+
+  return XFILE::CStreamHeadCache::GetKey(url);
+}
+
+bool CDVDDemuxFFmpeg::ApplyProbedStreams(const CStdString& key)
+{
+  CSingleLock lock(g_probeCacheSection);
+
+  std::list<SProbedPart>::iterator it;
+  for (it = g_probeCache.begin(); it != g_probeCache.end(); ++it)
+  {
+    if (it->key == key)
+      break;
+  }
+
+  if (it == g_probeCache.end())
+    return false;
+
+  // the part changed if the header doesn't describe the same streams
+  if (it->length != m_pInput->GetLength() || it->streams.size() != m_pFormatContext->nb_streams)
+    return false;
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    AVCodecContext* codec = m_pFormatContext->streams[i]->codec;
+    if (codec->codec_type != it->streams[i].type || codec->codec_id != it->streams[i].codec_id)
+      return false;
+  }
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    const SProbedStream& probed = it->streams[i];
+    AVStream* st = m_pFormatContext->streams[i];
+    AVCodecContext* codec = st->codec;
+
+    codec->codec_tag             = probed.codec_tag;
+    codec->width                 = probed.width;
+    codec->height                = probed.height;
+    codec->pix_fmt               = (PixelFormat)probed.pix_fmt;
+    codec->has_b_frames          = probed.has_b_frames;
+    codec->sample_aspect_ratio   = probed.sample_aspect_ratio;
+    codec->sample_rate           = probed.sample_rate;
+    codec->channels              = probed.channels;
+    codec->channel_layout        = probed.channel_layout;
+    codec->sample_fmt            = (AVSampleFormat)probed.sample_fmt;
+    codec->block_align           = probed.block_align;
+    codec->bits_per_coded_sample = probed.bits_per_coded_sample;
+    codec->bit_rate              = probed.bit_rate;
+    codec->profile               = probed.profile;
+    codec->level                 = probed.level;
+
+    st->r_frame_rate   = probed.r_frame_rate;
+    st->avg_frame_rate = probed.avg_frame_rate;
+    if (st->start_time == (int64_t)AV_NOPTS_VALUE)
+      st->start_time = probed.start_time;
+    if (st->duration == (int64_t)AV_NOPTS_VALUE)
+      st->duration = probed.duration;
+
+    if (codec->extradata_size == 0 && !probed.extradata.empty())
+    {
+      codec->extradata = (uint8_t*)m_dllAvUtil.av_mallocz(probed.extradata.size() + FF_INPUT_BUFFER_PADDING_SIZE);
+      if (codec->extradata)
+      {
+        memcpy(codec->extradata, probed.extradata.data(), probed.extradata.size());
+        codec->extradata_size = probed.extradata.size();
+      }
+    }
+  }
+
+  if (m_pFormatContext->start_time == (int64_t)AV_NOPTS_VALUE)
+    m_pFormatContext->start_time = it->start_time;
+  if (m_pFormatContext->duration == (int64_t)AV_NOPTS_VALUE)
+    m_pFormatContext->duration = it->duration;
+  if (m_pFormatContext->bit_rate == 0)
+    m_pFormatContext->bit_rate = it->bit_rate;
+
+  g_probeCache.splice(g_probeCache.begin(), g_probeCache, it);
+  return true;
+}
+
+void CDVDDemuxFFmpeg::StoreProbedStreams(const CStdString& key)
+{
+  SProbedPart part;
+  part.key        = key;
+  part.length     = m_pInput->GetLength();
+  part.start_time = m_pFormatContext->start_time;
+  part.duration   = m_pFormatContext->duration;
+  part.bit_rate   = m_pFormatContext->bit_rate;
+
+  for (unsigned int i = 0; i < m_pFormatContext->nb_streams; i++)
+  {
+    AVStream* st = m_pFormatContext->streams[i];
+    AVCodecContext* codec = st->codec;
+
+    SProbedStream probed;
+    probed.type                  = codec->codec_type;
+    probed.codec_id              = codec->codec_id;
+    probed.codec_tag             = codec->codec_tag;
+    probed.width                 = codec->width;
+    probed.height                = codec->height;
+    probed.pix_fmt               = codec->pix_fmt;
+    probed.has_b_frames          = codec->has_b_frames;
+    probed.sample_aspect_ratio   = codec->sample_aspect_ratio;
+    probed.sample_rate           = codec->sample_rate;
+    probed.channels              = codec->channels;
+    probed.channel_layout        = codec->channel_layout;
+    probed.sample_fmt            = codec->sample_fmt;
+    probed.block_align           = codec->block_align;
+    probed.bits_per_coded_sample = codec->bits_per_coded_sample;
+    probed.bit_rate              = codec->bit_rate;
+    probed.profile               = codec->profile;
+    probed.level                 = codec->level;
+    probed.r_frame_rate          = st->r_frame_rate;
+    probed.avg_frame_rate        = st->avg_frame_rate;
+    probed.start_time            = st->start_time;
+    probed.duration              = st->duration;
+    if (codec->extradata && codec->extradata_size > 0)
+      probed.extradata.assign((const char*)codec->extradata, codec->extradata_size);
+
+    part.streams.push_back(probed);
+  }
+
+  CSingleLock lock(g_probeCacheSection);
+
+  for (std::list<SProbedPart>::iterator it = g_probeCache.begin(); it != g_probeCache.end(); ++it)
+  {
+    if (it->key == key)
+    {
+      g_probeCache.erase(it);
+      break;
+    }
+  }
+
+  g_probeCache.push_front(part);
+  if (g_probeCache.size() > PROBE_CACHE_SIZE)
+    g_probeCache.pop_back();
+}
+
 CStdString CDVDDemuxFFmpeg::GetErrorString(int code)
 {
   switch (code)
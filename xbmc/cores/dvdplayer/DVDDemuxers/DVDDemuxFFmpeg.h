@@ -149,6 +149,10 @@ protected:
   XbmcThreads::EndTime  m_timeout;
 
   /* PLEX */
+  CStdString GetProbeKey();
+  bool ApplyProbedStreams(const CStdString& key);
+  void StoreProbedStreams(const CStdString& key);
+
   bool m_bPlexTranscode;
   /* END PLEX */
 };
@@ -105,6 +105,7 @@
 #include "Client/PlexTranscoderClient.h"
 #include "PlexApplication.h"
 #include "FileSystem/PlexFile.h"
+#include "Client/PlexPlaybackPrefetcher.h"
 
 static StreamType ConvertPlexStreamType(int plexStreamType);
 static void UpdatePlexSelectionStream(SelectionStream &s, const CFileItemPtr &part);
@@ -2501,6 +2502,12 @@ void CDVDPlayer::SetCaching(ECacheState state)
     m_dvdPlayerAudio.SetSpeed(m_playSpeed);
     m_dvdPlayerVideo.SetSpeed(m_playSpeed);
     m_pInputStream->ResetScanTimeout(0);
+
+    /* PLEX */
+    // the clock runs, the first frame goes up now
+    if (g_plexApplication.playbackPrefetcher)
+      g_plexApplication.playbackPrefetcher->PlaybackStarted();
+    /* END PLEX */
   }
   m_caching = state;
 }
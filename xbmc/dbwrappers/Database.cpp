@@ -244,6 +244,28 @@ bool CDatabase::ExecuteQuery(const CStdString &strQuery)
   return bReturn;
 }
 
+/* PLEX */
+bool CDatabase::ExecuteQuery(const CStdString &strQuery, const dbiplus::sql_record &params)
+{
+  bool bReturn = false;
+
+  try
+  {
+    if (NULL == m_pDB.get()) return bReturn;
+    if (NULL == m_pDS.get()) return bReturn;
+    m_pDS->exec(strQuery, params);
+    bReturn = true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s'",
+        __FUNCTION__, strQuery.c_str());
+  }
+
+  return bReturn;
+}
+/* END PLEX */
+
 bool CDatabase::ResultQuery(const CStdString &strQuery)
 {
   bool bReturn = false;
@@ -285,6 +307,21 @@ bool CDatabase::QueueInsertQuery(const CStdString &strQuery)
   return true;
 }
 
+/* PLEX */
+bool CDatabase::QueueInsertQuery(const CStdString &strQuery, const dbiplus::sql_record &params)
+{
+  if (strQuery.IsEmpty())
+    return false;
+
+  if (NULL == m_pDB.get()) return false;
+  if (NULL == m_pDS2.get()) return false;
+
+  m_queuedQueries.push_back(std::make_pair(strQuery, params));
+
+  return true;
+}
+/* END PLEX */
+
 bool CDatabase::CommitInsertQueries()
 {
   bool bReturn = true;
@@ -305,6 +342,34 @@ bool CDatabase::CommitInsertQueries()
     }
   }
 
+  /* PLEX */
+  if (!m_queuedQueries.empty())
+  {
+    // one transaction for all of them, unless the caller has one open already
+    bool ownTransaction = !m_pDB->in_transaction();
+    try
+    {
+      if (ownTransaction)
+        m_pDB->start_transaction();
+
+      for (size_t i = 0; i < m_queuedQueries.size(); i++)
+        m_pDS2->exec(m_queuedQueries[i].first, m_queuedQueries[i].second);
+
+      if (ownTransaction)
+        m_pDB->commit_transaction();
+    }
+    catch (...)
+    {
+      if (ownTransaction)
+        m_pDB->rollback_transaction();
+      bReturn = false;
+      CLog::Log(LOGERROR, "%s - failed to execute %d queries with parameters",
+          __FUNCTION__, (int)m_queuedQueries.size());
+    }
+    m_queuedQueries.clear();
+  }
+  /* END PLEX */
+
   return bReturn;
 }
 
@@ -436,7 +501,11 @@ bool CDatabase::Connect(const CStdString &dbName, const DatabaseSettings &dbSett
   // create the appropriate database structure
   if (dbSettings.type.Equals("sqlite3"))
   {
-    m_pDB.reset( new SqliteDatabase() ) ;
+    /* PLEX */
+    SqliteDatabase *sqlite = new SqliteDatabase();
+    sqlite->setStatementCacheSize(g_advancedSettings.m_sqliteStatementCache);
+    m_pDB.reset(sqlite);
+    /* END PLEX */
   }
 #ifdef HAS_MYSQL
   else if (dbSettings.type.Equals("mysql"))
@@ -495,8 +564,21 @@ bool CDatabase::Connect(const CStdString &dbName, const DatabaseSettings &dbSett
     // sqlite3 post connection operations
     if (dbSettings.type.Equals("sqlite3"))
     {
-      m_pDS->exec("PRAGMA cache_size=4096\n");
-      m_pDS->exec("PRAGMA synchronous='NORMAL'\n");
+      /* PLEX */
+      try
+      {
+        // it is persistent, another connection to the database may be busy while it is changed
+        m_pDS->exec(PrepareSQL("PRAGMA journal_mode='%s'\n", g_advancedSettings.m_sqliteJournalMode.c_str()));
+      }
+      catch (DbErrors &error)
+      {
+        CLog::Log(LOGWARNING, "%s unable to set journal mode %s: %s", __FUNCTION__,
+                  g_advancedSettings.m_sqliteJournalMode.c_str(), error.getMsg());
+      }
+      m_pDS->exec(PrepareSQL("PRAGMA cache_size=%u\n", g_advancedSettings.m_sqliteCacheSize));
+      m_pDS->exec(PrepareSQL("PRAGMA synchronous='%s'\n", g_advancedSettings.m_sqliteSynchronous.c_str()));
+      m_pDS->exec(PrepareSQL("PRAGMA mmap_size=%u\n", g_advancedSettings.m_sqliteMmapSize));
+      /* END PLEX */
       m_pDS->exec("PRAGMA count_changes='OFF'\n");
     }
   }
@@ -21,6 +21,9 @@
  */
 
 #include "utils/StdString.h"
+/* PLEX */
+#include "qry_dat.h"
+/* END PLEX */
 
 namespace dbiplus {
   class Database;
@@ -109,6 +112,16 @@ public:
    */
   bool ExecuteQuery(const CStdString &strQuery);
 
+  /* PLEX */
+  /*!
+   * @brief Execute a query that does not return any result, with its ? bound to params in order.
+   * @param strQuery The query to execute.
+   * @param params The values of its parameters.
+   * @return True if the query was executed successfully, false otherwise.
+   */
+  bool ExecuteQuery(const CStdString &strQuery, const dbiplus::sql_record &params);
+  /* END PLEX */
+
   /*!
    * @brief Execute a query that returns a result.
    * @remarks Call m_pDS->close(); to clean up the dataset when done.
@@ -130,6 +143,17 @@ public:
    */
   bool QueueInsertQuery(const CStdString &strQuery);
 
+  /* PLEX */
+  /*!
+   * @brief Put a query with parameters in the queue, the ? in it are bound to params in order.
+   * They are committed together in one transaction after the queries without parameters.
+   * @param strQuery The query to queue.
+   * @param params The values of its parameters.
+   * @return True if the query was added successfully, false otherwise.
+   */
+  bool QueueInsertQuery(const CStdString &strQuery, const dbiplus::sql_record &params);
+  /* END PLEX */
+
   /*!
    * @brief Commit all queries in the queue.
    * @return True if all queries were executed successfully, false otherwise.
@@ -172,5 +196,8 @@ private:
   bool UpdateVersionNumber();
 
   bool m_bMultiWrite; /*!< True if there are any queries in the queue, false otherwise */
+  /* PLEX */
+  std::vector<std::pair<CStdString, dbiplus::sql_record> > m_queuedQueries; /*!< queued queries with parameters */
+  /* END PLEX */
   unsigned int m_openCount;
 };
@@ -193,6 +193,52 @@ void Dataset::parse_sql(string &sql) {
 }
 
 
+string Dataset::bind_params(const string &sql, const sql_record &params) {
+  if (db == NULL) throw DbErrors("No Database Connection");
+
+  string result;
+  unsigned int param = 0;
+  bool quoted = false;
+
+  for (unsigned int i = 0; i < sql.size(); i++)
+  {
+    if (sql[i] == '\'')
+      quoted = !quoted;
+
+    if (sql[i] != '?' || quoted)
+    {
+      result += sql[i];
+      continue;
+    }
+
+    if (param >= params.size())
+      throw DbErrors("Not enough parameters for query: %s", sql.c_str());
+
+    const field_value &value = params[param++];
+    if (value.get_isNull())
+      result += "NULL";
+    else if (value.get_fType() == ft_String || value.get_fType() == ft_Char)
+      result += db->prepare("'%s'", value.get_asString().c_str());
+    else if (value.get_fType() == ft_Boolean)
+      result += value.get_asBool() ? "1" : "0";
+    else
+      result += value.get_asString();
+  }
+
+  return result;
+}
+
+
+int Dataset::exec(const string &sql, const sql_record &params) {
+  return exec(bind_params(sql, params));
+}
+
+
+bool Dataset::query(const string &sql, const sql_record &params) {
+  return query(bind_params(sql, params).c_str());
+}
+
+
 void Dataset::close(void) {
   haveError  = false;
   frecno = 0;
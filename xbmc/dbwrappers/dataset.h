@@ -251,6 +251,9 @@ protected:
 /* Returns old field value (for :OLD) */
   virtual const field_value f_old(const char *f);
 
+/* Replaces each ? outside of quotes in sql with the next of params, formatted by the database */
+  std::string bind_params(const std::string &sql, const sql_record &params);
+
 public:
 
  virtual int str_compare(const char * s1, const char * s2);
@@ -296,6 +299,9 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const char *sql) = 0;
+/* as exec and query, the ? in sql take the values of params in order */
+  virtual int  exec (const std::string &sql, const sql_record &params);
+  virtual bool query(const std::string &sql, const sql_record &params);
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
@@ -79,6 +79,48 @@ int callback(void* res_ptr,int ncol, char** reslt,char** cols)
   return 0;  
 }
 
+// binds params to the ? of a prepared statement in order
+static int bind_statement(sqlite3_stmt *stmt, const sql_record &params)
+{
+  if ((int)params.size() != sqlite3_bind_parameter_count(stmt))
+    return SQLITE_RANGE;
+
+  for (unsigned int i = 0; i < params.size(); i++)
+  {
+    const field_value &v = params[i];
+    int rc;
+    if (v.get_isNull())
+      rc = sqlite3_bind_null(stmt, i + 1);
+    else
+    {
+      switch (v.get_fType())
+      {
+      case ft_Boolean:
+      case ft_Short:
+      case ft_UShort:
+      case ft_Int:
+      case ft_UInt:
+      case ft_Int64:
+        rc = sqlite3_bind_int64(stmt, i + 1, v.get_asInt64());
+        break;
+      case ft_Float:
+      case ft_Double:
+        rc = sqlite3_bind_double(stmt, i + 1, v.get_asDouble());
+        break;
+      default:
+        {
+          string value = v.get_asString();
+          rc = sqlite3_bind_text(stmt, i + 1, value.c_str(), value.size(), SQLITE_TRANSIENT);
+        }
+        break;
+      }
+    }
+    if (rc != SQLITE_OK)
+      return rc;
+  }
+  return SQLITE_OK;
+}
+
 static int busy_callback(void*, int busyCount)
 {
 	Sleep(100);
@@ -92,6 +134,7 @@ SqliteDatabase::SqliteDatabase() {
 
   active = false;	
   _in_transaction = false;		// for transaction
+  statement_cache_size = SQLITE_STATEMENT_CACHE_SIZE;
 
   error = "Unknown database error";//S_NO_CONNECTION;
   host = "localhost";
@@ -260,10 +303,55 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  // the connection doesn't close with statements left
+  clearStatements();
   sqlite3_close(conn);
   active = false;
 }
 
+sqlite3_stmt *SqliteDatabase::getStatement(const char *sql) {
+  std::map<string, StatementList::iterator>::iterator it = statement_index.find(sql);
+  if (it != statement_index.end())
+  {
+    statements.splice(statements.begin(), statements, it->second);
+    sqlite3_stmt *stmt = it->second->second;
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    return stmt;
+  }
+
+  sqlite3_stmt *stmt = NULL;
+  if (setErr(sqlite3_prepare_v2(conn, sql, -1, &stmt, NULL), sql) != SQLITE_OK || stmt == NULL)
+  {
+    sqlite3_finalize(stmt);
+    return NULL;
+  }
+
+  statements.push_front(make_pair(string(sql), stmt));
+  statement_index[sql] = statements.begin();
+
+  // the one just compiled is kept even without a cache, it is in use until the next call
+  while (statements.size() > 1 && statements.size() > statement_cache_size)
+  {
+    sqlite3_finalize(statements.back().second);
+    statement_index.erase(statements.back().first);
+    statements.pop_back();
+  }
+
+  return stmt;
+}
+
+void SqliteDatabase::setStatementCacheSize(unsigned int size) {
+  statement_cache_size = size;
+}
+
+void SqliteDatabase::clearStatements() {
+  for (StatementList::iterator it = statements.begin(); it != statements.end(); ++it)
+    sqlite3_finalize(it->second);
+  statements.clear();
+  statement_index.clear();
+}
+
 int SqliteDatabase::create() {
   return connect(true);
 }
@@ -611,6 +699,69 @@ bool SqliteDataset::query(const char *query) {
   if (db->setErr(sqlite3_prepare_v2(handle(),query,-1,&stmt, NULL),query) != SQLITE_OK)
     throw DbErrors(db->getErrorMsg());
 
+  read_rows(stmt);
+
+  if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
+  {
+    active = true;
+    ds_state = dsSelect;
+    this->first();
+    return true;
+  }
+  else
+  {
+    throw DbErrors(db->getErrorMsg());
+  }  
+}
+
+bool SqliteDataset::query(const string &q){
+  return query(q.c_str());
+}
+
+bool SqliteDataset::query(const string &sql, const sql_record &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+
+  close();
+
+  sqlite3_stmt *stmt = static_cast<SqliteDatabase*>(db)->getStatement(sql.c_str());
+  if (stmt == NULL)
+    throw DbErrors(db->getErrorMsg());
+
+  if (db->setErr(bind_statement(stmt, params), sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  read_rows(stmt);
+
+  // a statement that isn't reset keeps its read transaction
+  if (db->setErr(sqlite3_reset(stmt), sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
+int SqliteDataset::exec(const string &sql, const sql_record &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+  exec_res.clear();
+
+  sqlite3_stmt *stmt = static_cast<SqliteDatabase*>(db)->getStatement(sql.c_str());
+  if (stmt == NULL)
+    throw DbErrors(db->getErrorMsg());
+
+  if (db->setErr(bind_statement(stmt, params), sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  while (sqlite3_step(stmt) == SQLITE_ROW) {}
+
+  int res = db->setErr(sqlite3_reset(stmt), sql.c_str());
+  if (res != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+  return res;
+}
+
+void SqliteDataset::read_rows(sqlite3_stmt *stmt) {
   // column headers
   const unsigned int numColumns = sqlite3_column_count(stmt);
   result.record_header.resize(numColumns);
@@ -648,21 +799,6 @@ bool SqliteDataset::query(const char *query) {
     }
     result.records.push_back(res);
   }
-  if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
-  {
-    active = true;
-    ds_state = dsSelect;
-    this->first();
-    return true;
-  }
-  else
-  {
-    throw DbErrors(db->getErrorMsg());
-  }  
-}
-
-bool SqliteDataset::query(const string &q){
-  return query(q.c_str());
 }
 
 void SqliteDataset::open(const string &sql) {
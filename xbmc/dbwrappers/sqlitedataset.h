@@ -30,9 +30,14 @@
 #define _SQLITEDATASET_H
 
 #include <stdio.h>
+#include <list>
+#include <map>
 #include "dataset.h"
 #include <sqlite3.h>
 
+/* how many compiled statements with parameters a connection keeps by default */
+#define SQLITE_STATEMENT_CACHE_SIZE 32
+
 namespace dbiplus {
 /***************** Class SqliteDatabase definition ******************
 
@@ -46,6 +51,14 @@ protected:
   bool _in_transaction;
   int last_err;
 
+/* compiled statements by their sql, the most recently used first */
+  typedef std::list<std::pair<std::string, sqlite3_stmt*> > StatementList;
+  StatementList statements;
+  std::map<std::string, StatementList::iterator> statement_index;
+  unsigned int statement_cache_size;
+
+  void clearStatements();
+
 public:
 /* default constructor */
   SqliteDatabase();
@@ -56,6 +69,11 @@ public:
 
 /* func. returns connection handle with SQLite-server */
   sqlite3 *getHandle() {  return conn; }
+/* func. returns the compiled statement for sql, reset and without bindings. It is kept with
+   the connection for the next time, NULL if sql doesn't compile */
+  sqlite3_stmt *getStatement(const char *sql);
+/* sets how many compiled statements are kept, the least recently used are dropped beyond it */
+  void setStatementCacheSize(unsigned int size);
 /* func. returns current status about SQLite-server connection */
   virtual int status();
   virtual int setErr(int err_code,const char * qry);
@@ -108,6 +126,9 @@ class SqliteDataset : public Dataset {
 protected:
   sqlite3* handle();
 
+/* reads the rows of a prepared statement into the result */
+  void read_rows(sqlite3_stmt *stmt);
+
 /* Makes direct queries to database */
   virtual void make_query(StringList &_sql);
 /* Makes direct inserts into database */
@@ -147,6 +168,9 @@ or insert() operations default = false) */
 /* as open, but with our query exept Sql */
   virtual bool query(const char *query);
   virtual bool query(const std::string &query);
+/* as exec and query, with the parameters bound to a statement the connection keeps compiled */
+  virtual int  exec (const std::string &sql, const sql_record &params);
+  virtual bool query(const std::string &sql, const sql_record &params);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
@@ -0,0 +1,195 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dbwrappers/sqlitedataset.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/SystemClock.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+using namespace dbiplus;
+
+#define TEST_DB_NAME "TestSqliteDataset.db"
+
+class TestSqliteDataset : public testing::Test
+{
+protected:
+  TestSqliteDataset()
+  {
+    path = CSpecialProtocol::TranslatePath("special://temp/");
+    removeFiles();
+
+    db.setHostName(path.c_str());
+    db.setDatabase(TEST_DB_NAME);
+    db.connect(true);
+    ds.reset(db.CreateDataset());
+    ds->exec("CREATE TABLE texture (id integer primary key, url text, cachedurl text, width integer)");
+    ds->exec("CREATE INDEX idxTexture ON texture(url)");
+  }
+
+  ~TestSqliteDataset()
+  {
+    ds.reset();
+    db.disconnect();
+    removeFiles();
+  }
+
+  void removeFiles()
+  {
+    XFILE::CFile::Delete(path + TEST_DB_NAME);
+    XFILE::CFile::Delete(path + TEST_DB_NAME "-wal");
+    XFILE::CFile::Delete(path + TEST_DB_NAME "-shm");
+  }
+
+  CStdString path;
+  SqliteDatabase db;
+  std::auto_ptr<Dataset> ds;
+};
+
+TEST_F(TestSqliteDataset, BindParameters)
+{
+  sql_record params;
+  params.push_back("it's a 'quoted' url?");
+  params.push_back("%s %i");
+  params.push_back(1920);
+  EXPECT_EQ(SQLITE_OK, ds->exec("INSERT INTO texture (id, url, cachedurl, width) VALUES(NULL, ?, ?, ?)", params));
+
+  field_value null;
+  null.set_isNull();
+  params.clear();
+  params.push_back(null);
+  params.push_back(false);
+  params.push_back(7.5);
+  ds->exec("INSERT INTO texture (id, url, cachedurl, width) VALUES(NULL, ?, ?, ?)", params);
+
+  params.clear();
+  params.push_back("it's a 'quoted' url?");
+  EXPECT_TRUE(ds->query("SELECT cachedurl, width FROM texture WHERE url=?", params));
+  ASSERT_FALSE(ds->eof());
+  EXPECT_STREQ("%s %i", ds->fv(0).get_asString().c_str());
+  EXPECT_EQ(1920, ds->fv(1).get_asInt());
+  ds->next();
+  EXPECT_TRUE(ds->eof());
+  ds->close();
+
+  params.clear();
+  EXPECT_TRUE(ds->query("SELECT url, cachedurl, width FROM texture WHERE url IS NULL", params));
+  ASSERT_FALSE(ds->eof());
+  EXPECT_EQ(0, ds->fv(1).get_asInt());
+  EXPECT_EQ(7.5, ds->fv(2).get_asDouble());
+  ds->close();
+}
+
+TEST_F(TestSqliteDataset, WrongParameterCount)
+{
+  sql_record params;
+  params.push_back("url");
+  EXPECT_THROW(ds->query("SELECT * FROM texture WHERE url=? AND width=?", params), DbErrors);
+  EXPECT_THROW(ds->exec("DELETE FROM texture", params), DbErrors);
+  EXPECT_THROW(ds->exec("DELETE FROM texture WHERE unknown=?", params), DbErrors);
+}
+
+TEST_F(TestSqliteDataset, StatementCache)
+{
+  db.setStatementCacheSize(2);
+
+  sqlite3_stmt *a = db.getStatement("SELECT 1");
+  ASSERT_TRUE(a != NULL);
+  EXPECT_EQ(a, db.getStatement("SELECT 1"));
+
+  db.getStatement("SELECT 2");
+  EXPECT_EQ(a, db.getStatement("SELECT 1"));
+
+  // "SELECT 2" is the least recently used one now
+  db.getStatement("SELECT 3");
+  EXPECT_EQ(a, db.getStatement("SELECT 1"));
+
+  EXPECT_TRUE(db.getStatement("SELECT * FROM nothere") == NULL);
+}
+
+TEST_F(TestSqliteDataset, Performance)
+{
+  const int count = 1000;
+  CStdString sql;
+
+  // the way it was done, a query string and a commit for each row
+  ds->exec("PRAGMA journal_mode=DELETE");
+  ds->exec("PRAGMA synchronous=NORMAL");
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (int i = 0; i < count; i++)
+  {
+    sql = db.prepare("INSERT INTO texture (id, url, cachedurl, width) VALUES(NULL, 'http://server/%i', 'a/%i.jpg', %i)", i, i, i);
+    ds->exec(sql);
+  }
+  unsigned int insertBefore = XbmcThreads::SystemClockMillis() - start;
+
+  start = XbmcThreads::SystemClockMillis();
+  for (int i = 0; i < count; i++)
+  {
+    sql = db.prepare("SELECT cachedurl, width FROM texture WHERE url='http://server/%i'", i);
+    ds->query(sql);
+    EXPECT_EQ(i, ds->fv(1).get_asInt());
+    ds->close();
+  }
+  unsigned int lookupBefore = XbmcThreads::SystemClockMillis() - start;
+
+  // WAL, bound parameters and one transaction for all of them
+  ds->exec("DELETE FROM texture");
+  ds->exec("PRAGMA journal_mode=WAL");
+
+  start = XbmcThreads::SystemClockMillis();
+  db.start_transaction();
+  sql_record params;
+  for (int i = 0; i < count; i++)
+  {
+    params.clear();
+    sql = db.prepare("http://server/%i", i);
+    params.push_back(sql.c_str());
+    sql = db.prepare("a/%i.jpg", i);
+    params.push_back(sql.c_str());
+    params.push_back(i);
+    ds->exec("INSERT INTO texture (id, url, cachedurl, width) VALUES(NULL, ?, ?, ?)", params);
+  }
+  db.commit_transaction();
+  unsigned int insertAfter = XbmcThreads::SystemClockMillis() - start;
+
+  start = XbmcThreads::SystemClockMillis();
+  for (int i = 0; i < count; i++)
+  {
+    params.clear();
+    sql = db.prepare("http://server/%i", i);
+    params.push_back(sql.c_str());
+    ds->query("SELECT cachedurl, width FROM texture WHERE url=?", params);
+    EXPECT_EQ(i, ds->fv(1).get_asInt());
+    ds->close();
+  }
+  unsigned int lookupAfter = XbmcThreads::SystemClockMillis() - start;
+
+  std::cout << "Inserts/s  before: " << count * 1000.0 / std::max(insertBefore, 1u)
+            << " after: " << count * 1000.0 / std::max(insertAfter, 1u) << std::endl;
+  std::cout << "Lookups/s  before: " << count * 1000.0 / std::max(lookupBefore, 1u)
+            << " after: " << count * 1000.0 / std::max(lookupAfter, 1u) << std::endl;
+}
@@ -57,6 +57,19 @@ public:
   virtual bool IsEndOfInput();
   virtual void ClearEndOfInput();
 
+  /* PLEX */
+  /*! \brief End of the cached data that is contiguous from pos
+   \return pos if nothing is cached there, or -1 if the strategy only holds
+   data contiguous with the write position (so refilling never makes sense)
+   */
+  virtual int64_t CachedDataEnd(int64_t pos) { return -1; }
+
+  /*! \brief Move where the next write goes without dropping cached data or
+   moving the read position. Only used when CachedDataEnd is supported.
+   */
+  virtual void SetWritePosition(int64_t pos) {}
+  /* END PLEX */
+
   CEvent m_space;
 protected:
   bool  m_bEndOfInput;
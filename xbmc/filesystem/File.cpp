@@ -34,7 +34,8 @@
 #include "commons/Exception.h"
 
 /* PLEX */
-#include "CircularCache.h"
+#include "SegmentCache.h"
+#include "settings/AdvancedSettings.h"
 /* END PLEX */
 
 using namespace XFILE;
@@ -239,8 +240,9 @@ bool CFile::Open(const CStdString& strFileName, unsigned int flags, size_t cache
       /* PLEX */
       if (cacheSize > 0)
       {
-        CCircularCache *cirCache = new CCircularCache(cacheSize, std::max<unsigned int>(cacheSize / 4, 1024 * 1024));
-        m_pFile = new CFileCache(cirCache, true);
+        CSegmentCache *segCache = new CSegmentCache(cacheSize, std::max<unsigned int>(cacheSize / 4, 1024 * 1024),
+                                                    g_advancedSettings.m_cacheDiskBufferSize);
+        m_pFile = new CFileCache(segCache, true);
       }
       /* END PLEX */
       else
@@ -26,6 +26,11 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+/* PLEX */
+#include "SegmentCache.h"
+#include "RangePrefetcher.h"
+#include "StreamHeadCache.h"
+/* END PLEX */
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -36,6 +41,12 @@ using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (64*1024)
 
+/* PLEX */
+#define READ_AHEAD_MAX_SECONDS 10
+#define PREFETCH_TRIGGER_MS    5000
+#define PREFETCH_RANGE_SIZE    (1024*1024)
+/* END PLEX */
+
 class CWriteRate
 {
 public:
@@ -85,11 +96,21 @@ CFileCache::CFileCache() : CThread("CFileCache")
    m_seekPos = 0;
    m_readPos = 0;
    m_writePos = 0;
+   /* PLEX */
+   m_refillPos = -1;
+   m_prefetcher = NULL;
+   /* END PLEX */
    if (g_advancedSettings.m_cacheMemBufferSize == 0)
      m_pCache = new CSimpleFileCache();
    else
+#ifndef __PLEX__
      m_pCache = new CCircularCache(g_advancedSettings.m_cacheMemBufferSize
                                  , std::max<unsigned int>( g_advancedSettings.m_cacheMemBufferSize / 4, 1024 * 1024));
+#else
+     m_pCache = new CSegmentCache(g_advancedSettings.m_cacheMemBufferSize
+                                , std::max<unsigned int>( g_advancedSettings.m_cacheMemBufferSize / 4, 1024 * 1024)
+                                , g_advancedSettings.m_cacheDiskBufferSize);
+#endif
    m_seekPossible = 0;
    m_cacheFull = false;
 }
@@ -103,6 +124,10 @@ CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache) : CThread("CFi
   m_writePos = 0;
   m_nSeekResult = 0;
   m_chunkSize = 0;
+  /* PLEX */
+  m_refillPos = -1;
+  m_prefetcher = NULL;
+  /* END PLEX */
 }
 
 CFileCache::~CFileCache()
@@ -174,6 +199,14 @@ bool CFileCache::Open(const CURL& url)
   m_cacheFull = false;
   m_seekEvent.Reset();
   m_seekEnded.Reset();
+  /* PLEX */
+  m_refillPos = -1;
+  m_prefetchFailed = false;
+  m_rateKnown = false;
+  m_behindSince = 0;
+
+  SeedFromHead();
+  /* END PLEX */
 
   CThread::Create(false);
 
@@ -199,12 +232,52 @@ void CFileCache::Process()
   CWriteRate limiter;
   CWriteRate average;
 
+  /* PLEX */
+  // a head we started out with wasn't read from the source
+  limiter.Reset(m_writePos);
+  average.Reset(m_writePos);
+  /* END PLEX */
+
   while (!m_bStop)
   {
+    /* PLEX */
+    bool throttled = false;
+    /* END PLEX */
+
     // check for seek events
     if (m_seekEvent.WaitMSec(0))
     {
       m_seekEvent.Reset();
+
+      /* PLEX */
+      // parallel fetching only follows a linear read, the source takes over again
+      StopPrefetch();
+      /* END PLEX */
+
+      /* PLEX */
+      // the reader is served from cache, continue the source where that cached data ends
+      int64_t refillPos = TakeRefillPosition();
+      if (refillPos >= 0)
+      {
+        // a partly written chunk leaves the source ahead of what we hold
+        if (refillPos != m_writePos || m_source.GetPosition() != refillPos)
+        {
+          CLog::Log(LOGDEBUG,"%s, refilling from %"PRId64, __FUNCTION__, refillPos);
+          if (m_source.Seek(refillPos, SEEK_SET) == refillPos)
+          {
+            m_pCache->SetWritePosition(refillPos);
+            average.Reset(refillPos);
+            limiter.Reset(refillPos);
+            SetWritePos(refillPos);
+            m_cacheFull = false;
+          }
+          else
+            m_seekPossible = m_source.IoControl(IOCTRL_SEEK_POSSIBLE, NULL);
+        }
+        continue;
+      }
+      /* END PLEX */
+
       CLog::Log(LOGDEBUG,"%s, request seek on source to %"PRId64, __FUNCTION__, m_seekPos);
       m_nSeekResult = m_source.Seek(m_seekPos, SEEK_SET);
       if (m_nSeekResult != m_seekPos)
@@ -217,7 +290,9 @@ void CFileCache::Process()
         m_pCache->Reset(m_seekPos);
         average.Reset(m_seekPos);
         limiter.Reset(m_seekPos);
-        m_writePos = m_seekPos;
+        /* PLEX */
+        SetWritePos(m_seekPos);
+        /* END PLEX */
         m_readPos = m_seekPos;
         m_cacheFull = false;
       }
@@ -227,7 +302,11 @@ void CFileCache::Process()
 
     while (m_writeRate)
     {
+#ifndef __PLEX__
       if (m_writePos - m_readPos < m_writeRate)
+#else
+      if (m_writePos - m_readPos < GetReadAhead())
+#endif
       {
         limiter.Reset(m_writePos);
         break;
@@ -236,14 +315,42 @@ void CFileCache::Process()
       if (limiter.Rate(m_writePos) < m_writeRate)
         break;
 
+#ifndef __PLEX__
       if (m_seekEvent.WaitMSec(100))
+#else
+      // keep the time we hold the source back out of its measured throughput
+      throttled = true;
+      average.Pause();
+      bool seekRequested = m_seekEvent.WaitMSec(100);
+      average.Resume();
+      if (seekRequested)
+#endif
       {
         m_seekEvent.Set();
         break;
       }
     }
 
+#ifndef __PLEX__
     int iRead = m_source.Read(buffer.get(), m_chunkSize);
+#else
+    int iRead;
+    if (m_prefetcher)
+    {
+      iRead = m_prefetcher->Read(buffer.get(), m_chunkSize, 30 * 1000);
+      if (iRead < 0)
+      {
+        // don't try again for this file, the single connection continues where we are
+        CLog::Log(LOGWARNING, "CFileCache::Process - parallel fetching failed, back to a single connection");
+        StopPrefetch();
+        m_prefetchFailed = true;
+        if (m_source.Seek(m_writePos, SEEK_SET) == m_writePos)
+          iRead = m_source.Read(buffer.get(), m_chunkSize);
+      }
+    }
+    else
+      iRead = m_source.Read(buffer.get(), m_chunkSize);
+#endif
     if (iRead == 0)
     {
       CLog::Log(LOGINFO, "CFileCache::Process - Hit eof.");
@@ -295,12 +402,35 @@ void CFileCache::Process()
       }
     }
 
-    m_writePos += iTotalWrite;
+    /* PLEX */
+    SetWritePos(m_writePos + iTotalWrite);
+
+    // what follows may still be cached from earlier, skip the source over it
+    if (m_seekPossible && !m_prefetcher && iRead > 0 && iTotalWrite == iRead)
+    {
+      int64_t end = m_pCache->CachedDataEnd(m_writePos);
+      if (end > m_writePos + m_chunkSize && m_source.Seek(end, SEEK_SET) == end)
+      {
+        m_pCache->SetWritePosition(end);
+        average.Reset(end);
+        limiter.Reset(end);
+        SetWritePos(end);
+      }
+    }
+    /* END PLEX */
 
     // under estimate write rate by a second, to
     // avoid uncertainty at start of caching
     m_writeRateActual = average.Rate(m_writePos, 1000);
+
+    /* PLEX */
+    UpdatePrefetch(throttled);
+    /* END PLEX */
   }
+
+  /* PLEX */
+  StopPrefetch();
+  /* END PLEX */
 }
 
 void CFileCache::OnExit()
@@ -346,6 +476,10 @@ retry:
 
   if (iRc == CACHE_RC_WOULD_BLOCK)
   {
+    /* PLEX */
+    RequestRefill();
+    /* END PLEX */
+
     // just wait for some data to show up
 #ifndef __PLEX__
     iRc = m_pCache->WaitForData(1, 10000);
@@ -405,6 +539,12 @@ int64_t CFileCache::Seek(int64_t iFilePosition, int iWhence)
     /* never request closer to end than 2k, speeds up tag reading */
     m_seekPos = std::min(iTarget, std::max((int64_t)0, m_source.GetLength() - m_chunkSize));
 
+    /* PLEX */
+    {
+      CSingleLock refillLock(m_refillSection);
+      m_refillPos = -1;
+    }
+    /* END PLEX */
     m_seekEvent.Set();
     if (!m_seekEnded.Wait())
     {
@@ -427,11 +567,153 @@ int64_t CFileCache::Seek(int64_t iFilePosition, int iWhence)
     m_seekEvent.Reset();
   }
   else
+  {
     m_readPos = iTarget;
+    /* PLEX */
+    RequestRefill();
+    /* END PLEX */
+  }
 
   return m_nSeekResult;
 }
 
+/* PLEX */
+/* Asks the source to continue where the cached data following the read position
+ * ends, if the cache keeps data apart from what the source is currently writing. */
+void CFileCache::RequestRefill()
+{
+  if (!m_seekPossible)
+    return;
+
+  int64_t end = m_pCache->CachedDataEnd(m_readPos);
+  if (end < 0)
+    return;
+
+  int64_t length = GetLength();
+  if (length > 0 && end >= length)
+    return;
+
+  CSingleLock lock(m_refillSection);
+  if (end == m_writePos)
+    return;
+
+  m_refillPos = end;
+  m_seekEvent.Set();
+}
+
+/* Only the cache thread changes the write position, RequestRefill looks at it from the
+ * reader's thread. */
+void CFileCache::SetWritePos(int64_t pos)
+{
+  CSingleLock lock(m_refillSection);
+  m_writePos = pos;
+}
+
+int64_t CFileCache::TakeRefillPosition()
+{
+  CSingleLock lock(m_refillSection);
+  int64_t pos = m_refillPos;
+  m_refillPos = -1;
+  return pos;
+}
+
+/* How much data we keep ahead of the reader before holding the source back to the
+ * stream rate. The less headroom the source has over the bitrate, the larger the
+ * cushion, from one second at twice the bitrate to READ_AHEAD_MAX_SECONDS. */
+unsigned int CFileCache::GetReadAhead() const
+{
+  if (!m_rateKnown || m_writeRateActual >= 2 * m_writeRate)
+    return m_writeRate;
+
+  unsigned int headroom = (unsigned int)((uint64_t)1000 * m_writeRateActual / m_writeRate);
+  unsigned int seconds = READ_AHEAD_MAX_SECONDS;
+  if (headroom > 1000)
+    seconds = 1 + (READ_AHEAD_MAX_SECONDS - 1) * (2000 - headroom) / 1000;
+
+  return m_writeRate * seconds;
+}
+
+/* Splits the source up into concurrent range requests once a single connection
+ * has been falling short of the stream rate for a while, even though we let it
+ * run unthrottled. */
+void CFileCache::UpdatePrefetch(bool throttled)
+{
+  if (m_prefetcher || m_prefetchFailed || !m_rateKnown || !m_seekPossible ||
+      g_advancedSettings.m_cacheParallelConnections < 2)
+    return;
+
+  if (throttled || m_writeRateActual >= m_writeRate)
+  {
+    m_behindSince = 0;
+    return;
+  }
+
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  if (m_behindSince == 0)
+    m_behindSince = now;
+
+  if (now - m_behindSince < PREFETCH_TRIGGER_MS)
+    return;
+
+  int64_t length = GetLength();
+  if (length <= 0 || m_writePos >= length || !CRangePrefetcher::CanPrefetch(CURL(m_sourcePath)))
+  {
+    m_prefetchFailed = true;
+    return;
+  }
+
+  CLog::Log(LOGINFO, "CFileCache::Process - source delivers %u of %u bytes/s, fetching with %u connections",
+            m_writeRateActual, m_writeRate, g_advancedSettings.m_cacheParallelConnections);
+
+  m_prefetcher = new CRangePrefetcher(m_sourcePath, length, g_advancedSettings.m_cacheParallelConnections, PREFETCH_RANGE_SIZE);
+  m_prefetcher->Start(m_writePos);
+}
+
+void CFileCache::StopPrefetch()
+{
+  delete m_prefetcher;
+  m_prefetcher = NULL;
+  m_behindSince = 0;
+}
+
+/* Starts the cache out with the head of the stream if it was read ahead of time,
+ * the source continues right after it. */
+void CFileCache::SeedFromHead()
+{
+  std::string head;
+  if (!m_seekPossible || !CStreamHeadCache::GetInstance().Lookup(m_sourcePath, head))
+    return;
+
+  // not what we read before
+  int64_t length = m_source.GetLength();
+  if (length > 0 && (int64_t)head.size() > length)
+  {
+    CStreamHeadCache::GetInstance().Remove(m_sourcePath);
+    return;
+  }
+
+  size_t written = 0;
+  while (written < head.size())
+  {
+    int iWrite = m_pCache->WriteToCache(head.data() + written, head.size() - written);
+    if (iWrite <= 0)
+      break;
+    written += iWrite;
+  }
+
+  if (written == 0 || m_source.Seek(written, SEEK_SET) != (int64_t)written)
+  {
+    CLog::Log(LOGDEBUG, "CFileCache::SeedFromHead - couldn't continue the source after the head");
+    m_pCache->Reset(0);
+    m_source.Seek(0, SEEK_SET);
+    return;
+  }
+
+  SetWritePos(written);
+  CLog::Log(LOGDEBUG, "CFileCache::SeedFromHead - starting with %u bytes read ahead", (unsigned)written);
+}
+/* END PLEX */
+
 void CFileCache::Close()
 {
   StopThread();
@@ -484,6 +766,9 @@ int CFileCache::IoControl(EIoControl request, void* param)
   if (request == IOCTRL_CACHE_SETRATE)
   {
     m_writeRate = *(unsigned*)param;
+    /* PLEX */
+    m_rateKnown = true;
+    /* END PLEX */
     return 0;
   }
 
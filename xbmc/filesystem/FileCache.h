@@ -27,6 +27,9 @@
 
 namespace XFILE
 {
+  /* PLEX */
+  class CRangePrefetcher;
+  /* END PLEX */
 
   class CFileCache : public IFile, public CThread
   {
@@ -61,6 +64,16 @@ namespace XFILE
     virtual CStdString GetContent();
 
   private:
+    /* PLEX */
+    void RequestRefill();
+    int64_t TakeRefillPosition();
+    void SetWritePos(int64_t pos);
+    unsigned int GetReadAhead() const;
+    void UpdatePrefetch(bool throttled);
+    void StopPrefetch();
+    void SeedFromHead();
+    /* END PLEX */
+
     CCacheStrategy *m_pCache;
     bool      m_bDeleteCache;
     int        m_seekPossible;
@@ -77,6 +90,14 @@ namespace XFILE
     unsigned     m_writeRateActual;
     bool         m_cacheFull;
     CCriticalSection m_sync;
+    /* PLEX */
+    int64_t      m_refillPos;
+    CCriticalSection m_refillSection; // guards m_refillPos and changes to m_writePos
+    CRangePrefetcher* m_prefetcher;
+    bool         m_prefetchFailed;
+    bool         m_rateKnown;
+    unsigned int m_behindSince;
+    /* END PLEX */
   };
 
 }
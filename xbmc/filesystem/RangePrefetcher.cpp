@@ -0,0 +1,250 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "RangePrefetcher.h"
+#include "CurlFile.h"
+#include "FileFactory.h"
+#include "URL.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/log.h"
+
+#ifdef _LINUX
+#include <inttypes.h>
+#endif
+
+using namespace XFILE;
+
+namespace XFILE
+{
+  class CRangeFetchThread : public CThread
+  {
+  public:
+    CRangeFetchThread(CRangePrefetcher* owner) : CThread("CRangeFetchThread"), m_owner(owner) {}
+
+  protected:
+    virtual void Process()
+    {
+      while (!m_bStop)
+      {
+        int64_t start;
+        unsigned int size;
+        if (!m_owner->TakeRange(start, size, 100))
+          continue;
+
+        std::vector<char> data;
+        bool success = Fetch(start, size, data);
+        m_owner->DeliverRange(start, data, success);
+      }
+    }
+
+    bool Fetch(int64_t start, unsigned int size, std::vector<char>& data)
+    {
+      CURL url(m_owner->m_path);
+      IFile* file = CFileFactory::CreateLoader(url);
+      CCurlFile* curl = dynamic_cast<CCurlFile*>(file);
+      if (!curl)
+      {
+        delete file;
+        return false;
+      }
+
+      CStdString range;
+      range.Format("bytes=%"PRId64"-%"PRId64, start, start + size - 1);
+      curl->SetRequestHeader("Range", range);
+
+      bool success = false;
+      if (curl->Open(url))
+      {
+        // a server ignoring the range sends us the whole resource instead
+        if (curl->GetLength() == size)
+        {
+          data.resize(size);
+          unsigned int total = 0;
+          while (!m_bStop && total < size)
+          {
+            unsigned int read = curl->Read(&data[total], size - total);
+            if (read == 0)
+              break;
+            total += read;
+          }
+          success = (total == size);
+        }
+        else
+          CLog::Log(LOGDEBUG, "CRangeFetchThread::Fetch - range %s not honoured, got %"PRId64" bytes", range.c_str(), curl->GetLength());
+
+        curl->Close();
+      }
+
+      delete file;
+      return success;
+    }
+
+    CRangePrefetcher* m_owner;
+  };
+}
+
+CRangePrefetcher::CRangePrefetcher(const CStdString& path, int64_t length, unsigned int connections, unsigned int rangeSize)
+  : m_path(path), m_length(length), m_rangeSize(rangeSize), m_readPos(0), m_nextRange(0), m_window(connections * 2), m_pending(true)
+{
+  for (unsigned int i = 0; i < connections; i++)
+  {
+    CRangeFetchThread* thread = new CRangeFetchThread(this);
+    thread->Create();
+    m_threads.push_back(thread);
+  }
+}
+
+CRangePrefetcher::~CRangePrefetcher()
+{
+  for (std::vector<CRangeFetchThread*>::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
+    (*it)->StopThread(false);
+
+  m_pending.Set();
+
+  for (std::vector<CRangeFetchThread*>::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
+  {
+    (*it)->StopThread(true);
+    delete *it;
+  }
+}
+
+bool CRangePrefetcher::CanPrefetch(const CURL& url)
+{
+  return url.GetProtocol().Equals("http") ||
+         url.GetProtocol().Equals("https") ||
+         url.GetProtocol().Equals("plexserver");
+}
+
+void CRangePrefetcher::Start(int64_t pos)
+{
+  CSingleLock lock(m_section);
+  m_ranges.clear();
+  m_readPos = pos;
+  m_nextRange = pos;
+  FillWindow();
+}
+
+void CRangePrefetcher::FillWindow()
+{
+  bool added = false;
+  while (m_ranges.size() < m_window && m_nextRange < m_length)
+  {
+    Range& range = m_ranges[m_nextRange];
+    range.state = RANGE_PENDING;
+    range.size = (unsigned int)std::min<int64_t>(m_rangeSize, m_length - m_nextRange);
+    m_nextRange += range.size;
+    added = true;
+  }
+
+  if (added)
+    m_pending.Set();
+}
+
+bool CRangePrefetcher::TakeRange(int64_t& start, unsigned int& size, unsigned int timeoutMs)
+{
+  CSingleLock lock(m_section);
+  for (RangeMap::iterator it = m_ranges.begin(); it != m_ranges.end(); ++it)
+  {
+    if (it->second.state == RANGE_PENDING)
+    {
+      it->second.state = RANGE_FETCHING;
+      start = it->first;
+      size = it->second.size;
+      return true;
+    }
+  }
+
+  m_pending.Reset();
+  lock.Leave();
+
+  m_pending.WaitMSec(timeoutMs);
+  return false;
+}
+
+void CRangePrefetcher::DeliverRange(int64_t start, std::vector<char>& data, bool success)
+{
+  CSingleLock lock(m_section);
+
+  // the range might have been dropped or rescheduled by a restart in the meantime
+  RangeMap::iterator it = m_ranges.find(start);
+  if (it == m_ranges.end() || it->second.state != RANGE_FETCHING)
+    return;
+
+  if (success)
+  {
+    it->second.state = RANGE_DONE;
+    it->second.data.swap(data);
+  }
+  else
+    it->second.state = RANGE_FAILED;
+
+  m_delivered.Set();
+}
+
+int CRangePrefetcher::Read(char* buf, unsigned int size, unsigned int timeoutMs)
+{
+  CSingleLock lock(m_section);
+  if (m_readPos >= m_length)
+    return 0;
+
+  // the first range we hold always contains the read position
+  XbmcThreads::EndTime timer(timeoutMs);
+  RangeMap::iterator it;
+  while (true)
+  {
+    it = m_ranges.begin();
+    if (it == m_ranges.end())
+      return -1;
+
+    if (it->second.state == RANGE_DONE)
+      break;
+
+    if (it->second.state == RANGE_FAILED)
+    {
+      CLog::Log(LOGWARNING, "CRangePrefetcher::Read - failed to fetch range at %"PRId64, it->first);
+      return -1;
+    }
+
+    if (timer.IsTimePast())
+    {
+      CLog::Log(LOGWARNING, "CRangePrefetcher::Read - timeout waiting for range at %"PRId64, it->first);
+      return -1;
+    }
+
+    lock.Leave();
+    m_delivered.WaitMSec(std::min(timer.MillisLeft(), 100u));
+    lock.Enter();
+  }
+
+  unsigned int offset = (unsigned int)(m_readPos - it->first);
+  unsigned int len = std::min(size, it->second.size - offset);
+  memcpy(buf, &it->second.data[offset], len);
+  m_readPos += len;
+
+  if (m_readPos >= it->first + it->second.size)
+  {
+    m_ranges.erase(it);
+    FillWindow();
+  }
+
+  return len;
+}
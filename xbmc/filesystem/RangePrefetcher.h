@@ -0,0 +1,101 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <vector>
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/StdString.h"
+
+class CURL;
+
+namespace XFILE
+{
+  class CRangeFetchThread;
+
+  /**
+   * Reads a HTTP resource sequentially through several concurrent range requests.
+   *
+   * A single connection with a high round trip time can't always keep up with the
+   * bitrate of the stream. The prefetcher keeps a window of fixed size ranges ahead
+   * of the read position, fetches them over separate connections and hands out the
+   * data in file order.
+   */
+  class CRangePrefetcher
+  {
+  public:
+    CRangePrefetcher(const CStdString& path, int64_t length, unsigned int connections, unsigned int rangeSize);
+    ~CRangePrefetcher();
+
+    /*! \brief Only plain HTTP resources (and what the Plex file translates to one) can be split up */
+    static bool CanPrefetch(const CURL& url);
+
+    /*! \brief Start fetching from pos, drops anything that was fetched before */
+    void Start(int64_t pos);
+
+    /*! \brief Read the data following the last read, in order
+     \return bytes read, 0 at the end of the resource, -1 if a range couldn't be fetched
+     */
+    int Read(char* buf, unsigned int size, unsigned int timeoutMs);
+
+    int64_t GetPosition() const { return m_readPos; }
+
+  private:
+    friend class CRangeFetchThread;
+
+    enum RangeState
+    {
+      RANGE_PENDING,
+      RANGE_FETCHING,
+      RANGE_DONE,
+      RANGE_FAILED
+    };
+
+    struct Range
+    {
+      RangeState state;
+      unsigned int size;
+      std::vector<char> data;
+    };
+    typedef std::map<int64_t, Range> RangeMap;
+
+    /* called by the fetch threads */
+    bool TakeRange(int64_t& start, unsigned int& size, unsigned int timeoutMs);
+    void DeliverRange(int64_t start, std::vector<char>& data, bool success);
+
+    void FillWindow();
+
+    CStdString m_path;
+    int64_t m_length;
+    unsigned int m_rangeSize;
+
+    std::vector<CRangeFetchThread*> m_threads;
+
+    RangeMap m_ranges;
+    int64_t m_readPos;
+    int64_t m_nextRange;
+    unsigned int m_window;
+
+    CCriticalSection m_section;
+    CEvent m_pending;
+    CEvent m_delivered;
+  };
+}
@@ -0,0 +1,485 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/SystemClock.h"
+#include "system.h"
+#include "utils/log.h"
+#include "threads/SingleLock.h"
+#include "Util.h"
+#include "SpecialProtocol.h"
+#include "SegmentCache.h"
+#ifdef _LINUX
+#include "PlatformInclude.h"
+#endif
+
+using namespace XFILE;
+
+#define SEGMENT_BLOCK_SIZE (256 * 1024)
+
+CSegmentCache::CSegmentCache(size_t front, size_t back, size_t disk)
+ : CCacheStrategy()
+ , m_maxBlocks(std::max<size_t>((front + back) / SEGMENT_BLOCK_SIZE, 4))
+ , m_memBlocks(0)
+ , m_sizeBack(back)
+ , m_cur(0)
+ , m_write(0)
+ , m_eof(0)
+ , m_useCounter(0)
+ , m_maxSlots(disk / SEGMENT_BLOCK_SIZE)
+ , m_nextSlot(0)
+ , m_spill(INVALID_HANDLE_VALUE)
+ , m_seekHits(0)
+ , m_seekMisses(0)
+ , m_seekAtWrite(0)
+ , m_bytesRead(0)
+ , m_bytesSpilled(0)
+{
+}
+
+CSegmentCache::~CSegmentCache()
+{
+  Close();
+}
+
+int CSegmentCache::Open()
+{
+  Close();
+
+  CSingleLock lock(m_sync);
+  m_cur = 0;
+  m_write = 0;
+  m_eof = 0;
+  m_seekHits = m_seekMisses = m_seekAtWrite = 0;
+  m_bytesRead = m_bytesSpilled = 0;
+  return CACHE_RC_OK;
+}
+
+void CSegmentCache::Close()
+{
+  CSingleLock lock(m_sync);
+
+  if (m_bytesRead)
+    CLog::Log(LOGDEBUG, "CSegmentCache::Close - %u of %u seeks served from cache, %u waited on the source, %"PRIu64" bytes read, %"PRIu64" bytes spilled to disk",
+              m_seekHits, m_seekHits + m_seekAtWrite + m_seekMisses, m_seekAtWrite, m_bytesRead, m_bytesSpilled);
+
+  for (BlockMap::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+    delete[] it->second.data;
+  m_blocks.clear();
+  m_memBlocks = 0;
+
+  for (std::vector<uint8_t*>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+    delete[] *it;
+  m_free.clear();
+
+  if (m_spill != INVALID_HANDLE_VALUE)
+  {
+    CloseHandle(m_spill);
+    m_spill = INVALID_HANDLE_VALUE;
+    ::DeleteFile(m_spillPath.c_str());
+  }
+  m_freeSlots.clear();
+  m_nextSlot = 0;
+  m_bytesRead = 0;
+}
+
+bool CSegmentCache::IsProtected(uint64_t index) const
+{
+  // the block being read from and our guaranteed history are never dropped
+  uint64_t beg = m_cur > m_sizeBack ? m_cur - m_sizeBack : 0;
+  return index >= beg / SEGMENT_BLOCK_SIZE && index <= m_cur / SEGMENT_BLOCK_SIZE;
+}
+
+void CSegmentCache::DropBlock(BlockMap::iterator it)
+{
+  if (it->second.data)
+  {
+    m_free.push_back(it->second.data);
+    m_memBlocks--;
+  }
+  if (it->second.slot >= 0)
+    m_freeSlots.push_back(it->second.slot);
+  m_blocks.erase(it);
+}
+
+int CSegmentCache::AllocateSlot(uint64_t keep)
+{
+  if (!m_freeSlots.empty())
+  {
+    int slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    return slot;
+  }
+
+  if ((size_t)m_nextSlot < m_maxSlots)
+  {
+    if (m_spill == INVALID_HANDLE_VALUE)
+    {
+      m_spillPath = CSpecialProtocol::TranslatePath(CUtil::GetNextFilename("special://temp/segcache%03d.cache", 999));
+      if (!m_spillPath.empty())
+        m_spill = CreateFile(m_spillPath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                             NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+      if (m_spill == INVALID_HANDLE_VALUE)
+      {
+        CLog::Log(LOGWARNING, "CSegmentCache::AllocateSlot - unable to create spill file, keeping data in memory only");
+        m_maxSlots = 0;
+        return -1;
+      }
+    }
+    return m_nextSlot++;
+  }
+
+  // reuse the slot of the least recently used block that only lives on disk
+  BlockMap::iterator victim = m_blocks.end();
+  for (BlockMap::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+  {
+    if (!it->second.data && it->second.slot >= 0 && it->first != keep && !IsProtected(it->first) &&
+        (victim == m_blocks.end() || it->second.lastUse < victim->second.lastUse))
+      victim = it;
+  }
+  if (victim == m_blocks.end())
+    return -1;
+
+  int slot = victim->second.slot;
+  m_blocks.erase(victim);
+  return slot;
+}
+
+bool CSegmentCache::MakeRoom(uint64_t keep)
+{
+  if (m_memBlocks < m_maxBlocks)
+    return true;
+
+  // data ahead of the reader is what we'll need next, so only drop it if we can spill it
+  uint64_t forwardEnd = ContiguousEnd(m_cur);
+  BlockMap::iterator victim = m_blocks.end();
+  BlockMap::iterator forward = m_blocks.end();
+  for (BlockMap::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+  {
+    if (!it->second.data || it->first == keep || IsProtected(it->first))
+      continue;
+
+    bool ahead = it->first * SEGMENT_BLOCK_SIZE < forwardEnd && it->first >= m_cur / SEGMENT_BLOCK_SIZE;
+    BlockMap::iterator &best = ahead ? forward : victim;
+    if (best == m_blocks.end() || it->second.lastUse < best->second.lastUse)
+      best = it;
+  }
+
+  if (victim == m_blocks.end())
+  {
+    if (forward == m_blocks.end() || m_maxSlots == 0)
+      return false;
+    victim = forward;
+  }
+
+  Block &block = victim->second;
+  if (m_maxSlots > 0)
+  {
+    if (block.slot < 0)
+    {
+      block.slot = AllocateSlot(keep);
+      block.dirty = true;
+    }
+
+    if (block.slot >= 0)
+    {
+      bool spilled = !block.dirty;
+      if (!spilled)
+      {
+        LARGE_INTEGER pos;
+        pos.QuadPart = (int64_t)block.slot * SEGMENT_BLOCK_SIZE;
+        DWORD written = 0;
+        spilled = SetFilePointerEx(m_spill, pos, NULL, FILE_BEGIN) &&
+                  WriteFile(m_spill, block.data, SEGMENT_BLOCK_SIZE, &written, NULL) &&
+                  written == SEGMENT_BLOCK_SIZE;
+        if (spilled)
+          m_bytesSpilled += SEGMENT_BLOCK_SIZE;
+      }
+
+      if (spilled)
+      {
+        m_free.push_back(block.data);
+        block.data = NULL;
+        block.dirty = false;
+        m_memBlocks--;
+        return true;
+      }
+    }
+    else if (victim == forward)
+      return false;
+  }
+
+  DropBlock(victim);
+  return true;
+}
+
+bool CSegmentCache::LoadBlock(uint64_t index, Block &block)
+{
+  uint8_t *data;
+  if (!m_free.empty())
+  {
+    data = m_free.back();
+    m_free.pop_back();
+  }
+  else
+    data = new uint8_t[SEGMENT_BLOCK_SIZE];
+
+  if (block.slot >= 0)
+  {
+    LARGE_INTEGER pos;
+    pos.QuadPart = (int64_t)block.slot * SEGMENT_BLOCK_SIZE;
+    DWORD bytes = 0;
+    if (!SetFilePointerEx(m_spill, pos, NULL, FILE_BEGIN) ||
+        !ReadFile(m_spill, data, SEGMENT_BLOCK_SIZE, &bytes, NULL) ||
+        bytes != SEGMENT_BLOCK_SIZE)
+    {
+      CLog::Log(LOGERROR, "CSegmentCache::LoadBlock - failed to read block %"PRIu64" back from disk", index);
+      m_free.push_back(data);
+      return false;
+    }
+  }
+
+  block.data = data;
+  block.dirty = false;
+  m_memBlocks++;
+  return true;
+}
+
+CSegmentCache::Block *CSegmentCache::GetBlock(uint64_t index, bool create)
+{
+  BlockMap::iterator it = m_blocks.find(index);
+  if (it != m_blocks.end() && it->second.data)
+    return &it->second;
+
+  if (it == m_blocks.end() && !create)
+    return NULL;
+
+  if (!MakeRoom(index))
+    return NULL;
+
+  // making room may have removed entries
+  it = m_blocks.find(index);
+  if (it == m_blocks.end())
+  {
+    Block block;
+    block.data = NULL;
+    block.beg = 0;
+    block.end = 0;
+    block.slot = -1;
+    block.dirty = false;
+    block.lastUse = 0;
+    it = m_blocks.insert(std::make_pair(index, block)).first;
+  }
+  else if (it->second.data)
+    return &it->second;
+
+  if (!LoadBlock(index, it->second))
+  {
+    DropBlock(it);
+    return NULL;
+  }
+  return &it->second;
+}
+
+uint64_t CSegmentCache::ContiguousEnd(uint64_t pos)
+{
+  uint64_t end = pos;
+  for (uint64_t index = pos / SEGMENT_BLOCK_SIZE; ; index++)
+  {
+    BlockMap::const_iterator it = m_blocks.find(index);
+    if (it == m_blocks.end())
+      break;
+
+    size_t offset = (size_t)(end - index * SEGMENT_BLOCK_SIZE);
+    if (offset < it->second.beg || offset >= it->second.end)
+      break;
+
+    end = index * SEGMENT_BLOCK_SIZE + it->second.end;
+    if (it->second.end < SEGMENT_BLOCK_SIZE)
+      break;
+  }
+  return end;
+}
+
+/**
+ * Writes at the write position, up to the end of the block it falls in.
+ * Returns 0 when every block we hold is still needed, in which case the
+ * caller should wait for the reader to make progress.
+ */
+int CSegmentCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  uint64_t index  = m_write / SEGMENT_BLOCK_SIZE;
+  size_t   offset = (size_t)(m_write % SEGMENT_BLOCK_SIZE);
+
+  if (len > SEGMENT_BLOCK_SIZE - offset)
+    len = SEGMENT_BLOCK_SIZE - offset;
+
+  if (len == 0)
+    return 0;
+
+  Block *block = GetBlock(index, true);
+  if (!block)
+    return 0;
+
+  memcpy(block->data + offset, buf, len);
+
+  // a block holds a single range, so anything not touching what we write is lost
+  if (block->end > block->beg && offset <= block->end && offset + len >= block->beg)
+  {
+    block->beg = std::min(block->beg, offset);
+    block->end = std::max(block->end, offset + len);
+  }
+  else
+  {
+    block->beg = offset;
+    block->end = offset + len;
+  }
+  block->dirty = true;
+  block->lastUse = ++m_useCounter;
+
+  m_write += len;
+  m_written.Set();
+
+  return len;
+}
+
+int CSegmentCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  uint64_t index  = m_cur / SEGMENT_BLOCK_SIZE;
+  size_t   offset = (size_t)(m_cur % SEGMENT_BLOCK_SIZE);
+
+  Block *block = NULL;
+  BlockMap::iterator it = m_blocks.find(index);
+  if (it != m_blocks.end() && offset >= it->second.beg && offset < it->second.end)
+    block = GetBlock(index, false);
+
+  if (!block || offset < block->beg || offset >= block->end)
+  {
+    if (IsEndOfInput() && m_cur >= m_eof)
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  if (len > block->end - offset)
+    len = block->end - offset;
+
+  memcpy(buf, block->data + offset, len);
+  block->lastUse = ++m_useCounter;
+  m_cur += len;
+  m_bytesRead += len;
+
+  m_space.Set();
+
+  return len;
+}
+
+int64_t CSegmentCache::WaitForData(unsigned int minimum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+  uint64_t end = ContiguousEnd(m_cur);
+
+  // nothing more is coming once our data runs into the end of input
+  if (millis == 0 || (IsEndOfInput() && end >= m_eof))
+    return end - m_cur;
+
+  size_t forward = (m_maxBlocks * SEGMENT_BLOCK_SIZE > m_sizeBack) ? m_maxBlocks * SEGMENT_BLOCK_SIZE - m_sizeBack : SEGMENT_BLOCK_SIZE;
+  if (minimum > forward)
+    minimum = forward;
+
+  XbmcThreads::EndTime endtime(millis);
+  while (!(IsEndOfInput() && end >= m_eof) && end - m_cur < minimum && !endtime.IsTimePast())
+  {
+    lock.Leave();
+    m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
+    lock.Enter();
+    end = ContiguousEnd(m_cur);
+  }
+
+  return end - m_cur;
+}
+
+int64_t CSegmentCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  // if seek is a bit over what the source is writing, try to wait a few seconds for the data
+  // to be available. we try to avoid a (heavy) seek on the source
+  if ((uint64_t)pos >= m_write && (uint64_t)pos < m_write + 100000 && ContiguousEnd(m_cur) == m_write)
+  {
+    lock.Leave();
+    WaitForData((size_t)(pos - m_cur), 5000);
+    lock.Enter();
+  }
+
+  if (ContiguousEnd(pos) > (uint64_t)pos)
+  {
+    m_cur = pos;
+    m_seekHits++;
+    return pos;
+  }
+
+  // nothing cached there yet, but the source is about to write it
+  if ((uint64_t)pos == m_write)
+  {
+    m_cur = pos;
+    m_seekAtWrite++;
+    return pos;
+  }
+
+  m_seekMisses++;
+  return CACHE_RC_ERROR;
+}
+
+void CSegmentCache::Reset(int64_t pos)
+{
+  // unlike the circular cache we keep what we have, the source simply continues from pos
+  CSingleLock lock(m_sync);
+  m_cur = pos;
+  m_write = pos;
+}
+
+void CSegmentCache::EndOfInput()
+{
+  CSingleLock lock(m_sync);
+  m_eof = m_write;
+  CCacheStrategy::EndOfInput();
+}
+
+void CSegmentCache::ClearEndOfInput()
+{
+  CSingleLock lock(m_sync);
+  CCacheStrategy::ClearEndOfInput();
+}
+
+int64_t CSegmentCache::CachedDataEnd(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+  return ContiguousEnd(pos);
+}
+
+void CSegmentCache::SetWritePosition(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+  m_write = pos;
+}
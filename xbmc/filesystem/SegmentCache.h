@@ -0,0 +1,112 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CACHESEGMENT_H
+#define CACHESEGMENT_H
+
+#include <map>
+#include <vector>
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/StdString.h"
+
+namespace XFILE {
+
+/**
+ * Cache strategy keeping several non-contiguous ranges of the source.
+ *
+ * The source is cached in fixed size blocks, each holding one valid byte
+ * range. Seeking back into a range that was downloaded before is served
+ * from memory instead of restarting the source. When the memory budget is
+ * used up, the least recently used block that isn't needed for the data
+ * ahead of the read position is dropped, or spilled to a temporary file if
+ * a disk budget was given.
+ */
+class CSegmentCache : public CCacheStrategy
+{
+public:
+    CSegmentCache(size_t front, size_t back, size_t disk = 0);
+    virtual ~CSegmentCache();
+
+    virtual int Open() ;
+    virtual void Close();
+
+    virtual int WriteToCache(const char *buf, size_t len) ;
+    virtual int ReadFromCache(char *buf, size_t len) ;
+    virtual int64_t WaitForData(unsigned int minimum, unsigned int iMillis) ;
+
+    virtual int64_t Seek(int64_t pos) ;
+    virtual void Reset(int64_t pos) ;
+
+    virtual void EndOfInput();
+    virtual void ClearEndOfInput();
+
+    virtual int64_t CachedDataEnd(int64_t pos);
+    virtual void SetWritePosition(int64_t pos);
+
+protected:
+    struct Block
+    {
+      uint8_t *data;     /**< block data, NULL while spilled to disk */
+      size_t   beg;      /**< start of valid data, relative to the block */
+      size_t   end;      /**< end of valid data, relative to the block */
+      int      slot;     /**< slot in the spill file, -1 if none */
+      bool     dirty;    /**< in memory data changed since it was spilled */
+      unsigned lastUse;
+    };
+    typedef std::map<uint64_t, Block> BlockMap;
+
+    Block   *GetBlock(uint64_t index, bool create);
+    bool     LoadBlock(uint64_t index, Block &block);
+    bool     MakeRoom(uint64_t keep);
+    bool     IsProtected(uint64_t index) const;
+    void     DropBlock(BlockMap::iterator it);
+    uint64_t ContiguousEnd(uint64_t pos);
+    int      AllocateSlot(uint64_t keep);
+
+    BlockMap              m_blocks;
+    std::vector<uint8_t*> m_free;        /**< unused block buffers */
+    size_t                m_maxBlocks;   /**< blocks we may hold in memory */
+    size_t                m_memBlocks;   /**< blocks currently in memory */
+    size_t                m_sizeBack;    /**< guaranteed history behind the read position */
+    uint64_t              m_cur;         /**< current reading index in file */
+    uint64_t              m_write;       /**< index in file the source writes to next */
+    uint64_t              m_eof;         /**< file index the end of input was seen at */
+    unsigned              m_useCounter;
+
+    size_t                m_maxSlots;
+    std::vector<int>      m_freeSlots;
+    int                   m_nextSlot;
+    CStdString            m_spillPath;
+    HANDLE                m_spill;
+
+    unsigned              m_seekHits;
+    unsigned              m_seekMisses;
+    unsigned              m_seekAtWrite;
+    uint64_t              m_bytesRead;
+    uint64_t              m_bytesSpilled;
+
+    CCriticalSection      m_sync;
+    CEvent                m_written;
+};
+
+} // namespace XFILE
+#endif
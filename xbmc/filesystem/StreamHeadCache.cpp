@@ -0,0 +1,149 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/SystemClock.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "URL.h"
+#include "StreamHeadCache.h"
+
+using namespace XFILE;
+
+CStreamHeadCache::CStreamHeadCache(size_t budget, unsigned int ttlMs)
+ : m_budget(budget)
+ , m_size(0)
+ , m_ttl(ttlMs)
+{
+}
+
+CStreamHeadCache &CStreamHeadCache::GetInstance()
+{
+  static CStreamHeadCache instance;
+  return instance;
+}
+
+CStdString CStreamHeadCache::GetKey(const CURL &url)
+{
+  // the token and the headers don't change what is served
+  CURL key(url);
+  key.SetProtocolOptions("");
+  key.RemoveOption("X-Plex-Token");
+  return key.Get();
+}
+
+void CStreamHeadCache::Store(const CStdString &path, const std::string &data)
+{
+  if (data.empty() || data.size() > m_budget)
+    return;
+
+  CStdString key = GetKey(CURL(path));
+
+  CSingleLock lock(m_sync);
+
+  EntryMap::iterator it = m_entries.find(key);
+  if (it != m_entries.end())
+    Drop(it);
+
+  unsigned now = XbmcThreads::SystemClockMillis();
+  Expire(now);
+
+  // the oldest guess is the least likely to be played
+  while (m_size + data.size() > m_budget && !m_entries.empty())
+  {
+    EntryMap::iterator oldest = m_entries.begin();
+    for (it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+      if (now - it->second.stamp > now - oldest->second.stamp)
+        oldest = it;
+    }
+    Drop(oldest);
+  }
+
+  Entry &entry = m_entries[key];
+  entry.data = data;
+  entry.stamp = now;
+  m_size += data.size();
+
+  CLog::Log(LOGDEBUG, "CStreamHeadCache::Store - holding %u bytes of %s", (unsigned)data.size(), key.c_str());
+}
+
+bool CStreamHeadCache::Lookup(const CStdString &path, std::string &data)
+{
+  CStdString key = GetKey(CURL(path));
+
+  CSingleLock lock(m_sync);
+  Expire(XbmcThreads::SystemClockMillis());
+
+  EntryMap::iterator it = m_entries.find(key);
+  if (it == m_entries.end())
+    return false;
+
+  data = it->second.data;
+  return true;
+}
+
+bool CStreamHeadCache::Contains(const CStdString &path)
+{
+  CStdString key = GetKey(CURL(path));
+
+  CSingleLock lock(m_sync);
+  Expire(XbmcThreads::SystemClockMillis());
+  return m_entries.find(key) != m_entries.end();
+}
+
+void CStreamHeadCache::Remove(const CStdString &path)
+{
+  CStdString key = GetKey(CURL(path));
+
+  CSingleLock lock(m_sync);
+  EntryMap::iterator it = m_entries.find(key);
+  if (it != m_entries.end())
+    Drop(it);
+}
+
+void CStreamHeadCache::Clear()
+{
+  CSingleLock lock(m_sync);
+  m_entries.clear();
+  m_size = 0;
+}
+
+size_t CStreamHeadCache::GetSize() const
+{
+  CSingleLock lock(m_sync);
+  return m_size;
+}
+
+void CStreamHeadCache::Expire(unsigned now)
+{
+  EntryMap::iterator it = m_entries.begin();
+  while (it != m_entries.end())
+  {
+    EntryMap::iterator cur = it++;
+    if (now - cur->second.stamp >= m_ttl)
+      Drop(cur);
+  }
+}
+
+void CStreamHeadCache::Drop(EntryMap::iterator it)
+{
+  m_size -= it->second.data.size();
+  m_entries.erase(it);
+}
@@ -0,0 +1,86 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STREAMHEADCACHE_H
+#define STREAMHEADCACHE_H
+
+#include <map>
+#include <string>
+#include "threads/CriticalSection.h"
+#include "utils/StdString.h"
+
+class CURL;
+
+namespace XFILE {
+
+#define STREAM_HEAD_CACHE_BUDGET (16 * 1024 * 1024)
+#define STREAM_HEAD_CACHE_TTL_MS (60 * 1000)
+
+/**
+ * Holds the first bytes of streams that are likely to be played next.
+ *
+ * Whoever guesses what is played next reads the start of it ahead of time
+ * and stores it here, the file cache starts out with that data when the
+ * stream is opened and the player doesn't wait for the source to get going.
+ * Heads are keyed by the resource without its options, so a different
+ * token or set of headers still finds them. They expire after a while and
+ * the oldest ones are dropped when the budget is used up.
+ */
+class CStreamHeadCache
+{
+public:
+    CStreamHeadCache(size_t budget = STREAM_HEAD_CACHE_BUDGET, unsigned int ttlMs = STREAM_HEAD_CACHE_TTL_MS);
+
+    static CStreamHeadCache &GetInstance();
+
+    /** the key a resource is stored under */
+    static CStdString GetKey(const CURL &url);
+
+    void Store(const CStdString &path, const std::string &data);
+
+    /** copies the head of path to data, false if there is none or it expired */
+    bool Lookup(const CStdString &path, std::string &data);
+
+    bool Contains(const CStdString &path);
+    void Remove(const CStdString &path);
+    void Clear();
+
+    size_t GetSize() const;
+
+protected:
+    struct Entry
+    {
+      std::string data;
+      unsigned    stamp;
+    };
+    typedef std::map<CStdString, Entry> EntryMap;
+
+    void Expire(unsigned now);
+    void Drop(EntryMap::iterator it);
+
+    EntryMap                 m_entries;
+    size_t                   m_budget;
+    size_t                   m_size;
+    unsigned int             m_ttl;
+    mutable CCriticalSection m_sync;
+};
+
+} // namespace XFILE
+#endif
@@ -130,6 +130,15 @@ bool CDDSImage::Create(const std::string &outputFile, unsigned int width, unsign
   return WriteFile(outputFile);
 }
 
+/* PLEX */
+bool CDDSImage::CreateCompressed(const std::string &outputFile, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE)
+{
+  if (!brga || !Compress(width, height, pitch, brga, maxMSE))
+    return false;
+  return WriteFile(outputFile);
+}
+/* END PLEX */
+
 bool CDDSImage::WriteFile(const std::string &outputFile) const
 {
   // open the file
@@ -48,6 +48,20 @@ public:
    \return true on successful image creation, false otherwise
    */
   bool Create(const std::string &file, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0);
+
+  /* PLEX */
+  /*! \brief Create a DXT compressed DDS image file from the given ARGB buffer
+   Unlike Create, nothing is written if the image can't be compressed within maxMSE.
+   \param file name of the file to write
+   \param width width of the pixel buffer
+   \param height height of the pixel buffer
+   \param pitch pitch of the pixel buffer
+   \param argb pixel buffer
+   \param maxMSE maximum mean square error to allow, ignored if 0 (the default)
+   \return true if the image was compressed and written, false otherwise
+   */
+  bool CreateCompressed(const std::string &file, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0);
+  /* END PLEX */
   
   /*! \brief Decompress a DXT1/3/5 image to the given buffer
    Assumes the buffer has been allocated to at least width*height*4
@@ -492,15 +492,48 @@ bool CGUIBaseContainer::OnMessage(CGUIMessage& message)
       if (message.GetParam1())
       {
         int removeItem = (int)message.GetParam1() - 1;
+        if (removeItem >= (int)m_items.size())
+          return false;
+
+        int selectedItem = GetSelectedItem();
         m_items.erase(m_items.begin() + removeItem);
 
-        if (removeItem == GetSelectedItem())
-          SelectItem(0);
+        // keep the same item selected, or the one that takes the place of the removed one
+        if (removeItem < selectedItem)
+          SelectItem(selectedItem - 1);
+        else if (removeItem == selectedItem && !m_items.empty())
+          SelectItem(std::min(selectedItem, (int)m_items.size() - 1));
 
         SetInvalid();
         return true;
       }
     }
+    else if (message.GetMessage() == GUI_MSG_LIST_INSERT_ITEM)
+    {
+      int insertItem = (int)message.GetParam1() - 1;
+      if (message.GetItem() && insertItem >= 0 && insertItem <= (int)m_items.size())
+      {
+        int selectedItem = GetSelectedItem();
+        m_items.insert(m_items.begin() + insertItem, message.GetItem());
+
+        // keep the same item selected
+        if (m_items.size() > 1 && insertItem <= selectedItem)
+          SelectItem(selectedItem + 1);
+
+        SetInvalid();
+        return true;
+      }
+    }
+    else if (message.GetMessage() == GUI_MSG_LIST_UPDATE_ITEM)
+    {
+      int updateItem = (int)message.GetParam1() - 1;
+      if (message.GetItem() && updateItem >= 0 && updateItem < (int)m_items.size())
+      {
+        m_items[updateItem] = message.GetItem();
+        SetInvalid();
+        return true;
+      }
+    }
     /* END PLEX */
   }
   return CGUIControl::OnMessage(message);
@@ -1339,4 +1372,14 @@ int CGUIBaseContainer::GetSelectedItemID() const
   CFileItemPtr item = boost::static_pointer_cast<CFileItem>(m_items[GetSelectedItem()]);
   return item->m_iprogramCount;
 }
+
+bool CGUIBaseContainer::GetVisibleRange(int &first, int &last) const
+{
+  if (m_items.empty())
+    return false;
+
+  first = std::max(GetOffset(), 0);
+  last = std::min(GetOffset() + m_itemsPerPage, (int)m_items.size()) - 1;
+  return first <= last;
+}
 /* END PLEX */
@@ -109,6 +109,13 @@ public:
   virtual int GetSelectedItemID() const;
   std::vector<CGUIListItemPtr>& GetStaticItems() { return m_staticItems; }
   std::vector<CGUIListItemPtr>& GetItems() { return m_items; }
+
+  /*! \brief Get the range of items that is on screen
+   \param first the first item that is shown
+   \param last the last item that is shown
+   \return false if no item is shown
+   */
+  virtual bool GetVisibleRange(int &first, int &last) const;
   /* END PLEX */
 
 #ifdef _DEBUG
@@ -742,6 +742,14 @@ bool GUIFontManager::FindSystemFontPath(const CStdString& strFilename, CStdStrin
   return FALSE;
 }
 
+uint64_t GUIFontManager::GetTextureMemoryUsage() const
+{
+  uint64_t bytes = 0;
+  for (unsigned int i = 0; i < m_vecFontFiles.size(); i++)
+    bytes += m_vecFontFiles[i]->GetTextureMemoryUsage();
+  return bytes;
+}
+
 std::vector<std::string> GUIFontManager::GetSystemFontNames()
 {
 #ifndef TARGET_DARWIN_OSX
@@ -92,6 +92,7 @@ public:
 
   /* PLEX */
   std::vector<std::string> GetSystemFontNames();
+  uint64_t GetTextureMemoryUsage() const; ///< bytes of the textures of all loaded font files
   /* END PLEX */
 
 protected:
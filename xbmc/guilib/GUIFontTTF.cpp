@@ -27,6 +27,9 @@
 #include "utils/MathUtils.h"
 #include "utils/log.h"
 #include "windowing/WindowingFactory.h"
+/* PLEX */
+#include "threads/SystemClock.h"
+/* END PLEX */
 
 #include <math.h>
 
@@ -53,6 +56,121 @@ int CGUIFontTTFBase::justification_word_weight = 6;   // weight of word spacing
                                                   // A larger number means more of the "dead space" is placed between
                                                   // words rather than between letters.
 
+/* PLEX */
+#define STRING_CACHE_MAX_ENTRIES 1024 // strings kept per font face
+#define STRING_CACHE_EXPIRE_MS   1000 // strings not drawn for this long may be evicted
+
+static inline void HashCombine(size_t &seed, uint32_t value)
+{
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+static inline uint32_t FloatBits(float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+CGUIFontCacheKey::CGUIFontCacheKey(const vecColors &colors, const vecText &text,
+                                   uint32_t alignment, float maxPixelWidth, bool scrolling)
+  : m_colors(colors), m_text(text), m_alignment(alignment),
+    m_maxPixelWidth(maxPixelWidth), m_scrolling(scrolling),
+    m_scaleX(g_graphicsContext.GetGUIScaleX()), m_scaleY(g_graphicsContext.GetGUIScaleY())
+{
+  m_hash = 0;
+  for (vecText::const_iterator it = m_text.begin(); it != m_text.end(); ++it)
+    HashCombine(m_hash, *it);
+  for (vecColors::const_iterator it = m_colors.begin(); it != m_colors.end(); ++it)
+    HashCombine(m_hash, *it);
+  HashCombine(m_hash, m_alignment);
+  HashCombine(m_hash, FloatBits(m_maxPixelWidth));
+}
+
+CGUIFontCache::Entry::Entry(const CGUIFontCacheKey &key)
+  : colors(key.m_colors), text(key.m_text), alignment(key.m_alignment),
+    maxPixelWidth(key.m_maxPixelWidth), scrolling(key.m_scrolling),
+    scaleX(key.m_scaleX), scaleY(key.m_scaleY), hash(key.Hash()), lastUsed(0)
+{
+}
+
+bool CGUIFontCache::Entry::Matches(const CGUIFontCacheKey &key) const
+{
+  if (hash != key.Hash() ||
+      alignment != key.m_alignment ||
+      maxPixelWidth != key.m_maxPixelWidth ||
+      scrolling != key.m_scrolling ||
+      scaleX != key.m_scaleX || scaleY != key.m_scaleY)
+    return false;
+
+  return text == key.m_text && colors == key.m_colors;
+}
+
+CGUIFontCache::CGUIFontCache() : m_hits(0), m_misses(0)
+{
+}
+
+const std::vector<SGlyphQuad> *CGUIFontCache::Lookup(const CGUIFontCacheKey &key)
+{
+  std::pair<EntryMap::iterator, EntryMap::iterator> range = m_index.equal_range(key.Hash());
+  for (EntryMap::iterator it = range.first; it != range.second; ++it)
+  {
+    EntryList::iterator entry = it->second;
+    if (entry->Matches(key))
+    {
+      entry->lastUsed = XbmcThreads::SystemClockMillis();
+      m_entries.splice(m_entries.begin(), m_entries, entry);
+      m_hits++;
+      return &entry->glyphs;
+    }
+  }
+  m_misses++;
+  return NULL;
+}
+
+void CGUIFontCache::Insert(const CGUIFontCacheKey &key, const std::vector<SGlyphQuad> &glyphs)
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  Evict(now);
+
+  // only now the text and colors are copied, lookups get by with the caller's
+  m_entries.push_front(Entry(key));
+  Entry &entry = m_entries.front();
+  entry.glyphs = glyphs;
+  entry.lastUsed = now;
+  m_index.insert(std::make_pair(key.Hash(), m_entries.begin()));
+}
+
+void CGUIFontCache::Evict(unsigned int now)
+{
+  // strings are drawn every frame while visible, so anything that hasn't been
+  // drawn for a while is gone from screen (or scrolling) and may be dropped
+  while (!m_entries.empty())
+  {
+    Entry &oldest = m_entries.back();
+    if (m_entries.size() < STRING_CACHE_MAX_ENTRIES && now - oldest.lastUsed < STRING_CACHE_EXPIRE_MS)
+      break;
+
+    std::pair<EntryMap::iterator, EntryMap::iterator> range = m_index.equal_range(oldest.hash);
+    for (EntryMap::iterator it = range.first; it != range.second; ++it)
+    {
+      if (&(*it->second) == &oldest)
+      {
+        m_index.erase(it);
+        break;
+      }
+    }
+    m_entries.pop_back();
+  }
+}
+
+void CGUIFontCache::Flush()
+{
+  m_index.clear();
+  m_entries.clear();
+}
+/* END PLEX */
+
 class CFreeTypeLibrary
 {
 public:
@@ -204,6 +322,9 @@ CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
   m_color = 0;
   m_vertex_count = 0;
   m_nTexture = 0;
+  /* PLEX */
+  m_glyphGeneration = 0;
+  /* END PLEX */
 }
 
 CGUIFontTTFBase::~CGUIFontTTFBase(void)
@@ -225,8 +346,20 @@ void CGUIFontTTFBase::RemoveReference()
 }
 
 
+/* PLEX */
+unsigned int CGUIFontTTFBase::GetTextureMemoryUsage() const
+{
+  return m_texture ? m_texture->GetPitch() * m_texture->GetRows() : 0;
+}
+/* END PLEX */
+
 void CGUIFontTTFBase::ClearCharacterCache()
 {
+  /* PLEX */
+  m_stringCache.Flush();
+  m_glyphGeneration++;
+  /* END PLEX */
+
   delete(m_texture);
 
   DeleteHardwareTexture();
@@ -266,6 +399,10 @@ void CGUIFontTTFBase::Clear()
   free(m_vertex);
   m_vertex = NULL;
   m_vertex_count = 0;
+
+  /* PLEX */
+  m_stringCache.Flush();
+  /* END PLEX */
 }
 
 #ifndef __PLEX__
@@ -367,6 +504,27 @@ void CGUIFontTTFBase::DrawTextInternal(float x, float y, const vecColors &colors
 {
   Begin();
 
+  /* PLEX */
+  // a string laid out before only needs its glyphs placed at the new origin, which
+  // keeps the labels of a scrolling list cached while they move
+  CGUIFontCacheKey key(colors, text, alignment, maxPixelWidth, scrolling);
+  const std::vector<SGlyphQuad> *cached = m_stringCache.Lookup(key);
+  if (cached)
+  {
+    ReserveVertices(cached->size() * 4);
+    for (std::vector<SGlyphQuad>::const_iterator it = cached->begin(); it != cached->end(); ++it)
+    {
+      CRect vertex(it->vertex);
+      vertex += CPoint(x, y);
+      RenderQuad(vertex, it->texture, it->color, !scrolling);
+    }
+    End();
+    return;
+  }
+  m_laidOut.clear();
+  unsigned int glyphGeneration = m_glyphGeneration;
+  /* END PLEX */
+
   // save the origin, which is scaled separately
   m_originX = x;
   m_originY = y;
@@ -468,6 +626,13 @@ void CGUIFontTTFBase::DrawTextInternal(float x, float y, const vecColors &colors
       cursorX += ch->advance;
   }
 
+  /* PLEX */
+  // if the glyph texture was cleared while laying out, the glyphs placed
+  // before that point to where other glyphs are now
+  if (glyphGeneration == m_glyphGeneration)
+    m_stringCache.Insert(key, m_laidOut);
+  /* END PLEX */
+
   End();
 }
 
@@ -728,8 +893,17 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
                (posY + ch->offsetY) * g_graphicsContext.GetGUIScaleY(),
                (posX + ch->offsetX + width) * g_graphicsContext.GetGUIScaleX(),
                (posY + ch->offsetY + height) * g_graphicsContext.GetGUIScaleY());
-  vertex += CPoint(m_originX, m_originY);
   CRect texture(ch->left, ch->top, ch->right, ch->bottom);
+  /* PLEX */
+  // the string cache keeps the glyph relative to the origin, where it goes is up to each draw
+  m_laidOut.push_back(SGlyphQuad(vertex, texture, color));
+  vertex += CPoint(m_originX, m_originY);
+  RenderQuad(vertex, texture, color, roundX);
+}
+
+void CGUIFontTTFBase::RenderQuad(CRect vertex, CRect texture, color_t color, bool roundX)
+{
+  /* END PLEX */
   g_graphicsContext.ClipRect(vertex, texture);
 
   // transform our positions - note, no scaling due to GUI calibration/resolution occurs
@@ -778,18 +952,9 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
   float tb = texture.y2 * m_textureScaleY;
 
   // grow the vertex buffer if required
-  if(m_vertex_count >= m_vertex_size)
-  {
-    m_vertex_size *= 2;
-    void* old      = m_vertex;
-    m_vertex       = (SVertex*)realloc(m_vertex, m_vertex_size * sizeof(SVertex));
-    if (!m_vertex)
-    {
-      free(old);
-      printf("realloc failed in CGUIFontTTF::RenderCharacter. aborting\n");
-      abort();
-    }
-  }
+  /* PLEX */
+  ReserveVertices(4);
+  /* END PLEX */
 
   m_color = color;
   SVertex* v = m_vertex + m_vertex_count;
@@ -863,6 +1028,25 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
   m_vertex_count+=4;
 }
 
+/* PLEX */
+void CGUIFontTTFBase::ReserveVertices(int count)
+{
+  if (m_vertex_count + count <= m_vertex_size)
+    return;
+
+  while (m_vertex_count + count > m_vertex_size)
+    m_vertex_size *= 2;
+  void* old      = m_vertex;
+  m_vertex       = (SVertex*)realloc(m_vertex, m_vertex_size * sizeof(SVertex));
+  if (!m_vertex)
+  {
+    free(old);
+    printf("realloc failed in CGUIFontTTF::ReserveVertices. aborting\n");
+    abort();
+  }
+}
+/* END PLEX */
+
 // Oblique code - original taken from freetype2 (ftsynth.c)
 void CGUIFontTTFBase::ObliqueGlyph(FT_GlyphSlot slot)
 {
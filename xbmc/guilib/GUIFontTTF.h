@@ -27,6 +27,13 @@
  *
  */
 
+/* PLEX */
+#include <list>
+#include <map>
+#include <vector>
+#include "Geometry.h"
+/* END PLEX */
+
 // forward definition
 class CBaseTexture;
 
@@ -63,6 +70,96 @@ struct SVertex
   float u, v;
 };
 
+/* PLEX */
+/*!
+ \ingroup textures
+ \brief One glyph of a laid out string. The position is GUI scaled and relative to
+ the origin the string is drawn at, the texture rect is in glyph texture pixels.
+ */
+struct SGlyphQuad
+{
+  SGlyphQuad(const CRect &v, const CRect &t, color_t c) : vertex(v), texture(t), color(c) {}
+  CRect vertex;
+  CRect texture;
+  color_t color;
+};
+
+/*!
+ \ingroup textures
+ \brief Identifies one laid out string: the text and its styling. The origin, transform
+ and clip region aren't part of it, they are applied every time the string is drawn.
+ The key only refers to the text and colors, entries in the cache keep their own copy.
+ */
+class CGUIFontCacheKey
+{
+public:
+  CGUIFontCacheKey(const vecColors &colors, const vecText &text,
+                   uint32_t alignment, float maxPixelWidth, bool scrolling);
+
+  size_t Hash() const { return m_hash; }
+
+  const vecColors &m_colors;
+  const vecText &m_text;
+  uint32_t m_alignment;
+  float m_maxPixelWidth;
+  bool m_scrolling;
+  float m_scaleX, m_scaleY;
+
+private:
+  size_t m_hash;
+};
+
+/*!
+ \ingroup textures
+ \brief LRU cache of laid out strings, so labels that are drawn frame after frame, even
+ while they move with a scrolling list, skip the glyph lookups and width calculations
+ and only have their quads placed.
+ */
+class CGUIFontCache
+{
+public:
+  CGUIFontCache();
+
+  /*! \brief Look up the glyphs of a string, refreshing its LRU position
+   \return the cached glyphs, or NULL if the string isn't cached
+   */
+  const std::vector<SGlyphQuad> *Lookup(const CGUIFontCacheKey &key);
+  void Insert(const CGUIFontCacheKey &key, const std::vector<SGlyphQuad> &glyphs);
+
+  /*! \brief Drop all entries, needed whenever the glyphs move in the texture */
+  void Flush();
+
+  unsigned int GetHits() const { return m_hits; }
+  unsigned int GetMisses() const { return m_misses; }
+
+private:
+  struct Entry
+  {
+    Entry(const CGUIFontCacheKey &key);
+    bool Matches(const CGUIFontCacheKey &key) const;
+
+    vecColors colors;
+    vecText text;
+    uint32_t alignment;
+    float maxPixelWidth;
+    bool scrolling;
+    float scaleX, scaleY;
+    size_t hash;
+    std::vector<SGlyphQuad> glyphs;
+    unsigned int lastUsed;
+  };
+  typedef std::list<Entry> EntryList;
+  typedef std::multimap<size_t, EntryList::iterator> EntryMap;
+
+  void Evict(unsigned int now);
+
+  EntryList m_entries; // most recently used first
+  EntryMap m_index;
+  unsigned int m_hits;
+  unsigned int m_misses;
+};
+/* END PLEX */
+
 
 class CGUIFontTTFBase
 {
@@ -85,6 +182,9 @@ public:
   virtual void End() = 0;
 
   const CStdString& GetFileName() const { return m_strFileName; };
+  /* PLEX */
+  unsigned int GetTextureMemoryUsage() const; ///< bytes of the texture holding the rendered characters
+  /* END PLEX */
 
 protected:
   struct Character
@@ -114,6 +214,10 @@ protected:
   inline Character *GetCharacter(character_t letter);
   bool CacheCharacter(wchar_t letter, uint32_t style, Character *ch);
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX);
+  /* PLEX */
+  void RenderQuad(CRect vertex, CRect texture, color_t color, bool roundX);
+  void ReserveVertices(int count);
+  /* END PLEX */
   void ClearCharacterCache();
 
   virtual CBaseTexture* ReallocTexture(unsigned int& newHeight) = 0;
@@ -172,6 +276,12 @@ protected:
 
   CStdString m_strFileName;
 
+  /* PLEX */
+  CGUIFontCache m_stringCache;
+  std::vector<SGlyphQuad> m_laidOut; // glyphs of the string being laid out
+  unsigned int m_glyphGeneration;    // bumped every time the glyph texture is cleared
+  /* END PLEX */
+
 private:
   int m_referenceCount;
 };
@@ -30,6 +30,9 @@
 #include "utils/GLUtils.h"
 #include "windowing/WindowingFactory.h"
 #include "guilib/MatrixGLES.h"
+/* PLEX */
+#include "GUITexture.h"
+/* END PLEX */
 
 // stuff for freetype
 #include <ft2build.h>
@@ -55,6 +58,11 @@ void CGUIFontTTFGL::Begin()
 {
   if (m_nestedBeginCount == 0)
   {
+#ifdef HAS_GL
+    /* PLEX */
+    CGUITextureGL::FlushBatch();
+    /* END PLEX */
+#endif
     if (!m_bTextureLoaded)
     {
       // Have OpenGL generate a texture object handle for us
@@ -538,3 +538,14 @@ bool CGUIPanelContainer::HasNextPage() const
   return (GetOffset() != (int)GetRows() - m_itemsPerPage && (int)GetRows() > m_itemsPerPage);
 }
 
+/* PLEX */
+bool CGUIPanelContainer::GetVisibleRange(int &first, int &last) const
+{
+  if (m_items.empty())
+    return false;
+
+  first = std::max(GetOffset() * m_itemsPerRow, 0);
+  last = std::min((GetOffset() + m_itemsPerPage) * m_itemsPerRow, (int)m_items.size()) - 1;
+  return first <= last;
+}
+/* END PLEX */
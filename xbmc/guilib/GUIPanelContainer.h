@@ -47,6 +47,9 @@ public:
   virtual void OnUp();
   virtual void OnDown();
   virtual bool GetCondition(int condition, int data) const;
+  /* PLEX */
+  virtual bool GetVisibleRange(int &first, int &last) const;
+  /* END PLEX */
 protected:
   virtual bool MoveUp(bool wrapAround);
   virtual bool MoveDown(bool wrapAround);
@@ -29,6 +29,17 @@
 
 #if defined(HAS_GL)
 
+/* PLEX */
+std::vector<CGUITextureGL::PackedVertex> CGUITextureGL::m_batch;
+const CBaseTexture *CGUITextureGL::m_batchTexture = NULL;
+const CBaseTexture *CGUITextureGL::m_batchDiffuse = NULL;
+bool CGUITextureGL::m_batchActive = false;
+GLuint CGUITextureGL::m_batchVBO = 0;
+int CGUITextureGL::m_batchUseVBO = -1;
+GUIBatchStats CGUITextureGL::m_frameStats;
+GUIBatchStats CGUITextureGL::m_lastFrameStats;
+/* END PLEX */
+
 #ifndef __PLEX__
 CGUITextureGL::CGUITextureGL(float posX, float posY, float width, float height, const CTextureInfo &texture)
 : CGUITextureBase(posX, posY, width, height, texture)
@@ -54,6 +65,18 @@ void CGUITextureGL::Begin(color_t color)
   m_col[3] = GET_A(color);
 
   CBaseTexture* texture = m_texture.m_textures[m_currentFrame];
+
+  /* PLEX */
+  // colour is per vertex, so as long as the same textures are bound we can
+  // keep appending to the pending batch without touching any GL state
+  const CBaseTexture* diffuse = m_diffuse.size() ? m_diffuse.m_textures[0] : NULL;
+  m_frameStats.textures++;
+  if (m_batchActive && m_batchTexture == texture && m_batchDiffuse == diffuse)
+    return;
+
+  FlushBatch();
+  /* END PLEX */
+
   texture->LoadToGPU();
   if (m_diffuse.size())
     m_diffuse.m_textures[0]->LoadToGPU();
@@ -114,74 +137,152 @@ void CGUITextureGL::Begin(color_t color)
     VerifyGLState();
   }
 
-  //glDisable(GL_TEXTURE_2D); // uncomment these 2 lines to switch to wireframe rendering
-  //glBegin(GL_LINE_LOOP);
-  glBegin(GL_QUADS);
+  /* PLEX */
+  m_batchTexture = texture;
+  m_batchDiffuse = diffuse;
+  m_batchActive = true;
+  /* END PLEX */
 }
 
 void CGUITextureGL::End()
 {
-  glEnd();
-  glActiveTexture(GL_TEXTURE2_ARB);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
-  glActiveTexture(GL_TEXTURE1_ARB);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
-  glActiveTexture(GL_TEXTURE0_ARB);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
+  /* PLEX */
+  // nothing to do - the quads stay queued until the next state change
+  // or until someone else needs the GL state, see FlushBatch()
+  /* END PLEX */
 }
 
+/* PLEX */
+void CGUITextureGL::AddVertex(float x, float y, float z, float u1, float v1, float u2, float v2)
+{
+  PackedVertex v;
+  v.x = x; v.y = y; v.z = z;
+  v.r = m_col[0]; v.g = m_col[1]; v.b = m_col[2]; v.a = m_col[3];
+  v.u1 = u1; v.v1 = v1;
+  v.u2 = u2; v.v2 = v2;
+  m_batch.push_back(v);
+}
+/* END PLEX */
+
 void CGUITextureGL::Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation)
 {
+  /* PLEX */
+  const bool rotTexture = (orientation & 4) != 0;
+  const bool rotDiffuse = (m_info.orientation & 4) != 0;
+
   // Top-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y1);
-  if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y1);
-  glVertex3f(x[0], y[0], z[0]);
+  AddVertex(x[0], y[0], z[0], texture.x1, texture.y1, diffuse.x1, diffuse.y1);
 
   // Top-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
-  else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
-  if (m_diffuse.size())
-  {
-    if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
-    else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
-  }
-  glVertex3f(x[1], y[1], z[1]);
+  AddVertex(x[1], y[1], z[1],
+            rotTexture ? texture.x1 : texture.x2, rotTexture ? texture.y2 : texture.y1,
+            rotDiffuse ? diffuse.x1 : diffuse.x2, rotDiffuse ? diffuse.y2 : diffuse.y1);
 
   // Bottom-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y2);
-  if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y2);
-  glVertex3f(x[2], y[2], z[2]);
+  AddVertex(x[2], y[2], z[2], texture.x2, texture.y2, diffuse.x2, diffuse.y2);
 
   // Bottom-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
-  else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
-  if (m_diffuse.size())
+  AddVertex(x[3], y[3], z[3],
+            rotTexture ? texture.x2 : texture.x1, rotTexture ? texture.y1 : texture.y2,
+            rotDiffuse ? diffuse.x2 : diffuse.x1, rotDiffuse ? diffuse.y1 : diffuse.y2);
+  /* END PLEX */
+}
+
+/* PLEX */
+void CGUITextureGL::FlushBatch()
+{
+  if (!m_batchActive)
+    return;
+
+  if (!m_batch.empty())
   {
-    if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
-    else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
+    if (m_batchUseVBO < 0)
+      m_batchUseVBO = glewIsSupported("GL_ARB_vertex_buffer_object") ? 1 : 0;
+
+    const char *base = (const char *)&m_batch[0];
+    const GLsizeiptrARB size = m_batch.size() * sizeof(PackedVertex);
+
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+    if (m_batchUseVBO)
+    {
+      if (!m_batchVBO)
+        glGenBuffersARB(1, &m_batchVBO);
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, m_batchVBO);
+      // orphan the previous contents so the driver doesn't stall on a buffer still in flight
+      glBufferDataARB(GL_ARRAY_BUFFER_ARB, size, NULL, GL_STREAM_DRAW_ARB);
+      glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, 0, size, base);
+      base = NULL;
+    }
+
+    glVertexPointer(3, GL_FLOAT,         sizeof(PackedVertex), base + offsetof(PackedVertex, x));
+    glColorPointer (4, GL_UNSIGNED_BYTE, sizeof(PackedVertex), base + offsetof(PackedVertex, r));
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    glClientActiveTextureARB(GL_TEXTURE0_ARB);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(PackedVertex), base + offsetof(PackedVertex, u1));
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+    if (m_batchDiffuse)
+    {
+      glClientActiveTextureARB(GL_TEXTURE1_ARB);
+      glTexCoordPointer(2, GL_FLOAT, sizeof(PackedVertex), base + offsetof(PackedVertex, u2));
+      glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    }
+
+    glDrawArrays(GL_QUADS, 0, m_batch.size());
+
+    if (m_batchUseVBO)
+      glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    glPopClientAttrib();
+
+    m_frameStats.drawCalls++;
+    m_frameStats.vertices += m_batch.size();
+    m_batch.clear();
   }
-  glVertex3f(x[3], y[3], z[3]);
+
+  glActiveTexture(GL_TEXTURE2_ARB);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+  glActiveTexture(GL_TEXTURE1_ARB);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+  glActiveTexture(GL_TEXTURE0_ARB);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+
+  m_batchTexture = NULL;
+  m_batchDiffuse = NULL;
+  m_batchActive = false;
 }
 
+void CGUITextureGL::EndFrame()
+{
+  FlushBatch();
+  m_lastFrameStats = m_frameStats;
+  m_frameStats = GUIBatchStats();
+}
+
+void CGUITextureGL::DestroyBatch()
+{
+  m_batch.clear();
+  m_batchActive = false;
+  m_batchTexture = NULL;
+  m_batchDiffuse = NULL;
+  if (m_batchVBO)
+    glDeleteBuffersARB(1, &m_batchVBO);
+  m_batchVBO = 0;
+  m_batchUseVBO = -1;
+}
+/* END PLEX */
+
 void CGUITextureGL::DrawQuad(const CRect &rect, color_t color, CBaseTexture *texture, const CRect *texCoords)
 {
+  /* PLEX */
+  FlushBatch();
+  /* END PLEX */
+
   if (texture)
   {
     texture->LoadToGPU();
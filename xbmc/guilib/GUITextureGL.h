@@ -32,6 +32,19 @@
 
 #include "system_gl.h"
 
+/* PLEX */
+#include <vector>
+
+struct GUIBatchStats
+{
+  GUIBatchStats() : drawCalls(0), vertices(0), textures(0) {}
+
+  unsigned int drawCalls; // glDrawArrays calls issued
+  unsigned int vertices;  // vertices submitted
+  unsigned int textures;  // texture renders merged into those calls
+};
+/* END PLEX */
+
 class CGUITextureGL : public CGUITextureBase
 {
 public:
@@ -41,12 +54,49 @@ public:
   CGUITextureGL(float posX, float posY, float width, float height, const CTextureInfo& texture, float minWidth=0.0f);
 #endif
   static void DrawQuad(const CRect &coords, color_t color, CBaseTexture *texture = NULL, const CRect *texCoords = NULL);
+
+  /* PLEX */
+  /*! \brief Draw all quads queued since the last texture state change.
+   Must be called before anything else touches the GL state (fonts, video,
+   scissors, matrices, texture uploads) so queued quads keep their order.
+   */
+  static void FlushBatch();
+
+  /*! \brief Flush and roll the per-frame counters over, called once per presented frame */
+  static void EndFrame();
+
+  /*! \brief Release the vertex buffer, called before the GL context goes away */
+  static void DestroyBatch();
+
+  static GUIBatchStats GetFrameStats() { return m_lastFrameStats; }
+  /* END PLEX */
 protected:
   void Begin(color_t color);
   void Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation);
   void End();
 private:
   GLubyte m_col[4];
+
+  /* PLEX */
+  struct PackedVertex
+  {
+    float x, y, z;
+    unsigned char r, g, b, a;
+    float u1, v1; // texture
+    float u2, v2; // diffuse
+  };
+
+  void AddVertex(float x, float y, float z, float u1, float v1, float u2, float v2);
+
+  static std::vector<PackedVertex> m_batch;
+  static const CBaseTexture *m_batchTexture;
+  static const CBaseTexture *m_batchDiffuse;
+  static bool m_batchActive;
+  static GLuint m_batchVBO;
+  static int m_batchUseVBO;
+  static GUIBatchStats m_frameStats;
+  static GUIBatchStats m_lastFrameStats;
+  /* END PLEX */
 };
 
 #endif
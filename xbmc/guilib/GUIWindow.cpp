@@ -42,6 +42,10 @@
 #include "Application.h"
 #include "ApplicationMessenger.h"
 #include "utils/Variant.h"
+/* PLEX */
+#include "filesystem/File.h"
+#include "TextureManager.h"
+/* END PLEX */
 
 #ifdef HAS_PERFORMANCE_SAMPLE
 #include "utils/PerformanceSample.h"
@@ -49,6 +53,48 @@
 
 using namespace std;
 
+/* PLEX */
+// a control whose visible condition is false right now doesn't load its textures when the
+// window opens, they only come in once it shows up
+static bool IsHiddenOnLoad(const TiXmlElement *control, int windowID)
+{
+  for (const TiXmlElement *visible = control->FirstChildElement("visible"); visible; visible = visible->NextSiblingElement("visible"))
+  {
+    const TiXmlNode *condition = visible->FirstChild();
+    if (condition && condition->Type() == TiXmlNode::TINYXML_TEXT && !g_infoManager.EvaluateBool(condition->Value(), windowID))
+      return true;
+  }
+  return false;
+}
+
+// gather the static texture names a window draws when it opens - anything with an info
+// label in it can only be resolved once the controls are up, and hidden controls or
+// layouts that depend on the items may never be drawn at all
+static void CollectTextures(const TiXmlElement *element, int windowID, vector<CStdString> &textures)
+{
+  for (const TiXmlElement *child = element->FirstChildElement(); child; child = child->NextSiblingElement())
+  {
+    CStdString tag = child->ValueStr();
+    tag.ToLower();
+    if (tag == "control" && IsHiddenOnLoad(child, windowID))
+      continue;
+    if ((tag == "itemlayout" || tag == "focusedlayout") && child->Attribute("condition"))
+      continue;
+
+    if (tag.Find("texture") >= 0)
+    {
+      const TiXmlNode *value = child->FirstChild();
+      if (value && value->Type() == TiXmlNode::TINYXML_TEXT && !strchr(value->Value(), '$'))
+        textures.push_back(value->Value());
+      const char *diffuse = child->Attribute("diffuse");
+      if (diffuse && !strchr(diffuse, '$'))
+        textures.push_back(diffuse);
+    }
+    CollectTextures(child, windowID, textures);
+  }
+}
+/* END PLEX */
+
 CGUIWindow::CGUIWindow(int id, const CStdString &xmlFile)
 {
   SetID(id);
@@ -69,12 +115,30 @@ CGUIWindow::CGUIWindow(int id, const CStdString &xmlFile)
   m_exclusiveMouseControl = 0;
   m_clearBackground = 0xff000000; // opaque black -> always clear
   m_windowXMLRootElement = NULL;
+  /* PLEX */
+  m_windowXMLResolvedElement = NULL;
+  m_windowXMLResolvedWidth = m_windowXMLResolvedHeight = 0;
+  m_windowXMLModified = 0;
+  /* END PLEX */
 }
 
 CGUIWindow::~CGUIWindow(void)
+{
+  /* PLEX */
+  ClearXMLCache();
+  /* END PLEX */
+}
+
+/* PLEX */
+void CGUIWindow::ClearXMLCache()
 {
   delete m_windowXMLRootElement;
+  m_windowXMLRootElement = NULL;
+  delete m_windowXMLResolvedElement;
+  m_windowXMLResolvedElement = NULL;
+  m_windowXMLModified = 0;
 }
+/* END PLEX */
 
 bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
 {
@@ -130,6 +194,19 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
 
 bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPath)
 {
+  /* PLEX */
+  // drop the stored xml if the skin file has been edited since we read it
+  struct __stat64 stat;
+  time_t modified = 0;
+  if (XFILE::CFile::Stat(strPath, &stat) == 0)
+    modified = stat.st_mtime;
+  if (m_windowXMLRootElement && modified != m_windowXMLModified)
+  {
+    CLog::Log(LOGDEBUG, "Skin file %s has changed, reloading it", strPath.c_str());
+    ClearXMLCache();
+  }
+  /* END PLEX */
+
   // load window xml if we don't have it stored yet
   if (!m_windowXMLRootElement)
   {
@@ -141,6 +218,9 @@ bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPa
       return false;
     }
     m_windowXMLRootElement = (TiXmlElement*)xmlDoc.RootElement()->Clone();
+    /* PLEX */
+    m_windowXMLModified = modified;
+    /* END PLEX */
   }
   else
     CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
@@ -159,6 +239,7 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
     return false;
   }
 
+#ifndef __PLEX__
   // we must create copy of root element as we will manipulate it when resolving includes
   // and we don't want original root element to change
   pRootElement = (TiXmlElement*)pRootElement->Clone();
@@ -169,6 +250,47 @@ bool CGUIWindow::Load(TiXmlElement* pRootElement)
 
   // Resolve any includes that may be present and save conditions used to do it
   g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+#else
+  // resolving includes is most of the cost of loading a window. The result only depends on
+  // the source xml, the resolution and the include conditions, so reuse the last one while
+  // none of those changed
+  bool isStoredXML = (pRootElement == m_windowXMLRootElement);
+  if (isStoredXML && m_windowXMLResolvedElement &&
+      m_windowXMLResolvedWidth == m_coordsRes.iWidth &&
+      m_windowXMLResolvedHeight == m_coordsRes.iHeight &&
+      !g_infoManager.ConditionsChangedValues(m_xmlIncludeConditions))
+  {
+    CLog::Log(LOGDEBUG, "Using already resolved xml for %s", GetProperty("xmlfile").c_str());
+    pRootElement = (TiXmlElement*)m_windowXMLResolvedElement->Clone();
+    g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
+  }
+  else
+  {
+    // we must create copy of root element as we will manipulate it when resolving includes
+    // and we don't want original root element to change
+    pRootElement = (TiXmlElement*)pRootElement->Clone();
+
+    // set the scaling resolution so that any control creation or initialisation can
+    // be done with respect to the correct aspect ratio
+    g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
+
+    // Resolve any includes that may be present and save conditions used to do it
+    g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+
+    if (isStoredXML)
+    {
+      delete m_windowXMLResolvedElement;
+      m_windowXMLResolvedElement = (TiXmlElement*)pRootElement->Clone();
+      m_windowXMLResolvedWidth = m_coordsRes.iWidth;
+      m_windowXMLResolvedHeight = m_coordsRes.iHeight;
+    }
+  }
+
+  // get bundled textures unpacking in the background while the controls are created
+  vector<CStdString> textures;
+  CollectTextures(pRootElement, GetID(), textures);
+  g_TextureManager.PrefetchTextures(textures);
+#endif
   // now load in the skin file
   SetDefaults();
 
@@ -386,6 +508,10 @@ void CGUIWindow::Close_Internal(bool forceClose /*= false*/, int nextWindowID /*
       // Perform the window out effect
       QueueAnimation(ANIM_TYPE_WINDOW_CLOSE);
       m_closing = true;
+      /* PLEX */
+      if (IsDialog())
+        g_windowManager.OnDialogClosing();
+      /* END PLEX */
     }
     return;
   }
@@ -766,8 +892,9 @@ void CGUIWindow::FreeResources(bool forceUnload /*= FALSE */)
   if (m_loadType == LOAD_EVERY_TIME || forceUnload) ClearAll();
   if (forceUnload)
   {
-    delete m_windowXMLRootElement;
-    m_windowXMLRootElement = NULL;
+    /* PLEX */
+    ClearXMLCache();
+    /* END PLEX */
   }
 }
 
@@ -278,6 +278,15 @@ protected:
 
   TiXmlElement* m_windowXMLRootElement;
 
+  /* PLEX */
+  void ClearXMLCache();
+
+  TiXmlElement* m_windowXMLResolvedElement; ///< \brief m_windowXMLRootElement with includes resolved, reused while include conditions are unchanged
+  int m_windowXMLResolvedWidth;
+  int m_windowXMLResolvedHeight;
+  time_t m_windowXMLModified;               ///< \brief modification time of the file m_windowXMLRootElement was read from
+  /* END PLEX */
+
   bool m_manualRunActions;
 
   int m_exclusiveMouseControl; ///< \brief id of child control that wishes to receive all mouse events \sa GUI_MSG_EXCLUSIVE_MOUSE
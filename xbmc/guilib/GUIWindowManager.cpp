@@ -48,6 +48,7 @@ CGUIWindowManager::CGUIWindowManager(void)
 
   /* PLEX */
   m_restrictedAccessMode = false;
+  m_stateVersion = 0;
   /* END PLEX */
 }
 
@@ -220,6 +221,9 @@ void CGUIWindowManager::AddModeless(CGUIWindow* dialog)
   for (iDialog it = m_activeDialogs.begin(); it != m_activeDialogs.end(); ++it)
     if (*it == dialog) return;
   m_activeDialogs.push_back(dialog);
+  /* PLEX */
+  m_stateVersion++;
+  /* END PLEX */
 }
 
 void CGUIWindowManager::Remove(int id)
@@ -235,6 +239,9 @@ void CGUIWindowManager::Remove(int id)
       else
         it2++;
     }
+    /* PLEX */
+    m_stateVersion++;
+    /* END PLEX */
 
     m_mapWindows.erase(it);
   }
@@ -337,6 +344,9 @@ void CGUIWindowManager::PreviousWindow()
 
   // remove the current window off our window stack
   m_windowHistory.pop();
+  /* PLEX */
+  m_stateVersion++;
+  /* END PLEX */
 
   // ok, initialize the new window
   CLog::Log(LOGDEBUG,"CGUIWindowManager::PreviousWindow: Activate new");
@@ -748,6 +758,9 @@ void CGUIWindowManager::DeInitialize()
   // clear our vectors of windows
   m_vecCustomWindows.clear();
   m_activeDialogs.clear();
+  /* PLEX */
+  m_stateVersion++;
+  /* END PLEX */
 
   m_initialized = false;
 }
@@ -762,6 +775,9 @@ void CGUIWindowManager::RouteToWindow(CGUIWindow* dialog)
   RemoveDialog(dialog->GetID());
 
   m_activeDialogs.push_back(dialog);
+  /* PLEX */
+  m_stateVersion++;
+  /* END PLEX */
 }
 
 /// \brief Unroute window
@@ -774,6 +790,9 @@ void CGUIWindowManager::RemoveDialog(int id)
     if ((*it)->GetID() == id)
     {
       m_activeDialogs.erase(it);
+      /* PLEX */
+      m_stateVersion++;
+      /* END PLEX */
       return;
     }
   }
@@ -1024,6 +1043,9 @@ void CGUIWindowManager::AddToWindowHistory(int newWindowID)
   { // didn't find window in history - add it to the stack
     m_windowHistory.push(newWindowID);
   }
+  /* PLEX */
+  m_stateVersion++;
+  /* END PLEX */
 }
 
 void CGUIWindowManager::GetActiveModelessWindows(vector<int> &ids)
@@ -1072,7 +1094,24 @@ void CGUIWindowManager::ClearWindowHistory()
 {
   while (m_windowHistory.size())
     m_windowHistory.pop();
+  /* PLEX */
+  m_stateVersion++;
+  /* END PLEX */
+}
+
+/* PLEX */
+unsigned int CGUIWindowManager::GetStateVersion() const
+{
+  return m_stateVersion;
+}
+
+void CGUIWindowManager::OnDialogClosing()
+{
+  // a dialog stops counting as active as soon as it starts animating out
+  CSingleLock lock(g_graphicsContext);
+  m_stateVersion++;
 }
+/* END PLEX */
 
 void CGUIWindowManager::CloseWindowSync(CGUIWindow *window, int nextWindowID /*= 0*/)
 {
@@ -54,6 +54,17 @@ public:
  /* PLEX */
   void setRetrictedAccess(bool restricted) { m_restrictedAccessMode = restricted; }
   bool isAccessRestricted() { return m_restrictedAccessMode; }
+
+  /*! \brief Version of the window stack and active dialogs
+   Changes whenever the active window changes, a dialog is opened or closed, or a
+   dialog starts its close animation. Used by the info manager to decide
+   whether window conditions need to be re-evaluated.
+   */
+  unsigned int GetStateVersion() const;
+
+  /*! \brief Called by a dialog when it queues its close animation
+   */
+  void OnDialogClosing();
   /* END PLEX */
   void Initialize();
   void Add(CGUIWindow* pWindow);
@@ -185,6 +196,7 @@ private:
   /* PLEX */
 private :
   bool m_restrictedAccessMode;
+  unsigned int m_stateVersion;
   /* END PLEX */
 };
 
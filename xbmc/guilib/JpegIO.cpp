@@ -366,19 +366,25 @@ bool CJpegIO::Read(unsigned char* buffer, unsigned int bufSize, unsigned int min
 
     m_cinfo.scale_denom = 8;
     m_cinfo.out_color_space = JCS_RGB;
-    unsigned int maxtexsize = g_Windowing.GetMaxTextureSize();
-    for (unsigned int scale = 1; scale <= 8; scale++)
+    /* PLEX */
+    // the smallest scale that covers minx x miny. Only the powers of two, libjpeg-turbo has simd
+    // for those alone and decodes 3/8 or 6/8 slower than the whole image
+    for (unsigned int scale = 1; scale <= 8; scale *= 2)
     {
       m_cinfo.scale_num = scale;
       jpeg_calc_output_dimensions(&m_cinfo);
-      if ((m_cinfo.output_width > maxtexsize) || (m_cinfo.output_height > maxtexsize))
-      {
-        m_cinfo.scale_num--;
-        break;
-      }
       if (m_cinfo.output_width >= minx && m_cinfo.output_height >= miny)
         break;
     }
+
+    // but no more than the gpu can hold
+    unsigned int maxtexsize = g_Windowing.GetMaxTextureSize();
+    while (m_cinfo.scale_num > 1 && (m_cinfo.output_width > maxtexsize || m_cinfo.output_height > maxtexsize))
+    {
+      m_cinfo.scale_num /= 2;
+      jpeg_calc_output_dimensions(&m_cinfo);
+    }
+    /* END PLEX */
     jpeg_calc_output_dimensions(&m_cinfo);
     m_width  = m_cinfo.output_width;
     m_height = m_cinfo.output_height;
@@ -404,9 +410,21 @@ bool CJpegIO::Decode(const unsigned char *pixels, unsigned int pitch, unsigned i
   }
   else
   {
+    /* PLEX */
+    bool direct = format == XB_FMT_RGB8;
+#ifdef JCS_ALPHA_EXTENSIONS
+    // libjpeg-turbo writes the rows in the texture format itself, with the alpha at 0xff
+    if (format == XB_FMT_A8R8G8B8)
+    {
+      m_cinfo.out_color_space = JCS_EXT_BGRA;
+      direct = true;
+    }
+#endif
+    /* END PLEX */
+
     jpeg_start_decompress(&m_cinfo);
 
-    if (format == XB_FMT_RGB8)
+    if (direct)
     {
       while (m_cinfo.output_scanline < m_height)
       {
@@ -503,10 +521,22 @@ bool CJpegIO::CreateThumbnailFromSurface(unsigned char* buffer, unsigned int wid
     return false;
   }
 
+  /* PLEX */
+  bool direct = format == XB_FMT_RGB8;
+  /* END PLEX */
   if(format == XB_FMT_RGB8)
   {
     rgbbuf = buffer;
   }
+#ifdef JCS_EXTENSIONS
+  /* PLEX */
+  else if(format == XB_FMT_A8R8G8B8)
+  { // libjpeg-turbo reads bgra itself
+    rgbbuf = buffer;
+    direct = true;
+  }
+  /* END PLEX */
+#else
   else if(format == XB_FMT_A8R8G8B8)
   {
     // create a copy for bgra -> rgb.
@@ -526,6 +556,7 @@ bool CJpegIO::CreateThumbnailFromSurface(unsigned char* buffer, unsigned int wid
       src += pitch;
     }
   }
+#endif
   else
   {
     CLog::Log(LOGWARNING, "JpegIO::CreateThumbnailFromSurface Unsupported format");
@@ -541,7 +572,7 @@ bool CJpegIO::CreateThumbnailFromSurface(unsigned char* buffer, unsigned int wid
   {
     jpeg_destroy_compress(&cinfo);
     free(result);
-    if(format != XB_FMT_RGB8)
+    if(!direct)
       delete [] rgbbuf;
     return false;
   }
@@ -556,20 +587,31 @@ bool CJpegIO::CreateThumbnailFromSurface(unsigned char* buffer, unsigned int wid
     cinfo.image_height = height;
     cinfo.input_components = 3;
     cinfo.in_color_space = JCS_RGB;
+    /* PLEX */
+    unsigned int rowSize = width * 3;
+#ifdef JCS_EXTENSIONS
+    if(format == XB_FMT_A8R8G8B8)
+    {
+      cinfo.input_components = 4;
+      cinfo.in_color_space = JCS_EXT_BGRX;
+      rowSize = pitch;
+    }
+#endif
+    /* END PLEX */
     jpeg_set_defaults(&cinfo);
     jpeg_set_quality(&cinfo, 90, TRUE);
     jpeg_start_compress(&cinfo, TRUE);
 
     while (cinfo.next_scanline < cinfo.image_height)
     {
-      row_pointer[0] = &rgbbuf[cinfo.next_scanline * width * 3];
+      row_pointer[0] = &rgbbuf[cinfo.next_scanline * rowSize];
       jpeg_write_scanlines(&cinfo, row_pointer, 1);
     }
 
     jpeg_finish_compress(&cinfo);
     jpeg_destroy_compress(&cinfo);
   }
-  if(format != XB_FMT_RGB8)
+  if(!direct)
     delete [] rgbbuf;
 
   XFILE::CFile file;
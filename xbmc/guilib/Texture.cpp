@@ -141,6 +141,15 @@ void CBaseTexture::Update(unsigned int width, unsigned int height, unsigned int
     LoadToGPU();
 }
 
+/* PLEX */
+bool CBaseTexture::LoadToGPUPartially(unsigned int maxBytes, unsigned int &loaded)
+{
+  loaded = m_pixels ? GetPitch() * GetRows() : 0;
+  LoadToGPU();
+  return true;
+}
+/* END PLEX */
+
 void CBaseTexture::ClampToEdge()
 {
   unsigned int imagePitch = GetPitch(m_imageWidth);
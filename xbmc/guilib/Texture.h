@@ -82,6 +82,17 @@ public:
   virtual void LoadToGPU() = 0;
   virtual void BindToUnit(unsigned int unit) = 0;
 
+  /* PLEX */
+  /*! \brief Load the next part of the texture to the GPU
+   Renderers that can't load a texture in parts load all of it at once.
+   \param maxBytes how much to load now, at least one row is loaded regardless
+   \param loaded [out] how much was loaded
+   \return true once all of the texture is on the GPU
+   */
+  virtual bool LoadToGPUPartially(unsigned int maxBytes, unsigned int &loaded);
+  bool IsLoadedToGPU() const { return m_loadedToGPU; }
+  /* END PLEX */
+
   unsigned char* GetPixels() const { return m_pixels; }
   unsigned int GetPitch() const { return GetPitch(m_textureWidth); }
   unsigned int GetRows() const { return GetRows(m_textureHeight); }
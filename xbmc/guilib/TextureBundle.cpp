@@ -103,6 +103,15 @@ int CTextureBundle::LoadAnim(const CStdString& Filename, CBaseTexture*** ppTextu
   }
 }
 
+/* PLEX */
+void CTextureBundle::PrefetchTextures(const std::vector<CStdString>& names)
+{
+  // only XBT bundles can be unpacked in the background
+  if (m_useXBT)
+    m_tbXBT.PrefetchTextures(names);
+}
+/* END PLEX */
+
 void CTextureBundle::Cleanup()
 {
   m_tbXBT.Cleanup();
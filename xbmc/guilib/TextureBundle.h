@@ -41,6 +41,10 @@ public:
 
   int LoadAnim(const CStdString& Filename, CBaseTexture*** ppTextures, int &width, int &height, int& nLoops, int** ppDelays);
 
+  /* PLEX */
+  void PrefetchTextures(const std::vector<CStdString>& names);
+  /* END PLEX */
+
 private:
   CTextureBundleXPR m_tbXPR;
   CTextureBundleXBT m_tbXBT;
@@ -31,6 +31,62 @@
 #include "utils/URIUtils.h"
 #include "XBTF.h"
 #include <lzo/lzo1x.h>
+/* PLEX */
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/JobManager.h"
+#include <set>
+
+// Upper bound on unpacked pixel data held for textures that were prefetched
+// but not yet picked up by the texture manager.
+#define XBT_PREFETCH_MAX_BYTES (64 * 1024 * 1024)
+
+class CXBTFPrefetchJob : public CJob
+{
+public:
+  CXBTFPrefetchJob(const CXBTFMappingPtr& mapping, const CXBTFFrame& frame)
+    : m_mapping(mapping), m_frame(frame), m_unpacked(NULL)
+  {
+  }
+
+  virtual ~CXBTFPrefetchJob()
+  {
+    delete[] m_unpacked;
+  }
+
+  virtual const char *GetType() const { return "xbtprefetch"; }
+
+  virtual bool DoWork()
+  {
+    const unsigned char* packed = m_mapping->GetFrameData(m_frame);
+    if (!packed)
+      return false;
+
+    m_unpacked = new unsigned char[(size_t)m_frame.GetUnpackedSize()];
+    if (!CTextureBundleXBT::UnpackFrame(packed, m_frame, m_unpacked))
+    {
+      delete[] m_unpacked;
+      m_unpacked = NULL;
+      return false;
+    }
+    return true;
+  }
+
+  unsigned char* Detach()
+  {
+    unsigned char* unpacked = m_unpacked;
+    m_unpacked = NULL;
+    return unpacked;
+  }
+
+  const CXBTFFrame& GetFrame() const { return m_frame; }
+
+private:
+  CXBTFMappingPtr m_mapping;
+  CXBTFFrame      m_frame;
+  unsigned char*  m_unpacked;
+};
+/* END PLEX */
 
 #ifdef _WIN32
 #pragma comment(lib,"liblzo2.lib")
@@ -40,6 +96,12 @@ CTextureBundleXBT::CTextureBundleXBT(void)
 {
   m_themeBundle = false;
   m_TimeStamp = 0;
+  /* PLEX */
+  m_prefetchBytes = 0;
+  m_statLoads = 0;
+  m_statPrefetchHits = 0;
+  m_statUnpackMs = 0;
+  /* END PLEX */
 }
 
 CTextureBundleXBT::~CTextureBundleXBT(void)
@@ -193,6 +255,7 @@ int CTextureBundleXBT::LoadAnim(const CStdString& Filename, CBaseTexture*** ppTe
 
 bool CTextureBundleXBT::ConvertFrameToTexture(const CStdString& name, CXBTFFrame& frame, CBaseTexture** ppTexture)
 {
+#ifndef __PLEX__
   // found texture - allocate the necessary buffers
   squish::u8 *buffer = new squish::u8[(size_t)frame.GetPackedSize()];
   if (buffer == NULL)
@@ -232,6 +295,52 @@ bool CTextureBundleXBT::ConvertFrameToTexture(const CStdString& name, CXBTFFrame
     buffer = unpacked;
   }
 
+#else
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  m_statLoads++;
+
+  squish::u8 *buffer = TakePrefetched(frame);
+  if (buffer)
+  {
+    m_statPrefetchHits++;
+  }
+  else
+  {
+    // unpack directly out of the mapped bundle when we can, otherwise read
+    // the packed frame into a temporary buffer first
+    squish::u8 *packed = NULL;
+    const unsigned char *data = NULL;
+    CXBTFMappingPtr mapping = m_XBTFReader.GetMapping();
+    if (mapping)
+      data = mapping->GetFrameData(frame);
+
+    if (!data)
+    {
+      packed = new squish::u8[(size_t)frame.GetPackedSize()];
+      if (!m_XBTFReader.Load(frame, packed))
+      {
+        CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
+        delete[] packed;
+        return false;
+      }
+      data = packed;
+    }
+
+    buffer = new squish::u8[(size_t)frame.GetUnpackedSize()];
+    bool unpacked = UnpackFrame(data, frame, buffer);
+    delete[] packed;
+
+    if (!unpacked)
+    {
+      CLog::Log(LOGERROR, "Error loading texture: %s: Decompression error", name.c_str());
+      delete[] buffer;
+      return false;
+    }
+  }
+
+  m_statUnpackMs += XbmcThreads::SystemClockMillis() - start;
+#endif
+
   // create an xbmc texture
   *ppTexture = new CTexture();
   (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), buffer);
@@ -241,10 +350,142 @@ bool CTextureBundleXBT::ConvertFrameToTexture(const CStdString& name, CXBTFFrame
   return true;
 }
 
+/* PLEX */
+bool CTextureBundleXBT::UnpackFrame(const unsigned char* packed, const CXBTFFrame& frame, unsigned char* unpacked)
+{
+  if (!frame.IsPacked())
+  {
+    memcpy(unpacked, packed, (size_t)frame.GetUnpackedSize());
+    return true;
+  }
+
+  lzo_uint s = (lzo_uint)frame.GetUnpackedSize();
+  return lzo1x_decompress_safe(packed, (lzo_uint)frame.GetPackedSize(), unpacked, &s, NULL) == LZO_E_OK &&
+         s == frame.GetUnpackedSize();
+}
+
+void CTextureBundleXBT::PrefetchTextures(const std::vector<CStdString>& names)
+{
+  CXBTFMappingPtr mapping = m_XBTFReader.GetMapping();
+  if (!mapping)
+    return;
+
+  std::vector<const CXBTFFrame*> wanted;
+  std::set<uint64_t> wantedOffsets;
+  for (std::vector<CStdString>::const_iterator it = names.begin(); it != names.end(); ++it)
+  {
+    CXBTFFile* file = m_XBTFReader.Find(Normalize(*it));
+    if (!file)
+      continue;
+
+    std::vector<CXBTFFrame>& frames = file->GetFrames();
+    for (std::vector<CXBTFFrame>::const_iterator frame = frames.begin(); frame != frames.end(); ++frame)
+    {
+      if (frame->IsPacked() && wantedOffsets.insert(frame->GetOffset()).second)
+        wanted.push_back(&(*frame));
+    }
+  }
+
+  CSingleLock lock(m_prefetchSection);
+
+  // each window load asks for what it is about to draw. What an earlier one unpacked and
+  // nobody took by now isn't drawn, don't let it hold on to the budget
+  std::map<uint64_t, PrefetchedFrame>::iterator it = m_prefetched.begin();
+  while (it != m_prefetched.end())
+  {
+    if (wantedOffsets.find(it->first) == wantedOffsets.end())
+      DropPrefetched(it++);
+    else
+      ++it;
+  }
+
+  for (std::vector<const CXBTFFrame*>::const_iterator frame = wanted.begin(); frame != wanted.end(); ++frame)
+  {
+    uint64_t offset = (*frame)->GetOffset();
+    if (m_prefetched.find(offset) != m_prefetched.end())
+      continue;
+
+    if (m_prefetchBytes + (*frame)->GetUnpackedSize() > XBT_PREFETCH_MAX_BYTES)
+      return;
+
+    PrefetchedFrame& prefetched = m_prefetched[offset];
+    prefetched.size = (*frame)->GetUnpackedSize();
+    prefetched.jobID = CJobManager::GetInstance().AddJob(new CXBTFPrefetchJob(mapping, **frame), this, CJob::PRIORITY_HIGH);
+    m_prefetchBytes += prefetched.size;
+  }
+}
+
+void CTextureBundleXBT::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CXBTFPrefetchJob* prefetch = (CXBTFPrefetchJob*)job;
+  const CXBTFFrame& frame = prefetch->GetFrame();
+
+  CSingleLock lock(m_prefetchSection);
+  std::map<uint64_t, PrefetchedFrame>::iterator it = m_prefetched.find(frame.GetOffset());
+  if (it == m_prefetched.end() || it->second.jobID != jobID)
+    return; // already loaded synchronously, dropped, or the bundle was closed
+
+  unsigned char* unpacked = success ? prefetch->Detach() : NULL;
+  if (unpacked)
+  {
+    it->second.unpacked = unpacked;
+    it->second.jobID = 0;
+  }
+  else
+  {
+    m_prefetchBytes -= it->second.size;
+    m_prefetched.erase(it);
+  }
+}
+
+unsigned char* CTextureBundleXBT::TakePrefetched(const CXBTFFrame& frame)
+{
+  CSingleLock lock(m_prefetchSection);
+
+  std::map<uint64_t, PrefetchedFrame>::iterator it = m_prefetched.find(frame.GetOffset());
+  if (it == m_prefetched.end())
+    return NULL;
+
+  unsigned char* unpacked = it->second.unpacked;
+  it->second.unpacked = NULL;
+
+  // if it's still in flight we need it now, so unpack it ourselves and drop the
+  // job's result when it arrives
+  DropPrefetched(it);
+  return unpacked;
+}
+
+void CTextureBundleXBT::DropPrefetched(std::map<uint64_t, PrefetchedFrame>::iterator it)
+{
+  if (it->second.jobID)
+    CJobManager::GetInstance().CancelJob(it->second.jobID);
+  delete[] it->second.unpacked;
+  m_prefetchBytes -= it->second.size;
+  m_prefetched.erase(it);
+}
+
+void CTextureBundleXBT::CancelPrefetch()
+{
+  CSingleLock lock(m_prefetchSection);
+
+  while (!m_prefetched.empty())
+    DropPrefetched(m_prefetched.begin());
+}
+/* END PLEX */
+
 void CTextureBundleXBT::Cleanup()
 {
+  /* PLEX */
+  CancelPrefetch();
+  /* END PLEX */
+
   if (m_XBTFReader.IsOpen())
   {
+    /* PLEX */
+    if (m_statLoads)
+      CLog::Log(LOGDEBUG, "%s - %u textures loaded, %u from prefetch, %u ms spent unpacking", __FUNCTION__, m_statLoads, m_statPrefetchHits, m_statUnpackMs);
+    m_statLoads = m_statPrefetchHits = m_statUnpackMs = 0;
+    /* END PLEX */
     m_XBTFReader.Close();
     CLog::Log(LOGDEBUG, "%s - Closed %sbundle", __FUNCTION__, m_themeBundle ? "theme " : "");
   }
@@ -23,10 +23,18 @@
 #include "utils/StdString.h"
 #include <map>
 #include "XBTFReader.h"
+/* PLEX */
+#include "threads/CriticalSection.h"
+#include "utils/Job.h"
+/* END PLEX */
 
 class CBaseTexture;
 
+#ifndef __PLEX__
 class CTextureBundleXBT
+#else
+class CTextureBundleXBT : public IJobCallback
+#endif
 {
 public:
   CTextureBundleXBT(void);
@@ -44,10 +52,44 @@ public:
   int LoadAnim(const CStdString& Filename, CBaseTexture*** ppTextures,
                 int &width, int &height, int& nLoops, int** ppDelays);
 
+  /* PLEX */
+  /*! \brief Queue background decompression of the given textures.
+   Frames are unpacked on the job manager's workers straight from the mapped
+   bundle, and picked up by LoadTexture/LoadAnim when they are asked for.
+   Whatever an earlier call unpacked that isn't asked for again is dropped.
+   */
+  void PrefetchTextures(const std::vector<CStdString>& names);
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+  static bool UnpackFrame(const unsigned char* packed, const CXBTFFrame& frame, unsigned char* unpacked);
+  /* END PLEX */
+
 private:
   bool OpenBundle();
   bool ConvertFrameToTexture(const CStdString& name, CXBTFFrame& frame, CBaseTexture** ppTexture);
 
+  /* PLEX */
+  struct PrefetchedFrame
+  {
+    PrefetchedFrame() : jobID(0), unpacked(NULL), size(0) {}
+    unsigned int jobID;      // while it is being unpacked
+    unsigned char* unpacked; // once it is
+    uint64_t size;
+  };
+
+  unsigned char* TakePrefetched(const CXBTFFrame& frame);
+  void DropPrefetched(std::map<uint64_t, PrefetchedFrame>::iterator it);
+  void CancelPrefetch();
+
+  CCriticalSection m_prefetchSection;
+  std::map<uint64_t, PrefetchedFrame> m_prefetched; // frame offset -> pixels, by the last window load
+  uint64_t m_prefetchBytes;
+
+  unsigned int m_statLoads;
+  unsigned int m_statPrefetchHits;
+  unsigned int m_statUnpackMs;
+  /* END PLEX */
+
   time_t m_TimeStamp;
 
   bool m_themeBundle;
@@ -24,6 +24,9 @@
 #include "utils/log.h"
 #include "utils/GLUtils.h"
 #include "guilib/TextureManager.h"
+/* PLEX */
+#include "guilib/GUITexture.h"
+/* END PLEX */
 
 #if defined(HAS_GL) || defined(HAS_GLES)
 
@@ -36,6 +39,9 @@ CGLTexture::CGLTexture(unsigned int width, unsigned int height, unsigned int for
 : CBaseTexture(width, height, format)
 {
   m_texture = 0;
+  /* PLEX */
+  m_loadedRows = 0;
+  /* END PLEX */
 }
 
 CGLTexture::~CGLTexture()
@@ -61,6 +67,13 @@ void CGLTexture::LoadToGPU()
     // nothing to load - probably same image (no change)
     return;
   }
+
+#if defined(HAS_GL)
+  /* PLEX */
+  // binding below clobbers texture unit 0 of any pending GUI batch
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+#endif
   if (m_texture == 0)
   {
     // Have OpenGL generate a texture object handle for us
@@ -184,6 +197,50 @@ void CGLTexture::LoadToGPU()
   m_loadedToGPU = true;
 }
 
+/* PLEX */
+bool CGLTexture::LoadToGPUPartially(unsigned int maxBytes, unsigned int &loaded)
+{
+#if defined(HAS_GL)
+  // only plain BGRA in parts, compressed or truncated ones go in one piece
+  unsigned int maxSize = g_Windowing.GetMaxTextureSize();
+  if (!m_pixels || m_format != XB_FMT_A8R8G8B8 || m_textureWidth > maxSize || m_textureHeight > maxSize)
+    return CBaseTexture::LoadToGPUPartially(maxBytes, loaded);
+
+  CGUITextureGL::FlushBatch();
+  if (m_texture == 0)
+    CreateTextureObject();
+  glBindTexture(GL_TEXTURE_2D, m_texture);
+
+  if (m_loadedRows == 0)
+  { // the storage first, the rows follow
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_textureWidth, m_textureHeight, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+  }
+
+  unsigned int pitch = GetPitch();
+  unsigned int rows = std::min(std::max(maxBytes / pitch, 1u), m_textureHeight - m_loadedRows);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_loadedRows, m_textureWidth, rows, GL_BGRA, GL_UNSIGNED_BYTE, m_pixels + m_loadedRows * pitch);
+  VerifyGLState();
+
+  m_loadedRows += rows;
+  loaded = rows * pitch;
+  if (m_loadedRows < m_textureHeight)
+    return false;
+
+  delete [] m_pixels;
+  m_pixels = NULL;
+  m_loadedRows = 0;
+  m_loadedToGPU = true;
+  return true;
+#else
+  return CBaseTexture::LoadToGPUPartially(maxBytes, loaded);
+#endif
+}
+/* END PLEX */
+
 void CGLTexture::BindToUnit(unsigned int unit)
 {
   glActiveTexture(GL_TEXTURE0 + unit);
@@ -39,9 +39,15 @@ public:
   virtual void DestroyTextureObject();
   void LoadToGPU();
   void BindToUnit(unsigned int unit);
+  /* PLEX */
+  virtual bool LoadToGPUPartially(unsigned int maxBytes, unsigned int &loaded);
+  /* END PLEX */
 
 protected:
   GLuint m_texture;
+  /* PLEX */
+  unsigned int m_loadedRows; ///< rows on the GPU so far when loading in parts
+  /* END PLEX */
 };
 
 #endif
@@ -34,6 +34,9 @@
 #include "filesystem/Directory.h"
 #include "URL.h"
 #include <assert.h>
+/* PLEX */
+#include "GUITexture.h"
+/* END PLEX */
 
 using namespace std;
 
@@ -460,6 +463,11 @@ void CGUITextureManager::FreeUnusedTextures()
     delete *i;
   m_unusedTextures.clear();
 
+#if defined(HAS_GL)
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+#endif
 #if defined(HAS_GL) || defined(HAS_GLES)
   for (unsigned int i = 0; i < m_unusedHwTextures.size(); ++i)
   {
@@ -598,3 +606,35 @@ void CGUITextureManager::GetBundledTexturesFromPath(const CStdString& texturePat
   if (items.empty())
     m_TexBundle[1].GetTexturesFromPath(texturePath, items);
 }
+
+/* PLEX */
+void CGUITextureManager::PrefetchTextures(const std::vector<CStdString>& textures)
+{
+  std::vector<CStdString> bundled[2];
+  for (std::vector<CStdString>::const_iterator it = textures.begin(); it != textures.end(); ++it)
+  {
+    if (!CanLoad(*it))
+      continue;
+
+    bool loaded = false;
+    for (ivecTextures i = m_vecTextures.begin(); i != m_vecTextures.end() && !loaded; ++i)
+      loaded = (*i)->GetName() == *it;
+    if (loaded)
+      continue;
+
+    CStdString bundledName = CTextureBundle::Normalize(*it);
+    for (int i = 0; i < 2; i++)
+    {
+      if (m_TexBundle[i].HasFile(bundledName))
+      {
+        bundled[i].push_back(bundledName);
+        break;
+      }
+    }
+  }
+
+  // also when there is nothing new to unpack, so what the last window didn't take is dropped
+  for (int i = 0; i < 2; i++)
+    m_TexBundle[i].PrefetchTextures(bundled[i]);
+}
+/* END PLEX */
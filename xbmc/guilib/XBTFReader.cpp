@@ -28,6 +28,12 @@
 
 #include <string.h>
 #include "PlatformDefs.h"
+/* PLEX */
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+#include "utils/log.h"
+/* END PLEX */
 
 #define READ_STR(str, size, file) \
   if (!fread(str, size, 1, file)) \
@@ -43,6 +49,29 @@
     return false; \
   i = Endian_SwapLE64(i);
 
+/* PLEX */
+CXBTFMapping::CXBTFMapping(unsigned char* data, size_t size)
+  : m_data(data), m_size(size)
+{
+}
+
+CXBTFMapping::~CXBTFMapping()
+{
+#ifndef _WIN32
+  if (m_data)
+    munmap(m_data, m_size);
+#endif
+}
+
+const unsigned char* CXBTFMapping::GetFrameData(const CXBTFFrame& frame) const
+{
+  if (!m_data || frame.GetOffset() > m_size || frame.GetPackedSize() > m_size - frame.GetOffset())
+    return NULL;
+
+  return m_data + frame.GetOffset();
+}
+/* END PLEX */
+
 CXBTFReader::CXBTFReader()
 {
   m_file = NULL;
@@ -135,11 +164,31 @@ bool CXBTFReader::Open(const CStdString& fileName)
     return false;
   }
 
+  /* PLEX */
+  // Map the whole bundle so frames can be decompressed straight out of the
+  // page cache, from several threads at once, without seek + read copies.
+#ifndef _WIN32
+  struct stat fileStat;
+  if (fstat(fileno(m_file), &fileStat) == 0 && fileStat.st_size > 0)
+  {
+    void* data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fileno(m_file), 0);
+    if (data != MAP_FAILED)
+      m_mapping = CXBTFMappingPtr(new CXBTFMapping((unsigned char*)data, (size_t)fileStat.st_size));
+    else
+      CLog::Log(LOGDEBUG, "CXBTFReader::Open - unable to map %s, falling back to reads", m_fileName.c_str());
+  }
+#endif
+  /* END PLEX */
+
   return true;
 }
 
 void CXBTFReader::Close()
 {
+  /* PLEX */
+  m_mapping.reset();
+  /* END PLEX */
+
   if (m_file)
   {
     fclose(m_file);
@@ -188,6 +237,19 @@ bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
   {
     return false;
   }
+
+  /* PLEX */
+  if (m_mapping)
+  {
+    const unsigned char* data = m_mapping->GetFrameData(frame);
+    if (!data)
+      return false;
+
+    memcpy(buffer, data, (size_t)frame.GetPackedSize());
+    return true;
+  }
+  /* END PLEX */
+
 #if defined(TARGET_DARWIN) || defined(__FreeBSD__) || defined(__ANDROID__)
     if (fseeko(m_file, (off_t)frame.GetOffset(), SEEK_SET) == -1)
 #else
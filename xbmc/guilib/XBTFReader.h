@@ -25,6 +25,29 @@
 #include <map>
 #include "utils/StdString.h"
 #include "XBTF.h"
+/* PLEX */
+#include <boost/shared_ptr.hpp>
+
+/*! \brief Read-only view of a whole texture bundle mapped into memory.
+ Shared with background decompression jobs, so the mapping stays valid until
+ the last job reading from it is done even if the reader is closed.
+ */
+class CXBTFMapping
+{
+public:
+  CXBTFMapping(unsigned char* data, size_t size);
+  ~CXBTFMapping();
+
+  /*! \brief Returns the packed data of a frame, or NULL if it lies outside the mapping */
+  const unsigned char* GetFrameData(const CXBTFFrame& frame) const;
+
+private:
+  unsigned char* m_data;
+  size_t         m_size;
+};
+
+typedef boost::shared_ptr<CXBTFMapping> CXBTFMappingPtr;
+/* END PLEX */
 
 class CXBTFReader
 {
@@ -38,12 +61,18 @@ public:
   CXBTFFile* Find(const CStdString& name);
   bool Load(const CXBTFFrame& frame, unsigned char* buffer);
   std::vector<CXBTFFile>&  GetFiles();
+  /* PLEX */
+  CXBTFMappingPtr GetMapping() const { return m_mapping; }
+  /* END PLEX */
 
 private:
   CXBTF      m_xbtf;
   CStdString m_fileName;
   FILE*      m_file;
   std::map<CStdString, CXBTFFile> m_filesMap;
+  /* PLEX */
+  CXBTFMappingPtr m_mapping;
+  /* END PLEX */
 };
 
 #endif
@@ -30,6 +30,9 @@ InfoSingle::InfoSingle(const CStdString &expression, int context)
 : InfoBool(expression, context)
 {
   m_condition = g_infoManager.TranslateSingleString(expression);
+  /* PLEX */
+  m_dependencies = g_infoManager.GetConditionDependencies(m_condition);
+  /* END PLEX */
 }
 
 void InfoSingle::Update(const CGUIListItem *item)
@@ -142,6 +145,13 @@ void InfoExpression::Parse(const CStdString &expression)
     operators.pop();
   }
 
+  /* PLEX */
+  // we depend on whatever our operands depend on
+  m_dependencies = INFO_DEPENDS_NONE;
+  for (vector<unsigned int>::const_iterator it = m_operands.begin(); it != m_operands.end(); ++it)
+    m_dependencies |= g_infoManager.GetBoolDependencies(*it);
+  /* END PLEX */
+
   // test evaluate
   bool test;
   if (!Evaluate(NULL, test))
@@ -28,6 +28,24 @@ class CGUIListItem;
 
 namespace INFO
 {
+/* PLEX */
+/*! \brief State an info condition reads.
+ A condition is only re-evaluated when one of the state it depends on has changed
+ since it was last evaluated. Anything not classified depends on INFO_DEPENDS_FRAME
+ and is evaluated every frame.
+ */
+enum InfoDependency
+{
+  INFO_DEPENDS_NONE   = 0,      ///< constant until the info cache is reset
+  INFO_DEPENDS_PLAYER = 1 << 0, ///< playback state and the currently playing item
+  INFO_DEPENDS_WINDOW = 1 << 1, ///< active window and dialog stack
+  INFO_DEPENDS_PLEX   = 1 << 2, ///< Plex servers, myPlex account and play queues
+  INFO_DEPENDS_FRAME  = 1 << 3, ///< unknown, changes every frame
+  INFO_DEPENDS_ALL    = (1 << 4) - 1
+};
+#define INFO_DEPENDS_COUNT 4
+/* END PLEX */
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -41,6 +59,9 @@ public:
       m_expression(expression),
       m_lastUpdate(0)
   {
+    /* PLEX */
+    m_dependencies = INFO_DEPENDS_FRAME;
+    /* END PLEX */
   };
 
   virtual ~InfoBool() {};
@@ -62,6 +83,14 @@ public:
     return m_value;
   }
 
+  /* PLEX */
+  /*! \brief Whether Get() with the given time would re-evaluate this info bool */
+  bool IsDirty(unsigned int time) const { return time != m_lastUpdate; }
+
+  /*! \brief The INFO::InfoDependency flags this info bool reads */
+  unsigned int GetDependencies() const { return m_dependencies; }
+  /* END PLEX */
+
   bool operator==(const InfoBool &right) const
   {
     return (m_context == right.m_context && 
@@ -77,6 +106,9 @@ protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
+  /* PLEX */
+  unsigned int m_dependencies; ///< INFO::InfoDependency flags of the state this reads
+  /* END PLEX */
 
 private:
   CStdString m_expression;     ///< original expression
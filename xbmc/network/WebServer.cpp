@@ -29,6 +29,9 @@
 #include "threads/SingleLock.h"
 #include "XBDateTime.h"
 #include "URL.h"
+/* PLEX */
+#include <algorithm>
+/* END PLEX */
 
 #ifdef _WIN32
 #pragma comment(lib, "libmicrohttpd.dll.lib")
@@ -44,6 +47,12 @@ using namespace std;
 using namespace JSONRPC;
 
 vector<IHTTPRequestHandler *> CWebServer::m_requestHandlers;
+/* PLEX */
+CCriticalSection CWebServer::m_suspendedSection;
+CWebServer::SuspendedRequestMap CWebServer::m_suspendedRequests;
+CWebServer::SuspendedRequestMap CWebServer::m_resumedRequests;
+set<struct MHD_Connection *> CWebServer::m_earlyResumes;
+/* END PLEX */
 
 CWebServer::CWebServer()
 {
@@ -132,6 +141,20 @@ int CWebServer::AnswerToConnection(void *cls, struct MHD_Connection *connection,
   if (!IsAuthenticated(server, connection)) 
     return AskForAuthentication(connection);
 
+  /* PLEX */
+  // a parked request is handed to us again once it was resumed
+  IHTTPRequestHandler *resumed = TakeResumedRequest(connection);
+  if (resumed)
+  {
+    if (resumed->ResumeHTTPRequest(request) == MHD_NO)
+    {
+      delete resumed;
+      return SendErrorResponse(connection, MHD_HTTP_INTERNAL_SERVER_ERROR, methodType);
+    }
+    return SendResponse(resumed, request);
+  }
+  /* END PLEX */
+
   // Check if this is the first call to
   // AnswerToConnection for this request
   if (*con_cls == NULL)
@@ -280,6 +303,14 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
     return SendErrorResponse(request.connection, MHD_HTTP_INTERNAL_SERVER_ERROR, request.method);
   }
 
+  /* PLEX */
+  return SendResponse(handler, request);
+}
+
+int CWebServer::SendResponse(IHTTPRequestHandler *handler, const HTTPRequest &request)
+{
+  int ret;
+  /* END PLEX */
   struct MHD_Response *response = NULL;
   int responseCode = handler->GetHTTPResonseCode();
   switch (handler->GetHTTPResponseType())
@@ -316,6 +347,11 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
       ret = CreateErrorResponse(request.connection, handler->GetHTTPResonseCode(), request.method, response);
       break;
 
+    /* PLEX */
+    case HTTPSuspended:
+      return SuspendRequest(handler, request);
+    /* END PLEX */
+
     default:
       delete handler;
       return SendErrorResponse(request.connection, MHD_HTTP_INTERNAL_SERVER_ERROR, request.method);
@@ -338,6 +374,191 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
   return MHD_YES;
 }
 
+/* PLEX */
+bool CWebServer::CanSuspendRequest(const HTTPRequest &request)
+{
+#ifdef WEBSERVER_HAS_SUSPEND
+  return true;
+#else
+  // only a chunked body can be sent before MHD knows how long it is, the others would have to block
+  return request.version == MHD_HTTP_VERSION_1_1 && request.method != HEAD;
+#endif
+}
+
+int CWebServer::SuspendRequest(IHTTPRequestHandler *handler, const HTTPRequest &request)
+{
+  if (CanSuspendRequest(request))
+  {
+    CSingleLock lock(m_suspendedSection);
+
+    // the handler got its answer before we got around to suspending
+    if (m_earlyResumes.erase(request.connection) == 0)
+    {
+#ifdef WEBSERVER_HAS_SUSPEND
+      m_suspendedRequests[request.connection] = handler;
+      MHD_suspend_connection(request.connection);
+      return MHD_YES;
+#else
+      if (QueueDeferredResponse(handler, request))
+      {
+        m_suspendedRequests[request.connection] = handler;
+        return MHD_YES;
+      }
+      lock.Leave();
+
+      delete handler;
+      return SendErrorResponse(request.connection, MHD_HTTP_INTERNAL_SERVER_ERROR, request.method);
+#endif
+    }
+    lock.Leave();
+
+    if (handler->ResumeHTTPRequest(request) != MHD_NO && handler->GetHTTPResponseType() != HTTPSuspended)
+      return SendResponse(handler, request);
+  }
+
+  delete handler;
+  return SendErrorResponse(request.connection, MHD_HTTP_INTERNAL_SERVER_ERROR, request.method);
+}
+
+void CWebServer::ResumeRequest(struct MHD_Connection *connection)
+{
+  CSingleLock lock(m_suspendedSection);
+
+  SuspendedRequestMap::iterator it = m_suspendedRequests.find(connection);
+  if (it == m_suspendedRequests.end())
+  {
+    m_earlyResumes.insert(connection);
+    return;
+  }
+
+  m_resumedRequests[connection] = it->second;
+  m_suspendedRequests.erase(it);
+#ifdef WEBSERVER_HAS_SUSPEND
+  MHD_resume_connection(connection);
+#endif
+}
+
+IHTTPRequestHandler *CWebServer::TakeResumedRequest(struct MHD_Connection *connection)
+{
+  CSingleLock lock(m_suspendedSection);
+
+  SuspendedRequestMap::iterator it = m_resumedRequests.find(connection);
+  if (it == m_resumedRequests.end())
+    return NULL;
+
+  IHTTPRequestHandler *handler = it->second;
+  m_resumedRequests.erase(it);
+  return handler;
+}
+
+void CWebServer::ResumeAllRequests()
+{
+  CSingleLock lock(m_suspendedSection);
+
+  // MHD can't shut down with suspended connections
+  for (SuspendedRequestMap::iterator it = m_suspendedRequests.begin(); it != m_suspendedRequests.end(); ++it)
+  {
+    m_resumedRequests[it->first] = it->second;
+#ifdef WEBSERVER_HAS_SUSPEND
+    MHD_resume_connection(it->first);
+#endif
+  }
+  m_suspendedRequests.clear();
+  m_earlyResumes.clear();
+}
+
+void CWebServer::RequestCompleted(void *cls, struct MHD_Connection *connection, void **con_cls,
+                                  enum MHD_RequestTerminationCode toe)
+{
+  // the next connection might get the same address, it must not find anything of this one
+  vector<IHTTPRequestHandler *> handlers;
+  {
+    CSingleLock lock(m_suspendedSection);
+
+    SuspendedRequestMap::iterator it = m_suspendedRequests.find(connection);
+    if (it != m_suspendedRequests.end())
+    {
+      handlers.push_back(it->second);
+      m_suspendedRequests.erase(it);
+    }
+
+    it = m_resumedRequests.find(connection);
+    if (it != m_resumedRequests.end())
+    {
+      handlers.push_back(it->second);
+      m_resumedRequests.erase(it);
+    }
+  }
+
+  // deleting a handler stops whatever was going to resume it, not under the lock as that
+  // might be resuming right now
+  for (vector<IHTTPRequestHandler *>::iterator it = handlers.begin(); it != handlers.end(); ++it)
+    delete *it;
+
+  CSingleLock lock(m_suspendedSection);
+  m_earlyResumes.erase(connection);
+}
+
+#ifndef WEBSERVER_HAS_SUSPEND
+bool CWebServer::QueueDeferredResponse(IHTTPRequestHandler *handler, const HTTPRequest &request)
+{
+  DeferredResponse *deferred = new DeferredResponse;
+  deferred->request = request;
+  deferred->ready = false;
+
+  struct MHD_Response *response = MHD_create_response_from_callback(MHD_SIZE_UNKNOWN, 4096,
+                                                                    &CWebServer::DeferredResponseCallback, deferred,
+                                                                    &CWebServer::DeferredResponseFreeCallback);
+  if (response == NULL)
+  {
+    delete deferred;
+    return false;
+  }
+
+  multimap<string, string> header = handler->GetHTTPResponseHeaderFields();
+  for (multimap<string, string>::const_iterator it = header.begin(); it != header.end(); it++)
+    MHD_add_response_header(response, it->first.c_str(), it->second.c_str());
+
+  int ret = MHD_queue_response(request.connection, handler->GetHTTPResonseCode(), response);
+  MHD_destroy_response(response);
+  return ret == MHD_YES;
+}
+
+#if (MHD_VERSION >= 0x00090200)
+ssize_t CWebServer::DeferredResponseCallback(void *cls, uint64_t pos, char *buf, size_t max)
+#else
+int CWebServer::DeferredResponseCallback(void *cls, uint64_t pos, char *buf, int max)
+#endif
+{
+  DeferredResponse *deferred = (DeferredResponse *)cls;
+  if (!deferred->ready)
+  {
+    // nothing to send yet, MHD asks again the next time it goes over its connections
+    IHTTPRequestHandler *handler = TakeResumedRequest(deferred->request.connection);
+    if (handler == NULL)
+      return 0;
+
+    if (handler->ResumeHTTPRequest(deferred->request) != MHD_NO && handler->GetHTTPResponseData())
+      deferred->body.assign((const char *)handler->GetHTTPResponseData(), handler->GetHTTPResonseDataLength());
+    delete handler;
+    deferred->ready = true;
+  }
+
+  if (pos >= deferred->body.size())
+    return -1;
+
+  size_t size = std::min((size_t)max, deferred->body.size() - (size_t)pos);
+  memcpy(buf, deferred->body.c_str() + pos, size);
+  return size;
+}
+
+void CWebServer::DeferredResponseFreeCallback(void *cls)
+{
+  delete (DeferredResponse *)cls;
+}
+#endif
+/* END PLEX */
+
 HTTPMethod CWebServer::GetMethod(const char *method)
 {
   if (strcmp(method, "GET") == 0)
@@ -572,6 +793,9 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
                           MHD_OPTION_CONNECTION_LIMIT, 512,
                           MHD_OPTION_CONNECTION_TIMEOUT, timeout,
                           MHD_OPTION_URI_LOG_CALLBACK, &CWebServer::UriRequestLogger, this,
+                          /* PLEX */
+                          MHD_OPTION_NOTIFY_COMPLETED, &CWebServer::RequestCompleted, this,
+                          /* END PLEX */
                           MHD_OPTION_END);
 }
 
@@ -580,7 +804,11 @@ bool CWebServer::Start(int port, const string &username, const string &password)
   SetCredentials(username, password);
   if (!m_running)
   {
+#ifndef WEBSERVER_HAS_SUSPEND
     m_daemon = StartMHD(MHD_USE_SELECT_INTERNALLY, port);
+#else
+    m_daemon = StartMHD(MHD_USE_SELECT_INTERNALLY | MHD_USE_SUSPEND_RESUME, port);
+#endif
 
     m_running = m_daemon != NULL;
     if (m_running)
@@ -595,7 +823,19 @@ bool CWebServer::Stop()
 {
   if (m_running)
   {
+    /* PLEX */
+    ResumeAllRequests();
+    /* END PLEX */
     MHD_stop_daemon(m_daemon);
+    /* PLEX */
+    {
+      // resumed requests MHD didn't get around to answering before shutting down
+      CSingleLock lock(m_suspendedSection);
+      for (SuspendedRequestMap::iterator it = m_resumedRequests.begin(); it != m_resumedRequests.end(); ++it)
+        delete it->second;
+      m_resumedRequests.clear();
+    }
+    /* END PLEX */
     m_running = false;
     CLog::Log(LOGNOTICE, "WebServer: Stopped the webserver");
   } else 
@@ -29,10 +29,23 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <vector>
+/* PLEX */
+#include <map>
+#include <set>
+/* END PLEX */
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
 #include "httprequesthandler/IHTTPRequestHandler.h"
 
+/* PLEX */
+/* parking a request without holding a worker thread, with MHD_USE_SUSPEND_RESUME where MHD has
+ * it. Older versions, like the one in lib/libmicrohttpd, get a chunked response whose body MHD
+ * keeps asking for until the request is resumed */
+#if (MHD_VERSION >= 0x00095100)
+#define WEBSERVER_HAS_SUSPEND
+#endif
+/* END PLEX */
+
 class CWebServer : public JSONRPC::ITransportLayer
 {
 public:
@@ -54,6 +67,16 @@ public:
   static std::string GetRequestHeaderValue(struct MHD_Connection *connection, enum MHD_ValueKind kind, const std::string &key);
   static int GetRequestHeaderValues(struct MHD_Connection *connection, enum MHD_ValueKind kind, std::map<std::string, std::string> &headerValues);
   static int GetRequestHeaderValues(struct MHD_Connection *connection, enum MHD_ValueKind kind, std::multimap<std::string, std::string> &headerValues);
+
+  /* PLEX */
+  /*! \brief Whether handlers may answer this request with HTTPSuspended */
+  static bool CanSuspendRequest(const HTTPRequest &request);
+
+  /*! \brief Continue a request whose handler answered with HTTPSuspended.
+   Can be called from any thread, also while the request is still being suspended.
+   */
+  static void ResumeRequest(struct MHD_Connection *connection);
+  /* END PLEX */
 private:
   struct MHD_Daemon* StartMHD(unsigned int flags, int port);
   static int AskForAuthentication (struct MHD_Connection *connection);
@@ -89,6 +112,23 @@ private:
                              unsigned int size);
 #endif
   static int HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &request);
+  /* PLEX */
+  static int SendResponse(IHTTPRequestHandler *handler, const HTTPRequest &request);
+  static int SuspendRequest(IHTTPRequestHandler *handler, const HTTPRequest &request);
+  static IHTTPRequestHandler *TakeResumedRequest(struct MHD_Connection *connection);
+  static void ResumeAllRequests();
+  static void RequestCompleted(void *cls, struct MHD_Connection *connection, void **con_cls,
+                               enum MHD_RequestTerminationCode toe);
+#ifndef WEBSERVER_HAS_SUSPEND
+  static bool QueueDeferredResponse(IHTTPRequestHandler *handler, const HTTPRequest &request);
+#if (MHD_VERSION >= 0x00090200)
+  static ssize_t DeferredResponseCallback(void *cls, uint64_t pos, char *buf, size_t max);
+#else
+  static int DeferredResponseCallback(void *cls, uint64_t pos, char *buf, int max);
+#endif
+  static void DeferredResponseFreeCallback(void *cls);
+#endif
+  /* END PLEX */
   static void ContentReaderFreeCallback (void *cls);
   static int CreateRedirect(struct MHD_Connection *connection, const std::string &strURL, struct MHD_Response *&response);
   static int CreateFileDownloadResponse(struct MHD_Connection *connection, const std::string &strURL, HTTPMethod methodType, struct MHD_Response *&response, int &responseCode);
@@ -109,6 +149,22 @@ private:
   CCriticalSection m_critSection;
   static std::vector<IHTTPRequestHandler *> m_requestHandlers;
 
+  /* PLEX */
+  typedef std::map<struct MHD_Connection *, IHTTPRequestHandler *> SuspendedRequestMap;
+  static CCriticalSection m_suspendedSection;
+  static SuspendedRequestMap m_suspendedRequests;
+  static SuspendedRequestMap m_resumedRequests;
+  static std::set<struct MHD_Connection *> m_earlyResumes;
+
+  /* the body of a suspended request, once its handler was resumed */
+  typedef struct DeferredResponse
+  {
+    HTTPRequest request;
+    std::string body;
+    bool ready;
+  } DeferredResponse;
+  /* END PLEX */
+
   typedef struct ConnectionHandler
   {
     IHTTPRequestHandler *requestHandler;
@@ -53,7 +53,10 @@ enum HTTPResponseType
   HTTPMemoryDownloadNoFreeNoCopy,
   HTTPMemoryDownloadNoFreeCopy,
   HTTPMemoryDownloadFreeNoCopy,
-  HTTPMemoryDownloadFreeCopy
+  HTTPMemoryDownloadFreeCopy,
+  /* PLEX */
+  HTTPSuspended /* the response follows later, see CWebServer::ResumeRequest */
+  /* END PLEX */
 };
 
 typedef struct HTTPRequest
@@ -73,6 +76,10 @@ public:
   virtual IHTTPRequestHandler* GetInstance() = 0;
   virtual bool CheckHTTPRequest(const HTTPRequest &request) = 0;
   virtual int HandleHTTPRequest(const HTTPRequest &request) = 0;
+  /* PLEX */
+  // called once a request answered with HTTPSuspended was resumed, to get its response ready
+  virtual int ResumeHTTPRequest(const HTTPRequest &request) { return MHD_YES; }
+  /* END PLEX */
   
   virtual void* GetHTTPResponseData() const { return NULL; };
   virtual size_t GetHTTPResonseDataLength() const { return 0; }
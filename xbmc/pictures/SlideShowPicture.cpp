@@ -21,6 +21,9 @@
 #include "SlideShowPicture.h"
 #include "system.h"
 #include "guilib/Texture.h"
+/* PLEX */
+#include "guilib/GUITexture.h"
+/* END PLEX */
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/GUISettings.h"
@@ -775,6 +778,9 @@ void CSlideShowPic::Render(float *x, float *y, CBaseTexture* pTexture, color_t c
     g_Windowing.Get3DDevice()->DrawPrimitiveUP( D3DPT_LINESTRIP, 4, vertex, sizeof(VERTEX) );
 
 #elif defined(HAS_GL)
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
   g_graphicsContext.BeginPaint();
   if (pTexture)
   {
@@ -32,6 +32,9 @@
 #include "utils/TimeUtils.h"
 #include "utils/SystemInfo.h"
 #include "utils/MathUtils.h"
+/* PLEX */
+#include "guilib/GUITexture.h"
+/* END PLEX */
 
 CRenderSystemGL::CRenderSystemGL() : CRenderSystemBase()
 {
@@ -239,6 +242,10 @@ bool CRenderSystemGL::ResetRenderSystem(int width, int height, bool fullScreen,
 
 bool CRenderSystemGL::DestroyRenderSystem()
 {
+  /* PLEX */
+  CGUITextureGL::DestroyBatch();
+  /* END PLEX */
+
   m_bRenderCreated = false;
 
   return true;
@@ -257,6 +264,10 @@ bool CRenderSystemGL::EndRender()
   if (!m_bRenderCreated)
     return false;
 
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+
   return true;
 }
 
@@ -265,6 +276,10 @@ bool CRenderSystemGL::ClearBuffers(color_t color)
   if (!m_bRenderCreated)
     return false;
 
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+
   float r = GET_R(color) / 255.0f;
   float g = GET_G(color) / 255.0f;
   float b = GET_B(color) / 255.0f;
@@ -293,6 +308,10 @@ bool CRenderSystemGL::PresentRender(const CDirtyRegionList& dirty)
   if (!m_bRenderCreated)
     return false;
 
+  /* PLEX */
+  CGUITextureGL::EndFrame();
+  /* END PLEX */
+
   if (m_iVSyncMode != 0 && m_iSwapRate != 0)
   {
     int64_t curr, diff, freq;
@@ -389,6 +408,10 @@ void CRenderSystemGL::CaptureStateBlock()
   if (!m_bRenderCreated)
     return;
 
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+
   glMatrixProject.Push();
   glMatrixModview.Push();
   glMatrixTexture.Push();
@@ -406,6 +429,10 @@ void CRenderSystemGL::ApplyStateBlock()
   if (!m_bRenderCreated)
     return;
 
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+
   glViewport(m_viewPort[0], m_viewPort[1], m_viewPort[2], m_viewPort[3]);
 
   glMatrixProject.PopLoad();
@@ -425,6 +452,10 @@ void CRenderSystemGL::SetCameraPosition(const CPoint &camera, int screenWidth, i
   if (!m_bRenderCreated)
     return;
 
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+
   g_graphicsContext.BeginPaint();
 
   CPoint offset = camera - CPoint(screenWidth*0.5f, screenHeight*0.5f);
@@ -479,6 +510,10 @@ void CRenderSystemGL::ApplyHardwareTransform(const TransformMatrix &finalMatrix)
   if (!m_bRenderCreated)
     return;
 
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+
   glMatrixModview.Push();
   GLfloat matrix[4][4];
 
@@ -500,6 +535,10 @@ void CRenderSystemGL::RestoreHardwareTransform()
   if (!m_bRenderCreated)
     return;
 
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+
   glMatrixModview.PopLoad();
 }
 
@@ -565,6 +604,10 @@ void CRenderSystemGL::SetViewPort(CRect& viewPort)
   if (!m_bRenderCreated)
     return;
 
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+
   glScissor((GLint) viewPort.x1, (GLint) (m_height - viewPort.y1 - viewPort.Height()), (GLsizei) viewPort.Width(), (GLsizei) viewPort.Height());
   glViewport((GLint) viewPort.x1, (GLint) (m_height - viewPort.y1 - viewPort.Height()), (GLsizei) viewPort.Width(), (GLsizei) viewPort.Height());
   m_viewPort[0] = viewPort.x1;
@@ -577,6 +620,10 @@ void CRenderSystemGL::SetScissors(const CRect &rect)
 {
   if (!m_bRenderCreated)
     return;
+  /* PLEX */
+  CGUITextureGL::FlushBatch();
+  /* END PLEX */
+
   GLint x1 = MathUtils::round_int(rect.x1);
   GLint y1 = MathUtils::round_int(rect.y1);
   GLint x2 = MathUtils::round_int(rect.x2);
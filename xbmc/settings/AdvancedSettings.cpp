@@ -187,6 +187,9 @@ void CAdvancedSettings::Initialize()
   m_fanartRes = 1080;
   m_imageRes = 720;
   m_useDDSFanart = false;
+  /* PLEX */
+  m_ddsMinUseCount = 3;
+  /* END PLEX */
 
   m_sambaclienttimeout = 10;
   m_sambadoscodepage = "";
@@ -304,6 +307,10 @@ void CAdvancedSettings::Initialize()
   m_measureRefreshrate = false;
 
   m_cacheMemBufferSize = 1024 * 1024 * 20;
+  /* PLEX */
+  m_cacheDiskBufferSize = 0;
+  m_cacheParallelConnections = 4;
+  /* END PLEX */
   m_alwaysForceBuffer = false;
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
@@ -319,6 +326,17 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiDirtyRegionNoFlipTimeout = 0;
+  /* PLEX */
+  m_guiTextureUploadSize = 4 * 1024 * 1024;
+  m_guiTextureUploadTime = 4;
+#ifdef TARGET_RASPBERRY_PI
+  m_guiTextureMemoryBudget = 64;
+  m_guiLowMemoryThreshold = 48;
+#else
+  m_guiTextureMemoryBudget = 0;
+  m_guiLowMemoryThreshold = 0;
+#endif
+  /* END PLEX */
   m_logEnableAirtunes = false;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
@@ -374,6 +392,14 @@ void CAdvancedSettings::Initialize()
   m_bForceJpegImageFormat = false;
   m_bUseMatroskaTranscodes = true;
   m_bRequireEncryptedConnection = false;
+
+  /* readers don't block the writer and the other way round with WAL. mmap stays off by default,
+   * it keeps the file from being truncated on windows and costs address space on the small boxes */
+  m_sqliteJournalMode = "WAL";
+  m_sqliteSynchronous = "NORMAL";
+  m_sqliteCacheSize = 4096;
+  m_sqliteMmapSize = 0;
+  m_sqliteStatementCache = 32;
   /* END PLEX */
 }
 
@@ -750,6 +776,10 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
+    /* PLEX */
+    XMLUtils::GetUInt(pElement, "cachediskbuffersize", m_cacheDiskBufferSize);
+    XMLUtils::GetUInt(pElement, "cacheparallelconnections", m_cacheParallelConnections, 0, 8);
+    /* END PLEX */
     XMLUtils::GetUInt(pElement, "buffermode", m_networkBufferMode, 0, 3);
     XMLUtils::GetBoolean(pElement, "alwaysforcebuffer", m_alwaysForceBuffer);
     XMLUtils::GetFloat(pElement, "readbufferfactor", m_readBufferFactor);
@@ -999,6 +1029,9 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetUInt(pRootElement, "imageres", m_imageRes, 0, 1080);
 #if !defined(TARGET_RASPBERRY_PI)
   XMLUtils::GetBoolean(pRootElement, "useddsfanart", m_useDDSFanart);
+  /* PLEX */
+  XMLUtils::GetUInt(pRootElement, "ddsminusecount", m_ddsMinUseCount, 1, 1000);
+  /* END PLEX */
 #endif
   XMLUtils::GetBoolean(pRootElement, "playlistasfolders", m_playlistAsFolders);
   XMLUtils::GetBoolean(pRootElement, "detectasudf", m_detectAsUdf);
@@ -1124,6 +1157,12 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    /* PLEX */
+    XMLUtils::GetUInt(pElement, "textureuploadsize",         m_guiTextureUploadSize, 64 * 1024, 256 * 1024 * 1024);
+    XMLUtils::GetUInt(pElement, "textureuploadtime",         m_guiTextureUploadTime, 1, 1000);
+    XMLUtils::GetUInt(pElement, "texturememorybudget",       m_guiTextureMemoryBudget, 0, 4096);
+    XMLUtils::GetUInt(pElement, "lowmemorythreshold",        m_guiLowMemoryThreshold, 0, 4096);
+    /* END PLEX */
     
     /* PLEX */
     // If these are set manually in advancedsettings.xml, hide them from the UI since they won't be persisted.
@@ -1196,6 +1235,16 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetBoolean(pRootElement, "forcejpegimageformat", m_bForceJpegImageFormat);
   XMLUtils::GetBoolean(pRootElement, "usematroskatranscode", m_bUseMatroskaTranscodes);
   XMLUtils::GetBoolean(pRootElement, "requireencryptedconnection", m_bRequireEncryptedConnection);
+
+  pElement = pRootElement->FirstChildElement("sqlite");
+  if (pElement)
+  {
+    XMLUtils::GetString(pElement, "journalmode", m_sqliteJournalMode);
+    XMLUtils::GetString(pElement, "synchronous", m_sqliteSynchronous);
+    XMLUtils::GetUInt(pElement, "cachesize", m_sqliteCacheSize);
+    XMLUtils::GetUInt(pElement, "mmapsize", m_sqliteMmapSize);
+    XMLUtils::GetUInt(pElement, "statementcache", m_sqliteStatementCache, 1, 1000);
+  }
   /* END PLEX */
 
   // load in the GUISettings overrides:
@@ -222,6 +222,9 @@ class CAdvancedSettings
      */
     unsigned int GetThumbSize() const { return m_imageRes / 2; };
     bool m_useDDSFanart;
+    /* PLEX */
+    unsigned int m_ddsMinUseCount; ///< \brief times an image is shown before a .dds version of it is made
+    /* END PLEX */
 
     int m_sambaclienttimeout;
     CStdString m_sambadoscodepage;
@@ -352,9 +355,19 @@ class CAdvancedSettings
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    /* PLEX */
+    unsigned int m_guiTextureUploadSize; // bytes of large textures loaded to the gpu per frame
+    unsigned int m_guiTextureUploadTime; // ms per frame spent on it
+    unsigned int m_guiTextureMemoryBudget; // MB of skin, font and art textures, 0 for no limit
+    unsigned int m_guiLowMemoryThreshold; // MB of free memory below which unused textures are dropped
+    /* END PLEX */
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
+    /* PLEX */
+    unsigned int m_cacheDiskBufferSize;
+    unsigned int m_cacheParallelConnections;
+    /* END PLEX */
     unsigned int m_networkBufferMode;
     bool m_alwaysForceBuffer;
     float m_readBufferFactor;
@@ -403,6 +416,13 @@ class CAdvancedSettings
     void SetDirtyRegionsAlgorithm(int algorithm);
     void SetDirtyRegionsNoFlipTimeout(int timeout);
     bool m_bUseMatroskaTranscodes;
+
+    /* tuning of the sqlite databases, <sqlite> */
+    CStdString m_sqliteJournalMode;
+    CStdString m_sqliteSynchronous;
+    unsigned int m_sqliteCacheSize; // pages
+    unsigned int m_sqliteMmapSize; // bytes, 0 disables it
+    unsigned int m_sqliteStatementCache; // prepared statements kept per connection
     /* END PLEX */
 };
 
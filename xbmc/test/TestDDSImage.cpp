@@ -0,0 +1,138 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/DDSImage.h"
+#include "guilib/JpegIO.h"
+#include "guilib/XBTF.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/SystemClock.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <climits>
+#include <iostream>
+#include <vector>
+
+/* fanart and backgrounds of different sizes, what the home screen shows */
+static const char *corpus[] = {
+  "addons/skin.confluence/backgrounds/SKINDEFAULT.jpg",
+  "addons/skin.confluence/backgrounds/settings.jpg",
+  "addons/skin.confluence/backgrounds/tv.jpg",
+  "addons/skin.plex/Media/bg-beginner.jpg",
+  "addons/skin.plex/Media/preplay-movie-fanart-dummy.jpg",
+  "addons/weather.wunderground/fanart.jpg"
+};
+
+class TestDDSImage : public testing::Test
+{
+protected:
+  TestDDSImage()
+  {
+    ddsPath = CSpecialProtocol::TranslatePath("special://temp/TestDDSImage.dds");
+    tmpPath = ddsPath + ".tmp";
+  }
+
+  ~TestDDSImage()
+  {
+    XFILE::CFile::Delete(ddsPath);
+    XFILE::CFile::Delete(tmpPath);
+  }
+
+  bool decode(const char *path, CJpegIO &jpeg, std::vector<unsigned char> &pixels)
+  {
+    if (!jpeg.Open(XBMC_REF_FILE_PATH(path), UINT_MAX, UINT_MAX))
+      return false;
+    pixels.resize(jpeg.Width() * jpeg.Height() * 4);
+    return jpeg.Decode(&pixels[0], jpeg.Width() * 4, XB_FMT_A8R8G8B8);
+  }
+
+  CStdString ddsPath;
+  CStdString tmpPath;
+};
+
+TEST_F(TestDDSImage, CreateCompressed)
+{
+  CJpegIO jpeg;
+  std::vector<unsigned char> pixels;
+  ASSERT_TRUE(decode(corpus[0], jpeg, pixels));
+
+  CDDSImage dds;
+  ASSERT_TRUE(dds.CreateCompressed(ddsPath, jpeg.Width(), jpeg.Height(), jpeg.Width() * 4, &pixels[0], 40));
+
+  CDDSImage read;
+  ASSERT_TRUE(read.ReadFile(ddsPath));
+  EXPECT_EQ(jpeg.Width(), read.GetWidth());
+  EXPECT_EQ(jpeg.Height(), read.GetHeight());
+  EXPECT_EQ((unsigned int)XB_FMT_DXT1, read.GetFormat());
+
+  // noise doesn't compress within any sensible error, and nothing is written for it
+  std::vector<unsigned char> noise(64 * 64 * 4);
+  for (unsigned int i = 0; i < noise.size(); i++)
+    noise[i] = (unsigned char)(i * 7919 >> 3);
+  CDDSImage bad;
+  EXPECT_FALSE(bad.CreateCompressed(tmpPath, 64, 64, 64 * 4, &noise[0], 40));
+  EXPECT_FALSE(XFILE::CFile::Exists(tmpPath));
+}
+
+/* loading the cached original, decoded at full size, against loading the .dds made of it.
+ * Texture memory is what either takes on a gpu with DXT support */
+TEST_F(TestDDSImage, Performance)
+{
+  const unsigned int rounds = 5;
+  unsigned int jpegTime = 0, ddsTime = 0, jpegBytes = 0, ddsBytes = 0;
+
+  for (unsigned int i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+  {
+    CJpegIO jpeg;
+    std::vector<unsigned char> pixels;
+    ASSERT_TRUE(decode(corpus[i], jpeg, pixels)) << corpus[i];
+    jpegBytes += pixels.size();
+
+    CDDSImage dds;
+    ASSERT_TRUE(dds.CreateCompressed(ddsPath, jpeg.Width(), jpeg.Height(), jpeg.Width() * 4, &pixels[0], 40)) << corpus[i];
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    for (unsigned int round = 0; round < rounds; round++)
+    {
+      CJpegIO again;
+      ASSERT_TRUE(decode(corpus[i], again, pixels));
+    }
+    jpegTime += XbmcThreads::SystemClockMillis() - start;
+
+    start = XbmcThreads::SystemClockMillis();
+    for (unsigned int round = 0; round < rounds; round++)
+    {
+      CDDSImage read;
+      ASSERT_TRUE(read.ReadFile(ddsPath));
+      if (round == 0)
+        ddsBytes += read.GetSize();
+    }
+    ddsTime += XbmcThreads::SystemClockMillis() - start;
+  }
+
+  unsigned int images = rounds * sizeof(corpus) / sizeof(corpus[0]);
+  std::cout << "JPEG: " << (float)jpegTime / images << " ms/image, "
+            << jpegBytes / 1024 << "k of textures" << std::endl;
+  std::cout << "DDS:  " << (float)ddsTime / images << " ms/image, "
+            << ddsBytes / 1024 << "k of textures" << std::endl;
+  EXPECT_LT(ddsBytes, jpegBytes);
+}
@@ -0,0 +1,160 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/JpegIO.h"
+#include "guilib/XBTF.h"
+#include "filesystem/File.h"
+#include "pictures/Picture.h"
+#include "threads/SystemClock.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <climits>
+#include <iostream>
+#include <vector>
+
+/* fanart and backgrounds of different sizes */
+static const char *corpus[] = {
+  "addons/skin.confluence/backgrounds/SKINDEFAULT.jpg",
+  "addons/skin.confluence/backgrounds/settings.jpg",
+  "addons/skin.confluence/backgrounds/tv.jpg",
+  "addons/skin.confluence/media/Fanart_Fallback_Small.jpg",
+  "addons/skin.plex/Media/bg-beginner.jpg",
+  "addons/skin.plex/Media/preplay-movie-fanart-dummy.jpg",
+  "addons/weather.wunderground/fanart.jpg"
+};
+
+static bool readFile(const char *path, std::vector<unsigned char> &buffer)
+{
+  XFILE::CFile file;
+  if (!file.Open(XBMC_REF_FILE_PATH(path)))
+    return false;
+  buffer.resize((size_t)file.GetLength());
+  bool ok = !buffer.empty() && file.Read(&buffer[0], buffer.size()) == buffer.size();
+  file.Close();
+  return ok;
+}
+
+static unsigned int scaled(unsigned int size, unsigned int scale)
+{
+  return (size * scale + 7) / 8;
+}
+
+TEST(TestJpegIO, SmallestScaleCoveringTarget)
+{
+  for (unsigned int i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+  {
+    std::vector<unsigned char> buffer;
+    ASSERT_TRUE(readFile(corpus[i], buffer)) << corpus[i];
+
+    CJpegIO full;
+    ASSERT_TRUE(full.Read(&buffer[0], buffer.size(), UINT_MAX, UINT_MAX));
+    unsigned int width = full.Width(), height = full.Height();
+
+    unsigned int expected = 8;
+    for (unsigned int scale = 1; scale <= 8; scale *= 2)
+    {
+      if (scaled(width, scale) >= 300 && scaled(height, scale) >= 450)
+      {
+        expected = scale;
+        break;
+      }
+    }
+
+    CJpegIO poster;
+    ASSERT_TRUE(poster.Read(&buffer[0], buffer.size(), 300, 450));
+    EXPECT_EQ(scaled(width, expected), poster.Width()) << corpus[i];
+    EXPECT_EQ(scaled(height, expected), poster.Height()) << corpus[i];
+  }
+}
+
+TEST(TestJpegIO, DecodeToTextureFormat)
+{
+  std::vector<unsigned char> buffer;
+  ASSERT_TRUE(readFile(corpus[0], buffer));
+
+  CJpegIO rgb;
+  ASSERT_TRUE(rgb.Read(&buffer[0], buffer.size(), 300, 450));
+  std::vector<unsigned char> rgbPixels(rgb.Width() * rgb.Height() * 3);
+  ASSERT_TRUE(rgb.Decode(&rgbPixels[0], rgb.Width() * 3, XB_FMT_RGB8));
+
+  CJpegIO bgra;
+  ASSERT_TRUE(bgra.Read(&buffer[0], buffer.size(), 300, 450));
+  ASSERT_EQ(rgb.Width(), bgra.Width());
+  ASSERT_EQ(rgb.Height(), bgra.Height());
+  std::vector<unsigned char> bgraPixels(bgra.Width() * bgra.Height() * 4);
+  ASSERT_TRUE(bgra.Decode(&bgraPixels[0], bgra.Width() * 4, XB_FMT_A8R8G8B8));
+
+  for (unsigned int i = 0; i < rgb.Width() * rgb.Height(); i++)
+  {
+    ASSERT_EQ(rgbPixels[i * 3 + 2], bgraPixels[i * 4 + 0]);
+    ASSERT_EQ(rgbPixels[i * 3 + 1], bgraPixels[i * 4 + 1]);
+    ASSERT_EQ(rgbPixels[i * 3 + 0], bgraPixels[i * 4 + 2]);
+    ASSERT_EQ(0xff, bgraPixels[i * 4 + 3]);
+  }
+}
+
+/* a 320x180 thumbnail of each image, decoding all of it and scaling it down against decoding at
+ * the smallest scale that covers it and scaling what is left */
+TEST(TestJpegIO, Performance)
+{
+  const unsigned int rounds = 5;
+  unsigned int fullTime = 0, scaledTime = 0, fullPixels = 0, scaledPixels = 0;
+
+  for (unsigned int i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++)
+  {
+    std::vector<unsigned char> buffer;
+    ASSERT_TRUE(readFile(corpus[i], buffer)) << corpus[i];
+
+    for (unsigned int target = 0; target < 2; target++)
+    {
+      unsigned int start = XbmcThreads::SystemClockMillis();
+      for (unsigned int round = 0; round < rounds; round++)
+      {
+        CJpegIO jpeg;
+        if (target)
+          ASSERT_TRUE(jpeg.Read(&buffer[0], buffer.size(), 320, 180));
+        else
+          ASSERT_TRUE(jpeg.Read(&buffer[0], buffer.size(), UINT_MAX, UINT_MAX));
+
+        std::vector<unsigned char> pixels(jpeg.Width() * jpeg.Height() * 4);
+        ASSERT_TRUE(jpeg.Decode(&pixels[0], jpeg.Width() * 4, XB_FMT_A8R8G8B8));
+
+        unsigned int width = 320, height = 180;
+        CPicture::GetScale(jpeg.Width(), jpeg.Height(), width, height);
+        std::vector<unsigned char> thumb(width * height * 4);
+        ASSERT_TRUE(CPicture::ScaleImage(&pixels[0], jpeg.Width(), jpeg.Height(), jpeg.Width() * 4,
+                                         &thumb[0], width, height, width * 4));
+
+        if (round == 0)
+          (target ? scaledPixels : fullPixels) += jpeg.Width() * jpeg.Height();
+      }
+      (target ? scaledTime : fullTime) += XbmcThreads::SystemClockMillis() - start;
+    }
+  }
+
+  unsigned int images = rounds * sizeof(corpus) / sizeof(corpus[0]);
+  std::cout << "Full decode:   " << (float)fullTime / images << " ms/image, "
+            << fullPixels / 1000 << "k pixels decoded" << std::endl;
+  std::cout << "Scaled decode: " << (float)scaledTime / images << " ms/image, "
+            << scaledPixels / 1000 << "k pixels decoded" << std::endl;
+  EXPECT_LT(scaledPixels, fullPixels);
+}
@@ -22,11 +22,16 @@
 #include "Util.h"
 #include <fribidi/fribidi.h>
 #include "LangInfo.h"
+#include "threads/Atomics.h"
 #include "threads/SingleLock.h"
 #include "log.h"
 
 #include <errno.h>
 #include <iconv.h>
+#include <stdint.h>
+#if !defined(WIN32)
+#include <pthread.h>
+#endif
 
 #if defined(TARGET_DARWIN)
 #ifdef __POWERPC__
@@ -53,19 +58,6 @@
 #endif
 
 
-static iconv_t m_iconvStringCharsetToFontCharset = (iconv_t)-1;
-static iconv_t m_iconvSubtitleCharsetToW         = (iconv_t)-1;
-static iconv_t m_iconvUtf8ToStringCharset        = (iconv_t)-1;
-static iconv_t m_iconvStringCharsetToUtf8        = (iconv_t)-1;
-static iconv_t m_iconvUcs2CharsetToStringCharset = (iconv_t)-1;
-static iconv_t m_iconvUtf32ToStringCharset       = (iconv_t)-1;
-static iconv_t m_iconvWtoUtf8                    = (iconv_t)-1;
-static iconv_t m_iconvUtf16LEtoW                 = (iconv_t)-1;
-static iconv_t m_iconvUtf16BEtoUtf8              = (iconv_t)-1;
-static iconv_t m_iconvUtf16LEtoUtf8              = (iconv_t)-1;
-static iconv_t m_iconvUtf8toW                    = (iconv_t)-1;
-static iconv_t m_iconvUcs2CharsetToUtf8          = (iconv_t)-1;
-
 #if defined(FRIBIDI_CHAR_SET_NOT_FOUND)
 static FriBidiCharSet m_stringFribidiCharset     = FRIBIDI_CHAR_SET_NOT_FOUND;
 #define FRIBIDI_UTF8 FRIBIDI_CHAR_SET_UTF8
@@ -76,7 +68,8 @@ static FriBidiCharSet m_stringFribidiCharset     = FRIBIDI_CHARSET_NOT_FOUND;
 #define FRIBIDI_NOTFOUND FRIBIDI_CHARSET_NOT_FOUND
 #endif
 
-static CCriticalSection            m_critSection;
+// libfribidi is not threadsafe, the iconv handles are per thread and need no lock
+static CCriticalSection            m_fribidiSection;
 
 static struct SFribidMapping
 {
@@ -140,6 +133,88 @@ static struct SCharsetMapping
 #define ICONV_PREPARE(iconv) iconv=(iconv_t)-1
 #define ICONV_SAFE_CLOSE(iconv) if (iconv!=(iconv_t)-1) { iconv_close(iconv); iconv=(iconv_t)-1; }
 
+// the conversions that keep their iconv handle open between calls
+enum
+{
+  ICONV_UTF8_TO_W,
+  ICONV_W_TO_UTF8,
+  ICONV_SUBTITLE_TO_W,
+  ICONV_UTF8_TO_STRING,
+  ICONV_STRING_TO_UTF8,
+  ICONV_UCS2_TO_STRING,
+  ICONV_UTF32_TO_STRING,
+  ICONV_UTF16LE_TO_W,
+  ICONV_UTF16BE_TO_UTF8,
+  ICONV_UTF16LE_TO_UTF8,
+  ICONV_UCS2_TO_UTF8,
+  ICONV_COUNT
+};
+
+// An iconv handle carries state between calls and can't be used by two threads at once, so every
+// thread opens its own. They are closed when the thread ends, and when reset() changed the
+// charsets the next conversion on each thread reopens them.
+struct SIconvState
+{
+  iconv_t handles[ICONV_COUNT];
+  long    generation;
+};
+
+static volatile long g_iconvGeneration = 0;
+
+static void closeIconvState(SIconvState* state)
+{
+  for (int i = 0; i < ICONV_COUNT; i++)
+    ICONV_SAFE_CLOSE(state->handles[i]);
+}
+
+static void freeIconvState(void* state)
+{
+  closeIconvState((SIconvState*)state);
+  delete (SIconvState*)state;
+}
+
+// XbmcThreads::ThreadLocal can't free what it holds when a thread ends
+class CIconvStateTls
+{
+public:
+#if defined(WIN32)
+  CIconvStateTls() { m_key = FlsAlloc(freeFls); }
+  SIconvState* get() { return (SIconvState*)FlsGetValue(m_key); }
+  void set(SIconvState* state) { FlsSetValue(m_key, state); }
+private:
+  static VOID WINAPI freeFls(PVOID state) { if (state) freeIconvState(state); }
+  DWORD m_key;
+#else
+  CIconvStateTls() { pthread_key_create(&m_key, freeIconvState); }
+  SIconvState* get() { return (SIconvState*)pthread_getspecific(m_key); }
+  void set(SIconvState* state) { pthread_setspecific(m_key, state); }
+private:
+  pthread_key_t m_key;
+#endif
+};
+
+static CIconvStateTls g_iconvState;
+
+static iconv_t& threadIconv(int conversion)
+{
+  SIconvState* state = g_iconvState.get();
+  if (!state)
+  {
+    state = new SIconvState;
+    for (int i = 0; i < ICONV_COUNT; i++)
+      ICONV_PREPARE(state->handles[i]);
+    state->generation = g_iconvGeneration;
+    g_iconvState.set(state);
+  }
+  else if (state->generation != g_iconvGeneration)
+  {
+    closeIconvState(state);
+    state->generation = g_iconvGeneration;
+  }
+
+  return state->handles[conversion];
+}
+
 size_t iconv_const (void* cd, const char** inbuf, size_t *inbytesleft,
                     char* * outbuf, size_t *outbytesleft)
 {
@@ -273,10 +348,182 @@ static void convert(iconv_t& type, int multiplier, const CStdString& strFromChar
 
 using namespace std;
 
+// UTF-8 to and from wchar_t without iconv, for the strings the GUI converts all the time. iconv stays
+// in charge of what these don't handle: invalid UTF-8, where it drops the bad bytes, UTF-8-MAC on
+// darwin, which composes decomposed characters, and the UTF-16 wchar_t of windows. Like iconv's
+// output they end at the first NUL.
+#define ASCII_HIGH_BITS 0x8080808080808080ULL
+#define ASCII_LOW_BITS  0x0101010101010101ULL
+
+#if defined(TARGET_DARWIN)
+static const bool g_decodeUtf8 = false;
+#else
+static const bool g_decodeUtf8 = sizeof(wchar_t) == 4;
+#endif
+
+// how many bytes at s are ASCII and not NUL, eight at a time while there are eight left
+static size_t asciiRun(const unsigned char* s, size_t len)
+{
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t))
+  {
+    uint64_t word;
+    memcpy(&word, s + i, sizeof(word));
+    // a high bit that is set or comes from a byte that is zero
+    if ((word | ((word - ASCII_LOW_BITS) & ~word)) & ASCII_HIGH_BITS)
+      break;
+  }
+
+  while (i < len && s[i] && s[i] < 0x80)
+    i++;
+  return i;
+}
+
+static bool utf8ToWFast(const CStdStringA& strSource, CStdStringW& strDest)
+{
+  const unsigned char* s = (const unsigned char*)strSource.c_str();
+  size_t len = strSource.length();
+  if (!len)
+  {
+    strDest.clear();
+    return true;
+  }
+
+  wchar_t* out = strDest.GetBuffer(len);
+  size_t i = 0, n = 0;
+
+  while (i < len)
+  {
+    for (size_t end = i + asciiRun(s + i, len - i); i < end; i++)
+      out[n++] = s[i];
+
+    if (i == len || !s[i])
+      break;
+
+    unsigned char c = s[i];
+    uint32_t code;
+    size_t trailing;
+    if (!g_decodeUtf8)
+      break;
+    else if (c >= 0xc2 && c <= 0xdf)
+    {
+      code = c & 0x1f;
+      trailing = 1;
+    }
+    else if ((c & 0xf0) == 0xe0)
+    {
+      code = c & 0x0f;
+      trailing = 2;
+    }
+    else if (c >= 0xf0 && c <= 0xf4)
+    {
+      code = c & 0x07;
+      trailing = 3;
+    }
+    else
+      break;
+
+    if (i + trailing >= len)
+      break;
+
+    size_t k = 1;
+    for (; k <= trailing && (s[i + k] & 0xc0) == 0x80; k++)
+      code = (code << 6) | (s[i + k] & 0x3f);
+    if (k <= trailing)
+      break;
+
+    // overlong, surrogates and beyond unicode
+    if ((trailing == 2 && (code < 0x800 || (code >= 0xd800 && code <= 0xdfff))) ||
+        (trailing == 3 && (code < 0x10000 || code > 0x10ffff)))
+      break;
+
+    out[n++] = (wchar_t)code;
+    i += trailing + 1;
+  }
+
+  bool done = i == len || !s[i];
+  strDest.ReleaseBuffer(done ? n : 0);
+  return done;
+}
+
+static bool wToUTF8Fast(const CStdStringW& strSource, CStdStringA& strDest)
+{
+  size_t len = strSource.length();
+  if (!len)
+  {
+    strDest.clear();
+    return true;
+  }
+
+  const wchar_t* s = strSource.c_str();
+  char* out = strDest.GetBuffer(len * 4);
+  size_t i = 0, n = 0;
+
+  for (; i < len && s[i]; i++)
+  {
+    uint32_t code = (uint32_t)s[i];
+    if (code < 0x80)
+      out[n++] = (char)code;
+    else if (sizeof(wchar_t) < 4)
+      break;
+    else if (code < 0x800)
+    {
+      out[n++] = (char)(0xc0 | (code >> 6));
+      out[n++] = (char)(0x80 | (code & 0x3f));
+    }
+    else if (code < 0x10000)
+    {
+      if (code >= 0xd800 && code <= 0xdfff)
+        break;
+      out[n++] = (char)(0xe0 | (code >> 12));
+      out[n++] = (char)(0x80 | ((code >> 6) & 0x3f));
+      out[n++] = (char)(0x80 | (code & 0x3f));
+    }
+    else if (code <= 0x10ffff)
+    {
+      out[n++] = (char)(0xf0 | (code >> 18));
+      out[n++] = (char)(0x80 | ((code >> 12) & 0x3f));
+      out[n++] = (char)(0x80 | ((code >> 6) & 0x3f));
+      out[n++] = (char)(0x80 | (code & 0x3f));
+    }
+    else
+      break;
+  }
+
+  bool done = i == len || !s[i];
+  strDest.ReleaseBuffer(done ? n : 0);
+  return done;
+}
+
+// Whether fribidi could change the text. It leaves text without right-to-left characters, bidi
+// controls and line breaks as it is, which is most of what the GUI shows, and doesn't have to be
+// asked under its lock then.
+static bool needsVisualBiDi(const CStdStringW& text)
+{
+  for (size_t i = 0; i < text.length(); i++)
+  {
+    uint32_t c = (uint32_t)text[i];
+    if ((c >= 0x20 && c < 0x7f) || c == '\t' || c == '\r')
+      continue;
+    if (c >= 0xa0 && c < 0x590 && c != 0xad) // latin, greek, cyrillic, armenian
+      continue;
+    if (c >= 0x900 && c < 0x1800)            // indic, thai, georgian, ethiopic, ...
+      continue;
+    if (c >= 0x2010 && c < 0x2028)           // dashes, quotes, ellipsis
+      continue;
+    if (c >= 0x3000 && c < 0xa000)           // CJK
+      continue;
+    if (c >= 0xac00 && c < 0xd7a4)           // hangul
+      continue;
+    return true;
+  }
+  return false;
+}
+
 static void logicalToVisualBiDi(const CStdStringA& strSource, CStdStringA& strDest, FriBidiCharSet fribidiCharset, FriBidiCharType base = FRIBIDI_TYPE_LTR, bool* bWasFlipped =NULL)
 {
   // libfribidi is not threadsafe, so make sure we make it so
-  CSingleLock lock(m_critSection);
+  CSingleLock lock(m_fribidiSection);
 
   vector<CStdString> lines;
   CUtil::Tokenize(strSource, lines, "\n");
@@ -386,20 +633,10 @@ bool CCharsetConverter::isBidiCharset(const CStdString& charset)
 
 void CCharsetConverter::reset(void)
 {
-  CSingleLock lock(m_critSection);
-
-  ICONV_SAFE_CLOSE(m_iconvStringCharsetToFontCharset);
-  ICONV_SAFE_CLOSE(m_iconvUtf8ToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvStringCharsetToUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUcs2CharsetToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvSubtitleCharsetToW);
-  ICONV_SAFE_CLOSE(m_iconvWtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf16BEtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf16LEtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf32ToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvUtf8toW);
-  ICONV_SAFE_CLOSE(m_iconvUcs2CharsetToUtf8);
+  // every thread reopens its handles on its next conversion
+  AtomicIncrement(&g_iconvGeneration);
 
+  CSingleLock lock(m_fribidiSection);
 
   m_stringFribidiCharset = FRIBIDI_NOTFOUND;
 
@@ -415,27 +652,36 @@ void CCharsetConverter::reset(void)
 // of the string is already made or the string is not displayed in the GUI
 void CCharsetConverter::utf8ToW(const CStdStringA& utf8String, CStdStringW &wString, bool bVisualBiDiFlip/*=true*/, bool forceLTRReadingOrder /*=false*/, bool* bWasFlipped/*=NULL*/)
 {
+  if (utf8ToWFast(utf8String, wString))
+  {
+    if (!bVisualBiDiFlip)
+      return;
+
+    if (!needsVisualBiDi(wString))
+    {
+      if (bWasFlipped)
+        *bWasFlipped = false;
+      return;
+    }
+  }
+
   // Try to flip hebrew/arabic characters, if any
   if (bVisualBiDiFlip)
   {
     CStdStringA strFlipped;
     FriBidiCharType charset = forceLTRReadingOrder ? FRIBIDI_TYPE_LTR : FRIBIDI_TYPE_PDF;
     logicalToVisualBiDi(utf8String, strFlipped, FRIBIDI_UTF8, charset, bWasFlipped);
-    CSingleLock lock(m_critSection);
-    convert(m_iconvUtf8toW,sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,strFlipped,wString);
+    if (!utf8ToWFast(strFlipped, wString))
+      convert(threadIconv(ICONV_UTF8_TO_W),sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,strFlipped,wString);
   }
   else
-  {
-    CSingleLock lock(m_critSection);
-    convert(m_iconvUtf8toW,sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,utf8String,wString);
-  }
+    convert(threadIconv(ICONV_UTF8_TO_W),sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,utf8String,wString);
 }
 
 void CCharsetConverter::subtitleCharsetToW(const CStdStringA& strSource, CStdStringW& strDest)
 {
   // No need to flip hebrew/arabic as mplayer does the flipping
-  CSingleLock lock(m_critSection);
-  convert(m_iconvSubtitleCharsetToW,sizeof(wchar_t),g_langInfo.GetSubtitleCharSet(),WCHAR_CHARSET,strSource,strDest);
+  convert(threadIconv(ICONV_SUBTITLE_TO_W),sizeof(wchar_t),g_langInfo.GetSubtitleCharSet(),WCHAR_CHARSET,strSource,strDest);
 }
 
 void CCharsetConverter::fromW(const CStdStringW& strSource,
@@ -458,8 +704,7 @@ void CCharsetConverter::toW(const CStdStringA& strSource,
 
 void CCharsetConverter::utf8ToStringCharset(const CStdStringA& strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
-  convert(m_iconvUtf8ToStringCharset,1,UTF8_SOURCE,g_langInfo.GetGuiCharSet(),strSource,strDest);
+  convert(threadIconv(ICONV_UTF8_TO_STRING),1,UTF8_SOURCE,g_langInfo.GetGuiCharSet(),strSource,strDest);
 }
 
 void CCharsetConverter::utf8ToStringCharset(CStdStringA& strSourceDest)
@@ -521,43 +766,38 @@ void CCharsetConverter::unknownToUTF8(const CStdStringA &source, CStdStringA &de
     dest = source;
   else
   {
-    CSingleLock lock(m_critSection);
-    convert(m_iconvStringCharsetToUtf8, UTF8_DEST_MULTIPLIER, g_langInfo.GetGuiCharSet(), "UTF-8", source, dest);
+    convert(threadIconv(ICONV_STRING_TO_UTF8), UTF8_DEST_MULTIPLIER, g_langInfo.GetGuiCharSet(), "UTF-8", source, dest);
   }
 }
 
 void CCharsetConverter::wToUTF8(const CStdStringW& strSource, CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
-  convert(m_iconvWtoUtf8,UTF8_DEST_MULTIPLIER,WCHAR_CHARSET,"UTF-8",strSource,strDest);
+  if (!wToUTF8Fast(strSource, strDest))
+    convert(threadIconv(ICONV_W_TO_UTF8),UTF8_DEST_MULTIPLIER,WCHAR_CHARSET,"UTF-8",strSource,strDest);
 }
 
 void CCharsetConverter::utf16BEtoUTF8(const CStdString16& strSource, CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUtf16BEtoUtf8,UTF8_DEST_MULTIPLIER,"UTF-16BE","UTF-8",strSource,strDest))
+  if(!convert_checked(threadIconv(ICONV_UTF16BE_TO_UTF8),UTF8_DEST_MULTIPLIER,"UTF-16BE","UTF-8",strSource,strDest))
     strDest.clear();
 }
 
 void CCharsetConverter::utf16LEtoUTF8(const CStdString16& strSource,
                                       CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUtf16LEtoUtf8,UTF8_DEST_MULTIPLIER,"UTF-16LE","UTF-8",strSource,strDest))
+  if(!convert_checked(threadIconv(ICONV_UTF16LE_TO_UTF8),UTF8_DEST_MULTIPLIER,"UTF-16LE","UTF-8",strSource,strDest))
     strDest.clear();
 }
 
 void CCharsetConverter::ucs2ToUTF8(const CStdString16& strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUcs2CharsetToUtf8,UTF8_DEST_MULTIPLIER,"UCS-2LE","UTF-8",strSource,strDest))
+  if(!convert_checked(threadIconv(ICONV_UCS2_TO_UTF8),UTF8_DEST_MULTIPLIER,"UCS-2LE","UTF-8",strSource,strDest))
     strDest.clear();
 }
 
 void CCharsetConverter::utf16LEtoW(const CStdString16& strSource, CStdStringW &strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUtf16LEtoW,sizeof(wchar_t),"UTF-16LE",WCHAR_CHARSET,strSource,strDest))
+  if(!convert_checked(threadIconv(ICONV_UTF16LE_TO_W),sizeof(wchar_t),"UTF-16LE",WCHAR_CHARSET,strSource,strDest))
     strDest.clear();
 }
 
@@ -578,22 +818,21 @@ void CCharsetConverter::ucs2CharsetToStringCharset(const CStdStringW& strSource,
       s++;
     }
   }
-  CSingleLock lock(m_critSection);
-  convert(m_iconvUcs2CharsetToStringCharset,4,"UTF-16LE",
+  convert(threadIconv(ICONV_UCS2_TO_STRING),4,"UTF-16LE",
           g_langInfo.GetGuiCharSet(),strCopy,strDest);
 }
 
 void CCharsetConverter::utf32ToStringCharset(const unsigned long* strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
+  iconv_t& iconvUtf32 = threadIconv(ICONV_UTF32_TO_STRING);
 
-  if (m_iconvUtf32ToStringCharset == (iconv_t) - 1)
+  if (iconvUtf32 == (iconv_t) - 1)
   {
     CStdString strCharset=g_langInfo.GetGuiCharSet();
-    m_iconvUtf32ToStringCharset = iconv_open(strCharset.c_str(), "UTF-32LE");
+    iconvUtf32 = iconv_open(strCharset.c_str(), "UTF-32LE");
   }
 
-  if (m_iconvUtf32ToStringCharset != (iconv_t) - 1)
+  if (iconvUtf32 != (iconv_t) - 1)
   {
     const unsigned long* ptr=strSource;
     while (*ptr) ptr++;
@@ -603,7 +842,7 @@ void CCharsetConverter::utf32ToStringCharset(const unsigned long* strSource, CSt
     char *dst = strDest.GetBuffer(inBytes);
     size_t outBytes = inBytes;
 
-    if (iconv_const(m_iconvUtf32ToStringCharset, &src, &inBytes, &dst, &outBytes) == (size_t)-1)
+    if (iconv_const(iconvUtf32, &src, &inBytes, &dst, &outBytes) == (size_t)-1)
     {
       CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
       strDest.ReleaseBuffer();
@@ -611,7 +850,7 @@ void CCharsetConverter::utf32ToStringCharset(const unsigned long* strSource, CSt
       return;
     }
 
-    if (iconv(m_iconvUtf32ToStringCharset, NULL, NULL, &dst, &outBytes) == (size_t)-1)
+    if (iconv(iconvUtf32, NULL, NULL, &dst, &outBytes) == (size_t)-1)
     {
       CLog::Log(LOGERROR, "%s failed cleanup", __FUNCTION__);
       strDest.ReleaseBuffer();
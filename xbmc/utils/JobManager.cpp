@@ -109,6 +109,10 @@ void CJobQueue::CancelJob(const CJob *job)
   {
     i->CancelJob();
     m_processing.erase(i);
+    /* PLEX */
+    // its place is free, the queued ones would wait for the next one to complete otherwise
+    QueueNextJob();
+    /* END PLEX */
     return;
   }
   Queue::iterator j = find(m_jobQueue.begin(), m_jobQueue.end(), job);
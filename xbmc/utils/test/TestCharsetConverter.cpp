@@ -19,7 +19,10 @@
  */
 
 #include "settings/GUISettings.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
 #include "utils/CharsetConverter.h"
+#include "utils/log.h"
 
 #include "gtest/gtest.h"
 
@@ -122,6 +125,38 @@ TEST_F(TestCharsetConverter, utf8ToW)
   EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
 }
 
+TEST_F(TestCharsetConverter, utf8ToW_nonASCII)
+{
+  refstra1 = "Amélie – 千と千尋の神隠し 🐭";
+  refstrw1.clear();
+  g_charsetConverter.toW(refstra1, refstrw1, "UTF-8");
+  varstrw1.clear();
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, false);
+  EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
+}
+
+TEST_F(TestCharsetConverter, utf8ToW_invalid)
+{
+  /* the bytes that aren't UTF-8 are dropped */
+  refstra1 = "a\xff" "b\xc3(c\xed\xa0\x80" "d";
+  refstrw1 = L"ab(cd";
+  varstrw1.clear();
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, false);
+  EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
+}
+
+TEST_F(TestCharsetConverter, utf8ToW_noBiDi)
+{
+  bool flipped = true;
+  refstra1 = "Amélie – 千と千尋の神隠し";
+  refstrw1.clear();
+  g_charsetConverter.utf8ToW(refstra1, refstrw1, false);
+  varstrw1.clear();
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, true, false, &flipped);
+  EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
+  EXPECT_FALSE(flipped);
+}
+
 TEST_F(TestCharsetConverter, utf16LEtoW)
 {
   refstrw1 = L"ｔｅｓｔ＿ｕｔｆ１６ＬＥｔｏｗ";
@@ -245,6 +280,16 @@ TEST_F(TestCharsetConverter, wToUTF8)
   EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
 }
 
+TEST_F(TestCharsetConverter, wToUTF8_roundTrip)
+{
+  refstra1 = "Amélie – 千と千尋の神隠し 🐭";
+  varstrw1.clear();
+  g_charsetConverter.utf8ToW(refstra1, varstrw1, false);
+  varstra1.clear();
+  g_charsetConverter.wToUTF8(varstrw1, varstra1);
+  EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
+}
+
 TEST_F(TestCharsetConverter, utf16BEtoUTF8)
 {
   refstr16_1.assign(refutf16BE);
@@ -393,3 +438,60 @@ TEST_F(TestCharsetConverter, fromW)
   g_charsetConverter.fromW(refstrw1, varstra1, "UTF-16LE");
   EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
 }
+
+class CharsetConverterRunner : public IRunnable
+{
+public:
+  CharsetConverterRunner(int count) : m_count(count), m_failed(0) {}
+
+  void Run()
+  {
+    CStdStringA utf8 = "Amélie – 千と千尋の神隠し", back;
+    CStdStringW wide;
+    for (int i = 0; i < m_count; i++)
+    {
+      g_charsetConverter.utf8ToW(utf8, wide);
+      g_charsetConverter.wToUTF8(wide, back);
+      if (back != utf8)
+        m_failed++;
+    }
+  }
+
+  int m_count;
+  int m_failed;
+};
+
+static unsigned int runConverters(int threads, int count)
+{
+  std::vector<CharsetConverterRunner*> runners;
+  std::vector<CThread*> running;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+
+  for (int i = 0; i < threads; i++)
+  {
+    runners.push_back(new CharsetConverterRunner(count));
+    running.push_back(new CThread(runners.back(), "CharsetConverterRunner"));
+    running.back()->Create();
+  }
+
+  int failed = 0;
+  for (int i = 0; i < threads; i++)
+  {
+    running[i]->StopThread(true);
+    failed += runners[i]->m_failed;
+    delete running[i];
+    delete runners[i];
+  }
+  EXPECT_EQ(0, failed);
+
+  return XbmcThreads::SystemClockMillis() - start;
+}
+
+TEST_F(TestCharsetConverter, multiThreaded)
+{
+  /* the threads convert without waiting for each other */
+  unsigned int one = runConverters(1, 100000);
+  unsigned int four = runConverters(4, 100000);
+  CLog::Log(LOGINFO, "TestCharsetConverter: 100000 round trips on 1 thread took %u ms, on each of 4 threads %u ms",
+            one, four);
+}